@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Compares two builds of an ELF file and prints every section and symbol which differs between them
+// With -abi, only compares the symbols exported by two builds of a shared object and prints the ABI changes
+// Usage: elfdiff [-abi] <old file> <new file>
+
+void* read_file(const char* name, uint64_t* size_out);
+int diff_abi(const void* old_data, const ElfParser_Header* old_header,
+             const void* new_data, const ElfParser_Header* new_header);
+
+void print_diff(const ElfParser_DiffEntry* entry, void* user_data) {
+    uint64_t* num_diffs = user_data;
+    (*num_diffs)++;
+    
+    switch (entry->kind) {
+        case ELFPARSER_DIFF_SECTION_ADDED:
+            printf("+ section %s\n", entry->name);
+            break;
+        case ELFPARSER_DIFF_SECTION_REMOVED:
+            printf("- section %s\n", entry->name);
+            break;
+        case ELFPARSER_DIFF_SECTION_RESIZED:
+            printf("~ section %s size 0x%llx -> 0x%llx\n", entry->name,
+                   (long long unsigned)entry->old_value, (long long unsigned)entry->new_value);
+            break;
+        case ELFPARSER_DIFF_SECTION_CHANGED:
+            printf("~ section %s contents changed\n", entry->name);
+            break;
+        case ELFPARSER_DIFF_SYMBOL_ADDED:
+            printf("+ symbol %s\n", entry->name);
+            break;
+        case ELFPARSER_DIFF_SYMBOL_REMOVED:
+            printf("- symbol %s\n", entry->name);
+            break;
+        case ELFPARSER_DIFF_SYMBOL_MOVED:
+            printf("~ symbol %s value 0x%llx -> 0x%llx\n", entry->name,
+                   (long long unsigned)entry->old_value, (long long unsigned)entry->new_value);
+            break;
+        case ELFPARSER_DIFF_SYMBOL_RESIZED:
+            printf("~ symbol %s size 0x%llx -> 0x%llx\n", entry->name,
+                   (long long unsigned)entry->old_value, (long long unsigned)entry->new_value);
+            break;
+    }
+}
+
+void print_abi_symbol(char prefix, const ElfParser_AbiSymbol* symbol) {
+    printf("%c %s", prefix, symbol->name);
+    if (symbol->version[0] != '\0') printf("%s%s", symbol->is_default_version ? "@@" : "@", symbol->version);
+}
+
+void print_abi_change(const ElfParser_AbiChange* change, void* user_data) {
+    switch (change->kind) {
+        case ELFPARSER_ABI_ADDED:
+            print_abi_symbol('+', change->new_symbol);
+            break;
+        case ELFPARSER_ABI_REMOVED:
+            print_abi_symbol('-', change->old_symbol);
+            break;
+        case ELFPARSER_ABI_SIZE_CHANGED:
+            print_abi_symbol('!', change->new_symbol);
+            printf(" size 0x%llx -> 0x%llx", (long long unsigned)change->old_symbol->st_size,
+                   (long long unsigned)change->new_symbol->st_size);
+            break;
+        case ELFPARSER_ABI_TYPE_CHANGED:
+            print_abi_symbol('!', change->new_symbol);
+            printf(" type %d -> %d", change->old_symbol->st_type, change->new_symbol->st_type);
+            break;
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    bool abi_only = argc == 4 && strcmp(argv[1], "-abi") == 0;
+    if (argc != 3 && !abi_only) {
+        printf("Usage: %s [-abi] <old file> <new file>\n", argv[0]);
+        return 2;
+    }
+    
+    uint64_t old_size, new_size;
+    void* old_data = read_file(argv[argc - 2], &old_size);
+    void* new_data = read_file(argv[argc - 1], &new_size);
+    if (old_data == NULL || new_data == NULL) return 2;
+    
+    ElfParser_Header old_header, new_header;
+    if (elfparser_get_header(old_data, old_size, &old_header) != ELFPARSER_NOERROR ||
+        elfparser_get_header(new_data, new_size, &new_header) != ELFPARSER_NOERROR) {
+        printf("Error while parsing ELF header!\n");
+        return 2;
+    }
+    
+    if (abi_only) return diff_abi(old_data, &old_header, new_data, &new_header);
+    
+    uint64_t buffer_size = elfparser_get_diff_buffer_size(&old_header, &new_header);
+    void* buffer = malloc(buffer_size);
+    if (buffer == NULL) {
+        printf("Could not allocate diff buffer!\n");
+        return 2;
+    }
+    
+    uint64_t num_diffs = 0;
+    elfparser_diff(old_data, &old_header, new_data, &new_header, buffer, buffer_size, print_diff, &num_diffs);
+    
+    printf("%llu differences\n", (long long unsigned)num_diffs);
+    
+    // Exit code follows diff - 0 if same, 1 if different
+    return num_diffs == 0 ? 0 : 1;
+}
+
+
+int diff_abi(const void* old_data, const ElfParser_Header* old_header,
+             const void* new_data, const ElfParser_Header* new_header) {
+    ElfParser_SymbolTable old_dynsym, new_dynsym;
+    if (elfparser_get_symbol_table(old_data, old_header, ELFPARSER_SHT_DYNSYM, &old_dynsym) != ELFPARSER_NOERROR ||
+        elfparser_get_symbol_table(new_data, new_header, ELFPARSER_SHT_DYNSYM, &new_dynsym) != ELFPARSER_NOERROR) {
+        printf("Could not find .dynsym!\n");
+        return 2;
+    }
+    
+    // The number of symbols in .dynsym is an upper bound on the number of exported symbols
+    ElfParser_AbiSymbol* old_symbols = malloc(sizeof(ElfParser_AbiSymbol) * old_dynsym.num);
+    ElfParser_AbiSymbol* new_symbols = malloc(sizeof(ElfParser_AbiSymbol) * new_dynsym.num);
+    if (old_symbols == NULL || new_symbols == NULL) {
+        printf("Could not allocate symbol tables!\n");
+        return 2;
+    }
+    
+    uint64_t old_num, new_num;
+    elfparser_get_abi(old_data, old_header, old_symbols, old_dynsym.num, &old_num);
+    elfparser_get_abi(new_data, new_header, new_symbols, new_dynsym.num, &new_num);
+    
+    uint64_t num_incompatible = elfparser_compare_abi(old_symbols, old_num, new_symbols, new_num, print_abi_change, NULL);
+    
+    printf("%llu exported symbols, %llu incompatible changes\n",
+           (long long unsigned)new_num, (long long unsigned)num_incompatible);
+    
+    return num_incompatible == 0 ? 0 : 1;
+}
+
+
+void* read_file(const char* name, uint64_t* size_out) {
+    FILE* fptr = fopen(name, "rb");
+    
+    if (fptr == NULL) {
+        printf("Could not open file %s!\n", name);
+        return NULL;
+    }
+    
+    // Get file size
+    fseek(fptr, 0L, SEEK_END);
+    *size_out = ftell(fptr);
+    rewind(fptr);
+    
+    void* buffer = malloc(*size_out);
+    if (buffer == NULL || fread(buffer, *size_out, 1, fptr) != 1) {
+        printf("Could not read file %s!\n", name);
+        free(buffer);
+        buffer = NULL;
+    }
+    
+    fclose(fptr);
+    return buffer;
+}
\ No newline at end of file
@@ -0,0 +1,354 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Finds which of many ELF files define a symbol without opening the ones that can't. Building the index scans the
+// symbol tables of every ELF file under some paths into one Bloom filter per file, stored in a single index file which
+// queries map and check a name against with one cache line per file. Only the few files whose filter matches are
+// opened, to confirm they really define the symbol
+// Usage: elffind -b <index> <path>...      Build an index of the files under each path
+//        elffind [-n] <index> <symbol>...  Print the files defining each symbol, -n skips confirming
+
+#define SNIFF_SIZE      64      // Enough for a 32 or 64 bit ELF header
+#define INDEX_MAGIC     "ELFFIND1"
+
+// Start of an index file. Offsets are from the start of the file, so the index works wherever it's mapped
+typedef struct {
+    char        magic[8];
+    uint64_t    num_files;
+    uint64_t    filters_offset;     // ElfParser_SymbolFilterRef[num_files]
+    uint64_t    paths_offset;       // uint64_t[num_files] holding the offset of each path
+    uint64_t    size;               // Size of the whole file
+} IndexHeader;
+
+typedef struct {
+    uint8_t*    data;
+    uint64_t    size;
+    uint64_t    capacity;
+} Buffer;
+
+Buffer filter_data;     // Filters of the files found so far, back to back
+Buffer filter_refs;     // ElfParser_SymbolFilterRef of each file, offsets relative to filter_data
+Buffer path_data;       // Paths of the files, null terminated
+Buffer path_offsets;    // uint64_t offset of each path into path_data
+uint64_t num_files;
+
+int build_index(const char* index_path, char** paths, int num_paths);
+int query_index(const char* index_path, char** symbols, int num_symbols, bool confirm);
+
+
+int main(int argc, char** argv) {
+    if (argc > 3 && strcmp(argv[1], "-b") == 0) return build_index(argv[2], argv + 3, argc - 3);
+    if (argc > 3 && strcmp(argv[1], "-n") == 0) return query_index(argv[2], argv + 3, argc - 3, false);
+    if (argc > 2 && argv[1][0] != '-')          return query_index(argv[1], argv + 2, argc - 2, true);
+    
+    printf("Usage: %s -b <index> <path>...\n", argv[0]);
+    printf("       %s [-n] <index> <symbol>...\n", argv[0]);
+    return 1;
+}
+
+
+// Returns a pointer to `size` bytes added to the end of the buffer, NULL if out of memory
+void* grow_buffer(Buffer* buffer, uint64_t size) {
+    if (buffer->capacity - buffer->size < size) {
+        uint64_t capacity = buffer->capacity ? buffer->capacity : 4096;
+        while (capacity - buffer->size < size) capacity *= 2;
+        
+        uint8_t* data = realloc(buffer->data, capacity);
+        if (data == NULL) return NULL;
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    
+    void* ptr = buffer->data + buffer->size;
+    buffer->size += size;
+    return ptr;
+}
+
+// Maps a whole file read-only, returns NULL on failure
+void* map_file(const char* path, uint64_t* size_out) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    
+    *size_out = st.st_size;
+    return data;
+}
+
+
+void add_file(const char* path) {
+    // Most files aren't ELF files, so read just the header before committing to mapping the whole file
+    int fd = open(path, O_RDONLY | O_NOFOLLOW | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return;
+    
+    uint8_t sniff[SNIFF_SIZE];
+    ElfParser_Header header;
+    ssize_t sniff_size = pread(fd, sniff, sizeof(sniff), 0);
+    close(fd);
+    if (sniff_size <= 0 || elfparser_sniff_header(sniff, sniff_size, &header) != ELFPARSER_NOERROR) return;
+    
+    uint64_t size;
+    void* data = map_file(path, &size);
+    if (data == NULL) return;
+    
+    if (elfparser_get_header(data, size, &header) == ELFPARSER_NOERROR) {
+        uint64_t filter_size = elfparser_get_symbol_filter_size(data, &header);
+        uint64_t filter_offset = filter_data.size;
+        uint64_t path_offset = path_data.size;
+        uint64_t path_len = strlen(path) + 1;
+        
+        void* filter = grow_buffer(&filter_data, filter_size);
+        ElfParser_SymbolFilterRef* ref = grow_buffer(&filter_refs, sizeof(ElfParser_SymbolFilterRef));
+        void* path_copy = grow_buffer(&path_data, path_len);
+        uint64_t* path_ref = grow_buffer(&path_offsets, sizeof(uint64_t));
+        if (filter == NULL || ref == NULL || path_copy == NULL || path_ref == NULL) {
+            fprintf(stderr, "Out of memory!\n");
+            exit(1);
+        }
+        
+        elfparser_build_symbol_filter(data, &header, filter, filter_size);
+        ref->offset = filter_offset;
+        ref->size = filter_size;
+        memcpy(path_copy, path, path_len);
+        *path_ref = path_offset;
+        num_files++;
+    }
+    munmap(data, size);
+}
+
+char* join_path(const char* dir, const char* name) {
+    uint64_t dir_len = strlen(dir);
+    uint64_t name_len = strlen(name);
+    char* path = malloc(dir_len + name_len + 2);
+    if (path == NULL) return NULL;
+    
+    memcpy(path, dir, dir_len);
+    uint64_t len = dir_len;
+    if (len == 0 || path[len - 1] != '/') path[len++] = '/';
+    memcpy(path + len, name, name_len + 1);
+    return path;
+}
+
+void add_directory(const char* path) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) return;
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        
+        // Symlinks are not followed, so every file is indexed once under its real path and loops are impossible
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+            if (S_ISDIR(st.st_mode))        type = DT_DIR;
+            else if (S_ISREG(st.st_mode))   type = DT_REG;
+        }
+        if (type != DT_DIR && type != DT_REG) continue;
+        
+        char* child = join_path(path, entry->d_name);
+        if (child == NULL) continue;
+        
+        if (type == DT_DIR) {
+            add_directory(child);
+        } else {
+            add_file(child);
+        }
+        free(child);
+    }
+    closedir(dir);
+}
+
+bool write_padding(FILE* file, uint64_t size) {
+    static const uint8_t zeros[ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE];
+    return fwrite(zeros, 1, size, file) == size;
+}
+
+int build_index(const char* index_path, char** paths, int num_paths) {
+    for (int i = 0; i < num_paths; i++) {
+        struct stat st;
+        if (stat(paths[i], &st) != 0) {
+            fprintf(stderr, "Could not open %s!\n", paths[i]);
+        } else if (S_ISDIR(st.st_mode)) {
+            add_directory(paths[i]);
+        } else if (S_ISREG(st.st_mode)) {
+            add_file(paths[i]);
+        }
+    }
+    
+    // Header, filter refs, path offsets and paths, then the filters starting on a block boundary
+    IndexHeader header;
+    memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.num_files        = num_files;
+    header.filters_offset   = sizeof(IndexHeader);
+    header.paths_offset     = header.filters_offset + filter_refs.size;
+    
+    uint64_t path_data_offset = header.paths_offset + path_offsets.size;
+    uint64_t paths_end = path_data_offset + path_data.size;
+    uint64_t filter_data_offset = (paths_end + ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE - 1) &
+                                  ~(uint64_t)(ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE - 1);
+    header.size = filter_data_offset + filter_data.size;
+    
+    ElfParser_SymbolFilterRef* refs = (ElfParser_SymbolFilterRef*)filter_refs.data;
+    uint64_t* offsets = (uint64_t*)path_offsets.data;
+    for (uint64_t i = 0; i < num_files; i++) {
+        refs[i].offset += filter_data_offset;
+        offsets[i] += path_data_offset;
+    }
+    
+    FILE* file = fopen(index_path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not create %s!\n", index_path);
+        return 1;
+    }
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                      fwrite(filter_refs.data, 1, filter_refs.size, file) == filter_refs.size &&
+                      fwrite(path_offsets.data, 1, path_offsets.size, file) == path_offsets.size &&
+                      fwrite(path_data.data, 1, path_data.size, file) == path_data.size &&
+                      write_padding(file, filter_data_offset - paths_end) &&
+                      fwrite(filter_data.data, 1, filter_data.size, file) == filter_data.size;
+    if (fclose(file) != 0 || !is_written) {
+        fprintf(stderr, "Could not write %s!\n", index_path);
+        return 1;
+    }
+    
+    fprintf(stderr, "Indexed %lu files, %lu bytes of filters\n", num_files, filter_data.size);
+    return 0;
+}
+
+
+// Checks that every filter and path of a mapped index lies within it
+bool is_index_valid(const uint8_t* index, uint64_t size) {
+    if (size < sizeof(IndexHeader)) return false;
+    
+    const IndexHeader* header = (const IndexHeader*)index;
+    if (memcmp(header->magic, INDEX_MAGIC, sizeof(header->magic)) != 0 || header->size != size) return false;
+    if (header->filters_offset % 8 != 0 || header->paths_offset % 8 != 0) return false;
+    if (header->filters_offset > size || header->paths_offset > size) return false;
+    if (header->num_files > (size - header->filters_offset) / sizeof(ElfParser_SymbolFilterRef)) return false;
+    if (header->num_files > (size - header->paths_offset) / sizeof(uint64_t)) return false;
+    
+    const ElfParser_SymbolFilterRef* refs = (const ElfParser_SymbolFilterRef*)(index + header->filters_offset);
+    const uint64_t* offsets = (const uint64_t*)(index + header->paths_offset);
+    for (uint64_t i = 0; i < header->num_files; i++) {
+        if (refs[i].offset % 8 != 0 || refs[i].offset > size || refs[i].size > size - refs[i].offset) return false;
+        if (offsets[i] >= size || memchr(index + offsets[i], '\0', size - offsets[i]) == NULL) return false;
+    }
+    return true;
+}
+
+bool table_defines_symbol(const void* data, const ElfParser_Header* header, ElfParser_SH_Type type, const char* name) {
+    ElfParser_SymbolTable table;
+    if (elfparser_get_symbol_table(data, header, type, &table) != ELFPARSER_NOERROR) return false;
+    
+    // The same symbols elfparser_build_symbol_filter adds to a filter
+    ElfParser_SymbolQuery query;
+    elfparser_symbol_query_init(&query);
+    query.bind_mask     = 1 << ELFPARSER_STB_GLOBAL | 1 << ELFPARSER_STB_WEAK | 1 << ELFPARSER_STB_GNU_UNIQUE;
+    query.shndx_min     = ELFPARSER_SHN_UNDEF + 1;
+    query.name_prefix   = name;
+    
+    ElfParser_SymbolQueryCursor cursor;
+    elfparser_symbol_query_cursor_init(data, header, &table, &query, &cursor);
+    
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_query_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        if (strcmp(symbol.name, name) == 0) return true;
+    }
+    return false;
+}
+
+bool file_defines_symbol(const char* path, const char* name) {
+    uint64_t size;
+    void* data = map_file(path, &size);
+    if (data == NULL) {
+        fprintf(stderr, "Could not open %s!\n", path);
+        return false;
+    }
+    
+    ElfParser_Header header;
+    bool is_defined = elfparser_get_header(data, size, &header) == ELFPARSER_NOERROR &&
+                      (table_defines_symbol(data, &header, ELFPARSER_SHT_SYMTAB, name) ||
+                       table_defines_symbol(data, &header, ELFPARSER_SHT_DYNSYM, name));
+    munmap(data, size);
+    return is_defined;
+}
+
+int query_index(const char* index_path, char** symbols, int num_symbols, bool confirm) {
+    uint64_t size;
+    const uint8_t* index = map_file(index_path, &size);
+    if (index == NULL) {
+        fprintf(stderr, "Could not open %s!\n", index_path);
+        return 1;
+    }
+    if (!is_index_valid(index, size)) {
+        fprintf(stderr, "%s is not a valid index!\n", index_path);
+        return 1;
+    }
+    
+    const IndexHeader* header = (const IndexHeader*)index;
+    const ElfParser_SymbolFilterRef* refs = (const ElfParser_SymbolFilterRef*)(index + header->filters_offset);
+    const uint64_t* offsets = (const uint64_t*)(index + header->paths_offset);
+    
+    uint64_t* matches = malloc((header->num_files + 1) * sizeof(uint64_t));
+    if (matches == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        return 1;
+    }
+    
+    int ret = 1;
+    for (int i = 0; i < num_symbols; i++) {
+        ElfParser_SymbolFilterKey key;
+        elfparser_symbol_filter_key_init(symbols[i], &key);
+        uint64_t num_matches = elfparser_scan_symbol_filters(index, refs, header->num_files, &key, matches);
+        
+        for (uint64_t j = 0; j < num_matches; j++) {
+            const char* path = (const char*)index + offsets[matches[j]];
+            if (confirm && !file_defines_symbol(path, symbols[i])) continue;
+            
+            if (num_symbols > 1) printf("%s\t", symbols[i]);
+            printf("%s\n", path);
+            ret = 0;
+        }
+    }
+    return ret;
+}
\ No newline at end of file
@@ -0,0 +1,504 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <fcntl.h>
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Lists the transitive shared library dependencies of ELF files, like ldd but without running anything
+// Libraries are searched for inside a sysroot the same way the dynamic linker would: DT_RPATH, -L directories,
+// DT_RUNPATH, the directories in /etc/ld.so.conf, then the default directories
+// Usage: elfldd [--sysroot <dir>] [-L <dir>]... <file>...
+
+#define MAX_PATH_LEN    4096
+#define MAX_DIRS        256
+
+// Parsed once per (device, inode, modification time), however many paths or binaries lead to it
+typedef struct {
+    dev_t               dev;
+    ino_t               ino;
+    struct timespec     mtime;
+    
+    bool                is_valid;       // False if the file isn't an ELF file with a dynamic section
+    uint8_t             ei_class;
+    uint16_t            e_machine;
+    char*               soname;
+    char*               rpath;
+    char*               runpath;
+    bool                has_runpath;
+    char*               interp;         // PT_INTERP, NULL if none
+    char**              needed;
+    uint64_t            num_needed;
+} Library;
+
+// Open addressing hash tables which only ever grow
+typedef struct {
+    Library**           slots;
+    uint64_t            mask;
+    uint64_t            num;
+} LibraryCache;
+
+typedef struct {
+    char**              keys;
+    Library**           values;     // NULL if there is no library at the path
+    uint64_t            mask;
+    uint64_t            num;
+} PathCache;
+
+// One library in the closure of a binary, and the library which first needed it. The same file may be reached through
+// different paths (e.g. symlinks), so the path it was loaded from belongs here rather than in the cached library
+typedef struct {
+    Library*            library;
+    int64_t             loader;     // Index of the loading entry, -1 for the binary itself
+    char*               path;       // Path inside the sysroot
+    char*               origin;     // Directory of path, for $ORIGIN
+} LoadedEntry;
+
+const char* sysroot = "";
+const char* extra_dirs[MAX_DIRS];
+uint64_t num_extra_dirs;
+char* config_dirs[MAX_DIRS];
+uint64_t num_config_dirs;
+
+LibraryCache libraries;
+PathCache paths;
+uint64_t num_parsed;
+
+Library* get_library(const char* path);
+void read_ld_so_conf(const char* path, int depth);
+void print_dependencies(const char* path);
+
+
+int main(int argc, char** argv) {
+    int arg_index = 1;
+    while (arg_index + 1 < argc) {
+        if (strcmp(argv[arg_index], "--sysroot") == 0) {
+            sysroot = argv[arg_index + 1];
+        } else if (strcmp(argv[arg_index], "-L") == 0 && num_extra_dirs < MAX_DIRS) {
+            extra_dirs[num_extra_dirs++] = argv[arg_index + 1];
+        } else {
+            break;
+        }
+        arg_index += 2;
+    }
+    
+    if (arg_index >= argc) {
+        printf("Usage: %s [--sysroot <dir>] [-L <dir>]... <file>...\n", argv[0]);
+        return 1;
+    }
+    
+    // Stands in for ld.so.cache, which is built from the same file
+    read_ld_so_conf("/etc/ld.so.conf", 0);
+    
+    for (int i = arg_index; i < argc; i++) {
+        print_dependencies(argv[i]);
+    }
+    
+    fprintf(stderr, "%llu files parsed\n", (unsigned long long)num_parsed);
+    return 0;
+}
+
+
+uint64_t hash_string(const char* string) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (; *string != '\0'; string++) {
+        hash = (hash ^ (uint8_t)*string) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t hash_key(dev_t dev, ino_t ino, struct timespec mtime) {
+    uint64_t hash = dev * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ ino) * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ mtime.tv_sec) * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ mtime.tv_nsec) * 0x9e3779b97f4a7c15ULL;
+    return hash ^ (hash >> 29);
+}
+
+bool grow_library_cache(void) {
+    uint64_t size = libraries.slots == NULL ? 256 : (libraries.mask + 1) * 2;
+    Library** slots = calloc(size, sizeof(Library*));
+    if (slots == NULL) return false;
+    
+    for (uint64_t i = 0; libraries.slots != NULL && i <= libraries.mask; i++) {
+        Library* library = libraries.slots[i];
+        if (library == NULL) continue;
+        
+        uint64_t slot = hash_key(library->dev, library->ino, library->mtime) & (size - 1);
+        while (slots[slot] != NULL) slot = (slot + 1) & (size - 1);
+        slots[slot] = library;
+    }
+    
+    free(libraries.slots);
+    libraries.slots = slots;
+    libraries.mask = size - 1;
+    return true;
+}
+
+bool grow_path_cache(void) {
+    uint64_t size = paths.keys == NULL ? 1024 : (paths.mask + 1) * 2;
+    char** keys = calloc(size, sizeof(char*));
+    Library** values = calloc(size, sizeof(Library*));
+    if (keys == NULL || values == NULL) {
+        free(keys);
+        free(values);
+        return false;
+    }
+    
+    for (uint64_t i = 0; paths.keys != NULL && i <= paths.mask; i++) {
+        if (paths.keys[i] == NULL) continue;
+        
+        uint64_t slot = hash_string(paths.keys[i]) & (size - 1);
+        while (keys[slot] != NULL) slot = (slot + 1) & (size - 1);
+        keys[slot] = paths.keys[i];
+        values[slot] = paths.values[i];
+    }
+    
+    free(paths.keys);
+    free(paths.values);
+    paths.keys = keys;
+    paths.values = values;
+    paths.mask = size - 1;
+    return true;
+}
+
+
+char* copy_string(const char* string) {
+    char* copy = strdup(string);
+    if (copy == NULL) {
+        fprintf(stderr, "Could not allocate memory!\n");
+        exit(1);
+    }
+    return copy;
+}
+
+// Copies everything needed from the file, so that it can be unmapped straight away
+void parse_library(Library* library, const void* data, uint64_t size) {
+    ElfParser_Header header;
+    ElfParser_DynamicInfo info;
+    if (elfparser_get_header(data, size, &header) != ELFPARSER_NOERROR ||
+        elfparser_get_dynamic_info(data, &header, &info) != ELFPARSER_NOERROR) {
+        return;
+    }
+    
+    library->is_valid       = true;
+    library->ei_class       = header.ei_class;
+    library->e_machine      = header.e_machine;
+    library->soname         = copy_string(info.soname);
+    library->rpath          = copy_string(info.rpath);
+    library->runpath        = copy_string(info.runpath);
+    library->has_runpath    = info.runpath[0] != '\0';
+    library->needed         = calloc(info.num_needed + 1, sizeof(char*));
+    if (library->needed == NULL) return;
+    
+    ElfParser_ProgramHeaderCursor program_header_cursor;
+    elfparser_program_header_cursor_init(data, &header, &program_header_cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&program_header_cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_INTERP || program_header.p_offset >= size || program_header.p_filesz == 0 ||
+            program_header.p_filesz > size - program_header.p_offset) continue;
+        
+        const char* interp = data + program_header.p_offset;
+        if (memchr(interp, '\0', program_header.p_filesz) != NULL) library->interp = copy_string(interp);
+        break;
+    }
+    
+    ElfParser_DynamicCursor cursor;
+    elfparser_dynamic_cursor_init(data, &header, &cursor);
+    
+    ElfParser_DynamicEntry entry;
+    while (elfparser_dynamic_cursor_next(&cursor, &entry) == ELFPARSER_NOERROR && library->num_needed < info.num_needed) {
+        if (entry.d_tag != ELFPARSER_DT_NEEDED) continue;
+        library->needed[library->num_needed++] = copy_string(elfparser_get_dynamic_string(&cursor, entry.d_val));
+    }
+}
+
+// Looks a file up by identity, parsing it only if it hasn't been seen before
+Library* load_library(int fd, const struct stat* st) {
+    uint64_t slot = hash_key(st->st_dev, st->st_ino, st->st_mtim) & libraries.mask;
+    for (; libraries.slots[slot] != NULL; slot = (slot + 1) & libraries.mask) {
+        Library* library = libraries.slots[slot];
+        if (library->dev == st->st_dev && library->ino == st->st_ino &&
+            library->mtime.tv_sec == st->st_mtim.tv_sec && library->mtime.tv_nsec == st->st_mtim.tv_nsec) {
+            return library;
+        }
+    }
+    
+    Library* library = calloc(1, sizeof(Library));
+    if (library == NULL) return NULL;
+    library->dev    = st->st_dev;
+    library->ino    = st->st_ino;
+    library->mtime  = st->st_mtim;
+    
+    if (st->st_size > 0) {
+        void* data = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            parse_library(library, data, st->st_size);
+            munmap(data, st->st_size);
+        }
+    }
+    num_parsed++;
+    
+    libraries.slots[slot] = library;
+    if (++libraries.num * 2 > libraries.mask) grow_library_cache();
+    return library;
+}
+
+// Returns the library at a path inside the sysroot, or NULL if there is no file there
+Library* get_library(const char* path) {
+    if (paths.keys == NULL && !grow_path_cache()) return NULL;
+    if (libraries.slots == NULL && !grow_library_cache()) return NULL;
+    
+    uint64_t slot = hash_string(path) & paths.mask;
+    for (; paths.keys[slot] != NULL; slot = (slot + 1) & paths.mask) {
+        if (strcmp(paths.keys[slot], path) == 0) return paths.values[slot];
+    }
+    
+    char full_path[MAX_PATH_LEN];
+    Library* library = NULL;
+    if (snprintf(full_path, sizeof(full_path), "%s%s", sysroot, path) < (int)sizeof(full_path)) {
+        int fd = open(full_path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) library = load_library(fd, &st);
+        if (fd >= 0) close(fd);
+    }
+    
+    // Remember misses too, most lookups are for directories a library isn't in
+    paths.keys[slot] = copy_string(path);
+    paths.values[slot] = library;
+    if (++paths.num * 2 > paths.mask) grow_path_cache();
+    return library;
+}
+
+
+void read_ld_so_conf(const char* path, int depth) {
+    char full_path[MAX_PATH_LEN];
+    snprintf(full_path, sizeof(full_path), "%s%s", sysroot, path);
+    
+    FILE* fptr = fopen(full_path, "r");
+    if (fptr == NULL) return;
+    
+    char line[MAX_PATH_LEN];
+    while (fgets(line, sizeof(line), fptr) != NULL) {
+        line[strcspn(line, "#\r\n")] = '\0';
+        char* start = line + strspn(line, " \t");
+        char* end = start + strlen(start);
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+        if (*start == '\0') continue;
+        
+        if (strncmp(start, "include", 7) == 0 && (start[7] == ' ' || start[7] == '\t')) {
+            if (depth > 8) continue;
+            char* pattern = start + 7 + strspn(start + 7, " \t");
+            
+            // Relative includes are relative to the directory of the including file
+            char pattern_path[MAX_PATH_LEN];
+            if (pattern[0] == '/') {
+                snprintf(pattern_path, sizeof(pattern_path), "%s%s", sysroot, pattern);
+            } else {
+                const char* slash = strrchr(path, '/');
+                snprintf(pattern_path, sizeof(pattern_path), "%s%.*s/%s", sysroot, (int)(slash - path), path, pattern);
+            }
+            
+            glob_t matches;
+            if (glob(pattern_path, 0, NULL, &matches) == 0) {
+                uint64_t sysroot_len = strlen(sysroot);
+                for (size_t i = 0; i < matches.gl_pathc; i++) {
+                    read_ld_so_conf(matches.gl_pathv[i] + sysroot_len, depth + 1);
+                }
+                globfree(&matches);
+            }
+        } else if (start[0] == '/' && num_config_dirs < MAX_DIRS) {
+            config_dirs[num_config_dirs++] = copy_string(start);
+        }
+    }
+    fclose(fptr);
+}
+
+
+// Same check as the dynamic linker - a library built for another class or machine is skipped, and searching goes on
+bool is_compatible(const Library* library, const Library* dependent) {
+    return library != NULL && library->is_valid && library->ei_class == dependent->ei_class &&
+           library->e_machine == dependent->e_machine;
+}
+
+// Returns the first compatible library named `name` in a list of directories, and writes its path to `path_out`
+Library* search_path_list(const char* path_list, const LoadedEntry* object, const Library* dependent, const char* name,
+                          char* path_out) {
+    const char* lib = object->library->ei_class == ELFPARSER_ELFCLASS64 ? "lib64" : "lib";
+    const char* platform = object->library->e_machine == ELFPARSER_EM_X86_64 ? "x86_64" :
+                           object->library->e_machine == ELFPARSER_EM_AARCH64 ? "aarch64" : NULL;
+    
+    ElfParser_SearchPathCursor cursor;
+    elfparser_search_path_cursor_init(path_list, object->origin, lib, platform, &cursor);
+    
+    char dir[MAX_PATH_LEN];
+    ElfParser_Error err;
+    while ((err = elfparser_search_path_cursor_next(&cursor, dir, sizeof(dir))) != ELFPARSER_NOT_FOUND) {
+        if (err != ELFPARSER_NOERROR) continue;
+        if (snprintf(path_out, MAX_PATH_LEN, "%s/%s", dir, name) >= MAX_PATH_LEN) continue;
+        
+        Library* library = get_library(path_out);
+        if (is_compatible(library, dependent)) return library;
+    }
+    return NULL;
+}
+
+Library* resolve(const LoadedEntry* loaded, int64_t loader_index, const char* name, char* path_out) {
+    const LoadedEntry* entry = &loaded[loader_index];
+    const Library* dependent = entry->library;
+    
+    // Names with a slash are paths, not searched for
+    if (strchr(name, '/') != NULL) {
+        snprintf(path_out, MAX_PATH_LEN, "%s", name);
+        Library* library = get_library(name);
+        return is_compatible(library, dependent) ? library : NULL;
+    }
+    
+    Library* library;
+    
+    // DT_RPATH of the object and then of each object up the chain of loaders, unless the object has DT_RUNPATH
+    if (!dependent->has_runpath) {
+        for (int64_t i = loader_index; i >= 0; i = loaded[i].loader) {
+            const Library* object = loaded[i].library;
+            if (object->has_runpath || object->rpath[0] == '\0') continue;
+            if ((library = search_path_list(object->rpath, &loaded[i], dependent, name, path_out)) != NULL) return library;
+        }
+    }
+    
+    for (uint64_t i = 0; i < num_extra_dirs; i++) {
+        if ((library = search_path_list(extra_dirs[i], entry, dependent, name, path_out)) != NULL) return library;
+    }
+    
+    if (dependent->has_runpath &&
+        (library = search_path_list(dependent->runpath, entry, dependent, name, path_out)) != NULL) {
+        return library;
+    }
+    
+    for (uint64_t i = 0; i < num_config_dirs; i++) {
+        if ((library = search_path_list(config_dirs[i], entry, dependent, name, path_out)) != NULL) return library;
+    }
+    
+    const char* default_dirs = dependent->ei_class == ELFPARSER_ELFCLASS64 ? "/lib64:/usr/lib64:/lib:/usr/lib"
+                                                                          : "/lib:/usr/lib";
+    return search_path_list(default_dirs, entry, dependent, name, path_out);
+}
+
+
+void set_loaded_path(LoadedEntry* entry, const char* path) {
+    entry->path = copy_string(path);
+    entry->origin = copy_string(path);
+    
+    char* slash = strrchr(entry->origin, '/');
+    if (slash == NULL)                  strcpy(entry->origin, ".");
+    else if (slash == entry->origin)    slash[1] = '\0';
+    else                                *slash = '\0';
+}
+
+
+// Loads libraries breadth first like the dynamic linker, so they are printed in load order
+void print_dependencies(const char* path) {
+    Library* root = get_library(path);
+    if (root == NULL || !root->is_valid) {
+        printf("%s: not a dynamic ELF file\n", path);
+        return;
+    }
+    
+    uint64_t capacity = 64;
+    uint64_t num_loaded = 1;
+    LoadedEntry* loaded = malloc(capacity * sizeof(LoadedEntry));
+    if (loaded == NULL) return;
+    loaded[0].library = root;
+    loaded[0].loader = -1;
+    set_loaded_path(&loaded[0], path);
+    
+    // The interpreter is loaded before anything else, so needed entries matching its soname don't load another copy
+    Library* interp = root->interp != NULL ? get_library(root->interp) : NULL;
+    if (interp != NULL && interp->is_valid) {
+        loaded[1].library = interp;
+        loaded[1].loader = -1;
+        set_loaded_path(&loaded[1], root->interp);
+        num_loaded++;
+    }
+    uint64_t num_preloaded = num_loaded;
+    
+    printf("%s:\n", path);
+    
+    for (uint64_t i = 0; i < num_loaded; i++) {
+        // The interpreter's own dependencies are resolved when it is built, not by itself
+        if (i > 0 && i < num_preloaded) continue;
+        Library* object = loaded[i].library;
+        
+        for (uint64_t j = 0; j < object->num_needed; j++) {
+            const char* name = object->needed[j];
+            
+            // Already loaded libraries are matched by soname before anything is searched for
+            bool is_loaded = false;
+            for (uint64_t k = 1; k < num_loaded && !is_loaded; k++) {
+                is_loaded = strcmp(loaded[k].library->soname, name) == 0;
+            }
+            if (is_loaded) continue;
+            
+            char library_path[MAX_PATH_LEN];
+            Library* library = resolve(loaded, i, name, library_path);
+            if (library == NULL) {
+                printf("\t%s => not found\n", name);
+                continue;
+            }
+            
+            for (uint64_t k = 0; k < num_loaded && !is_loaded; k++) {
+                is_loaded = loaded[k].library == library;
+            }
+            if (is_loaded) continue;
+            
+            if (num_loaded == capacity) {
+                capacity *= 2;
+                LoadedEntry* grown = realloc(loaded, capacity * sizeof(LoadedEntry));
+                if (grown == NULL) break;
+                loaded = grown;
+            }
+            loaded[num_loaded].library = library;
+            loaded[num_loaded].loader = i;
+            set_loaded_path(&loaded[num_loaded], library_path);
+            num_loaded++;
+            
+            printf("\t%s => %s\n", name, library_path);
+        }
+    }
+    if (root->interp != NULL) printf("\t%s\n", root->interp);
+    
+    for (uint64_t i = 0; i < num_loaded; i++) {
+        free(loaded[i].path);
+        free(loaded[i].origin);
+    }
+    free(loaded);
+}
\ No newline at end of file
@@ -0,0 +1,420 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#define _GNU_SOURCE // statx
+
+#include <elfparser.h>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Loads many ELF files at once through io_uring, reading only the headers and tables each file needs
+// Every open, stat, read and close is queued on one ring, so thousands of files cost a handful of syscalls
+// Usage: elfload <file>... / elfload - (reads file names from stdin)
+
+#define QUEUE_DEPTH     4096
+#define MAX_FILES       4096    // Files in flight. Each has at most ELFPARSER_LOADER_MAX_REQUESTS reads queued at once
+#define MAX_PATH_LEN    4096
+#define RESERVED_FDS    16      // File descriptors left over for stdio and the ring itself
+#define MAX_READ_SIZE   (1 << 30)   // Bytes per read. Larger requests are read in pieces
+
+typedef enum { SLOT_FREE, SLOT_OPENING, SLOT_STATTING, SLOT_READING, SLOT_CLOSING } SlotState;
+
+typedef struct {
+    SlotState           state;
+    char                path[MAX_PATH_LEN];
+    int                 fd;
+    struct statx        stat;
+    void*               image;
+    uint64_t            image_size;
+    ElfParser_Loader    loader;
+    uint64_t            reads_left;     // Requests of the current batch which haven't been read in full
+    uint64_t            read_done[ELFPARSER_LOADER_MAX_REQUESTS];   // Bytes of each request read so far
+    bool                read_failed;    // A read of the current batch failed or hit the end of the file
+    uint64_t            num_batches;
+    uint64_t            bytes_read;
+} FileSlot;
+
+typedef struct {
+    int                     fd;
+    uint32_t*               sq_head;
+    uint32_t*               sq_tail;
+    uint32_t*               sq_mask;
+    uint32_t*               sq_array;
+    struct io_uring_sqe*    sqes;
+    uint32_t                to_submit;
+    uint32_t*               cq_head;
+    uint32_t*               cq_tail;
+    uint32_t*               cq_mask;
+    struct io_uring_cqe*    cqes;
+} Ring;
+
+// Called once loading of a file finishes. `error` is ELFPARSER_NOERROR if the loader finished
+typedef void (*LoadCallback)(const FileSlot* slot, ElfParser_Error error);
+
+Ring ring;
+FileSlot slots[MAX_FILES];
+FileSlot* free_slots[MAX_FILES];
+uint64_t num_free_slots;
+
+uint64_t get_max_open_files(void);
+bool setup_ring(unsigned entries, unsigned cq_entries, unsigned* cq_entries_out);
+struct io_uring_sqe* get_sqe(void);
+void submit_and_wait(unsigned min_complete);
+bool next_path(int argc, char** argv, int* arg_index, char* path_out);
+void start_file(FileSlot* slot);
+void handle_completion(FileSlot* slot, uint64_t request, int32_t result, LoadCallback callback);
+
+
+void print_file(const FileSlot* slot, ElfParser_Error error) {
+    if (error != ELFPARSER_NOERROR) {
+        printf("%s: not a valid ELF file\n", slot->path);
+        return;
+    }
+    
+    const ElfParser_Header* header = &slot->loader.header;
+    ElfParser_SymbolTable symbols, dynamic_symbols;
+    uint64_t num_symbols = 0, num_dynamic_symbols = 0;
+    if (elfparser_get_symbol_table(slot->image, header, ELFPARSER_SHT_SYMTAB, &symbols) == ELFPARSER_NOERROR) {
+        num_symbols = symbols.num;
+    }
+    if (elfparser_get_symbol_table(slot->image, header, ELFPARSER_SHT_DYNSYM, &dynamic_symbols) == ELFPARSER_NOERROR) {
+        num_dynamic_symbols = dynamic_symbols.num;
+    }
+    
+    printf("%s: type %u, machine %u, %u program headers, %llu sections, %llu symbols, %llu dynamic symbols, "
+           "%llu of %llu bytes read in %llu batches\n",
+           slot->path, header->e_type, header->e_machine, header->e_phnum, (unsigned long long)header->true_shnum,
+           (unsigned long long)num_symbols, (unsigned long long)num_dynamic_symbols,
+           (unsigned long long)slot->bytes_read, (unsigned long long)slot->image_size,
+           (unsigned long long)slot->num_batches);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: %s <file>... / %s - (reads file names from stdin)\n", argv[0], argv[0]);
+        return 1;
+    }
+    // Every read in flight needs room in the completion queue, so it limits the files in flight as much as file
+    // descriptors do
+    unsigned cq_entries;
+    if (!setup_ring(QUEUE_DEPTH, MAX_FILES * ELFPARSER_LOADER_MAX_REQUESTS, &cq_entries)) {
+        printf("Could not set up io_uring!\n");
+        return 1;
+    }
+    uint64_t num_slots = get_max_open_files();
+    if (num_slots > cq_entries / ELFPARSER_LOADER_MAX_REQUESTS) num_slots = cq_entries / ELFPARSER_LOADER_MAX_REQUESTS;
+    for (uint64_t i = 0; i < num_slots; i++) free_slots[num_free_slots++] = &slots[num_slots - 1 - i];
+    
+    int arg_index = 1;
+    bool paths_left = true;
+    uint64_t num_active = 0;
+    
+    while (paths_left || num_active > 0) {
+        // Keep every slot busy
+        while (paths_left && num_free_slots > 0) {
+            FileSlot* slot = free_slots[num_free_slots - 1];
+            paths_left = next_path(argc, argv, &arg_index, slot->path);
+            if (!paths_left) break;
+            
+            num_free_slots--;
+            start_file(slot);
+            num_active++;
+        }
+        if (num_active == 0) break;
+        
+        submit_and_wait(1);
+        
+        // Drain the completion queue
+        uint32_t head = *ring.cq_head;
+        while (head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+            FileSlot* slot = &slots[cqe->user_data / ELFPARSER_LOADER_MAX_REQUESTS];
+            uint64_t request = cqe->user_data % ELFPARSER_LOADER_MAX_REQUESTS;
+            int32_t result = cqe->res;
+            
+            head++;
+            __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+            
+            handle_completion(slot, request, result, print_file);
+            if (slot->state == SLOT_FREE) {
+                free_slots[num_free_slots++] = slot;
+                num_active--;
+            }
+        }
+    }
+    return 0;
+}
+
+
+bool next_path(int argc, char** argv, int* arg_index, char* path_out) {
+    if (strcmp(argv[1], "-") != 0) {
+        if (*arg_index >= argc) return false;
+        strncpy(path_out, argv[(*arg_index)++], MAX_PATH_LEN - 1);
+        path_out[MAX_PATH_LEN - 1] = '\0';
+        return true;
+    }
+    
+    while (fgets(path_out, MAX_PATH_LEN, stdin) != NULL) {
+        path_out[strcspn(path_out, "\n")] = '\0';
+        if (path_out[0] != '\0') return true;
+    }
+    return false;
+}
+
+
+// Completions carry the slot, and for reads, the request of the batch they belong to
+uint64_t get_user_data(const FileSlot* slot, uint64_t request) {
+    return (uint64_t)(slot - slots) * ELFPARSER_LOADER_MAX_REQUESTS + request;
+}
+
+void queue_open(FileSlot* slot) {
+    struct io_uring_sqe* sqe = get_sqe();
+    sqe->opcode     = IORING_OP_OPENAT;
+    sqe->fd         = AT_FDCWD;
+    sqe->addr       = (uintptr_t)slot->path;
+    sqe->open_flags = O_RDONLY | O_NOCTTY | O_NONBLOCK;
+    sqe->user_data  = get_user_data(slot, 0);
+}
+
+void queue_statx(FileSlot* slot) {
+    struct io_uring_sqe* sqe = get_sqe();
+    sqe->opcode     = IORING_OP_STATX;
+    sqe->fd         = slot->fd;
+    sqe->addr       = (uintptr_t)"";
+    sqe->len        = STATX_SIZE | STATX_TYPE;
+    sqe->off        = (uintptr_t)&slot->stat;
+    sqe->statx_flags = AT_EMPTY_PATH;
+    sqe->user_data  = get_user_data(slot, 0);
+}
+
+// Queues a read of the rest of a request, up to MAX_READ_SIZE - sqe->len is 32 bits, and Linux reads at most about
+// 2 GiB at a time anyway
+void queue_read(FileSlot* slot, uint64_t index) {
+    const ElfParser_ReadRequest* request = &slot->loader.requests[index];
+    uint64_t offset = request->offset + slot->read_done[index];
+    uint64_t size = request->size - slot->read_done[index];
+    if (size > MAX_READ_SIZE) size = MAX_READ_SIZE;
+    
+    struct io_uring_sqe* sqe = get_sqe();
+    sqe->opcode     = IORING_OP_READ;
+    sqe->fd         = slot->fd;
+    sqe->addr       = (uintptr_t)slot->image + offset;
+    sqe->len        = size;
+    sqe->off        = offset;
+    sqe->user_data  = get_user_data(slot, index);
+}
+
+void queue_reads(FileSlot* slot) {
+    for (uint64_t i = 0; i < slot->loader.num_requests; i++) {
+        slot->read_done[i] = 0;
+        queue_read(slot, i);
+    }
+    slot->reads_left = slot->loader.num_requests;
+    slot->read_failed = false;
+    slot->num_batches++;
+}
+
+void queue_close(FileSlot* slot) {
+    struct io_uring_sqe* sqe = get_sqe();
+    sqe->opcode     = IORING_OP_CLOSE;
+    sqe->fd         = slot->fd;
+    sqe->user_data  = get_user_data(slot, 0);
+    slot->state = SLOT_CLOSING;
+}
+
+
+void start_file(FileSlot* slot) {
+    slot->state         = SLOT_OPENING;
+    slot->image         = NULL;
+    slot->image_size    = 0;
+    slot->num_batches   = 0;
+    slot->bytes_read    = 0;
+    queue_open(slot);
+}
+
+void finish_file(FileSlot* slot, ElfParser_Error error, LoadCallback callback) {
+    callback(slot, error);
+    if (slot->image != NULL) munmap(slot->image, slot->image_size);
+    slot->image = NULL;
+    queue_close(slot);
+}
+
+// Moves the file on to its next step once an operation on it completes
+void handle_completion(FileSlot* slot, uint64_t request, int32_t result, LoadCallback callback) {
+    switch (slot->state) {
+        case SLOT_OPENING:
+            if (result < 0) {
+                fprintf(stderr, "Could not open file %s!\n", slot->path);
+                slot->state = SLOT_FREE;
+                return;
+            }
+            slot->fd = result;
+            slot->state = SLOT_STATTING;
+            queue_statx(slot);
+            return;
+            
+        case SLOT_STATTING:
+            if (result < 0 || !S_ISREG(slot->stat.stx_mode) || slot->stat.stx_size == 0) {
+                queue_close(slot);
+                return;
+            }
+            
+            // The image is only touched where the loader asks for reads, so reserve address space without backing it
+            slot->image_size = slot->stat.stx_size;
+            slot->image = mmap(NULL, slot->image_size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (slot->image == MAP_FAILED) {
+                slot->image = NULL;
+                queue_close(slot);
+                return;
+            }
+            
+            elfparser_loader_init(&slot->loader, slot->image, slot->image_size,
+                                  ELFPARSER_LOAD_SYMTAB | ELFPARSER_LOAD_DYNSYM | ELFPARSER_LOAD_DYNAMIC);
+            slot->state = SLOT_READING;
+            queue_reads(slot);
+            return;
+            
+        case SLOT_READING:
+            // Reads may come back short, so keep reading until the request is done. Hitting the end of the file
+            // means it shrank since it was statted
+            if (result > 0) {
+                slot->bytes_read += result;
+                slot->read_done[request] += result;
+                if (slot->read_done[request] < slot->loader.requests[request].size) {
+                    queue_read(slot, request);
+                    return;
+                }
+            } else if (slot->read_done[request] < slot->loader.requests[request].size) {
+                slot->read_failed = true;
+            }
+            if (--slot->reads_left > 0) return;
+            
+            if (slot->read_failed) {
+                fprintf(stderr, "Could not read file %s!\n", slot->path);
+                munmap(slot->image, slot->image_size);
+                slot->image = NULL;
+                queue_close(slot);
+            } else if (elfparser_loader_advance(&slot->loader) != ELFPARSER_NOERROR) {
+                finish_file(slot, ELFPARSER_INVALID, callback);
+            } else if (slot->loader.num_requests == 0) {
+                finish_file(slot, ELFPARSER_NOERROR, callback);
+            } else {
+                queue_reads(slot);
+            }
+            return;
+            
+        case SLOT_CLOSING:
+        default:
+            slot->state = SLOT_FREE;
+            return;
+    }
+}
+
+
+// Raises the soft limit on open files as far as allowed, and returns how many files can be in flight under it
+uint64_t get_max_open_files(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return 1;
+    
+    if (limit.rlim_cur < limit.rlim_max) {
+        rlim_t wanted = MAX_FILES + RESERVED_FDS;
+        limit.rlim_cur = limit.rlim_max < wanted ? limit.rlim_max : wanted;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+    
+    if (limit.rlim_cur <= RESERVED_FDS) return 1;
+    return limit.rlim_cur - RESERVED_FDS < MAX_FILES ? limit.rlim_cur - RESERVED_FDS : MAX_FILES;
+}
+
+bool setup_ring(unsigned entries, unsigned cq_entries, unsigned* cq_entries_out) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags        = IORING_SETUP_CQSIZE;
+    params.cq_entries   = cq_entries;
+    
+    // The kernel may round the completion queue up, never down
+    ring.fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring.fd < 0) return false;
+    *cq_entries_out = params.cq_entries;
+    
+    // Assume IORING_FEAT_SINGLE_MMAP (Linux 5.4+) - the submission and completion rings share one mapping
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) return false;
+    
+    uint64_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    uint64_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uint64_t ring_size = sq_size > cq_size ? sq_size : cq_size;
+    
+    void* rings = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED) return false;
+    
+    ring.sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (ring.sqes == MAP_FAILED) return false;
+    
+    ring.sq_head    = rings + params.sq_off.head;
+    ring.sq_tail    = rings + params.sq_off.tail;
+    ring.sq_mask    = rings + params.sq_off.ring_mask;
+    ring.sq_array   = rings + params.sq_off.array;
+    ring.cq_head    = rings + params.cq_off.head;
+    ring.cq_tail    = rings + params.cq_off.tail;
+    ring.cq_mask    = rings + params.cq_off.ring_mask;
+    ring.cqes       = rings + params.cq_off.cqes;
+    ring.to_submit  = 0;
+    return true;
+}
+
+// Returns a zeroed submission queue entry, submitting queued entries first if the queue is full
+struct io_uring_sqe* get_sqe(void) {
+    uint32_t tail = *ring.sq_tail;
+    if (tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) > *ring.sq_mask) {
+        submit_and_wait(0);
+        tail = *ring.sq_tail;
+    }
+    
+    uint32_t index = tail & *ring.sq_mask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    
+    ring.sq_array[index] = index;
+    __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring.to_submit++;
+    return sqe;
+}
+
+void submit_and_wait(unsigned min_complete) {
+    unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int submitted = syscall(__NR_io_uring_enter, ring.fd, ring.to_submit, min_complete, flags, NULL, 0);
+    if (submitted > 0) ring.to_submit -= submitted;
+}
\ No newline at end of file
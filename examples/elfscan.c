@@ -0,0 +1,461 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Walks directory trees in parallel and prints one JSON line per ELF file found, with its architecture, type,
+// interpreter, build ID, needed libraries and whether it is stripped
+// Usage: elfscan [-j threads] <path>...
+
+#define SNIFF_SIZE      64      // Enough for a 32 or 64 bit ELF header
+#define OUTPUT_SIZE     65536   // Per worker output buffer, flushed whole lines at a time
+#define MAX_THREADS     256
+
+// Each worker owns a deque of directories. The owner pushes and pops at the back so that it works depth first with a
+// hot dentry cache, and idle workers steal from the front, which holds the directories closest to the root and so
+// usually the most work
+typedef struct {
+    pthread_mutex_t lock;
+    char**          paths;
+    uint64_t        head;
+    uint64_t        tail;
+    uint64_t        capacity;
+} Deque;
+
+typedef struct {
+    uint64_t        index;
+    char*           output;
+    uint64_t        output_len;
+} Worker;
+
+Deque deques[MAX_THREADS];
+Worker workers[MAX_THREADS];
+uint64_t num_workers;
+atomic_uint_fast64_t pending;   // Directories pushed but not yet fully scanned
+atomic_uint_fast64_t queued;    // Directories waiting in a deque
+atomic_uint_fast64_t num_idle;  // Workers waiting for a directory to be pushed
+pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void push_path(uint64_t worker, char* path);
+char* pop_path(uint64_t worker);
+char* steal_path(uint64_t worker);
+void wait_for_path(void);
+void scan_directory(Worker* worker, const char* path);
+void scan_file(Worker* worker, const char* path);
+void flush_output(Worker* worker);
+
+
+void* worker_main(void* arg) {
+    Worker* worker = arg;
+    
+    while (atomic_load(&pending) != 0) {
+        char* path = pop_path(worker->index);
+        if (path == NULL) path = steal_path(worker->index);
+        if (path == NULL) {
+            wait_for_path();
+            continue;
+        }
+        
+        scan_directory(worker, path);
+        free(path);
+        
+        // The last directory is done, so wake every idle worker to exit
+        if (atomic_fetch_sub(&pending, 1) == 1) {
+            pthread_mutex_lock(&idle_lock);
+            pthread_cond_broadcast(&idle_cond);
+            pthread_mutex_unlock(&idle_lock);
+        }
+    }
+    
+    flush_output(worker);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers = cpus > 0 ? cpus : 1;
+    
+    int first_path = 1;
+    if (argc > 2 && strcmp(argv[1], "-j") == 0) {
+        num_workers = strtoull(argv[2], NULL, 10);
+        first_path = 3;
+    }
+    if (num_workers == 0) num_workers = 1;
+    if (num_workers > MAX_THREADS) num_workers = MAX_THREADS;
+    
+    if (first_path >= argc) {
+        printf("Usage: %s [-j threads] <path>...\n", argv[0]);
+        return 1;
+    }
+    
+    for (uint64_t i = 0; i < num_workers; i++) {
+        pthread_mutex_init(&deques[i].lock, NULL);
+        workers[i].index = i;
+        workers[i].output = malloc(OUTPUT_SIZE);
+        if (workers[i].output == NULL) {
+            printf("Could not allocate output buffers!\n");
+            return 1;
+        }
+    }
+    
+    // Files given on the command line are scanned straight away, directories are spread over the workers
+    for (int i = first_path; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) != 0) {
+            fprintf(stderr, "Could not open %s!\n", argv[i]);
+        } else if (S_ISDIR(st.st_mode)) {
+            atomic_fetch_add(&pending, 1);
+            push_path(i % num_workers, strdup(argv[i]));
+        } else if (S_ISREG(st.st_mode)) {
+            scan_file(&workers[0], argv[i]);
+        }
+    }
+    
+    pthread_t threads[MAX_THREADS];
+    for (uint64_t i = 0; i < num_workers; i++) {
+        pthread_create(&threads[i], NULL, worker_main, &workers[i]);
+    }
+    for (uint64_t i = 0; i < num_workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return 0;
+}
+
+
+void push_path(uint64_t worker, char* path) {
+    Deque* deque = &deques[worker];
+    pthread_mutex_lock(&deque->lock);
+    
+    if (deque->tail == deque->capacity) {
+        // Slide live entries down to the front before growing
+        uint64_t num = deque->tail - deque->head;
+        memmove(deque->paths, deque->paths + deque->head, num * sizeof(char*));
+        deque->head = 0;
+        deque->tail = num;
+        
+        if (num * 2 >= deque->capacity) {
+            deque->capacity = deque->capacity ? deque->capacity * 2 : 64;
+            deque->paths = realloc(deque->paths, deque->capacity * sizeof(char*));
+        }
+    }
+    deque->paths[deque->tail++] = path;
+    
+    // Counted before anyone can take the path. Idle workers count themselves before checking `queued`, so either they
+    // see this path or this sees them
+    atomic_fetch_add(&queued, 1);
+    pthread_mutex_unlock(&deque->lock);
+    
+    if (atomic_load(&num_idle) != 0) {
+        pthread_mutex_lock(&idle_lock);
+        pthread_cond_signal(&idle_cond);
+        pthread_mutex_unlock(&idle_lock);
+    }
+}
+
+char* pop_path(uint64_t worker) {
+    Deque* deque = &deques[worker];
+    pthread_mutex_lock(&deque->lock);
+    char* path = deque->tail > deque->head ? deque->paths[--deque->tail] : NULL;
+    pthread_mutex_unlock(&deque->lock);
+    
+    if (path != NULL) atomic_fetch_sub(&queued, 1);
+    return path;
+}
+
+char* steal_path(uint64_t worker) {
+    // Nothing to steal, without touching the other deques
+    if (atomic_load(&queued) == 0) return NULL;
+    
+    for (uint64_t i = 1; i < num_workers; i++) {
+        Deque* deque = &deques[(worker + i) % num_workers];
+        
+        // The lock is only ever held for a few instructions, so waiting for it is cheap
+        pthread_mutex_lock(&deque->lock);
+        char* path = deque->tail > deque->head ? deque->paths[deque->head++] : NULL;
+        pthread_mutex_unlock(&deque->lock);
+        
+        if (path != NULL) {
+            atomic_fetch_sub(&queued, 1);
+            return path;
+        }
+    }
+    return NULL;
+}
+
+// Blocks until a directory is pushed or every directory has been scanned
+void wait_for_path(void) {
+    pthread_mutex_lock(&idle_lock);
+    atomic_fetch_add(&num_idle, 1);
+    while (atomic_load(&queued) == 0 && atomic_load(&pending) != 0) {
+        pthread_cond_wait(&idle_cond, &idle_lock);
+    }
+    atomic_fetch_sub(&num_idle, 1);
+    pthread_mutex_unlock(&idle_lock);
+}
+
+
+char* join_path(const char* dir, const char* name) {
+    uint64_t dir_len = strlen(dir);
+    uint64_t name_len = strlen(name);
+    char* path = malloc(dir_len + name_len + 2);
+    if (path == NULL) return NULL;
+    
+    memcpy(path, dir, dir_len);
+    uint64_t len = dir_len;
+    if (len == 0 || path[len - 1] != '/') path[len++] = '/';
+    memcpy(path + len, name, name_len + 1);
+    return path;
+}
+
+void scan_directory(Worker* worker, const char* path) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) return;
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        
+        // Symlinks are not followed, so every file is reported once under its real path and loops are impossible
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat st;
+            if (fstatat(dirfd(dir), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue;
+            if (S_ISDIR(st.st_mode))        type = DT_DIR;
+            else if (S_ISREG(st.st_mode))   type = DT_REG;
+        }
+        if (type != DT_DIR && type != DT_REG) continue;
+        
+        char* child = join_path(path, entry->d_name);
+        if (child == NULL) continue;
+        
+        if (type == DT_DIR) {
+            atomic_fetch_add(&pending, 1);
+            push_path(worker->index, child);
+        } else {
+            scan_file(worker, child);
+            free(child);
+        }
+    }
+    closedir(dir);
+}
+
+
+void write_output(Worker* worker, const char* data, uint64_t len) {
+    while (len > 0) {
+        if (worker->output_len == OUTPUT_SIZE) {
+            pthread_mutex_lock(&output_lock);
+            fwrite(worker->output, 1, worker->output_len, stdout);
+            pthread_mutex_unlock(&output_lock);
+            worker->output_len = 0;
+        }
+        
+        uint64_t num = OUTPUT_SIZE - worker->output_len;
+        if (num > len) num = len;
+        memcpy(worker->output + worker->output_len, data, num);
+        worker->output_len += num;
+        data += num;
+        len -= num;
+    }
+}
+
+void write_string(Worker* worker, const char* string) {
+    write_output(worker, string, strlen(string));
+}
+
+void write_json_string(Worker* worker, const char* string) {
+    write_output(worker, "\"", 1);
+    for (const unsigned char* c = (const unsigned char*)string; *c != '\0'; c++) {
+        char escaped[8];
+        if (*c == '"' || *c == '\\') {
+            escaped[0] = '\\';
+            escaped[1] = *c;
+            write_output(worker, escaped, 2);
+        } else if (*c < 0x20) {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            write_output(worker, escaped, 6);
+        } else {
+            write_output(worker, (const char*)c, 1);
+        }
+    }
+    write_output(worker, "\"", 1);
+}
+
+// scan_file flushes between lines once the buffer is half full, so only lines longer than half the buffer can be split
+// and interleave with output from other workers
+void flush_output(Worker* worker) {
+    pthread_mutex_lock(&output_lock);
+    fwrite(worker->output, 1, worker->output_len, stdout);
+    fflush(stdout);
+    pthread_mutex_unlock(&output_lock);
+    worker->output_len = 0;
+}
+
+
+const char* get_machine_name(ElfParser_E_Machine machine) {
+    switch (machine) {
+        case ELFPARSER_EM_386:      return "x86";
+        case ELFPARSER_EM_X86_64:   return "x86_64";
+        case ELFPARSER_EM_ARM:      return "arm";
+        case ELFPARSER_EM_AARCH64:  return "aarch64";
+        case ELFPARSER_EM_PPC64:    return "ppc64";
+        case ELFPARSER_EM_S390:     return "s390";
+        case ELFPARSER_EM_RISCV:    return "riscv";
+        default:                    return NULL;
+    }
+}
+
+const char* get_type_name(ElfParser_E_Type type) {
+    switch (type) {
+        case ELFPARSER_ET_REL:      return "rel";
+        case ELFPARSER_ET_EXEC:     return "exec";
+        case ELFPARSER_ET_DYN:      return "dyn";
+        case ELFPARSER_ET_CORE:     return "core";
+        default:                    return "unknown";
+    }
+}
+
+void write_interpreter(Worker* worker, const void* data, const ElfParser_Header* header) {
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(data, header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_INTERP) continue;
+        if (program_header.p_offset >= header->elf_size || program_header.p_filesz == 0 ||
+            program_header.p_filesz > header->elf_size - program_header.p_offset) return;
+        
+        const char* interp = data + program_header.p_offset;
+        if (memchr(interp, '\0', program_header.p_filesz) == NULL) return;
+        
+        write_string(worker, ",\"interp\":");
+        write_json_string(worker, interp);
+        return;
+    }
+}
+
+void write_build_id(Worker* worker, const void* data, const ElfParser_Header* header) {
+    ElfParser_Note note;
+    if (elfparser_get_note(data, header, "GNU", ELFPARSER_NT_GNU_BUILD_ID, &note) != ELFPARSER_NOERROR) return;
+    
+    write_string(worker, ",\"build_id\":\"");
+    for (uint32_t i = 0; i < note.n_descsz; i++) {
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02x", ((const uint8_t*)note.desc)[i]);
+        write_output(worker, hex, 2);
+    }
+    write_string(worker, "\"");
+}
+
+void write_dynamic(Worker* worker, const void* data, const ElfParser_Header* header) {
+    ElfParser_DynamicCursor cursor;
+    if (elfparser_dynamic_cursor_init(data, header, &cursor) == ELFPARSER_NOT_FOUND) return;
+    
+    bool first_needed = true;
+    const char* soname = NULL;
+    ElfParser_DynamicEntry entry;
+    while (elfparser_dynamic_cursor_next(&cursor, &entry) == ELFPARSER_NOERROR) {
+        if (entry.d_tag == ELFPARSER_DT_SONAME) {
+            soname = elfparser_get_dynamic_string(&cursor, entry.d_val);
+        } else if (entry.d_tag == ELFPARSER_DT_NEEDED) {
+            write_string(worker, first_needed ? ",\"needed\":[" : ",");
+            write_json_string(worker, elfparser_get_dynamic_string(&cursor, entry.d_val));
+            first_needed = false;
+        }
+    }
+    if (!first_needed) write_string(worker, "]");
+    
+    if (soname != NULL) {
+        write_string(worker, ",\"soname\":");
+        write_json_string(worker, soname);
+    }
+}
+
+
+void scan_file(Worker* worker, const char* path) {
+    int fd = open(path, O_RDONLY | O_NOFOLLOW | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return;
+    
+    // Most files aren't ELF files, so read just the header before committing to mapping the whole file
+    uint8_t sniff[SNIFF_SIZE];
+    ElfParser_Header header;
+    ssize_t sniff_size = pread(fd, sniff, sizeof(sniff), 0);
+    if (sniff_size <= 0 || elfparser_sniff_header(sniff, sniff_size, &header) != ELFPARSER_NOERROR) {
+        close(fd);
+        return;
+    }
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return;
+    
+    char line[128];
+    const char* machine = get_machine_name(header.e_machine);
+    snprintf(line, sizeof(line), ",\"class\":%d,\"type\":\"%s\",\"arch\":",
+             header.ei_class == ELFPARSER_ELFCLASS64 ? 64 : 32, get_type_name(header.e_type));
+    
+    write_string(worker, "{\"path\":");
+    write_json_string(worker, path);
+    write_string(worker, line);
+    if (machine != NULL) {
+        write_json_string(worker, machine);
+    } else {
+        snprintf(line, sizeof(line), "\"em_%u\"", (unsigned)header.e_machine);
+        write_string(worker, line);
+    }
+    
+    // Fields past the ELF header are only reported if the rest of the file parses
+    if (elfparser_get_header(data, st.st_size, &header) == ELFPARSER_NOERROR) {
+        ElfParser_SymbolTable symbols;
+        bool stripped = elfparser_get_symbol_table(data, &header, ELFPARSER_SHT_SYMTAB, &symbols) != ELFPARSER_NOERROR;
+        
+        write_interpreter(worker, data, &header);
+        write_build_id(worker, data, &header);
+        write_dynamic(worker, data, &header);
+        write_string(worker, stripped ? ",\"stripped\":true" : ",\"stripped\":false");
+    } else {
+        write_string(worker, ",\"error\":\"invalid\"");
+    }
+    write_string(worker, "}\n");
+    
+    munmap(data, st.st_size);
+    
+    if (worker->output_len > OUTPUT_SIZE / 2) flush_output(worker);
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Answers symbol lookups for a set of ELF files for as long as it runs, reloading a file in the background whenever it
+// is replaced on disk (e.g. by a redeploy). Reads "<file> <address>" lines from stdin and prints the function containing
+// each address, or ?? if there is none
+// A reloader thread checks the device, inode, size and modification time of every file each interval. The indexes of
+// a replaced file are built from scratch and published with elfparser_rcu_publish, so lookups never wait and never see
+// a half-built index, and old versions are unmapped once no lookup can still be using them. Files should be replaced
+// by renaming a new file over them - a file rewritten in place changes under the mapping of the version in use
+// Usage: elfserve [-i <seconds>] <file>...
+
+#define MAX_LINE_LEN    4096
+#define LOOKUP_READER   0       // Reader number of the thread answering lookups
+
+// One build of a file and its indexes
+typedef struct {
+    dev_t                   dev;
+    ino_t                   ino;
+    off_t                   size;
+    struct timespec         mtime;
+    
+    void*                   data;
+    ElfParser_Header        header;
+    ElfParser_FunctionTable functions;
+    void*                   function_buffer;
+} Version;
+
+typedef struct {
+    const char*             path;
+    Version*                version;        // Published through rcu, NULL if the file couldn't be loaded yet
+} Module;
+
+// Version replaced in `epoch`, waiting for the readers which might use it to finish
+typedef struct Retired {
+    Version*                version;
+    uint64_t                epoch;
+    struct Retired*         next;
+} Retired;
+
+ElfParser_RcuDomain rcu;
+Module* modules;
+uint64_t num_modules;
+unsigned int interval = 1;
+
+void* reloader_main(void* arg);
+
+
+int compare_modules(const void* a, const void* b) {
+    return strcmp(((const Module*)a)->path, ((const Module*)b)->path);
+}
+
+Version* load_version(const char* path) {
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) return NULL;
+    
+    // The identity of the version is taken from the file actually opened, not from a path which may change again
+    struct stat st;
+    Version* version = calloc(1, sizeof(Version));
+    void* data = MAP_FAILED;
+    if (version != NULL && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        free(version);
+        return NULL;
+    }
+    
+    version->dev    = st.st_dev;
+    version->ino    = st.st_ino;
+    version->size   = st.st_size;
+    version->mtime  = st.st_mtim;
+    version->data   = data;
+    
+    uint64_t buffer_size = 0;
+    if (elfparser_get_header(data, st.st_size, &version->header) == ELFPARSER_NOERROR) {
+        buffer_size = elfparser_get_function_table_buffer_size(data, &version->header);
+        version->function_buffer = malloc(buffer_size);
+    }
+    if (version->function_buffer == NULL ||
+        elfparser_build_function_table(data, &version->header, version->function_buffer, buffer_size,
+                                       &version->functions) != ELFPARSER_NOERROR) {
+        munmap(data, st.st_size);
+        free(version->function_buffer);
+        free(version);
+        return NULL;
+    }
+    return version;
+}
+
+void free_version(Version* version) {
+    munmap(version->data, version->size);
+    free(version->function_buffer);
+    free(version);
+}
+
+
+int main(int argc, char** argv) {
+    int first_file = 1;
+    if (argc > 2 && strcmp(argv[1], "-i") == 0) {
+        interval = strtoul(argv[2], NULL, 10);
+        first_file = 3;
+    }
+    if (interval == 0) interval = 1;
+    
+    if (first_file >= argc) {
+        printf("Usage: %s [-i <seconds>] <file>...\n", argv[0]);
+        return 1;
+    }
+    
+    // Files are looked up with a binary search on their path
+    num_modules = argc - first_file;
+    modules = malloc(num_modules * sizeof(Module));
+    if (modules == NULL) {
+        printf("Could not allocate modules!\n");
+        return 1;
+    }
+    for (uint64_t i = 0; i < num_modules; i++) {
+        modules[i].path = argv[first_file + i];
+        modules[i].version = load_version(modules[i].path);
+        if (modules[i].version == NULL) fprintf(stderr, "Could not load %s!\n", modules[i].path);
+    }
+    qsort(modules, num_modules, sizeof(Module), compare_modules);
+    
+    elfparser_rcu_init(&rcu);
+    pthread_t reloader;
+    pthread_create(&reloader, NULL, reloader_main, NULL);
+    
+    char line[MAX_LINE_LEN];
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char* address_str = strrchr(line, ' ');
+        if (address_str == NULL) continue;
+        *address_str++ = '\0';
+        
+        Module key = { .path = line };
+        Module* module = bsearch(&key, modules, num_modules, sizeof(Module), compare_modules);
+        if (module == NULL) {
+            printf("Unknown file %s\n", line);
+            fflush(stdout);
+            continue;
+        }
+        
+        ElfParser_AddressLookup lookup;
+        lookup.address = strtoull(address_str, NULL, 16);
+        
+        // The name printed points into the mapping of the version, so it's only used before unlocking
+        elfparser_rcu_read_lock(&rcu, LOOKUP_READER);
+        const Version* version = elfparser_rcu_dereference((void* const*)&module->version);
+        if (version != NULL && elfparser_resolve_addresses(&version->functions, &lookup, 1) == ELFPARSER_NOERROR) {
+            printf("%s+0x%lx\n", lookup.name, lookup.offset);
+        } else {
+            printf("??\n");
+        }
+        elfparser_rcu_read_unlock(&rcu, LOOKUP_READER);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+
+bool is_file_replaced(const Module* module) {
+    struct stat st;
+    if (stat(module->path, &st) != 0) return false;     // Keep the old version while the file is missing
+    
+    const Version* version = module->version;
+    if (version == NULL) return true;
+    return st.st_dev != version->dev || st.st_ino != version->ino || st.st_size != version->size ||
+           st.st_mtim.tv_sec != version->mtime.tv_sec || st.st_mtim.tv_nsec != version->mtime.tv_nsec;
+}
+
+void* reloader_main(void* arg) {
+    Retired* retired = NULL;
+    
+    while (true) {
+        sleep(interval);
+        
+        // The reloader is the only writer, so it reads the slots without dereferencing them
+        for (uint64_t i = 0; i < num_modules; i++) {
+            Module* module = &modules[i];
+            if (!is_file_replaced(module)) continue;
+            
+            Version* version = load_version(module->path);
+            if (version == NULL) continue;
+            
+            void* old;
+            uint64_t epoch = elfparser_rcu_publish(&rcu, (void**)&module->version, version, &old);
+            fprintf(stderr, "Reloaded %s\n", module->path);
+            if (old == NULL) continue;
+            
+            Retired* entry = malloc(sizeof(Retired));
+            if (entry == NULL) {
+                fprintf(stderr, "Out of memory!\n");
+                exit(1);
+            }
+            entry->version  = old;
+            entry->epoch    = epoch;
+            entry->next     = retired;
+            retired         = entry;
+        }
+        
+        // Unmap the versions no reader can still be using
+        uint64_t safe_epoch = elfparser_rcu_get_safe_epoch(&rcu);
+        for (Retired** entry = &retired; *entry != NULL;) {
+            if ((*entry)->epoch >= safe_epoch) {
+                entry = &(*entry)->next;
+                continue;
+            }
+            Retired* reclaimed = *entry;
+            *entry = reclaimed->next;
+            free_version(reclaimed->version);
+            free(reclaimed);
+        }
+    }
+    return NULL;
+}
\ No newline at end of file
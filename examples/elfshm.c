@@ -0,0 +1,335 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <elfparser.h>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Shares the symbol indexes of some ELF files between any number of processes on one host. Building writes the
+// function table and name index of each file straight into one shared memory region (a file under /dev/shm), which is
+// then renamed into place. Every query maps the region read-only and attaches to the indexes of its file in place, so
+// the memory is shared by all of them and none pays to build the indexes again
+// Usage: elfshm -b <region> <file>...                  Build the indexes of each file into the region
+//        elfshm <region> <file> <address|symbol>...    Print the function containing each address (as in the file,
+//                                                      starting with 0x) and the address of each symbol
+
+#define REGION_MAGIC    "ELFSHM01"
+#define REGION_ALIGN    64      // Images start on a cache line
+
+// Start of a region. Offsets are from the start of the region, so it works wherever it's mapped
+typedef struct {
+    char        magic[8];
+    uint64_t    num_files;
+    uint64_t    files_offset;       // RegionFile[num_files]
+    uint64_t    size;               // Size of the whole region
+} RegionHeader;
+
+typedef struct {
+    uint64_t    path_offset;        // Real path of the file, null terminated
+    uint64_t    functions_offset;   // Function table image
+    uint64_t    functions_size;
+    uint64_t    names_offset;       // Name index image
+    uint64_t    names_size;
+} RegionFile;
+
+typedef struct {
+    char*               path;
+    void*               data;
+    uint64_t            size;
+    ElfParser_Header    header;
+    ElfParser_SymbolTable names;    // Symbol table to index the names of
+} MappedFile;
+
+int build_region(const char* region_path, char** paths, int num_paths);
+int query_region(const char* region_path, const char* path, char** queries, int num_queries);
+
+
+int main(int argc, char** argv) {
+    if (argc > 3 && strcmp(argv[1], "-b") == 0) return build_region(argv[2], argv + 3, argc - 3);
+    if (argc > 3 && argv[1][0] != '-')          return query_region(argv[1], argv[2], argv + 3, argc - 3);
+    
+    printf("Usage: %s -b <region> <file>...\n", argv[0]);
+    printf("       %s <region> <file> <address|symbol>...\n", argv[0]);
+    return 1;
+}
+
+
+// Maps a whole file read-only, returns NULL on failure
+void* map_file(const char* path, uint64_t* size_out) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    
+    *size_out = st.st_size;
+    return data;
+}
+
+// Maps an ELF file and reads its header, returns false on failure
+bool map_elf_file(const char* path, MappedFile* file_out) {
+    file_out->path = realpath(path, NULL);
+    if (file_out->path == NULL) return false;
+    
+    // Stripped files only have .dynsym
+    file_out->data = map_file(file_out->path, &file_out->size);
+    if (file_out->data != NULL &&
+        elfparser_get_header(file_out->data, file_out->size, &file_out->header) == ELFPARSER_NOERROR) {
+        if (elfparser_get_symbol_table(file_out->data, &file_out->header, ELFPARSER_SHT_SYMTAB,
+                                       &file_out->names) != ELFPARSER_NOERROR &&
+            elfparser_get_symbol_table(file_out->data, &file_out->header, ELFPARSER_SHT_DYNSYM,
+                                       &file_out->names) != ELFPARSER_NOERROR) {
+            memset(&file_out->names, 0, sizeof(ElfParser_SymbolTable));
+        }
+        return true;
+    }
+    
+    if (file_out->data != NULL) munmap(file_out->data, file_out->size);
+    free(file_out->path);
+    return false;
+}
+
+uint64_t align_offset(uint64_t offset) {
+    return (offset + REGION_ALIGN - 1) & ~(uint64_t)(REGION_ALIGN - 1);
+}
+
+
+int build_region(const char* region_path, char** paths, int num_paths) {
+    MappedFile* files = malloc(num_paths * sizeof(MappedFile));
+    if (files == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        return 1;
+    }
+    
+    uint64_t num_files = 0;
+    for (int i = 0; i < num_paths; i++) {
+        if (map_elf_file(paths[i], &files[num_files])) {
+            num_files++;
+        } else {
+            fprintf(stderr, "Could not open %s!\n", paths[i]);
+        }
+    }
+    
+    // Header, file directory and paths, then the images of each file starting on a cache line
+    RegionHeader header;
+    memcpy(header.magic, REGION_MAGIC, sizeof(header.magic));
+    header.num_files    = num_files;
+    header.files_offset = sizeof(RegionHeader);
+    
+    RegionFile* directory = malloc((num_files + 1) * sizeof(RegionFile));
+    if (directory == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        return 1;
+    }
+    
+    uint64_t offset = header.files_offset + num_files * sizeof(RegionFile);
+    for (uint64_t i = 0; i < num_files; i++) {
+        directory[i].path_offset = offset;
+        offset += strlen(files[i].path) + 1;
+    }
+    for (uint64_t i = 0; i < num_files; i++) {
+        RegionFile* entry = &directory[i];
+        entry->functions_offset = align_offset(offset);
+        entry->functions_size   = elfparser_get_function_table_buffer_size(files[i].data, &files[i].header);
+        entry->names_offset     = align_offset(entry->functions_offset + entry->functions_size);
+        entry->names_size       = elfparser_get_name_index_buffer_size(files[i].data, &files[i].header, &files[i].names);
+        offset = entry->names_offset + entry->names_size;
+    }
+    header.size = offset;
+    
+    // Built under another name and renamed into place, so queries only ever see a complete region
+    char temp_path[PATH_MAX];
+    snprintf(temp_path, sizeof(temp_path), "%s.%d", region_path, (int)getpid());
+    int fd = open(temp_path, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Could not create %s!\n", temp_path);
+        return 1;
+    }
+    
+    uint8_t* region = MAP_FAILED;
+    if (ftruncate(fd, header.size) == 0) {
+        region = mmap(NULL, header.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (region == MAP_FAILED) {
+        fprintf(stderr, "Could not map %s!\n", temp_path);
+        unlink(temp_path);
+        return 1;
+    }
+    
+    memcpy(region, &header, sizeof(header));
+    memcpy(region + header.files_offset, directory, num_files * sizeof(RegionFile));
+    for (uint64_t i = 0; i < num_files; i++) {
+        const RegionFile* entry = &directory[i];
+        memcpy(region + entry->path_offset, files[i].path, strlen(files[i].path) + 1);
+        
+        ElfParser_FunctionTable functions;
+        ElfParser_NameIndex names;
+        elfparser_build_function_table(files[i].data, &files[i].header, region + entry->functions_offset,
+                                       entry->functions_size, &functions);
+        elfparser_build_name_index(files[i].data, &files[i].header, &files[i].names, region + entry->names_offset,
+                                   entry->names_size, &names);
+        fprintf(stderr, "%s: %lu functions, %lu names\n", files[i].path, functions.num, names.num);
+        
+        munmap(files[i].data, files[i].size);
+        free(files[i].path);
+    }
+    
+    munmap(region, header.size);
+    if (rename(temp_path, region_path) != 0) {
+        fprintf(stderr, "Could not rename %s to %s!\n", temp_path, region_path);
+        unlink(temp_path);
+        return 1;
+    }
+    
+    fprintf(stderr, "Indexed %lu files, %lu bytes\n", num_files, header.size);
+    free(directory);
+    free(files);
+    return 0;
+}
+
+
+// Checks that every path and image of a mapped region lies within it
+bool is_region_valid(const uint8_t* region, uint64_t size) {
+    if (size < sizeof(RegionHeader)) return false;
+    
+    const RegionHeader* header = (const RegionHeader*)region;
+    if (memcmp(header->magic, REGION_MAGIC, sizeof(header->magic)) != 0 || header->size != size) return false;
+    if (header->files_offset % 8 != 0 || header->files_offset > size) return false;
+    if (header->num_files > (size - header->files_offset) / sizeof(RegionFile)) return false;
+    
+    const RegionFile* files = (const RegionFile*)(region + header->files_offset);
+    for (uint64_t i = 0; i < header->num_files; i++) {
+        const RegionFile* entry = &files[i];
+        if (entry->path_offset >= size || memchr(region + entry->path_offset, '\0', size - entry->path_offset) == NULL) {
+            return false;
+        }
+        if (entry->functions_offset > size || entry->functions_size > size - entry->functions_offset) return false;
+        if (entry->names_offset > size || entry->names_size > size - entry->names_offset) return false;
+    }
+    return true;
+}
+
+const RegionFile* find_region_file(const uint8_t* region, const char* path) {
+    const RegionHeader* header = (const RegionHeader*)region;
+    const RegionFile* files = (const RegionFile*)(region + header->files_offset);
+    for (uint64_t i = 0; i < header->num_files; i++) {
+        if (strcmp((const char*)region + files[i].path_offset, path) == 0) return &files[i];
+    }
+    return NULL;
+}
+
+void print_symbol(const ElfParser_NameIndex* names, const char* name) {
+    uint64_t first, end;
+    bool is_found = false;
+    if (elfparser_name_index_find_prefix(names, name, &first, &end) == ELFPARSER_NOERROR) {
+        // The names starting with `name` are sorted, so an exact match comes first
+        ElfParser_Symbol symbol;
+        for (uint64_t i = first; i < end; i++) {
+            if (elfparser_name_index_get(names, i, &symbol) != ELFPARSER_NOERROR || strcmp(symbol.name, name) != 0) break;
+            printf("%s 0x%lx %lu\n", name, symbol.st_value, symbol.st_size);
+            is_found = true;
+        }
+    }
+    if (!is_found) printf("%s ??\n", name);
+}
+
+int query_region(const char* region_path, const char* path, char** queries, int num_queries) {
+    uint64_t region_size;
+    const uint8_t* region = map_file(region_path, &region_size);
+    if (region == NULL) {
+        fprintf(stderr, "Could not open %s!\n", region_path);
+        return 1;
+    }
+    if (!is_region_valid(region, region_size)) {
+        fprintf(stderr, "%s is not a valid region!\n", region_path);
+        return 1;
+    }
+    
+    MappedFile file;
+    if (!map_elf_file(path, &file)) {
+        fprintf(stderr, "Could not open %s!\n", path);
+        return 1;
+    }
+    
+    // The file may have changed since the region was built, which attaching catches
+    const RegionFile* entry = find_region_file(region, file.path);
+    ElfParser_FunctionTable functions;
+    ElfParser_NameIndex names;
+    if (entry == NULL ||
+        elfparser_attach_function_table(file.data, &file.header, region + entry->functions_offset,
+                                        entry->functions_size, &functions) != ELFPARSER_NOERROR ||
+        elfparser_attach_name_index(file.data, &file.header, region + entry->names_offset,
+                                    entry->names_size, &names) != ELFPARSER_NOERROR) {
+        fprintf(stderr, "%s has no index of %s, rebuild it!\n", region_path, file.path);
+        return 1;
+    }
+    
+    ElfParser_AddressLookup* lookups = malloc(num_queries * sizeof(ElfParser_AddressLookup));
+    if (lookups == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        return 1;
+    }
+    
+    // Resolve every address in one batch, then print the answers in the order they were asked
+    uint64_t num_lookups = 0;
+    for (int i = 0; i < num_queries; i++) {
+        if (strncmp(queries[i], "0x", 2) != 0) continue;
+        
+        ElfParser_AddressLookup* lookup = &lookups[num_lookups++];
+        lookup->address = strtoull(queries[i] + 2, NULL, 16);
+        lookup->id      = i;
+    }
+    elfparser_sort_address_lookups(lookups, num_lookups);
+    elfparser_resolve_addresses(&functions, lookups, num_lookups);
+    
+    int lookup_positions[num_queries];
+    for (uint64_t i = 0; i < num_lookups; i++) lookup_positions[lookups[i].id] = i;
+    
+    for (int i = 0; i < num_queries; i++) {
+        if (strncmp(queries[i], "0x", 2) != 0) {
+            print_symbol(&names, queries[i]);
+            continue;
+        }
+        
+        const ElfParser_AddressLookup* lookup = &lookups[lookup_positions[i]];
+        if (lookup->error == ELFPARSER_NOERROR) {
+            printf("0x%lx %s+0x%lx\n", lookup->address, lookup->name, lookup->offset);
+        } else {
+            printf("0x%lx ??\n", lookup->address);
+        }
+    }
+    return 0;
+}
\ No newline at end of file
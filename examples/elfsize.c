@@ -0,0 +1,287 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Prints how much of the file and of the loaded address space is taken up by each section and symbol
+// Given two files, prints how much each section and symbol grew or shrank instead
+// Usage: elfsize <file> / elfsize <old file> <new file>
+
+#define NUM_TOP_SYMBOLS 20
+
+typedef struct {
+    const char* name;
+    int64_t     file_size;
+    int64_t     vm_size;
+} Row;
+
+typedef struct {
+    Row*        rows;
+    uint64_t    num;
+} Rows;
+
+typedef struct {
+    const void*             data;
+    ElfParser_Header        header;
+    ElfParser_SymbolTable   symbols;
+    Rows                    sections;   // Indexed by section index, followed by one row per pseudo-section below
+    Rows                    symbol_rows;// Indexed by symbol index
+    bool                    is_vm;      // Space currently being attributed
+} SizeProfile;
+
+enum { ROW_HEADERS, ROW_UNSECTIONED, ROW_UNMAPPED, NUM_PSEUDO_ROWS };
+const char* pseudo_row_names[NUM_PSEUDO_ROWS] = {"[ELF Headers]", "[LOAD without section]", "[Unmapped]"};
+
+void* read_file(const char* name, uint64_t* size_out);
+bool build_profile(const char* name, SizeProfile* profile);
+Rows merge_rows(Rows rows);
+void print_rows(Rows rows, uint64_t max_rows);
+void print_diff(Rows old_rows, Rows new_rows, uint64_t max_rows);
+
+
+void add_range(const ElfParser_SizeRange* range, void* user_data) {
+    SizeProfile* profile = user_data;
+    int64_t size = range->end - range->start;
+    
+    Row* section_row;
+    if (range->section_index != UINT64_MAX) {
+        section_row = &profile->sections.rows[range->section_index];
+    } else if (range->kind == ELFPARSER_SIZE_HEADER) {
+        section_row = &profile->sections.rows[profile->header.true_shnum + ROW_HEADERS];
+    } else if (range->kind == ELFPARSER_SIZE_SEGMENT) {
+        section_row = &profile->sections.rows[profile->header.true_shnum + ROW_UNSECTIONED];
+    } else {
+        section_row = &profile->sections.rows[profile->header.true_shnum + ROW_UNMAPPED];
+    }
+    
+    if (profile->is_vm) section_row->vm_size += size;
+    else                section_row->file_size += size;
+    
+    if (range->kind != ELFPARSER_SIZE_SYMBOL) return;
+    
+    Row* symbol_row = &profile->symbol_rows.rows[range->index];
+    if (profile->is_vm) symbol_row->vm_size += size;
+    else                symbol_row->file_size += size;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 3) {
+        printf("Usage: %s <file> / %s <old file> <new file>\n", argv[0], argv[0]);
+        return 1;
+    }
+    
+    SizeProfile profiles[2];
+    for (int i = 1; i < argc; i++) {
+        if (!build_profile(argv[i], &profiles[i - 1])) return 1;
+    }
+    
+    if (argc == 2) {
+        printf("Sections:\n");
+        print_rows(profiles[0].sections, UINT64_MAX);
+        printf("\nLargest symbols:\n");
+        print_rows(profiles[0].symbol_rows, NUM_TOP_SYMBOLS);
+    } else {
+        printf("Sections:\n");
+        print_diff(profiles[0].sections, profiles[1].sections, UINT64_MAX);
+        printf("\nSymbols:\n");
+        print_diff(profiles[0].symbol_rows, profiles[1].symbol_rows, NUM_TOP_SYMBOLS);
+    }
+    return 0;
+}
+
+
+bool build_profile(const char* name, SizeProfile* profile) {
+    uint64_t size;
+    profile->data = read_file(name, &size);
+    if (profile->data == NULL) return false;
+    
+    if (elfparser_get_header(profile->data, size, &profile->header) != ELFPARSER_NOERROR) {
+        printf("Error while parsing ELF header of %s!\n", name);
+        return false;
+    }
+    const ElfParser_Header* header = &profile->header;
+    
+    // Same choice of symbol table as elfparser_attribute_size
+    if (elfparser_get_symbol_table(profile->data, header, ELFPARSER_SHT_SYMTAB, &profile->symbols) != ELFPARSER_NOERROR &&
+        elfparser_get_symbol_table(profile->data, header, ELFPARSER_SHT_DYNSYM, &profile->symbols) != ELFPARSER_NOERROR) {
+        profile->symbols.num = 0;
+    }
+    
+    profile->sections.num = header->true_shnum + NUM_PSEUDO_ROWS;
+    profile->sections.rows = calloc(profile->sections.num, sizeof(Row));
+    profile->symbol_rows.num = profile->symbols.num;
+    profile->symbol_rows.rows = calloc(profile->symbol_rows.num + 1, sizeof(Row));
+    
+    uint64_t buffer_size = elfparser_get_size_map_buffer_size(profile->data, header);
+    void* buffer = malloc(buffer_size);
+    if (profile->sections.rows == NULL || profile->symbol_rows.rows == NULL || buffer == NULL) {
+        printf("Could not allocate size tables!\n");
+        return false;
+    }
+    
+    for (uint64_t i = 0; i < header->true_shnum; i++) {
+        ElfParser_SectionHeader section;
+        bool ok = elfparser_get_section_header(profile->data, header, i, &section) == ELFPARSER_NOERROR;
+        profile->sections.rows[i].name = ok ? section.name : "";
+    }
+    for (int i = 0; i < NUM_PSEUDO_ROWS; i++) {
+        profile->sections.rows[header->true_shnum + i].name = pseudo_row_names[i];
+    }
+    for (uint64_t i = 0; i < profile->symbols.num; i++) {
+        ElfParser_Symbol symbol;
+        bool ok = elfparser_get_symbol_from_table(profile->data, header, &profile->symbols, i, &symbol) == ELFPARSER_NOERROR;
+        profile->symbol_rows.rows[i].name = ok ? symbol.name : "";
+    }
+    
+    profile->is_vm = false;
+    elfparser_attribute_size(profile->data, header, ELFPARSER_SIZE_FILE, buffer, buffer_size, add_range, profile);
+    profile->is_vm = true;
+    elfparser_attribute_size(profile->data, header, ELFPARSER_SIZE_VM, buffer, buffer_size, add_range, profile);
+    
+    free(buffer);
+    
+    // Sections and symbols may share names (e.g. static functions in different files) - report them together
+    profile->sections = merge_rows(profile->sections);
+    profile->symbol_rows = merge_rows(profile->symbol_rows);
+    return true;
+}
+
+
+int compare_row_names(const void* a, const void* b) {
+    return strcmp(((const Row*)a)->name, ((const Row*)b)->name);
+}
+
+int compare_row_sizes(const void* a, const void* b) {
+    const Row* row_a = a;
+    const Row* row_b = b;
+    
+    // Largest absolute file size first, then largest absolute VM size
+    int64_t file_a = llabs(row_a->file_size), file_b = llabs(row_b->file_size);
+    if (file_a != file_b) return file_a < file_b ? 1 : -1;
+    
+    int64_t vm_a = llabs(row_a->vm_size), vm_b = llabs(row_b->vm_size);
+    if (vm_a != vm_b) return vm_a < vm_b ? 1 : -1;
+    
+    return strcmp(row_a->name, row_b->name);
+}
+
+
+// Sorts rows by name and combines rows with the same name, dropping unnamed and empty rows
+Rows merge_rows(Rows rows) {
+    qsort(rows.rows, rows.num, sizeof(Row), compare_row_names);
+    
+    uint64_t num = 0;
+    for (uint64_t i = 0; i < rows.num; i++) {
+        if (rows.rows[i].name[0] == '\0' || (rows.rows[i].file_size == 0 && rows.rows[i].vm_size == 0)) continue;
+        
+        if (num > 0 && strcmp(rows.rows[num - 1].name, rows.rows[i].name) == 0) {
+            rows.rows[num - 1].file_size += rows.rows[i].file_size;
+            rows.rows[num - 1].vm_size += rows.rows[i].vm_size;
+        } else {
+            rows.rows[num++] = rows.rows[i];
+        }
+    }
+    rows.num = num;
+    return rows;
+}
+
+
+void print_rows(Rows rows, uint64_t max_rows) {
+    int64_t total_file = 0, total_vm = 0;
+    for (uint64_t i = 0; i < rows.num; i++) {
+        total_file += rows.rows[i].file_size;
+        total_vm += rows.rows[i].vm_size;
+    }
+    
+    qsort(rows.rows, rows.num, sizeof(Row), compare_row_sizes);
+    
+    printf("%12s %12s  %s\n", "FILE SIZE", "VM SIZE", "NAME");
+    for (uint64_t i = 0; i < rows.num && i < max_rows; i++) {
+        printf("%12lld %12lld  %s\n", (long long)rows.rows[i].file_size, (long long)rows.rows[i].vm_size,
+               rows.rows[i].name);
+    }
+    printf("%12lld %12lld  TOTAL\n", (long long)total_file, (long long)total_vm);
+}
+
+
+// Both lists are sorted by name by merge_rows, so they can be matched up in one pass
+void print_diff(Rows old_rows, Rows new_rows, uint64_t max_rows) {
+    Rows diff = { .rows = malloc(sizeof(Row) * (old_rows.num + new_rows.num + 1)), .num = 0 };
+    if (diff.rows == NULL) return;
+    
+    uint64_t i = 0, j = 0;
+    while (i < old_rows.num || j < new_rows.num) {
+        int cmp;
+        if (i >= old_rows.num)      cmp = 1;
+        else if (j >= new_rows.num) cmp = -1;
+        else                        cmp = strcmp(old_rows.rows[i].name, new_rows.rows[j].name);
+        
+        Row row = { .name = cmp <= 0 ? old_rows.rows[i].name : new_rows.rows[j].name };
+        if (cmp <= 0) {
+            row.file_size -= old_rows.rows[i].file_size;
+            row.vm_size -= old_rows.rows[i].vm_size;
+            i++;
+        }
+        if (cmp >= 0) {
+            row.file_size += new_rows.rows[j].file_size;
+            row.vm_size += new_rows.rows[j].vm_size;
+            j++;
+        }
+        
+        if (row.file_size != 0 || row.vm_size != 0) diff.rows[diff.num++] = row;
+    }
+    
+    // Totals in print_rows are sums of the deltas, i.e. the total growth
+    print_rows(diff, max_rows);
+    free(diff.rows);
+}
+
+
+void* read_file(const char* name, uint64_t* size_out) {
+    FILE* fptr = fopen(name, "rb");
+    
+    if (fptr == NULL) {
+        printf("Could not open file %s!\n", name);
+        return NULL;
+    }
+    
+    // Get file size
+    fseek(fptr, 0L, SEEK_END);
+    *size_out = ftell(fptr);
+    rewind(fptr);
+    
+    void* buffer = malloc(*size_out);
+    if (buffer == NULL || fread(buffer, *size_out, 1, fptr) != 1) {
+        printf("Could not read file %s!\n", name);
+        free(buffer);
+        buffer = NULL;
+    }
+    
+    fclose(fptr);
+    return buffer;
+}
\ No newline at end of file
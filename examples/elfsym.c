@@ -0,0 +1,352 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <elfparser.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Symbolizes batches of raw addresses sampled from running processes, like a profiler does. Reads "<pid> <address>"
+// lines from stdin and prints "<pid> <address> <function>+<offset> <file>" for each, in the same order
+// The memory map of each process is read from /proc/<pid>/maps, or from a copy captured earlier given with -m. Each
+// mapped ELF file is opened and indexed once, and shared by every process (and path) with the same build ID. The
+// addresses of a process are sorted, so each mapping is found with one pass over the map and the addresses in it are
+// resolved with one pass over the function table of its file
+// Usage: elfsym [-m <pid> <maps file>]... < addresses
+
+#define MAX_PATH_LEN        4096
+#define MAX_BUILD_ID_SIZE   64
+
+typedef struct {
+    uint64_t                pid;
+    uint64_t                address;
+    uint64_t                index;          // Position in the input
+} Sample;
+
+// An indexed ELF file
+typedef struct {
+    char*                   path;
+    uint8_t                 build_id[MAX_BUILD_ID_SIZE];
+    uint32_t                build_id_size;  // 0 if the file has no build ID, so it is never shared
+    void*                   data;
+    uint64_t                size;
+    ElfParser_Header        header;
+    ElfParser_FunctionTable functions;
+} Module;
+
+// Files already looked at, by device and inode, so each is opened once however many processes map it
+typedef struct {
+    uint32_t                dev_major;
+    uint32_t                dev_minor;
+    uint64_t                inode;
+    Module*                 module;         // NULL if the file couldn't be indexed
+} FileKey;
+
+typedef struct {
+    uint64_t                pid;
+    const char*             path;
+} MapsFile;
+
+Module** modules;
+uint64_t num_modules;
+FileKey* files;
+uint64_t num_files;
+MapsFile* maps_files;
+uint64_t num_maps_files;
+
+uint64_t read_samples(Sample** samples_out);
+void symbolize_process(Sample* samples, uint64_t num, ElfParser_AddressLookup* lookups, Module** sample_modules);
+
+
+int compare_samples(const void* a, const void* b) {
+    const Sample* sample_a = a;
+    const Sample* sample_b = b;
+    if (sample_a->pid != sample_b->pid) return sample_a->pid < sample_b->pid ? -1 : 1;
+    if (sample_a->address != sample_b->address) return sample_a->address < sample_b->address ? -1 : 1;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    maps_files = malloc(argc * sizeof(MapsFile));
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") != 0 || i + 2 >= argc) {
+            printf("Usage: %s [-m <pid> <maps file>]... < addresses\n", argv[0]);
+            return 1;
+        }
+        maps_files[num_maps_files].pid = strtoull(argv[i + 1], NULL, 10);
+        maps_files[num_maps_files].path = argv[i + 2];
+        num_maps_files++;
+        i += 2;
+    }
+    
+    Sample* samples;
+    uint64_t num = read_samples(&samples);
+    ElfParser_AddressLookup* lookups = malloc((num + 1) * sizeof(ElfParser_AddressLookup));
+    Module** sample_modules = malloc((num + 1) * sizeof(Module*));
+    uint64_t* positions = malloc((num + 1) * sizeof(uint64_t));
+    if (samples == NULL || lookups == NULL || sample_modules == NULL || positions == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        return 1;
+    }
+    
+    // Each process is symbolized as a whole, with its addresses in order
+    qsort(samples, num, sizeof(Sample), compare_samples);
+    for (uint64_t first = 0; first < num;) {
+        uint64_t end = first + 1;
+        while (end < num && samples[end].pid == samples[first].pid) end++;
+        symbolize_process(&samples[first], end - first, &lookups[first], &sample_modules[first]);
+        first = end;
+    }
+    
+    for (uint64_t i = 0; i < num; i++) positions[samples[i].index] = i;
+    for (uint64_t i = 0; i < num; i++) {
+        uint64_t position = positions[i];
+        const Sample* sample = &samples[position];
+        const ElfParser_AddressLookup* lookup = &lookups[position];
+        const Module* module = sample_modules[position];
+        
+        printf("%lu %lx ", sample->pid, sample->address);
+        if (lookup->error == ELFPARSER_NOERROR) {
+            printf("%s+0x%lx", lookup->name, lookup->offset);
+        } else {
+            printf("??");
+        }
+        printf(module != NULL ? " %s\n" : "\n", module != NULL ? module->path : "");
+    }
+    return 0;
+}
+
+
+// Reads the whole of a file, including files like /proc/<pid>/maps which report a size of 0
+char* read_text_file(const char* path, uint64_t* size_out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    uint64_t size = 0;
+    uint64_t capacity = 65536;
+    char* text = malloc(capacity);
+    while (text != NULL) {
+        if (size == capacity) {
+            capacity *= 2;
+            char* grown = realloc(text, capacity);
+            if (grown == NULL) free(text);
+            text = grown;
+            if (text == NULL) break;
+        }
+        ssize_t num = read(fd, text + size, capacity - size);
+        if (num <= 0) break;
+        size += num;
+    }
+    close(fd);
+    
+    *size_out = size;
+    return text;
+}
+
+uint64_t read_samples(Sample** samples_out) {
+    uint64_t num = 0;
+    uint64_t capacity = 4096;
+    Sample* samples = malloc(capacity * sizeof(Sample));
+    
+    unsigned long pid;
+    unsigned long address;
+    while (samples != NULL && scanf("%lu %lx", &pid, &address) == 2) {
+        if (num == capacity) {
+            capacity *= 2;
+            Sample* grown = realloc(samples, capacity * sizeof(Sample));
+            if (grown == NULL) free(samples);
+            samples = grown;
+            if (samples == NULL) break;
+        }
+        samples[num].pid = pid;
+        samples[num].address = address;
+        samples[num].index = num;
+        num++;
+    }
+    
+    *samples_out = samples;
+    return samples != NULL ? num : 0;
+}
+
+
+Module* index_file(const char* path, const char* display_path) {
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    
+    Module* module = calloc(1, sizeof(Module));
+    if (module == NULL || elfparser_get_header(data, st.st_size, &module->header) != ELFPARSER_NOERROR) {
+        free(module);
+        munmap(data, st.st_size);
+        return NULL;
+    }
+    module->data = data;
+    module->size = st.st_size;
+    
+    ElfParser_Note note;
+    if (elfparser_get_note(data, &module->header, "GNU", ELFPARSER_NT_GNU_BUILD_ID, &note) == ELFPARSER_NOERROR &&
+        note.n_descsz <= MAX_BUILD_ID_SIZE) {
+        memcpy(module->build_id, note.desc, note.n_descsz);
+        module->build_id_size = note.n_descsz;
+    }
+    
+    // The same build of a file seen through another path (e.g. from another container) is only indexed once
+    for (uint64_t i = 0; i < num_modules && module->build_id_size != 0; i++) {
+        if (modules[i]->build_id_size == module->build_id_size &&
+            memcmp(modules[i]->build_id, module->build_id, module->build_id_size) == 0) {
+            munmap(data, st.st_size);
+            free(module);
+            return modules[i];
+        }
+    }
+    
+    uint64_t buffer_size = elfparser_get_function_table_buffer_size(data, &module->header);
+    void* buffer = malloc(buffer_size);
+    Module** grown = realloc(modules, (num_modules + 1) * sizeof(Module*));
+    module->path = strdup(display_path);
+    if (buffer == NULL || grown == NULL || module->path == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        exit(1);
+    }
+    elfparser_build_function_table(data, &module->header, buffer, buffer_size, &module->functions);
+    
+    modules = grown;
+    modules[num_modules++] = module;
+    return module;
+}
+
+Module* get_module(uint64_t pid, bool is_live, const ElfParser_ProcessMapping* mapping) {
+    for (uint64_t i = 0; i < num_files; i++) {
+        if (files[i].inode == mapping->inode && files[i].dev_major == mapping->dev_major &&
+            files[i].dev_minor == mapping->dev_minor) return files[i].module;
+    }
+    
+    // Files of a live process are opened through its root, so processes in containers work too
+    char path[MAX_PATH_LEN + 32];  // Room for the /proc/<pid>/root prefix
+    char display_path[MAX_PATH_LEN];
+    snprintf(display_path, sizeof(display_path), "%.*s", (int)mapping->name_length, mapping->name);
+    if (is_live) {
+        snprintf(path, sizeof(path), "/proc/%lu/root%s", pid, display_path);
+    } else {
+        snprintf(path, sizeof(path), "%s", display_path);
+    }
+    
+    FileKey* grown = realloc(files, (num_files + 1) * sizeof(FileKey));
+    if (grown == NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        exit(1);
+    }
+    files = grown;
+    
+    FileKey* key = &files[num_files++];
+    key->dev_major  = mapping->dev_major;
+    key->dev_minor  = mapping->dev_minor;
+    key->inode      = mapping->inode;
+    key->module     = index_file(path, display_path);
+    return key->module;
+}
+
+// Converts an address in a process to a virtual address in the file mapped there, through the PT_LOAD segment
+// holding the mapped part of the file
+bool get_file_vaddr(const Module* module, const ElfParser_ProcessMapping* mapping, uint64_t address, uint64_t* vaddr_out) {
+    uint64_t file_offset = address - mapping->start + mapping->file_offset;
+    
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(module->data, &module->header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_LOAD) continue;
+        if (file_offset < program_header.p_offset || file_offset - program_header.p_offset >= program_header.p_filesz) {
+            continue;
+        }
+        *vaddr_out = file_offset - program_header.p_offset + program_header.p_vaddr;
+        return true;
+    }
+    return false;
+}
+
+
+void symbolize_process(Sample* samples, uint64_t num, ElfParser_AddressLookup* lookups, Module** sample_modules) {
+    uint64_t pid = samples[0].pid;
+    
+    char path[MAX_PATH_LEN];
+    bool is_live = true;
+    snprintf(path, sizeof(path), "/proc/%lu/maps", pid);
+    for (uint64_t i = 0; i < num_maps_files; i++) {
+        if (maps_files[i].pid != pid) continue;
+        snprintf(path, sizeof(path), "%s", maps_files[i].path);
+        is_live = false;
+    }
+    
+    for (uint64_t i = 0; i < num; i++) {
+        lookups[i].error    = ELFPARSER_NOT_FOUND;
+        lookups[i].name     = NULL;
+        sample_modules[i]   = NULL;
+    }
+    
+    uint64_t maps_size;
+    char* maps = read_text_file(path, &maps_size);
+    if (maps == NULL) {
+        fprintf(stderr, "Could not read %s!\n", path);
+        return;
+    }
+    
+    // Mappings are listed in order of address, so both lists are walked together
+    ElfParser_ProcessMappingCursor cursor;
+    elfparser_process_mapping_cursor_init(maps, maps_size, &cursor);
+    
+    ElfParser_ProcessMapping mapping;
+    uint64_t i = 0;
+    while (i < num && elfparser_process_mapping_cursor_next(&cursor, &mapping) == ELFPARSER_NOERROR) {
+        while (i < num && samples[i].address < mapping.start) i++;
+        
+        uint64_t first = i;
+        while (i < num && samples[i].address < mapping.end) i++;
+        if (first == i || mapping.inode == 0 || mapping.name_length == 0 || mapping.name[0] != '/') continue;
+        
+        Module* module = get_module(pid, is_live, &mapping);
+        if (module == NULL) continue;
+        
+        // Addresses outside the file's segments (e.g. in .bss) get an address no function reaches
+        for (uint64_t j = first; j < i; j++) {
+            sample_modules[j] = module;
+            if (!get_file_vaddr(module, &mapping, samples[j].address, &lookups[j].address)) lookups[j].address = UINT64_MAX;
+        }
+        elfparser_resolve_addresses(&module->functions, &lookups[first], i - first);
+    }
+    free(maps);
+}
\ No newline at end of file
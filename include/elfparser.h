@@ -36,6 +36,13 @@
  * This should be the first function called to parse the elf data */
 ElfParser_Error elfparser_get_header(const void* elf_start, uint64_t elf_size, ElfParser_Header* header_out);
 
+/* Parses only the ELF header from the first `data_size` bytes of a file (at least 52 for 32-bit files, 64 for 64-bit)
+ * without reading anything else, e.g. to check whether a file is worth reading in full. Members which depend on other
+ * parts of the file are not filled in - true_shnum and true_shstrndx are copied from e_shnum and e_shstrndx, and the
+ * rest are 0. Use elfparser_get_header on the whole file before calling any other function
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the data is not an ELF header */
+ElfParser_Error elfparser_sniff_header(const void* data, uint64_t data_size, ElfParser_Header* header_out);
+
 /* Reads the section header at index and returns it in section_header_out
  * Returns ELFPARSER_NOERROR on success - contents of section_header_out undefined on failure */
 ElfParser_Error elfparser_get_section_header(const void* elf_start, const ElfParser_Header* header,
@@ -49,9 +56,20 @@ ElfParser_Error elfparser_get_section_header_by_name(const void* elf_start, cons
 ElfParser_Error elfparser_get_symbol(const void* elf_start, const ElfParser_Header* header,
                                      uint64_t index, ElfParser_Symbol* symbol_out);
 
+/* Same as elfparser_get_symbol, but reads from any symbol table, e.g. one returned by elfparser_get_symbol_table */
+ElfParser_Error elfparser_get_symbol_from_table(const void* elf_start, const ElfParser_Header* header,
+                                                const ElfParser_SymbolTable* table, uint64_t index,
+                                                ElfParser_Symbol* symbol_out);
+
 ElfParser_Error elfparser_get_symbol_by_name(const void* elf_start, const ElfParser_Header* header,
                                              const char* name, ElfParser_Symbol* symbol_out);
 
+/* Finds the first symbol table section of the given type (ELFPARSER_SHT_SYMTAB or ELFPARSER_SHT_DYNSYM)
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no such section,
+ * ELFPARSER_INVALID if the section has an entry size of 0 or lies outside the file */
+ElfParser_Error elfparser_get_symbol_table(const void* elf_start, const ElfParser_Header* header,
+                                           ElfParser_SH_Type type, ElfParser_SymbolTable* table_out);
+
 /* Reads the program header at index and returns it in program_header_out
  * Returns ELFPARSER_NOERROR on success - contents of program_header_out undefined on failure */
 ElfParser_Error elfparser_get_program_header(const void* elf_start, const ElfParser_Header* header,
@@ -65,6 +83,597 @@ ElfParser_Error elfparser_get_program_header(const void* elf_start, const ElfPar
 uint64_t elfparser_copy_segment(const void* elf_start, const ElfParser_Header* header, uint64_t segment_index,
                                 void* dest, uint64_t skip, uint64_t num_bytes);
 
+/* Initializes a cursor positioned at section #0
+ * Returns ELFPARSER_NOERROR if the whole section header table lies within the file. Otherwise returns ELFPARSER_INVALID,
+ * but the cursor is still usable and will only step through the sections which lie within the file */
+ElfParser_Error elfparser_section_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                              ElfParser_SectionCursor* cursor_out);
+
+/* Reads the section header under the cursor into section_header_out and advances the cursor
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more sections
+ * The name member of section_header_out is set to NULL - use elfparser_section_cursor_get_name to resolve it */
+ElfParser_Error elfparser_section_cursor_next(ElfParser_SectionCursor* cursor, ElfParser_SectionHeader* section_header_out);
+
+/* Resolves the name of a section header returned by elfparser_section_cursor_next, stores it in the name member and
+ * returns it. Will always return a valid string */
+const char* elfparser_section_cursor_get_name(const ElfParser_SectionCursor* cursor, ElfParser_SectionHeader* section_header);
+
+/* Same as the section cursor functions, but for symbols in .symtab */
+ElfParser_Error elfparser_symbol_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                             ElfParser_SymbolCursor* cursor_out);
+
+/* Same as elfparser_symbol_cursor_init, but for any symbol table, e.g. one returned by elfparser_get_symbol_table */
+ElfParser_Error elfparser_symbol_table_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                                   const ElfParser_SymbolTable* table, ElfParser_SymbolCursor* cursor_out);
+
+ElfParser_Error elfparser_symbol_cursor_next(ElfParser_SymbolCursor* cursor, ElfParser_Symbol* symbol_out);
+
+const char* elfparser_symbol_cursor_get_name(const ElfParser_SymbolCursor* cursor, ElfParser_Symbol* symbol);
+
+/* Same as the section cursor functions, but for program headers. Program headers have no names */
+ElfParser_Error elfparser_program_header_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                                     ElfParser_ProgramHeaderCursor* cursor_out);
+
+ElfParser_Error elfparser_program_header_cursor_next(ElfParser_ProgramHeaderCursor* cursor,
+                                                     ElfParser_ProgramHeader* program_header_out);
+
+/* Returns the size in bytes of the buffer needed by elfparser_build_section_cache, UINT64_MAX if the file has too many
+ * sections to cache */
+uint64_t elfparser_get_section_cache_size(const ElfParser_Header* header);
+
+/* Decodes the whole section header table in one pass into `buffer` and returns the cache in cache_out
+ * `buffer` must stay valid for as long as the cache is used. Sections which lie outside the file are left out
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `buffer_size` is smaller than elfparser_get_section_cache_size */
+ElfParser_Error elfparser_build_section_cache(const void* elf_start, const ElfParser_Header* header,
+                                              void* buffer, uint64_t buffer_size, ElfParser_SectionCache* cache_out);
+
+/* Finds the index of the first section matching the given name
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if name is NULL, ELFPARSER_NOT_FOUND if section not found */
+ElfParser_Error elfparser_section_cache_find_by_name(const ElfParser_SectionCache* cache, const char* name,
+                                                     uint64_t* index_out);
+
+/* Finds the index of the allocated section (SHF_ALLOC) whose address range contains `addr`
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if no section contains the address */
+ElfParser_Error elfparser_section_cache_find_by_address(const ElfParser_SectionCache* cache, uint64_t addr,
+                                                        uint64_t* index_out);
+
+/* Finds the index of the first section of the given type, starting the search at `start_index`
+ * Call again with start_index = *index_out + 1 to find the next section of the same type
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more sections of this type */
+ElfParser_Error elfparser_section_cache_find_by_type(const ElfParser_SectionCache* cache, ElfParser_SH_Type type,
+                                                     uint64_t start_index, uint64_t* index_out);
+
+/* Returns the name of the section at index. Will always return a valid string */
+const char* elfparser_section_cache_get_name(const ElfParser_SectionCache* cache, uint64_t index);
+
+/* Builds an index of the PT_LOAD segments sorted by virtual address, using `mappings` as storage
+ * `max_mappings` should be at least the number of PT_LOAD segments - e_phnum is always enough
+ * Segments whose data does not lie within the file are left out
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `mappings` is too small */
+ElfParser_Error elfparser_build_segment_map(const void* elf_start, const ElfParser_Header* header,
+                                            ElfParser_SegmentMapping* mappings, uint64_t max_mappings,
+                                            ElfParser_SegmentMap* map_out);
+
+/* Translates the range of `size` bytes starting at virtual address `vaddr`. Only the part of the range which lies
+ * within the segment containing `vaddr` is translated
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if `vaddr` is not in any PT_LOAD segment */
+ElfParser_Error elfparser_translate_vaddr(const ElfParser_SegmentMap* map, uint64_t vaddr, uint64_t size,
+                                         ElfParser_VaddrTranslation* translation_out);
+
+/* Copies `num_bytes` of memory starting at virtual address `vaddr` to `dest`, zero-filling where memory size is greater
+ * than file size. The range may span multiple segments, but copying stops at the first address not in any segment
+ * Returns the number of bytes copied */
+uint64_t elfparser_read_at_vaddr(const ElfParser_SegmentMap* map, uint64_t vaddr, void* dest, uint64_t num_bytes);
+
+/* Initializes a cursor positioned at the first note of the first PT_NOTE segment
+ * Returns ELFPARSER_NOERROR if the whole program header table lies within the file, otherwise returns ELFPARSER_INVALID
+ * but the cursor is still usable */
+ElfParser_Error elfparser_note_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                           ElfParser_NoteCursor* cursor_out);
+
+/* Reads the note under the cursor into note_out and advances the cursor, moving on to the next PT_NOTE segment as needed
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more notes */
+ElfParser_Error elfparser_note_cursor_next(ElfParser_NoteCursor* cursor, ElfParser_Note* note_out);
+
+/* Reads the first note with the given owner name and type
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if name is NULL, ELFPARSER_NOT_FOUND if note not found */
+ElfParser_Error elfparser_get_note(const void* elf_start, const ElfParser_Header* header, const char* name,
+                                   ElfParser_N_Type type, ElfParser_Note* note_out);
+
+/* Decodes an NT_PRSTATUS note from a core file
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the note is not a valid NT_PRSTATUS note */
+ElfParser_Error elfparser_get_prstatus(const ElfParser_Header* header, const ElfParser_Note* note,
+                                       ElfParser_PrStatus* prstatus_out);
+
+/* Reads register #index from the register set of an NT_PRSTATUS note
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if index is out of range */
+ElfParser_Error elfparser_get_prstatus_register(const ElfParser_Header* header, const ElfParser_PrStatus* prstatus,
+                                                uint64_t index, uint64_t* value_out);
+
+/* Reads the program counter and stack pointer from the register set of an NT_PRSTATUS note
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if e_machine is not supported,
+ * ELFPARSER_INVALID if the register set is too small */
+ElfParser_Error elfparser_get_prstatus_pc_sp(const ElfParser_Header* header, const ElfParser_PrStatus* prstatus,
+                                             uint64_t* pc_out, uint64_t* sp_out);
+
+/* Initializes a cursor over the entries of an NT_FILE note from a core file
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the note is not a valid NT_FILE note */
+ElfParser_Error elfparser_file_mapping_cursor_init(const ElfParser_Header* header, const ElfParser_Note* note,
+                                                   ElfParser_FileMappingCursor* cursor_out);
+
+/* Reads the NT_FILE entry under the cursor into mapping_out and advances the cursor
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more entries */
+ElfParser_Error elfparser_file_mapping_cursor_next(ElfParser_FileMappingCursor* cursor, ElfParser_FileMapping* mapping_out);
+
+/* Reads entry #index of an NT_AUXV note from a core file
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the note is not an NT_AUXV note or index is out of range */
+ElfParser_Error elfparser_get_auxv_entry(const ElfParser_Header* header, const ElfParser_Note* note,
+                                         uint64_t index, ElfParser_AuxvEntry* entry_out);
+
+/* Finds the value of the first entry of the given type in an NT_AUXV note
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no such entry */
+ElfParser_Error elfparser_find_auxv_entry(const ElfParser_Header* header, const ElfParser_Note* note,
+                                          ElfParser_AT_Type type, uint64_t* value_out);
+
+/* Same as elfparser_read_at_vaddr, but for core files - memory which is not present in the file was not dumped, so
+ * copying stops there instead of filling with 0s
+ * Returns the number of bytes copied */
+uint64_t elfparser_read_core_memory(const ElfParser_SegmentMap* map, uint64_t vaddr, void* dest, uint64_t num_bytes);
+
+/* Initializes a cursor over the dynamic section, found through PT_DYNAMIC or else the SHT_DYNAMIC section
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no dynamic section, ELFPARSER_INVALID if the
+ * dynamic section doesn't lie entirely within the file, but the cursor is still usable */
+ElfParser_Error elfparser_dynamic_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                              ElfParser_DynamicCursor* cursor_out);
+
+/* Reads the dynamic entry under the cursor into entry_out and advances the cursor
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND at DT_NULL or if there are no more entries */
+ElfParser_Error elfparser_dynamic_cursor_next(ElfParser_DynamicCursor* cursor, ElfParser_DynamicEntry* entry_out);
+
+/* Resolves a string table offset from a dynamic entry (e.g. DT_NEEDED or DT_SONAME) against DT_STRTAB
+ * Will always return a valid string, which is empty if offset is out of range */
+const char* elfparser_get_dynamic_string(const ElfParser_DynamicCursor* cursor, uint64_t offset);
+
+/* Reads DT_SONAME, DT_RPATH, DT_RUNPATH, DT_FLAGS and DT_FLAGS_1 and counts the DT_NEEDED entries in one pass
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no dynamic section */
+ElfParser_Error elfparser_get_dynamic_info(const void* elf_start, const ElfParser_Header* header,
+                                           ElfParser_DynamicInfo* info_out);
+
+/* Initializes a cursor over a colon separated list of directories (e.g. DT_RPATH or DT_RUNPATH), expanding the dynamic
+ * string tokens $ORIGIN, $LIB and $PLATFORM (or ${ORIGIN} etc) to the given strings. Any of them may be NULL, in which
+ * case directories using that token are skipped like the dynamic linker does */
+void elfparser_search_path_cursor_init(const char* path_list, const char* origin, const char* lib, const char* platform,
+                                       ElfParser_SearchPathCursor* cursor_out);
+
+/* Writes the next directory of the list to `dest` as a null-terminated string and advances the cursor
+ * An empty entry means the current directory, and is returned as "."
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more directories,
+ * ELFPARSER_INVALID if the expanded directory doesn't fit in `dest_size` bytes - the cursor still moves past it */
+ElfParser_Error elfparser_search_path_cursor_next(ElfParser_SearchPathCursor* cursor, char* dest, uint64_t dest_size);
+
+/* Streaming hash functions. Data can be passed to elfparser_hash_update in pieces of any size
+ * elfparser_hash_final writes the digest to digest_out (8 bytes for XXH64, 32 bytes for SHA-256) and returns its size */
+void elfparser_hash_init(ElfParser_HashState* state, ElfParser_HashType type);
+void elfparser_hash_update(ElfParser_HashState* state, const void* data, uint64_t size);
+void elfparser_hash_update_zeros(ElfParser_HashState* state, uint64_t size);
+uint64_t elfparser_hash_final(ElfParser_HashState* state, uint8_t* digest_out);
+
+/* Hashes the contents of a section straight from the file. SHT_NOBITS sections (e.g. .bss) are hashed as sh_size 0s
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the section data does not lie within the file */
+ElfParser_Error elfparser_hash_section(const void* elf_start, const ElfParser_Header* header,
+                                       const ElfParser_SectionHeader* section, ElfParser_HashType type,
+                                       ElfParser_Digest* digest_out);
+
+/* Hashes the contents of a segment as it would be in memory - file data followed by 0s up to the memory size
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the segment data does not lie within the file */
+ElfParser_Error elfparser_hash_segment(const void* elf_start, const ElfParser_Header* header,
+                                       const ElfParser_ProgramHeader* program_header, ElfParser_HashType type,
+                                       ElfParser_Digest* digest_out);
+
+/* Hashes the section (or segment) referenced by the index member of each of the `num` entries of `digests`
+ * Entries don't depend on each other, so a table can be split between threads
+ * Returns ELFPARSER_NOERROR if every entry was hashed, otherwise ELFPARSER_INVALID - check the error member of each entry */
+ElfParser_Error elfparser_hash_sections(const void* elf_start, const ElfParser_Header* header, ElfParser_HashType type,
+                                        ElfParser_Digest* digests, uint64_t num);
+
+ElfParser_Error elfparser_hash_segments(const void* elf_start, const ElfParser_Header* header, ElfParser_HashType type,
+                                        ElfParser_Digest* digests, uint64_t num);
+
+/* Fills in the index member of up to `max_digests` entries of `digests` with the indexes of the PT_LOAD segments
+ * Returns the total number of PT_LOAD segments, which may be more than `max_digests` */
+uint64_t elfparser_get_load_segment_indexes(const void* elf_start, const ElfParser_Header* header,
+                                            ElfParser_Digest* digests, uint64_t max_digests);
+
+/* Returns the size in bytes of the buffer needed by elfparser_diff */
+uint64_t elfparser_get_diff_buffer_size(const ElfParser_Header* old_header, const ElfParser_Header* new_header);
+
+/* Compares two ELF files section by section and symbol by symbol (from .symtab), matching them up by name
+ * `callback` is called once for every difference found - sections first, then symbols, each in order of name
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `buffer_size` is smaller than elfparser_get_diff_buffer_size
+ * or callback is NULL */
+ElfParser_Error elfparser_diff(const void* old_start, const ElfParser_Header* old_header,
+                               const void* new_start, const ElfParser_Header* new_header,
+                               void* buffer, uint64_t buffer_size,
+                               ElfParser_DiffCallback callback, void* user_data);
+
+/* Finds the symbol versioning sections belonging to a dynamic symbol table (usually .dynsym)
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if the symbol table has no .gnu.version section */
+ElfParser_Error elfparser_get_version_table(const void* elf_start, const ElfParser_Header* header,
+                                            const ElfParser_SymbolTable* symbols, ElfParser_VersionTable* versions_out);
+
+/* Reads the version of the symbol at symbol_index into version_out. Unversioned symbols have an empty version name
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if the version index has no definition or need,
+ * ELFPARSER_INVALID if symbol_index has no .gnu.version entry */
+ElfParser_Error elfparser_get_symbol_version(const void* elf_start, const ElfParser_Header* header,
+                                             const ElfParser_VersionTable* versions, uint64_t symbol_index,
+                                             ElfParser_SymbolVersion* version_out);
+
+/* Finds the hash table used to look up dynamic symbols, preferring .gnu.hash over .hash
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no hash table,
+ * ELFPARSER_INVALID if the hash table or its symbol table is malformed */
+ElfParser_Error elfparser_get_symbol_hash_table(const void* elf_start, const ElfParser_Header* header,
+                                                ElfParser_SymbolHashTable* table_out);
+
+/* Looks up a defined symbol by name through a hash table, without scanning the symbol table
+ * If versions is not NULL, the symbol must also have the given version - or if version is NULL, be the default version
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no such symbol,
+ * ELFPARSER_INVALID if name is NULL or the hash table is malformed */
+ElfParser_Error elfparser_lookup_symbol(const void* elf_start, const ElfParser_Header* header,
+                                        const ElfParser_SymbolHashTable* table, const ElfParser_VersionTable* versions,
+                                        const char* name, const char* version, ElfParser_Symbol* symbol_out);
+
+/* Fills `symbols` with the ABI exported by a shared object - the defined GLOBAL, WEAK and GNU_UNIQUE symbols in .dynsym
+ * with default or protected visibility - sorted by name, then version
+ * The total number of exported symbols is stored in num_out. The number of symbols in .dynsym is always enough space
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no .dynsym,
+ * ELFPARSER_INVALID if there are more than `max_symbols` exported symbols */
+ElfParser_Error elfparser_get_abi(const void* elf_start, const ElfParser_Header* header,
+                                  ElfParser_AbiSymbol* symbols, uint64_t max_symbols, uint64_t* num_out);
+
+/* Compares two tables returned by elfparser_get_abi, matching symbols by name and version
+ * `callback` is called for every change in order of name, and may be NULL
+ * Returns the number of incompatible changes - removed symbols, changed types and changed sizes of data symbols */
+uint64_t elfparser_compare_abi(const ElfParser_AbiSymbol* old_symbols, uint64_t old_num,
+                               const ElfParser_AbiSymbol* new_symbols, uint64_t new_num,
+                               ElfParser_AbiCallback callback, void* user_data);
+
+/* Returns the size in bytes of the buffer needed by elfparser_verify */
+uint64_t elfparser_get_verify_buffer_size(const ElfParser_Header* header);
+
+/* Checks the whole file in one pass - header, section headers, string tables, symbols, program headers, and overlaps
+ * between sections, header tables and segments - storing up to `max_anomalies` anomalies found in `anomalies`
+ * The total number of anomalies is stored in num_out, and may be more than `max_anomalies`
+ * Returns ELFPARSER_NOERROR if the checks ran, ELFPARSER_INVALID if `buffer_size` is smaller than
+ * elfparser_get_verify_buffer_size */
+ElfParser_Error elfparser_verify(const void* elf_start, const ElfParser_Header* header, void* buffer, uint64_t buffer_size,
+                                 ElfParser_Anomaly* anomalies, uint64_t max_anomalies, uint64_t* num_out);
+
+/* Returns the size in bytes of the buffer needed by elfparser_map_sections_to_segments */
+uint64_t elfparser_get_section_segment_buffer_size(const ElfParser_Header* header);
+
+/* Finds which sections belong to which segments, using the same rules as readelf, and stores up to `max_pairs` pairs
+ * in `pairs` - ordered by segment index, then by section address (or file offset for non-allocated sections)
+ * The total number of pairs is stored in num_out
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `buffer_size` is smaller than
+ * elfparser_get_section_segment_buffer_size or there are more than `max_pairs` pairs */
+ElfParser_Error elfparser_map_sections_to_segments(const void* elf_start, const ElfParser_Header* header,
+                                                   void* buffer, uint64_t buffer_size,
+                                                   ElfParser_SectionSegmentPair* pairs, uint64_t max_pairs,
+                                                   uint64_t* num_out);
+
+/* Returns the size in bytes of the buffer needed by elfparser_attribute_size */
+uint64_t elfparser_get_size_map_buffer_size(const void* elf_start, const ElfParser_Header* header);
+
+/* Assigns every byte of the file (or of the address space it occupies when loaded) to its most specific owner - symbol,
+ * then section, then header, then PT_LOAD segment. Symbols come from .symtab, or .dynsym if there is no .symtab
+ * `callback` is called once for every range of bytes with the same owner, in order of address
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `buffer_size` is smaller than
+ * elfparser_get_size_map_buffer_size or callback is NULL */
+ElfParser_Error elfparser_attribute_size(const void* elf_start, const ElfParser_Header* header, ElfParser_SizeSpace space,
+                                         void* buffer, uint64_t buffer_size,
+                                         ElfParser_SizeCallback callback, void* user_data);
+
+/* Starts loading a file without having all of it in memory, for callers doing their own (e.g. asynchronous) I/O
+ * `image` must be `file_size` bytes, and the range of each request in loader_out->requests must be read into `image` at
+ * the same offset as in the file before calling elfparser_loader_advance. Only requested ranges are written, so `image`
+ * may be sparse memory. `flags` is a combination of ElfParser_LoadFlags selecting which tables to read */
+void elfparser_loader_init(ElfParser_Loader* loader_out, void* image, uint64_t file_size, uint32_t flags);
+
+/* Moves on to the next batch of reads once every request in loader->requests has been read
+ * Returns ELFPARSER_NOERROR on success - if loader->num_requests is 0, loading is finished and loader->header can be
+ * passed to the other functions along with `image`, otherwise the new requests must be read first
+ * Returns ELFPARSER_INVALID if the file is not a valid ELF file */
+ElfParser_Error elfparser_loader_advance(ElfParser_Loader* loader);
+
+/* Reads the global header and special members (symbol index and long name table) of a static library
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the data is not an archive */
+ElfParser_Error elfparser_get_archive(const void* archive_start, uint64_t archive_size, ElfParser_Archive* archive_out);
+
+/* Reads the member whose header is at byte offset `offset`, e.g. from the symbol index
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if there is no valid member header at `offset` or the member
+ * runs past the end of the archive */
+ElfParser_Error elfparser_get_archive_member(const ElfParser_Archive* archive, uint64_t offset,
+                                             ElfParser_ArchiveMember* member_out);
+
+/* Initializes a cursor positioned at the first member, skipping the special members */
+void elfparser_archive_cursor_init(const ElfParser_Archive* archive, ElfParser_ArchiveCursor* cursor_out);
+
+/* Reads the member under the cursor into member_out and advances the cursor
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more members,
+ * ELFPARSER_INVALID if the member is corrupted - iteration can't go on past it */
+ElfParser_Error elfparser_archive_cursor_next(ElfParser_ArchiveCursor* cursor, ElfParser_ArchiveMember* member_out);
+
+/* Initializes a cursor over the symbol index
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if the archive has no symbol index,
+ * ELFPARSER_INVALID if the symbol index is truncated, but the cursor is still usable */
+ElfParser_Error elfparser_archive_symbol_cursor_init(const ElfParser_Archive* archive,
+                                                     ElfParser_ArchiveSymbolCursor* cursor_out);
+
+/* Reads the symbol under the cursor into symbol_out and advances the cursor
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more symbols */
+ElfParser_Error elfparser_archive_symbol_cursor_next(ElfParser_ArchiveSymbolCursor* cursor,
+                                                     ElfParser_ArchiveSymbol* symbol_out);
+
+/* Finds the member defining a symbol through the symbol index, without reading any other member
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if name is NULL or the member is corrupted,
+ * ELFPARSER_NOT_FOUND if there is no symbol index or the symbol is not in it */
+ElfParser_Error elfparser_archive_lookup_symbol(const ElfParser_Archive* archive, const char* name,
+                                                ElfParser_ArchiveMember* member_out);
+
+/* Reads the binary search table of .eh_frame_hdr, found through PT_GNU_EH_FRAME or the .eh_frame_hdr section
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no .eh_frame_hdr or it has no search table
+ * (use elfparser_build_fde_table instead), ELFPARSER_INVALID if .eh_frame_hdr is corrupted */
+ElfParser_Error elfparser_get_fde_table(const void* elf_start, const ElfParser_Header* header, ElfParser_FdeTable* table_out);
+
+/* Returns the size in bytes of the buffer needed by elfparser_build_fde_table */
+uint64_t elfparser_get_fde_table_buffer_size(const void* elf_start, const ElfParser_Header* header);
+
+/* Builds a table of every FDE in .eh_frame sorted by address in `buffer`, for files without .eh_frame_hdr
+ * If there is no .eh_frame, the FDEs of .debug_frame are used instead
+ * `buffer` must stay valid for as long as the table is used
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no .eh_frame,
+ * ELFPARSER_INVALID if `buffer_size` is smaller than elfparser_get_fde_table_buffer_size */
+ElfParser_Error elfparser_build_fde_table(const void* elf_start, const ElfParser_Header* header,
+                                          void* buffer, uint64_t buffer_size, ElfParser_FdeTable* table_out);
+
+/* Finds the FDE covering address `pc` with a binary search of the table, and returns only its address range and
+ * offset. Nothing is decoded for a table built by elfparser_build_fde_table, and only the encoding of addresses is read
+ * from the CIE otherwise, so this is the function to use for many lookups
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if no FDE covers `pc`, ELFPARSER_INVALID if the FDE or
+ * its CIE is corrupted */
+ElfParser_Error elfparser_find_fde_range(const ElfParser_FdeTable* table, uint64_t pc, ElfParser_FdeRange* range_out);
+
+/* Finds the FDE covering address `pc` with a binary search of the table, and decodes it and its CIE into fde_out
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if no FDE covers `pc`, ELFPARSER_INVALID if the FDE or
+ * its CIE is corrupted */
+ElfParser_Error elfparser_find_fde(const ElfParser_FdeTable* table, uint64_t pc, ElfParser_Fde* fde_out);
+
+/* Decodes the FDE at file offset `offset` of .eh_frame and its CIE into fde_out
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if there is no valid FDE at `offset` */
+ElfParser_Error elfparser_get_fde(const ElfParser_FdeTable* table, uint64_t offset, ElfParser_Fde* fde_out);
+
+/* Computes the rules to recover the calling frame at address `pc`, by running the call frame instructions of the
+ * CIE and FDE covering `pc`. Registers without a rule are ELFPARSER_UNWIND_RULE_SAME_VALUE
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if no FDE covers `pc`, ELFPARSER_INVALID if the FDE or
+ * its CIE is corrupted or the CFA is computed from a register past ELFPARSER_UNWIND_MAX_REGISTERS */
+ElfParser_Error elfparser_get_unwind_row(const ElfParser_FdeTable* table, uint64_t pc, ElfParser_UnwindRow* row_out);
+
+/* Computes the registers of the calling frame from the registers of the current frame using `row`
+ * `registers` and `registers_out` hold ELFPARSER_UNWIND_MAX_REGISTERS values indexed by DWARF register number
+ * `read_memory` is called to read saved registers from the stack
+ * The stack pointer of the calling frame is the CFA unless the row has a rule for it, and its return address is
+ * registers_out[row->return_address_register]. Unless row->is_signal_frame, the return address may be just past the
+ * end of the calling function, so look up the return address - 1 to unwind the next frame
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if the return address is undefined, meaning this is the
+ * outermost frame, ELFPARSER_INVALID if memory can't be read or an expression can't be evaluated */
+ElfParser_Error elfparser_apply_unwind_row(const ElfParser_FdeTable* table, const ElfParser_UnwindRow* row,
+                                           const uint64_t* registers, ElfParser_ReadMemoryCallback read_memory,
+                                           void* user_data, uint64_t* registers_out);
+
+/* Sets up an empty cache of unwind rows in `buffer`, which must stay valid for as long as the cache is used
+ * The number of rows is the largest power of two that fits - `buffer` should hold at least one ElfParser_UnwindRow */
+void elfparser_unwind_cache_init(ElfParser_UnwindCache* cache_out, void* buffer, uint64_t buffer_size);
+
+/* Like elfparser_get_unwind_row, but returns the cached row covering `pc` if there is one, and caches the row
+ * computed otherwise. Use one cache per table
+ * row_out points into the cache, and is only valid until the next call with the same cache */
+ElfParser_Error elfparser_get_unwind_row_cached(const ElfParser_FdeTable* table, ElfParser_UnwindCache* cache,
+                                                uint64_t pc, const ElfParser_UnwindRow** row_out);
+
+/* Returns the smallest buffer size accepted by elfparser_build_line_index, which is enough for the index of
+ * compilation units and .debug_aranges but leaves no room to cache line tables */
+uint64_t elfparser_get_line_index_buffer_size(const void* elf_start, const ElfParser_Header* header);
+
+/* Builds an index mapping addresses to compilation units in `buffer`. Line tables are only decoded the first time an
+ * address of their unit is looked up, and are cached in the rest of the buffer. Once the buffer is full, every cached
+ * line table is dropped, so memory stays bounded by `buffer_size` however large the file is
+ * `buffer` must stay valid for as long as the index is used
+ * Compressed debug sections are treated as missing, since they can't be read in place
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there is no .debug_info or .debug_line,
+ * ELFPARSER_INVALID if `buffer_size` is smaller than elfparser_get_line_index_buffer_size */
+ElfParser_Error elfparser_build_line_index(const void* elf_start, const ElfParser_Header* header,
+                                          void* buffer, uint64_t buffer_size, ElfParser_LineIndex* index_out);
+
+/* Finds the source location of `address`. The unit is picked with .debug_aranges - units missing from it are
+ * matched by the addresses their line table covers, which is decoded once to find them
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if no line table covers `address`, ELFPARSER_INVALID if
+ * the debug information is corrupted, or a line table doesn't fit in the buffer even on its own */
+ElfParser_Error elfparser_line_index_find(ElfParser_LineIndex* index, uint64_t address, ElfParser_LineInfo* info_out);
+
+/* Finds the contents of a section, reading the compression header of SHF_COMPRESSED sections. Nothing is decompressed
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the section data does not lie within the file or is too
+ * small for a compression header */
+ElfParser_Error elfparser_get_section_contents(const void* elf_start, const ElfParser_Header* header,
+                                               const ElfParser_SectionHeader* section,
+                                               ElfParser_SectionContents* contents_out);
+
+/* Decompresses the contents of a section into `dest`, which must hold at least the size found by
+ * elfparser_get_section_contents. Sections which aren't compressed are copied
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if the section is compressed with anything but zlib (zstd
+ * data can be passed to a zstd decoder using elfparser_get_section_contents), ELFPARSER_INVALID if `dest_size` is too
+ * small or the data is corrupted */
+ElfParser_Error elfparser_decompress_section(const void* elf_start, const ElfParser_Header* header,
+                                             const ElfParser_SectionHeader* section, void* dest, uint64_t dest_size);
+
+/* Decompresses the contents of a section a piece at a time, passing each piece to `callback` when `buffer` is full,
+ * so the whole section never has to be in memory. `buffer_size` must be at least ELFPARSER_DECOMPRESS_MIN_BUFFER_SIZE,
+ * and larger buffers mean fewer calls. Sections which aren't compressed are passed straight from the file
+ * Returns as elfparser_decompress_section, or ELFPARSER_INVALID if `buffer_size` is too small or `callback` returned
+ * false */
+ElfParser_Error elfparser_decompress_section_stream(const void* elf_start, const ElfParser_Header* header,
+                                                    const ElfParser_SectionHeader* section, void* buffer,
+                                                    uint64_t buffer_size, ElfParser_DecompressCallback callback,
+                                                    void* user_data);
+
+/* Decompresses the section referenced by the index member of each of the `num` entries of `jobs`
+ * Entries don't depend on each other, so a table can be split between threads
+ * Returns ELFPARSER_NOERROR if every section was decompressed, otherwise ELFPARSER_INVALID - check the error member of
+ * each entry */
+ElfParser_Error elfparser_decompress_sections(const void* elf_start, const ElfParser_Header* header,
+                                              ElfParser_DecompressJob* jobs, uint64_t num);
+
+/* Sets up a symbol query matching every symbol. Narrow it down by changing the members of query_out */
+void elfparser_symbol_query_init(ElfParser_SymbolQuery* query_out);
+
+/* Starts a query over the symbols of `table`, or of the symbol table found by elfparser_get_header if `table` is NULL.
+ * The fixed-size fields of the symbols are checked in batches straight from the file, and names are only read for
+ * symbols matching everything else. The name prefix of `query` must stay valid for as long as the cursor is used
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the table does not lie within the file. Symbols outside
+ * the file are skipped either way */
+ElfParser_Error elfparser_symbol_query_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                                   const ElfParser_SymbolTable* table, const ElfParser_SymbolQuery* query,
+                                                   ElfParser_SymbolQueryCursor* cursor_out);
+
+/* Finds the next symbol matching the query, in order of index. symbol_out->name is filled in
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND once there are no symbols left */
+ElfParser_Error elfparser_symbol_query_cursor_next(ElfParser_SymbolQueryCursor* cursor, ElfParser_Symbol* symbol_out);
+
+/* Returns the size in bytes of the buffer needed by elfparser_build_name_index for `table` (.symtab if NULL) */
+uint64_t elfparser_get_name_index_buffer_size(const void* elf_start, const ElfParser_Header* header,
+                                              const ElfParser_SymbolTable* table);
+
+/* Builds an index of the named symbols of `table` (.symtab if NULL) sorted by name in `buffer`, along with the length
+ * of the prefix each name shares with the previous one. `buffer` must stay valid for as long as the index is used
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `buffer_size` is smaller than
+ * elfparser_get_name_index_buffer_size */
+ElfParser_Error elfparser_build_name_index(const void* elf_start, const ElfParser_Header* header,
+                                          const ElfParser_SymbolTable* table, void* buffer, uint64_t buffer_size,
+                                          ElfParser_NameIndex* index_out);
+
+/* Finds the positions from first_out up to (not including) end_out of the symbols whose name starts with `prefix`,
+ * with two binary searches
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if no name starts with `prefix`, ELFPARSER_INVALID if
+ * `prefix` is NULL */
+ElfParser_Error elfparser_name_index_find_prefix(const ElfParser_NameIndex* index, const char* prefix,
+                                                 uint64_t* first_out, uint64_t* end_out);
+
+/* Reads the symbol at `position` in the index, with its name
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if `position` is past the end of the index */
+ElfParser_Error elfparser_name_index_get(const ElfParser_NameIndex* index, uint64_t position, ElfParser_Symbol* symbol_out);
+
+/* Returns the length of the prefix shared by every name from position `first` up to `end`, e.g. to complete a prefix
+ * found by elfparser_name_index_find_prefix as far as it goes */
+uint64_t elfparser_name_index_get_common_prefix_length(const ElfParser_NameIndex* index, uint64_t first, uint64_t end);
+
+/* Starts a search for the symbols whose name matches a glob pattern. `*` matches any characters, `?` any character and
+ * `[...]` any character in it (ranges like `a-z` are allowed, and `!` or `^` at the start negates it). Only names
+ * starting with the characters before the first wildcard are checked. `pattern` must stay valid for as long as the
+ * cursor is used */
+void elfparser_name_glob_cursor_init(const ElfParser_NameIndex* index, const char* pattern,
+                                     ElfParser_NameGlobCursor* cursor_out);
+
+/* Finds the next symbol matching the pattern, in order of name. symbol_out->name is filled in
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND once there are no symbols left */
+ElfParser_Error elfparser_name_glob_cursor_next(ElfParser_NameGlobCursor* cursor, ElfParser_Symbol* symbol_out);
+
+/* Returns the size in bytes of a symbol filter for the file, about 2 bytes per entry of .symtab and .dynsym */
+uint64_t elfparser_get_symbol_filter_size(const void* elf_start, const ElfParser_Header* header);
+
+/* Builds a Bloom filter of the names of the symbols defined by the file (global, weak and unique symbols of .symtab and
+ * .dynsym with a section index other than SHN_UNDEF). `filter` must be 8 byte aligned, and the filter is stored in
+ * native byte order
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `filter_size` isn't a non-zero multiple of
+ * ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE */
+ElfParser_Error elfparser_build_symbol_filter(const void* elf_start, const ElfParser_Header* header,
+                                             void* filter, uint64_t filter_size);
+
+/* Hashes a symbol name once, to check it against any number of symbol filters */
+void elfparser_symbol_filter_key_init(const char* name, ElfParser_SymbolFilterKey* key_out);
+
+/* Returns false if the file the filter was built from definitely doesn't define the name of `key`, true if it might */
+bool elfparser_symbol_filter_may_contain(const void* filter, uint64_t filter_size, const ElfParser_SymbolFilterKey* key);
+
+/* Checks `key` against the `num` filters at base + filters[i].offset, and writes the index i of each filter which might
+ * contain it to matches_out, which must have room for `num` indexes. Each filter is checked with one 64 byte block
+ * Returns the number of indexes written */
+uint64_t elfparser_scan_symbol_filters(const void* base, const ElfParser_SymbolFilterRef* filters, uint64_t num,
+                                       const ElfParser_SymbolFilterKey* key, uint64_t* matches_out);
+
+/* Initializes a cursor over the lines of the text of /proc/<pid>/maps (or a copy of it), `maps_size` bytes long.
+ * `maps` must stay valid for as long as the cursor and the mappings read through it are used */
+void elfparser_process_mapping_cursor_init(const char* maps, uint64_t maps_size, ElfParser_ProcessMappingCursor* cursor_out);
+
+/* Parses the next line into mapping_out and advances the cursor. Lines which can't be parsed are skipped
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_NOT_FOUND if there are no more lines */
+ElfParser_Error elfparser_process_mapping_cursor_next(ElfParser_ProcessMappingCursor* cursor,
+                                                      ElfParser_ProcessMapping* mapping_out);
+
+/* Returns the size in bytes of the buffer needed by elfparser_build_function_table */
+uint64_t elfparser_get_function_table_buffer_size(const void* elf_start, const ElfParser_Header* header);
+
+/* Builds a table of the functions defined in .symtab and .dynsym sorted by address in `buffer`. Where several names
+ * share an address, global names win over weak and local ones. `buffer` must stay valid for as long as the table is used
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if `buffer_size` is smaller than
+ * elfparser_get_function_table_buffer_size */
+ElfParser_Error elfparser_build_function_table(const void* elf_start, const ElfParser_Header* header,
+                                              void* buffer, uint64_t buffer_size, ElfParser_FunctionTable* table_out);
+
+/* Sorts a batch of addresses to resolve by address, ready for elfparser_resolve_addresses */
+void elfparser_sort_address_lookups(ElfParser_AddressLookup* lookups, uint64_t num);
+
+/* Finds the function containing the address member of each of the `num` entries of `lookups`. Addresses in any order
+ * are resolved, but sorted addresses are resolved in one pass over the table, merging them with the functions
+ * Returns ELFPARSER_NOERROR if every address was resolved, otherwise ELFPARSER_NOT_FOUND - check the error member
+ * of each entry */
+ElfParser_Error elfparser_resolve_addresses(const ElfParser_FunctionTable* table, ElfParser_AddressLookup* lookups,
+                                            uint64_t num);
+
+/* Initializes an RCU domain with no readers */
+void elfparser_rcu_init(ElfParser_RcuDomain* domain);
+
+/* Starts (and ends) a read of values published in the domain by thread number `reader`, which must be below
+ * ELFPARSER_RCU_MAX_READERS and not used by another thread at the same time. Values loaded with
+ * elfparser_rcu_dereference between the two calls stay valid until elfparser_rcu_read_unlock. Neither call waits */
+void elfparser_rcu_read_lock(ElfParser_RcuDomain* domain, uint64_t reader);
+void elfparser_rcu_read_unlock(ElfParser_RcuDomain* domain, uint64_t reader);
+
+/* Loads the value published in `slot` */
+void* elfparser_rcu_dereference(void* const* slot);
+
+/* Replaces the value in `slot` with `value`, which must be fully built, and returns the old value in old_out (if not
+ * NULL). Readers see either the old or the new value, never anything in between. Writers to the same slot must not
+ * publish at the same time
+ * Returns the epoch the old value was retired in - it can be reclaimed once elfparser_rcu_get_safe_epoch is above it */
+uint64_t elfparser_rcu_publish(ElfParser_RcuDomain* domain, void** slot, void* value, void** old_out);
+
+/* Returns the oldest epoch a reader might still be reading in. Values retired in an earlier epoch aren't used by any
+ * reader and can be reclaimed */
+uint64_t elfparser_rcu_get_safe_epoch(const ElfParser_RcuDomain* domain);
+
+/* Uses a buffer filled in by elfparser_build_function_table as a function table, without building it again. The buffer
+ * only refers to the file by offset, so it can be built in shared memory (or saved to a file) and attached to by other
+ * processes mapping it read-only, at any 8 byte aligned address. It must have been built on a host with the same byte
+ * order
+ * Returns ELFPARSER_NOERROR on success, ELFPARSER_INVALID if the buffer doesn't hold a function table built from this
+ * file (checked by size and by a hash of the headers of the file) */
+ElfParser_Error elfparser_attach_function_table(const void* elf_start, const ElfParser_Header* header,
+                                               const void* buffer, uint64_t buffer_size, ElfParser_FunctionTable* table_out);
+
+/* Same as elfparser_attach_function_table, for a buffer filled in by elfparser_build_name_index. The index uses the
+ * symbol table it was built from */
+ElfParser_Error elfparser_attach_name_index(const void* elf_start, const ElfParser_Header* header,
+                                           const void* buffer, uint64_t buffer_size, ElfParser_NameIndex* index_out);
+
 // Header ident fields checks
 static inline bool elfparser_is_valid_ei_class(ElfParser_EI_Class value);
 static inline bool elfparser_is_valid_ei_data(ElfParser_EI_Data value);
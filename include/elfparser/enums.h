@@ -161,7 +161,9 @@ typedef enum {
     ELFPARSER_EM_NS32K	        = 97,
     ELFPARSER_EM_TPC	        = 98,
     ELFPARSER_EM_SNP1K	        = 99,
-    ELFPARSER_EM_ST200	        = 100
+    ELFPARSER_EM_ST200	        = 100,
+    ELFPARSER_EM_AARCH64        = 183,
+    ELFPARSER_EM_RISCV          = 243
 } ElfParser_E_Machine;
 
 typedef enum {
@@ -182,7 +184,12 @@ typedef enum {
     ELFPARSER_SHT_PREINIT_ARRAY = 16,
     ELFPARSER_SHT_GROUP         = 17,
     ELFPARSER_SHT_SYMTAB_SHNDX  = 18,
+    ELFPARSER_SHT_RELR          = 19,
     ELFPARSER_SHT_LOOS          = 0x60000000,
+    ELFPARSER_SHT_GNU_HASH      = 0x6ffffff6,
+    ELFPARSER_SHT_GNU_VERDEF    = 0x6ffffffd,
+    ELFPARSER_SHT_GNU_VERNEED   = 0x6ffffffe,
+    ELFPARSER_SHT_GNU_VERSYM    = 0x6fffffff,
     ELFPARSER_SHT_HIOS          = 0x6fffffff,
     ELFPARSER_SHT_LOPROC        = 0x70000000,
     ELFPARSER_SHT_HIPROC        = 0x7fffffff,
@@ -201,6 +208,7 @@ typedef enum {
     ELFPARSER_SHF_OS_NONCONFORMING  = 0x100,
     ELFPARSER_SHF_GROUP             = 0x200,
     ELFPARSER_SHF_TLS               = 0x400,
+    ELFPARSER_SHF_COMPRESSED        = 0x800,
     ELFPARSER_SHF_MASKOS            = 0x0ff00000,
     ELFPARSER_SHF_MASKPROC          = 0xf0000000
 } ElfParser_SH_Flags;
@@ -223,6 +231,7 @@ typedef enum {
     ELFPARSER_STB_GLOBAL    = 1,
     ELFPARSER_STB_WEAK      = 2,
     ELFPARSER_STB_LOOS      = 10,
+    ELFPARSER_STB_GNU_UNIQUE = 10,
     ELFPARSER_STB_HIOS      = 12,
     ELFPARSER_STB_LOPROC    = 13,
     ELFPARSER_STB_HIPROC    = 15
@@ -237,6 +246,7 @@ typedef enum {
     ELFPARSER_STT_COMMON    = 5,
     ELFPARSER_STT_TLS       = 6,
     ELFPARSER_STT_LOOS      = 10,
+    ELFPARSER_STT_GNU_IFUNC = 10,
     ELFPARSER_STT_HIOS      = 12,
     ELFPARSER_STT_LOPROC    = 13,
     ELFPARSER_STT_HIPROC    = 15
@@ -259,6 +269,13 @@ typedef enum {
     ELFPARSER_PT_PHDR       = 6,
     ELFPARSER_PT_TLS        = 7,
     ELFPARSER_PT_LOOS       = 0x60000000,
+    ELFPARSER_PT_GNU_EH_FRAME = 0x6474e550,
+    ELFPARSER_PT_GNU_STACK  = 0x6474e551,
+    ELFPARSER_PT_GNU_RELRO  = 0x6474e552,
+    ELFPARSER_PT_GNU_PROPERTY = 0x6474e553,
+    ELFPARSER_PT_GNU_SFRAME = 0x6474e554,
+    ELFPARSER_PT_GNU_MBIND_LO = 0x6474e555,
+    ELFPARSER_PT_GNU_MBIND_HI = 0x6474f554,
     ELFPARSER_PT_HIOS       = 0x6fffffff,
     ELFPARSER_PT_LOPROC     = 0x70000000,
     ELFPARSER_PT_HIPROC     = 0x7fffffff
@@ -270,4 +287,257 @@ typedef enum {
     ELFPARSER_PF_R          = 0x4,
     ELFPARSER_PF_MASKOS     = 0x0ff00000,
     ELFPARSER_PF_MASKPROC   = 0xf0000000
-} ElfParser_P_Flags;
\ No newline at end of file
+} ElfParser_P_Flags;
+
+// Note types are specific to the owner (name) of the note, so values overlap
+typedef enum {
+    // Notes owned by "CORE", found in core files
+    ELFPARSER_NT_PRSTATUS   = 1,
+    ELFPARSER_NT_PRFPREG    = 2,
+    ELFPARSER_NT_PRPSINFO   = 3,
+    ELFPARSER_NT_TASKSTRUCT = 4,
+    ELFPARSER_NT_AUXV       = 6,
+    ELFPARSER_NT_SIGINFO    = 0x53494749,
+    ELFPARSER_NT_FILE       = 0x46494c45,
+    
+    // Notes owned by "GNU"
+    ELFPARSER_NT_GNU_ABI_TAG        = 1,
+    ELFPARSER_NT_GNU_HWCAP          = 2,
+    ELFPARSER_NT_GNU_BUILD_ID       = 3,
+    ELFPARSER_NT_GNU_GOLD_VERSION   = 4,
+    ELFPARSER_NT_GNU_PROPERTY_TYPE_0 = 5
+} ElfParser_N_Type;
+
+typedef enum {
+    ELFPARSER_AT_NULL       = 0,
+    ELFPARSER_AT_IGNORE     = 1,
+    ELFPARSER_AT_EXECFD     = 2,
+    ELFPARSER_AT_PHDR       = 3,
+    ELFPARSER_AT_PHENT      = 4,
+    ELFPARSER_AT_PHNUM      = 5,
+    ELFPARSER_AT_PAGESZ     = 6,
+    ELFPARSER_AT_BASE       = 7,
+    ELFPARSER_AT_FLAGS      = 8,
+    ELFPARSER_AT_ENTRY      = 9,
+    ELFPARSER_AT_UID        = 11,
+    ELFPARSER_AT_EUID       = 12,
+    ELFPARSER_AT_GID        = 13,
+    ELFPARSER_AT_EGID       = 14,
+    ELFPARSER_AT_PLATFORM   = 15,
+    ELFPARSER_AT_HWCAP      = 16,
+    ELFPARSER_AT_CLKTCK     = 17,
+    ELFPARSER_AT_SECURE     = 23,
+    ELFPARSER_AT_RANDOM     = 25,
+    ELFPARSER_AT_HWCAP2     = 26,
+    ELFPARSER_AT_EXECFN     = 31,
+    ELFPARSER_AT_SYSINFO_EHDR = 33
+} ElfParser_AT_Type;
+
+// Dynamic section tags. d_val holds either an integer or an address, depending on the tag
+typedef enum {
+    ELFPARSER_DT_NULL           = 0,
+    ELFPARSER_DT_NEEDED         = 1,    // String table offset of the name of a needed library
+    ELFPARSER_DT_PLTRELSZ       = 2,
+    ELFPARSER_DT_PLTGOT         = 3,
+    ELFPARSER_DT_HASH           = 4,
+    ELFPARSER_DT_STRTAB         = 5,
+    ELFPARSER_DT_SYMTAB         = 6,
+    ELFPARSER_DT_RELA           = 7,
+    ELFPARSER_DT_RELASZ         = 8,
+    ELFPARSER_DT_RELAENT        = 9,
+    ELFPARSER_DT_STRSZ          = 10,
+    ELFPARSER_DT_SYMENT         = 11,
+    ELFPARSER_DT_INIT           = 12,
+    ELFPARSER_DT_FINI           = 13,
+    ELFPARSER_DT_SONAME         = 14,
+    ELFPARSER_DT_RPATH          = 15,
+    ELFPARSER_DT_SYMBOLIC       = 16,
+    ELFPARSER_DT_REL            = 17,
+    ELFPARSER_DT_RELSZ          = 18,
+    ELFPARSER_DT_RELENT         = 19,
+    ELFPARSER_DT_PLTREL         = 20,
+    ELFPARSER_DT_DEBUG          = 21,
+    ELFPARSER_DT_TEXTREL        = 22,
+    ELFPARSER_DT_JMPREL         = 23,
+    ELFPARSER_DT_BIND_NOW       = 24,
+    ELFPARSER_DT_INIT_ARRAY     = 25,
+    ELFPARSER_DT_FINI_ARRAY     = 26,
+    ELFPARSER_DT_INIT_ARRAYSZ   = 27,
+    ELFPARSER_DT_FINI_ARRAYSZ   = 28,
+    ELFPARSER_DT_RUNPATH        = 29,
+    ELFPARSER_DT_FLAGS          = 30,
+    ELFPARSER_DT_PREINIT_ARRAY  = 32,
+    ELFPARSER_DT_PREINIT_ARRAYSZ = 33,
+    ELFPARSER_DT_SYMTAB_SHNDX   = 34,
+    ELFPARSER_DT_RELRSZ         = 35,
+    ELFPARSER_DT_RELR           = 36,
+    ELFPARSER_DT_RELRENT        = 37,
+    ELFPARSER_DT_LOOS           = 0x6000000d,
+    ELFPARSER_DT_GNU_HASH       = 0x6ffffef5,
+    ELFPARSER_DT_VERSYM         = 0x6ffffff0,
+    ELFPARSER_DT_FLAGS_1        = 0x6ffffffb,
+    ELFPARSER_DT_VERDEF         = 0x6ffffffc,
+    ELFPARSER_DT_VERDEFNUM      = 0x6ffffffd,
+    ELFPARSER_DT_VERNEED        = 0x6ffffffe,
+    ELFPARSER_DT_VERNEEDNUM     = 0x6fffffff,
+    ELFPARSER_DT_HIOS           = 0x6ffff000,
+    ELFPARSER_DT_LOPROC         = 0x70000000,
+    ELFPARSER_DT_HIPROC         = 0x7fffffff
+} ElfParser_D_Tag;
+
+typedef enum {
+    ELFPARSER_HASH_XXH64    = 0,    // 8 byte digest, fast non-cryptographic hash
+    ELFPARSER_HASH_SHA256   = 1     // 32 byte digest
+} ElfParser_HashType;
+
+typedef enum {
+    ELFPARSER_DIFF_SECTION_ADDED,
+    ELFPARSER_DIFF_SECTION_REMOVED,
+    ELFPARSER_DIFF_SECTION_RESIZED,     // old_value and new_value are sh_size
+    ELFPARSER_DIFF_SECTION_CHANGED,     // Same size, different contents
+    ELFPARSER_DIFF_SYMBOL_ADDED,
+    ELFPARSER_DIFF_SYMBOL_REMOVED,
+    ELFPARSER_DIFF_SYMBOL_MOVED,        // old_value and new_value are st_value
+    ELFPARSER_DIFF_SYMBOL_RESIZED       // old_value and new_value are st_size
+} ElfParser_DiffKind;
+
+typedef enum {
+    ELFPARSER_ABI_ADDED,
+    ELFPARSER_ABI_REMOVED,
+    ELFPARSER_ABI_SIZE_CHANGED,
+    ELFPARSER_ABI_TYPE_CHANGED
+} ElfParser_AbiChangeKind;
+
+typedef enum {
+    ELFPARSER_ANOMALY_INVALID_HEADER_FIELD,         // ELF header field with a value not allowed by the standard
+    ELFPARSER_ANOMALY_BAD_ENTRY_SIZE,               // e_ehsize, e_phentsize or e_shentsize smaller than its structure
+    ELFPARSER_ANOMALY_PH_TABLE_OUT_OF_BOUNDS,
+    ELFPARSER_ANOMALY_SH_TABLE_OUT_OF_BOUNDS,
+    ELFPARSER_ANOMALY_BAD_SHSTRNDX,                 // Section name string table missing or not a string table
+    ELFPARSER_ANOMALY_BAD_NULL_SECTION,
+    ELFPARSER_ANOMALY_SECTION_INVALID_TYPE,
+    ELFPARSER_ANOMALY_SECTION_NAME_OUT_OF_BOUNDS,
+    ELFPARSER_ANOMALY_SECTION_OUT_OF_BOUNDS,
+    ELFPARSER_ANOMALY_SECTION_BAD_LINK,
+    ELFPARSER_ANOMALY_SECTION_BAD_ENTSIZE,
+    ELFPARSER_ANOMALY_SECTION_BAD_ALIGN,            // sh_addralign not a power of 2
+    ELFPARSER_ANOMALY_SECTION_MISALIGNED,           // sh_addr not a multiple of sh_addralign
+    ELFPARSER_ANOMALY_STRING_TABLE_UNTERMINATED,
+    ELFPARSER_ANOMALY_OVERLAP,                      // Section data overlaps another section or a header table
+    ELFPARSER_ANOMALY_SECTION_STRADDLES_SEGMENT,    // Allocated section starts inside a PT_LOAD segment but ends past it
+    ELFPARSER_ANOMALY_SYMBOL_NAME_OUT_OF_BOUNDS,
+    ELFPARSER_ANOMALY_SYMBOL_INVALID_INFO,
+    ELFPARSER_ANOMALY_SYMBOL_BAD_SECTION,
+    ELFPARSER_ANOMALY_SYMBOL_OUTSIDE_SECTION,
+    ELFPARSER_ANOMALY_SYMBOL_BAD_ORDER,             // Local symbol after the first global symbol, or the other way around
+    ELFPARSER_ANOMALY_SEGMENT_INVALID_TYPE,
+    ELFPARSER_ANOMALY_SEGMENT_OUT_OF_BOUNDS,
+    ELFPARSER_ANOMALY_SEGMENT_FILESZ_TOO_BIG,       // PT_LOAD segment with p_filesz > p_memsz
+    ELFPARSER_ANOMALY_SEGMENT_BAD_ALIGN,            // p_align not a power of 2
+    ELFPARSER_ANOMALY_SEGMENT_MISALIGNED,           // PT_LOAD segment with p_offset and p_vaddr not equal modulo p_align
+    ELFPARSER_ANOMALY_LOAD_SEGMENTS_UNORDERED,
+    ELFPARSER_ANOMALY_LOAD_SEGMENTS_OVERLAP
+} ElfParser_AnomalyKind;
+
+// Owners of bytes in a file, from least to most specific
+typedef enum {
+    ELFPARSER_SIZE_UNMAPPED,    // Not owned by anything - padding or data outside any section
+    ELFPARSER_SIZE_SEGMENT,     // PT_LOAD segment, but no section
+    ELFPARSER_SIZE_HEADER,      // ELF header, program header table or section header table
+    ELFPARSER_SIZE_SECTION,
+    ELFPARSER_SIZE_SYMBOL
+} ElfParser_SizeOwnerKind;
+
+typedef enum {
+    ELFPARSER_SIZE_FILE,        // Bytes in the file
+    ELFPARSER_SIZE_VM           // Bytes of address space when loaded
+} ElfParser_SizeSpace;
+
+// Tables read by the loader on top of the ELF header, program header table, section header table and section names
+typedef enum {
+    ELFPARSER_LOAD_SYMTAB   = 0x1,  // .symtab and its string table
+    ELFPARSER_LOAD_DYNSYM   = 0x2,  // .dynsym and its string table
+    ELFPARSER_LOAD_DYNAMIC  = 0x4,  // Dynamic section and the string table referenced by DT_STRTAB
+    ELFPARSER_LOAD_INTERP   = 0x8,  // PT_INTERP segment
+    ELFPARSER_LOAD_NOTES    = 0x10  // Every PT_NOTE segment
+} ElfParser_LoadFlags;
+
+// Pointer encodings used by .eh_frame and .eh_frame_hdr. The low 4 bits give the format of the value, the next 3 bits
+// what it is relative to, and the top bit whether the value is the address of the pointer rather than the pointer
+typedef enum {
+    ELFPARSER_DW_EH_PE_ABSPTR   = 0x00,     // Word sized
+    ELFPARSER_DW_EH_PE_ULEB128  = 0x01,
+    ELFPARSER_DW_EH_PE_UDATA2   = 0x02,
+    ELFPARSER_DW_EH_PE_UDATA4   = 0x03,
+    ELFPARSER_DW_EH_PE_UDATA8   = 0x04,
+    ELFPARSER_DW_EH_PE_SLEB128  = 0x09,
+    ELFPARSER_DW_EH_PE_SDATA2   = 0x0a,
+    ELFPARSER_DW_EH_PE_SDATA4   = 0x0b,
+    ELFPARSER_DW_EH_PE_SDATA8   = 0x0c,
+    ELFPARSER_DW_EH_PE_PCREL    = 0x10,     // Relative to the address of the value itself
+    ELFPARSER_DW_EH_PE_TEXTREL  = 0x20,
+    ELFPARSER_DW_EH_PE_DATAREL  = 0x30,     // Relative to the start of .eh_frame_hdr, in .eh_frame_hdr
+    ELFPARSER_DW_EH_PE_FUNCREL  = 0x40,     // Relative to the start of the function
+    ELFPARSER_DW_EH_PE_ALIGNED  = 0x50,
+    ELFPARSER_DW_EH_PE_INDIRECT = 0x80,
+    ELFPARSER_DW_EH_PE_OMIT     = 0xff      // No value
+} ElfParser_DW_EH_PE;
+
+// How a register of the calling frame is recovered, see ElfParser_UnwindRule
+typedef enum {
+    ELFPARSER_UNWIND_RULE_SAME_VALUE        = 0,    // Not changed by the function
+    ELFPARSER_UNWIND_RULE_UNDEFINED         = 1,    // Can't be recovered - for the return address, there is no caller
+    ELFPARSER_UNWIND_RULE_OFFSET            = 2,    // Saved at CFA + offset
+    ELFPARSER_UNWIND_RULE_VAL_OFFSET        = 3,    // Is CFA + offset
+    ELFPARSER_UNWIND_RULE_REGISTER          = 4,    // Saved in register reg, or for the CFA, is reg + offset
+    ELFPARSER_UNWIND_RULE_EXPRESSION        = 5,    // Saved at the address computed by a DWARF expression
+    ELFPARSER_UNWIND_RULE_VAL_EXPRESSION    = 6     // Is the value computed by a DWARF expression
+} ElfParser_UnwindRuleType;
+
+// DWARF register numbers, as used by ElfParser_UnwindRow
+typedef enum {
+    ELFPARSER_X86_64_RAX    = 0,
+    ELFPARSER_X86_64_RDX    = 1,
+    ELFPARSER_X86_64_RCX    = 2,
+    ELFPARSER_X86_64_RBX    = 3,
+    ELFPARSER_X86_64_RSI    = 4,
+    ELFPARSER_X86_64_RDI    = 5,
+    ELFPARSER_X86_64_RBP    = 6,
+    ELFPARSER_X86_64_RSP    = 7,
+    ELFPARSER_X86_64_R8     = 8,
+    ELFPARSER_X86_64_R9     = 9,
+    ELFPARSER_X86_64_R10    = 10,
+    ELFPARSER_X86_64_R11    = 11,
+    ELFPARSER_X86_64_R12    = 12,
+    ELFPARSER_X86_64_R13    = 13,
+    ELFPARSER_X86_64_R14    = 14,
+    ELFPARSER_X86_64_R15    = 15,
+    ELFPARSER_X86_64_RA     = 16    // Return address
+} ElfParser_X86_64_Register;
+
+typedef enum {
+    ELFPARSER_I386_EAX  = 0,
+    ELFPARSER_I386_ECX  = 1,
+    ELFPARSER_I386_EDX  = 2,
+    ELFPARSER_I386_EBX  = 3,
+    ELFPARSER_I386_ESP  = 4,
+    ELFPARSER_I386_EBP  = 5,
+    ELFPARSER_I386_ESI  = 6,
+    ELFPARSER_I386_EDI  = 7,
+    ELFPARSER_I386_RA   = 8     // Return address
+} ElfParser_I386_Register;
+
+// x0 to x30 are numbered 0 to 30
+typedef enum {
+    ELFPARSER_AARCH64_X0    = 0,
+    ELFPARSER_AARCH64_FP    = 29,   // x29
+    ELFPARSER_AARCH64_LR    = 30,   // x30, the return address
+    ELFPARSER_AARCH64_SP    = 31,
+    ELFPARSER_AARCH64_PC    = 32
+} ElfParser_AArch64_Register;
+
+// ch_type of the compression header of SHF_COMPRESSED sections
+typedef enum {
+    ELFPARSER_ELFCOMPRESS_ZLIB  = 1,
+    ELFPARSER_ELFCOMPRESS_ZSTD  = 2
+} ElfParser_CompressionType;
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 #include "enums.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef struct {
@@ -112,3 +113,629 @@ typedef struct {
     
     uint64_t            index;
 } ElfParser_ProgramHeader;
+
+
+// Cursors check the span of their table against the file size once when initialized, and then step through the table
+// one entry at a time. Names are not resolved while stepping - the `name` member of each returned entry is left NULL
+// until the matching elfparser_*_cursor_get_name function is called. Treat the members as private
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    const void*             next;       // Pointer to next entry to read
+    uint64_t                entry_size;
+    uint64_t                index;      // Index of next entry to read
+    uint64_t                num;        // Number of entries which lie within the file
+} ElfParser_SectionCursor;
+
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    const void*             next;
+    uint64_t                entry_size;
+    uint64_t                index;
+    uint64_t                num;
+    uint64_t                string_table_offset;
+} ElfParser_SymbolCursor;
+
+// Location of a symbol table section (e.g. .symtab or .dynsym) and the string table holding its symbol names
+typedef struct {
+    uint64_t                offset;                 // Byte offset of symbol table data
+    uint64_t                entry_size;             // Size in bytes of each symbol entry
+    uint64_t                num;                    // Number of symbols
+    uint64_t                string_table_offset;    // Byte offset of string table data referenced by sh_link, 0 if none
+    uint64_t                section_index;          // Index of the symbol table section
+} ElfParser_SymbolTable;
+
+// Conditions on the symbols found by a symbol query, see elfparser_symbol_query_init. Ranges include both ends
+typedef struct {
+    uint16_t                bind_mask;          // Bit (1 << st_bind) set for each binding to match
+    uint16_t                type_mask;          // Bit (1 << st_type) set for each type to match
+    uint8_t                 visibility_mask;    // Bit (1 << st_visibility) set for each visibility to match
+    uint16_t                shndx_min;          // Compared with the raw st_shndx, so special indexes (e.g.
+    uint16_t                shndx_max;          // ELFPARSER_SHN_ABS) can be matched too
+    uint64_t                value_min;
+    uint64_t                value_max;
+    uint64_t                size_min;
+    uint64_t                size_max;
+    const char*             name_prefix;        // NULL to match any name
+} ElfParser_SymbolQuery;
+
+// Steps through the symbols of a table matching a query. Treat the members as private
+typedef struct {
+    ElfParser_SymbolCursor  symbols;            // Positioned after the current batch
+    ElfParser_SymbolQuery   query;
+    uint64_t                name_prefix_length;
+    uint64_t                batch_start;        // Index of the first symbol of the current batch
+    uint64_t                batch_mask;         // Bit i set if symbol batch_start + i is a candidate left to check
+    uint8_t                 is_info_matched[1024];  // Indexed by visibility << 8 | st_info, 1 if the symbol matches
+} ElfParser_SymbolQueryCursor;
+
+// Named symbols of a table sorted by name, see elfparser_build_name_index. Positions in the index go from 0 to num - 1
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    ElfParser_SymbolTable   table;
+    void*                   entries;        // Private
+    uint64_t                num;            // Number of symbols in the index
+} ElfParser_NameIndex;
+
+// Steps through the symbols of a name index matching a glob pattern. Treat the members as private
+typedef struct {
+    const ElfParser_NameIndex*  index;
+    const char*                 pattern;
+    uint64_t                    next;           // Position of the next name to check
+    uint64_t                    end;            // End of the names starting with the part of pattern before wildcards
+    uint64_t                    fail_position;  // Where the last name failed to match before any *, UINT64_MAX if not
+} ElfParser_NameGlobCursor;
+
+// Size of the blocks of a symbol filter - the size of a filter must be a multiple of this
+#define ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE 64
+
+// Hash of a symbol name to check against symbol filters, see elfparser_symbol_filter_key_init
+typedef struct {
+    uint64_t                hash;
+    uint64_t                mask[ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE / 8];   // Bits the name sets in each word of a block
+} ElfParser_SymbolFilterKey;
+
+// Location of a symbol filter built by elfparser_build_symbol_filter, see elfparser_scan_symbol_filters
+typedef struct {
+    uint64_t                offset;         // Byte offset of the filter from the base passed to elfparser_scan_symbol_filters
+    uint64_t                size;           // Size of the filter in bytes
+} ElfParser_SymbolFilterRef;
+
+// Functions of a file sorted by address, see elfparser_build_function_table
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    void*                   entries;        // Private
+    uint64_t                num;            // Number of functions in the table
+} ElfParser_FunctionTable;
+
+// Entry of a batch of addresses to resolve, see elfparser_resolve_addresses
+typedef struct {
+    uint64_t                address;            // Virtual address in the file to resolve - filled in by the caller
+    uint64_t                id;                 // Not used by the library, e.g. the position of the address in a batch
+    ElfParser_Error         error;              // ELFPARSER_NOERROR if the address is inside a function
+    const char*             name;               // Name of the function, NULL if not found
+    uint64_t                function_address;   // Start of the function
+    uint64_t                offset;             // address - function_address
+} ElfParser_AddressLookup;
+
+// Number of threads which can read values published through one RCU domain
+#define ELFPARSER_RCU_MAX_READERS 64
+
+// Epoch a reader started reading in, on a cache line of its own so readers don't slow each other down
+typedef struct {
+    uint64_t                epoch;
+    uint8_t                 padding[56];
+} ElfParser_RcuReader;
+
+// Readers and epoch shared by any number of values published with elfparser_rcu_publish. Treat the members as private
+typedef struct {
+    uint64_t                epoch;
+    uint8_t                 padding[56];
+    ElfParser_RcuReader     readers[ELFPARSER_RCU_MAX_READERS];
+} ElfParser_RcuDomain;
+
+// Location of the symbol versioning sections belonging to a dynamic symbol table, see elfparser_get_version_table
+typedef struct {
+    uint64_t                versym_offset;                  // Byte offset of .gnu.version data
+    uint64_t                versym_num;                     // Number of .gnu.version entries which lie within the file
+    uint64_t                verdef_offset;                  // Byte offset of .gnu.version_d data, 0 if none
+    uint64_t                verdef_num;                     // Number of version definitions
+    uint64_t                verdef_string_table_offset;
+    uint64_t                verneed_offset;                 // Byte offset of .gnu.version_r data, 0 if none
+    uint64_t                verneed_num;                    // Number of files which versions are needed from
+    uint64_t                verneed_string_table_offset;
+} ElfParser_VersionTable;
+
+typedef struct {
+    const char*             name;       // Name of the version, empty string if the symbol is unversioned
+    const char*             file;       // File the version is needed from, NULL if the version is defined in this file
+    uint16_t                index;      // Version index from .gnu.version, without the hidden bit
+    bool                    is_hidden;  // True if this is not the default version of the symbol (name@version)
+} ElfParser_SymbolVersion;
+
+// Hash table used by the dynamic linker to look up symbols in .dynsym, see elfparser_get_symbol_hash_table
+typedef struct {
+    ElfParser_SH_Type       type;           // ELFPARSER_SHT_GNU_HASH or ELFPARSER_SHT_HASH
+    uint64_t                offset;         // Byte offset of hash table data
+    uint64_t                size;           // Size in bytes of hash table data which lies within the file
+    uint32_t                num_buckets;
+    uint32_t                symbol_offset;  // Index of the first symbol in the hash table (GNU only)
+    uint32_t                bloom_size;     // Number of words in the bloom filter (GNU only)
+    uint32_t                bloom_shift;    // (GNU only)
+    ElfParser_SymbolTable   symbols;        // Symbol table referenced by sh_link
+} ElfParser_SymbolHashTable;
+
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    const void*             next;
+    uint64_t                entry_size;
+    uint64_t                index;
+    uint64_t                num;
+} ElfParser_ProgramHeaderCursor;
+
+
+// Decoded copy of the section header table, stored as one array per member so that queries only touch the members they
+// need. All arrays are indexed by section index and point into the buffer passed to elfparser_build_section_cache
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    uint64_t                num;            // Number of sections in the cache
+    
+    uint32_t*               sh_type;
+    uint64_t*               sh_flags;
+    uint64_t*               sh_addr;
+    uint64_t*               sh_offset;
+    uint64_t*               sh_size;
+    uint32_t*               name_hash;      // GNU hash of name
+    uint64_t*               name_offset;    // File offset of name, or UINT64_MAX if the section has no valid name
+    
+    // Members below this are lookup structures used by the query functions, treat them as private
+    uint32_t*               name_buckets;   // Open addressing hash table of section index + 1, 0 for empty slots
+    uint64_t                name_bucket_mask;
+    uint32_t*               addr_order;     // Indexes of allocated sections, sorted by sh_addr
+    uint64_t*               addr_max_end;   // Highest end address of any section up to this point in addr_order
+    uint64_t                addr_num;
+    uint64_t*               type_bitmaps;   // One bitmap of sections per standard section type
+    uint64_t                bitmap_words;   // Number of words in each bitmap
+} ElfParser_SectionCache;
+
+
+// Virtual address range of a PT_LOAD segment and where its data lies in the file
+typedef struct {
+    uint64_t            p_vaddr;
+    uint64_t            p_memsz;
+    uint64_t            p_offset;
+    uint64_t            p_filesz;
+    uint64_t            index;      // Index of the program header
+} ElfParser_SegmentMapping;
+
+// PT_LOAD segments sorted by virtual address, built by elfparser_build_segment_map
+typedef struct {
+    const void*                 elf_start;
+    const ElfParser_Header*     header;
+    ElfParser_SegmentMapping*   mappings;
+    uint64_t                    num;
+} ElfParser_SegmentMap;
+
+// Result of translating a virtual address range. The range starts with file_size bytes read from the file at
+// file_offset, followed by zero_size bytes of zero-filled memory (e.g. .bss), and either part may be 0 bytes long
+typedef struct {
+    uint64_t            file_offset;
+    uint64_t            file_size;
+    uint64_t            zero_size;
+    uint64_t            segment_index;  // Index of the program header containing the range
+} ElfParser_VaddrTranslation;
+
+
+typedef struct {
+    uint32_t                n_namesz;
+    uint32_t                n_descsz;
+    ElfParser_N_Type        n_type;
+    
+    const char*             name;           // Owner of the note, e.g. "CORE" or "GNU". Will always point to valid string
+    const void*             desc;           // Pointer to n_descsz bytes of note data, in the byte order of the file
+    uint64_t                offset;         // File offset of the note
+    uint64_t                segment_index;  // Index of the PT_NOTE program header containing the note
+} ElfParser_Note;
+
+// Steps through the notes of every PT_NOTE segment. Treat the members as private
+typedef struct {
+    const void*                     elf_start;
+    const ElfParser_Header*         header;
+    ElfParser_ProgramHeaderCursor   segments;
+    uint64_t                        segment_index;
+    uint64_t                        next;       // File offset of next note in the current segment
+    uint64_t                        end;        // File offset of end of the current segment
+    uint64_t                        alignment;
+} ElfParser_NoteCursor;
+
+// Decoded NT_PRSTATUS note, one per thread in a core file
+typedef struct {
+    int32_t                 pr_signo;       // Signal which caused the dump
+    int32_t                 pr_code;
+    int32_t                 pr_errno;
+    int16_t                 pr_cursig;      // Current signal of the thread
+    uint32_t                pr_pid;         // Thread ID
+    uint32_t                pr_ppid;
+    uint32_t                pr_pgrp;
+    uint32_t                pr_sid;
+    
+    const void*             registers;      // Machine specific general purpose registers (elf_gregset_t), in the byte order of the file
+    uint64_t                register_num;
+    uint64_t                register_size;  // 4 or 8 bytes
+} ElfParser_PrStatus;
+
+// One entry of an NT_FILE note - a range of memory mapped from a file
+typedef struct {
+    uint64_t                start;          // Start address of the mapping
+    uint64_t                end;            // End address of the mapping (exclusive)
+    uint64_t                file_offset;    // Offset in bytes of the mapping in the mapped file
+    const char*             name;           // Path of the mapped file. Will always point to valid string
+} ElfParser_FileMapping;
+
+// Steps through the entries of an NT_FILE note. Treat the members as private
+typedef struct {
+    const ElfParser_Header* header;
+    const void*             next_entry;
+    const char*             next_name;
+    const char*             end;
+    uint64_t                page_size;
+    uint64_t                index;
+    uint64_t                num;
+} ElfParser_FileMappingCursor;
+
+// One line of /proc/<pid>/maps - a range of memory of a running process and what it maps
+typedef struct {
+    uint64_t                start;          // Start address of the mapping
+    uint64_t                end;            // End address of the mapping (exclusive)
+    uint64_t                file_offset;    // Offset in bytes of the mapping in the mapped file
+    ElfParser_P_Flags       flags;          // ELFPARSER_PF_R, ELFPARSER_PF_W and ELFPARSER_PF_X bits
+    bool                    is_shared;
+    uint32_t                dev_major;      // Device of the mapped file
+    uint32_t                dev_minor;
+    uint64_t                inode;          // Inode of the mapped file, 0 if the mapping isn't backed by a file
+    const char*             name;           // Path of the mapped file or e.g. "[heap]". Not null terminated!
+    uint64_t                name_length;    // Length of name, 0 for anonymous mappings
+} ElfParser_ProcessMapping;
+
+// Steps through the lines of the text of /proc/<pid>/maps. Treat the members as private
+typedef struct {
+    const char*             next;
+    const char*             end;
+} ElfParser_ProcessMappingCursor;
+
+typedef struct {
+    uint64_t                d_tag;      // One of ElfParser_D_Tag, but OS and processor specific tags may have other values
+    uint64_t                d_val;
+    uint64_t                index;
+} ElfParser_DynamicEntry;
+
+// Steps through the dynamic section up to DT_NULL. Treat the members as private
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    const void*             next;
+    uint64_t                entry_size;
+    uint64_t                index;
+    uint64_t                num;
+    uint64_t                string_table_offset;    // Byte offset of the string table referenced by DT_STRTAB
+    uint64_t                string_table_size;      // 0 if there is no string table
+} ElfParser_DynamicCursor;
+
+// Entries of the dynamic section used to find needed libraries, see elfparser_get_dynamic_info
+typedef struct {
+    const char*             soname;         // DT_SONAME, empty string if none. Strings will always point to valid strings
+    const char*             rpath;          // DT_RPATH, colon separated list of directories, empty string if none
+    const char*             runpath;        // DT_RUNPATH, same as rpath
+    uint64_t                num_needed;     // Number of DT_NEEDED entries
+    uint64_t                flags;          // DT_FLAGS, 0 if none
+    uint64_t                flags_1;        // DT_FLAGS_1, 0 if none
+} ElfParser_DynamicInfo;
+
+// Steps through a colon separated list of directories, e.g. from DT_RUNPATH. Treat the members as private
+typedef struct {
+    const char*             next;           // NULL once the list is finished
+    const char*             origin;
+    const char*             lib;
+    const char*             platform;
+} ElfParser_SearchPathCursor;
+
+// Static library (.a file), see elfparser_get_archive
+typedef struct {
+    const void*             archive_start;
+    uint64_t                archive_size;
+    bool                    is_thin;                // Members of thin archives are separate files, named relative to the archive
+    uint64_t                first_member_offset;    // Byte offset of the first member which isn't a special member
+    uint64_t                long_names_offset;      // Byte offset of the "//" member data, 0 if none
+    uint64_t                long_names_size;
+    uint64_t                symbol_index_offset;    // Byte offset of the "/" or "/SYM64/" member data, 0 if none
+    uint64_t                symbol_index_size;
+    bool                    is_symbol_index_64;     // True for "/SYM64/", which has 8 byte offsets
+} ElfParser_Archive;
+
+typedef struct {
+    const char*             name;           // Not null-terminated, see name_len
+    uint64_t                name_len;
+    const void*             data;           // Member contents, can be passed to elfparser_get_header. NULL for thin archives
+    uint64_t                size;           // Size of the member contents (of the separate file for thin archives)
+    uint64_t                mtime;
+    uint32_t                uid;
+    uint32_t                gid;
+    uint32_t                mode;
+    uint64_t                offset;         // Byte offset of the member header in the archive
+} ElfParser_ArchiveMember;
+
+// Steps through the members of an archive. Treat the members as private
+typedef struct {
+    const ElfParser_Archive*    archive;
+    uint64_t                    next;       // Byte offset of the next member header
+} ElfParser_ArchiveCursor;
+
+typedef struct {
+    const char*             name;           // Will always point to valid string
+    uint64_t                member_offset;  // Byte offset of the header of the member defining the symbol
+    uint64_t                index;
+} ElfParser_ArchiveSymbol;
+
+// Steps through the symbol index of an archive. Treat the members as private
+typedef struct {
+    const ElfParser_Archive*    archive;
+    uint64_t                    index;
+    uint64_t                    num;
+    uint64_t                    next_name;  // Byte offset of the next name within the symbol index
+} ElfParser_ArchiveSymbolCursor;
+
+// Common information entry of .eh_frame, holding what many FDEs have in common
+typedef struct {
+    uint64_t                offset;                     // File offset of the CIE
+    uint8_t                 version;
+    const char*             augmentation;               // e.g. "zR". Will always point to valid string
+    uint64_t                code_alignment;
+    int64_t                 data_alignment;
+    uint64_t                return_address_register;
+    uint8_t                 fde_encoding;               // ElfParser_DW_EH_PE encoding of addresses in FDEs
+    uint8_t                 lsda_encoding;              // ELFPARSER_DW_EH_PE_OMIT if FDEs have no LSDA
+    uint64_t                personality;                // Address of the personality routine, 0 if none
+    bool                    is_signal_frame;
+    uint64_t                instructions_offset;        // File offset of the initial call frame instructions
+    uint64_t                instructions_size;
+} ElfParser_Cie;
+
+// Frame description entry of .eh_frame, describing how to unwind the code from pc_begin to pc_begin + pc_range
+typedef struct {
+    uint64_t                offset;                     // File offset of the FDE
+    uint64_t                pc_begin;
+    uint64_t                pc_range;
+    uint64_t                lsda;                       // Address of the language specific data area, 0 if none
+    uint64_t                instructions_offset;        // File offset of the call frame instructions
+    uint64_t                instructions_size;
+    ElfParser_Cie           cie;
+} ElfParser_Fde;
+
+// Address range of an FDE, see elfparser_find_fde_range
+typedef struct {
+    uint64_t                offset;                     // File offset of the FDE, to decode it with elfparser_get_fde
+    uint64_t                pc_begin;
+    uint64_t                pc_range;
+} ElfParser_FdeRange;
+
+// Table of FDEs sorted by address, either the one in .eh_frame_hdr or one built by elfparser_build_fde_table. Treat
+// the members as private
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    uint64_t                eh_frame_offset;            // File offset of .eh_frame, or .debug_frame if is_debug_frame
+    uint64_t                eh_frame_vaddr;
+    uint64_t                eh_frame_size;
+    const void*             entries;
+    uint64_t                num;
+    uint64_t                table_vaddr;                // Address entries of .eh_frame_hdr are relative to
+    uint8_t                 table_encoding;             // ElfParser_DW_EH_PE encoding of .eh_frame_hdr entries
+    ElfParser_Cie           cie;                        // CIE most FDEs share, with an offset of UINT64_MAX if not known
+    bool                    is_built;                   // True if entries were built by elfparser_build_fde_table
+    bool                    is_debug_frame;
+} ElfParser_FdeTable;
+
+// Registers numbered 0 to ELFPARSER_UNWIND_MAX_REGISTERS - 1 are tracked by the unwinder. This covers the general
+// purpose registers of x86-64, i386 and AArch64 - rules for other registers, e.g. vector registers, are ignored
+#define ELFPARSER_UNWIND_MAX_REGISTERS 33
+
+// Rule to recover one register of the calling frame, or the CFA (canonical frame address), kept small so that many
+// rows can be cached
+typedef struct {
+    int32_t                 offset;     // ElfParser_UnwindRuleType offset, or of expressions, the offset of the expression
+                                        // from the start of .eh_frame or .debug_frame
+    uint16_t                reg;        // Register of ELFPARSER_UNWIND_RULE_REGISTER
+    uint16_t                size;       // Size of expressions
+    uint8_t                 type;       // ElfParser_UnwindRuleType
+} ElfParser_UnwindRule;
+
+// Rules to recover the calling frame, valid for addresses from pc_begin to pc_end
+typedef struct {
+    uint64_t                pc_begin;
+    uint64_t                pc_end;
+    ElfParser_UnwindRule    cfa;                    // ELFPARSER_UNWIND_RULE_REGISTER, or _EXPRESSION
+    ElfParser_UnwindRule    registers[ELFPARSER_UNWIND_MAX_REGISTERS];
+    uint64_t                changed_registers;      // Bit mask of registers whose rule isn't ELFPARSER_UNWIND_RULE_SAME_VALUE
+    uint16_t                return_address_register;
+    bool                    is_signal_frame;
+    bool                    is_return_address_signed;   // AArch64 pointer authentication
+} ElfParser_UnwindRow;
+
+// Direct-mapped cache of unwind rows, see elfparser_unwind_cache_init. Treat the members as private
+typedef struct {
+    ElfParser_UnwindRow*    rows;
+    uint64_t                num_rows;       // Power of two
+} ElfParser_UnwindCache;
+
+// Reads `size` bytes at `address` of the unwound process into value_out - returns false if it can't be read
+typedef bool (*ElfParser_ReadMemoryCallback)(uint64_t address, uint64_t size, uint64_t* value_out, void* user_data);
+
+// Address to source line index over .debug_line, see elfparser_build_line_index. Treat the members as private
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    const uint8_t*          debug_info;
+    uint64_t                debug_info_size;
+    const uint8_t*          debug_abbrev;
+    uint64_t                debug_abbrev_size;
+    const uint8_t*          debug_line;
+    uint64_t                debug_line_size;
+    const uint8_t*          debug_str;
+    uint64_t                debug_str_size;
+    const uint8_t*          debug_line_str;
+    uint64_t                debug_line_str_size;
+    void*                   units;          // One per compilation unit, in order of .debug_info
+    uint64_t                num_units;
+    void*                   ranges;         // Address ranges of the units, sorted by address
+    uint64_t                num_ranges;
+    bool                    has_unit_ranges;    // Units missing from .debug_aranges have been added to ranges
+    uint8_t*                cache_start;    // Line tables of the units looked up so far
+    uint8_t*                cache_next;
+    uint8_t*                cache_end;
+} ElfParser_LineIndex;
+
+// Source location of an address, see elfparser_line_index_find
+typedef struct {
+    uint64_t                address;        // Start address of the line table row covering the address
+    uint64_t                line;           // 0 if the code has no source line, e.g. compiler generated code
+    uint64_t                column;         // 0 if unknown
+    const char*             file_name;      // May be absolute. Will always point to null-terminated string
+    const char*             directory;      // Directory of file_name, may be relative to comp_dir
+    const char*             comp_dir;       // Directory the unit was compiled in, empty string if unknown
+    uint64_t                unit_offset;    // Offset of the compilation unit in .debug_info
+} ElfParser_LineInfo;
+
+// Contents of a section as stored in the file, see elfparser_get_section_contents
+typedef struct {
+    const uint8_t*          data;           // NULL for SHT_NOBITS sections. Compressed data if is_compressed
+    uint64_t                data_size;      // Size of data in the file
+    uint64_t                size;           // Size of the contents once decompressed
+    uint64_t                alignment;      // Alignment of the contents once decompressed
+    ElfParser_CompressionType compression_type; // Only valid if is_compressed
+    bool                    is_compressed;
+} ElfParser_SectionContents;
+
+// Smallest buffer accepted by elfparser_decompress_section_stream - decompressing needs the last 32 KiB of output
+#define ELFPARSER_DECOMPRESS_MIN_BUFFER_SIZE 65536
+
+// Called with each piece of the decompressed contents of a section in order. `offset` is the position of `data` in the
+// contents. Return false to stop decompressing
+typedef bool (*ElfParser_DecompressCallback)(const uint8_t* data, uint64_t size, uint64_t offset, void* user_data);
+
+// Entry of a decompression table, see elfparser_decompress_sections
+typedef struct {
+    uint64_t                index;          // Index of the section to decompress - filled in by the caller
+    void*                   dest;           // Filled in by the caller
+    uint64_t                dest_size;      // Filled in by the caller
+    ElfParser_Error         error;          // ELFPARSER_NOERROR if dest holds the contents of the section
+} ElfParser_DecompressJob;
+
+typedef struct {
+    ElfParser_AT_Type       a_type;
+    uint64_t                a_val;
+} ElfParser_AuxvEntry;
+
+// Streaming hash state, used by the elfparser_hash_* functions. Treat the members as private
+typedef struct {
+    ElfParser_HashType      type;
+    uint64_t                total_size;
+    uint64_t                state[8];       // XXH64 uses the first 4 accumulators, SHA-256 uses all 8 as 32-bit words
+    uint8_t                 buffer[64];     // Input which doesn't fill a whole block yet
+    uint64_t                buffer_size;
+} ElfParser_HashState;
+
+// Entry of a digest table, see elfparser_hash_sections and elfparser_hash_segments
+typedef struct {
+    uint64_t                index;          // Index of the section or program header to hash - filled in by the caller
+    ElfParser_Error         error;          // ELFPARSER_NOERROR if digest is valid
+    uint64_t                size;           // Number of bytes hashed, including zero-filled bytes
+    uint8_t                 digest[32];     // XXH64 digests use the first 8 bytes (big-endian), SHA-256 uses all 32
+} ElfParser_Digest;
+
+// One difference found by elfparser_diff
+typedef struct {
+    ElfParser_DiffKind      kind;
+    const char*             name;       // Name of the section or symbol
+    uint64_t                old_index;  // Index in the old file, UINT64_MAX if added
+    uint64_t                new_index;  // Index in the new file, UINT64_MAX if removed
+    uint64_t                old_value;  // Meaning depends on kind
+    uint64_t                new_value;
+} ElfParser_DiffEntry;
+
+typedef void (*ElfParser_DiffCallback)(const ElfParser_DiffEntry* entry, void* user_data);
+
+// Symbol exported by a shared object, see elfparser_get_abi
+typedef struct {
+    const char*             name;
+    const char*             version;            // Name of symbol version, empty string if unversioned
+    uint64_t                st_size;
+    ElfParser_ST_Type       st_type;
+    ElfParser_ST_Bind       st_bind;
+    ElfParser_ST_Visibility st_visibility;
+    bool                    is_default_version; // False for hidden versions (name@version rather than name@@version)
+    uint64_t                index;              // Index of the symbol in .dynsym
+} ElfParser_AbiSymbol;
+
+// One change found by elfparser_compare_abi. old_symbol is NULL if added, new_symbol is NULL if removed
+typedef struct {
+    ElfParser_AbiChangeKind     kind;
+    const ElfParser_AbiSymbol*  old_symbol;
+    const ElfParser_AbiSymbol*  new_symbol;
+} ElfParser_AbiChange;
+
+typedef void (*ElfParser_AbiCallback)(const ElfParser_AbiChange* change, void* user_data);
+
+// One problem found by elfparser_verify
+typedef struct {
+    ElfParser_AnomalyKind   kind;
+    uint64_t                offset; // File offset of the header field, section header, symbol or program header at fault
+    uint64_t                index;  // Index of the section, symbol or program header, UINT64_MAX for the ELF header
+    uint64_t                value;  // Offending value, e.g. sh_link for ELFPARSER_ANOMALY_SECTION_BAD_LINK.
+                                    // For overlaps, index of the earlier section (UINT64_MAX for a header table)
+} ElfParser_Anomaly;
+
+// One section belonging to one segment, see elfparser_map_sections_to_segments
+typedef struct {
+    uint64_t                segment_index;
+    uint64_t                section_index;
+} ElfParser_SectionSegmentPair;
+
+// Range of bytes with a single owner, see elfparser_attribute_size
+typedef struct {
+    uint64_t                start;          // File offset or virtual address, depending on the space
+    uint64_t                end;
+    ElfParser_SizeOwnerKind kind;
+    uint64_t                index;          // Index of the symbol, section or program header. For headers, 0 is the ELF
+                                            // header, 1 the program header table and 2 the section header table.
+                                            // UINT64_MAX if unmapped
+    uint64_t                section_index;  // Section containing the range, UINT64_MAX if none
+    uint64_t                segment_index;  // PT_LOAD segment containing the range, UINT64_MAX if none
+} ElfParser_SizeRange;
+
+// Byte range of a file which the loader needs read into its image
+typedef struct {
+    uint64_t                offset;
+    uint64_t                size;
+} ElfParser_ReadRequest;
+
+#define ELFPARSER_LOADER_MAX_REQUESTS 8
+
+// Reads the parts of a file needed to parse it in a few batches of reads, see elfparser_loader_init. Only `header`,
+// `requests` and `num_requests` are public, treat the other members as private
+typedef struct {
+    void*                   image;
+    uint64_t                file_size;
+    uint32_t                flags;          // ElfParser_LoadFlags
+    uint32_t                stage;
+    
+    ElfParser_Header        header;         // Valid once loading is finished
+    ElfParser_ReadRequest   requests[ELFPARSER_LOADER_MAX_REQUESTS];
+    uint64_t                num_requests;   // Number of ranges to read before the next call to elfparser_loader_advance
+} ElfParser_Loader;
+
+typedef void (*ElfParser_SizeCallback)(const ElfParser_SizeRange* range, void* user_data);
\ No newline at end of file
@@ -61,7 +61,7 @@ static inline bool elfparser_is_valid_e_version(ElfParser_E_Version value) {
 
 static inline bool elfparser_is_valid_sh_type(ElfParser_SH_Type value) {
     return  (ELFPARSER_SHT_NULL         <= value && value <= ELFPARSER_SHT_DYNSYM) ||
-            (ELFPARSER_SHT_INIT_ARRAY   <= value && value <= ELFPARSER_SHT_SYMTAB_SHNDX) ||
+            (ELFPARSER_SHT_INIT_ARRAY   <= value && value <= ELFPARSER_SHT_RELR) ||
             (ELFPARSER_SHT_LOOS         <= value && value <= ELFPARSER_SHT_HIUSER);
 }
 
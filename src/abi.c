@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+
+static bool elfparser_is_abi_exported(const ElfParser_Symbol* symbol) {
+    if (symbol->st_shndx == ELFPARSER_SHN_UNDEF) return false;
+    
+    if (symbol->st_bind != ELFPARSER_STB_GLOBAL && symbol->st_bind != ELFPARSER_STB_WEAK &&
+        symbol->st_bind != ELFPARSER_STB_GNU_UNIQUE) return false;
+    
+    return symbol->st_visibility == ELFPARSER_STV_DEFAULT || symbol->st_visibility == ELFPARSER_STV_PROTECTED;
+}
+
+
+static int elfparser_compare_abi_symbol_key(const ElfParser_AbiSymbol* a, const ElfParser_AbiSymbol* b) {
+    int cmp = strcmp(a->name, b->name);
+    return cmp != 0 ? cmp : strcmp(a->version, b->version);
+}
+
+
+static bool elfparser_is_abi_symbol_less(const void* a, const void* b, const void* context) {
+    const ElfParser_AbiSymbol* symbol_a = a;
+    const ElfParser_AbiSymbol* symbol_b = b;
+    
+    int cmp = elfparser_compare_abi_symbol_key(symbol_a, symbol_b);
+    return cmp < 0 || (cmp == 0 && symbol_a->index < symbol_b->index);
+}
+
+
+// Only the size of data is part of the ABI - code can change size freely
+static bool elfparser_is_abi_data(ElfParser_ST_Type type) {
+    return type == ELFPARSER_STT_OBJECT || type == ELFPARSER_STT_COMMON || type == ELFPARSER_STT_TLS;
+}
+
+
+ElfParser_Error elfparser_get_abi(const void* elf_start, const ElfParser_Header* header,
+                                  ElfParser_AbiSymbol* symbols, uint64_t max_symbols, uint64_t* num_out) {
+    *num_out = 0;
+    
+    ElfParser_SymbolTable table;
+    ElfParser_Error err = elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_DYNSYM, &table);
+    if (err != ELFPARSER_NOERROR) return err;
+    
+    // Files without symbol versioning are fine - every symbol is simply unversioned
+    ElfParser_VersionTable versions;
+    elfparser_get_version_table(elf_start, header, &table, &versions);
+    
+    ElfParser_SymbolCursor cursor;
+    elfparser_symbol_table_cursor_init(elf_start, header, &table, &cursor);
+    
+    uint64_t num = 0;
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        if (!elfparser_is_abi_exported(&symbol)) continue;
+        
+        // Keep counting once the table is full so the caller knows how much space is needed
+        if (num < max_symbols) {
+            ElfParser_AbiSymbol* abi_symbol = &symbols[num];
+            ElfParser_SymbolVersion version;
+            if (elfparser_get_symbol_version(elf_start, header, &versions, symbol.index, &version) != ELFPARSER_NOERROR) {
+                version.name        = "";
+                version.is_hidden   = false;
+            }
+            
+            abi_symbol->name                = elfparser_symbol_cursor_get_name(&cursor, &symbol);
+            abi_symbol->version             = version.name;
+            abi_symbol->is_default_version  = !version.is_hidden;
+            abi_symbol->st_size             = symbol.st_size;
+            abi_symbol->st_type             = symbol.st_type;
+            abi_symbol->st_bind             = symbol.st_bind;
+            abi_symbol->st_visibility       = symbol.st_visibility;
+            abi_symbol->index               = symbol.index;
+        }
+        num++;
+    }
+    
+    *num_out = num;
+    if (num > max_symbols) return ELFPARSER_INVALID;
+    
+    elfparser_sort(symbols, num, sizeof(ElfParser_AbiSymbol), elfparser_is_abi_symbol_less, NULL);
+    return ELFPARSER_NOERROR;
+}
+
+
+uint64_t elfparser_compare_abi(const ElfParser_AbiSymbol* old_symbols, uint64_t old_num,
+                               const ElfParser_AbiSymbol* new_symbols, uint64_t new_num,
+                               ElfParser_AbiCallback callback, void* user_data) {
+    uint64_t num_incompatible = 0;
+    uint64_t i = 0;
+    uint64_t j = 0;
+    
+    // Both tables are sorted by name and version, so matching symbols are found in a single pass
+    while (i < old_num || j < new_num) {
+        int cmp;
+        if (i >= old_num)       cmp = 1;
+        else if (j >= new_num)  cmp = -1;
+        else                    cmp = elfparser_compare_abi_symbol_key(&old_symbols[i], &new_symbols[j]);
+        
+        ElfParser_AbiChange change = {
+            .old_symbol = cmp <= 0 ? &old_symbols[i] : NULL,
+            .new_symbol = cmp >= 0 ? &new_symbols[j] : NULL
+        };
+        
+        if (cmp < 0) {
+            change.kind = ELFPARSER_ABI_REMOVED;
+            num_incompatible++;
+            i++;
+        } else if (cmp > 0) {
+            // Adding symbols doesn't break anything linked against the old file
+            change.kind = ELFPARSER_ABI_ADDED;
+            j++;
+        } else {
+            i++;
+            j++;
+            
+            if (change.old_symbol->st_type != change.new_symbol->st_type) {
+                change.kind = ELFPARSER_ABI_TYPE_CHANGED;
+            } else if (change.old_symbol->st_size != change.new_symbol->st_size &&
+                       elfparser_is_abi_data(change.new_symbol->st_type)) {
+                change.kind = ELFPARSER_ABI_SIZE_CHANGED;
+            } else {
+                continue;
+            }
+            num_incompatible++;
+        }
+        
+        if (callback != NULL) callback(&change, user_data);
+    }
+    
+    return num_incompatible;
+}
\ No newline at end of file
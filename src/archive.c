@@ -0,0 +1,269 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+#define AR_HEADER_SIZE  sizeof(Ar_Hdr)
+
+
+// Parses a space padded decimal (base 10) or octal (base 8) field. An empty field is 0
+static bool elfparser_parse_archive_field(const char* field, uint64_t field_size, uint64_t base, uint64_t* value_out) {
+    uint64_t value = 0;
+    uint64_t i = 0;
+    
+    while (i < field_size && field[i] == ' ') i++;
+    for (; i < field_size && field[i] >= '0' && field[i] < (char)('0' + base); i++) {
+        if (value > (UINT64_MAX - 9) / base) return false;
+        value = value * base + (field[i] - '0');
+    }
+    while (i < field_size && field[i] == ' ') i++;
+    
+    *value_out = value;
+    return i == field_size;
+}
+
+
+// Archive symbol indexes are big-endian whatever the byte order of the members
+static inline uint64_t elfparser_read_archive_offset(const uint8_t* ptr, uint64_t size) {
+    uint64_t value = 0;
+    for (uint64_t i = 0; i < size; i++) value = (value << 8) | ptr[i];
+    return value;
+}
+
+
+static bool elfparser_is_archive_name(const ElfParser_ArchiveMember* member, const char* name) {
+    uint64_t name_len = strlen(name);
+    return member->name_len == name_len && memcmp(member->name, name, name_len) == 0;
+}
+
+
+static bool elfparser_is_special_archive_member(const ElfParser_ArchiveMember* member) {
+    return elfparser_is_archive_name(member, "/") || elfparser_is_archive_name(member, "//") ||
+           elfparser_is_archive_name(member, "/SYM64/") || elfparser_is_archive_name(member, "__.SYMDEF") ||
+           elfparser_is_archive_name(member, "__.SYMDEF SORTED");
+}
+
+
+// Reads the member header at `offset` and returns the offset of the member after it in next_offset_out
+static ElfParser_Error elfparser_read_archive_member(const ElfParser_Archive* archive, uint64_t offset,
+                                                     ElfParser_ArchiveMember* member_out, uint64_t* next_offset_out) {
+    if (offset > archive->archive_size || archive->archive_size - offset < AR_HEADER_SIZE) return ELFPARSER_INVALID;
+    
+    const Ar_Hdr* header = archive->archive_start + offset;
+    if (memcmp(header->ar_fmag, AR_FMAG, sizeof(header->ar_fmag)) != 0) return ELFPARSER_INVALID;
+    
+    uint64_t size, mtime, uid, gid, mode;
+    if (!elfparser_parse_archive_field(header->ar_size, sizeof(header->ar_size), 10, &size) ||
+        !elfparser_parse_archive_field(header->ar_date, sizeof(header->ar_date), 10, &mtime) ||
+        !elfparser_parse_archive_field(header->ar_uid, sizeof(header->ar_uid), 10, &uid) ||
+        !elfparser_parse_archive_field(header->ar_gid, sizeof(header->ar_gid), 10, &gid) ||
+        !elfparser_parse_archive_field(header->ar_mode, sizeof(header->ar_mode), 8, &mode)) {
+        return ELFPARSER_INVALID;
+    }
+    
+    uint64_t data_offset = offset + AR_HEADER_SIZE;
+    uint64_t data_left = archive->archive_size - data_offset;
+    const char* name = header->ar_name;
+    uint64_t name_len = sizeof(header->ar_name);
+    uint64_t long_name_offset;
+    uint64_t bsd_name_len = 0;
+    
+    if (name[0] == '/' && name[1] >= '0' && name[1] <= '9' &&
+        elfparser_parse_archive_field(name + 1, sizeof(header->ar_name) - 1, 10, &long_name_offset)) {
+        // GNU long name - offset into the "//" member, terminated by "/\n"
+        if (long_name_offset >= archive->long_names_size) return ELFPARSER_INVALID;
+        
+        name = archive->archive_start + archive->long_names_offset + long_name_offset;
+        uint64_t max_len = archive->long_names_size - long_name_offset;
+        for (name_len = 0; name_len < max_len && name[name_len] != '\n'; name_len++);
+        if (name_len > 0 && name[name_len - 1] == '/') name_len--;
+    } else if (memcmp(name, "#1/", 3) == 0 &&
+               elfparser_parse_archive_field(name + 3, sizeof(header->ar_name) - 3, 10, &bsd_name_len)) {
+        // BSD long name - stored at the start of the member data, and counted in its size
+        if (bsd_name_len > size || bsd_name_len > data_left) return ELFPARSER_INVALID;
+        
+        name = archive->archive_start + data_offset;
+        for (name_len = 0; name_len < bsd_name_len && name[name_len] != '\0'; name_len++);
+    } else {
+        // Short name, padded with spaces. GNU names end with '/', except for the special members which start with one
+        while (name_len > 0 && name[name_len - 1] == ' ') name_len--;
+        if (name_len > 1 && name[name_len - 1] == '/' && name[0] != '/') name_len--;
+    }
+    
+    member_out->name        = name;
+    member_out->name_len    = name_len;
+    member_out->size        = size - bsd_name_len;
+    member_out->mtime       = mtime;
+    member_out->uid         = uid;
+    member_out->gid         = gid;
+    member_out->mode        = mode;
+    member_out->offset      = offset;
+    
+    // Thin archives hold only the headers of normal members, but the special members are still stored in the archive
+    uint64_t stored_size = size;
+    if (archive->is_thin && !elfparser_is_special_archive_member(member_out)) {
+        member_out->data = NULL;
+        stored_size = 0;
+    } else {
+        if (size > data_left) return ELFPARSER_INVALID;
+        member_out->data = archive->archive_start + data_offset + bsd_name_len;
+    }
+    
+    // Members start at even offsets
+    *next_offset_out = data_offset + stored_size + ((data_offset + stored_size) & 1);
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_archive(const void* archive_start, uint64_t archive_size, ElfParser_Archive* archive_out) {
+    if (archive_size < AR_MAGIC_SIZE) return ELFPARSER_INVALID;
+    
+    memset(archive_out, 0, sizeof(ElfParser_Archive));
+    archive_out->archive_start  = archive_start;
+    archive_out->archive_size   = archive_size;
+    
+    if (memcmp(archive_start, AR_THIN_MAGIC, AR_MAGIC_SIZE) == 0) {
+        archive_out->is_thin = true;
+    } else if (memcmp(archive_start, AR_MAGIC, AR_MAGIC_SIZE) != 0) {
+        return ELFPARSER_INVALID;
+    }
+    
+    // The special members come before all others
+    uint64_t offset = AR_MAGIC_SIZE;
+    while (offset < archive_size) {
+        ElfParser_ArchiveMember member;
+        uint64_t next_offset;
+        if (elfparser_read_archive_member(archive_out, offset, &member, &next_offset) != ELFPARSER_NOERROR) break;
+        if (!elfparser_is_special_archive_member(&member)) break;
+        
+        uint64_t data_offset = member.data - archive_start;
+        if (elfparser_is_archive_name(&member, "//")) {
+            archive_out->long_names_offset  = data_offset;
+            archive_out->long_names_size    = member.size;
+        } else if (elfparser_is_archive_name(&member, "/") || elfparser_is_archive_name(&member, "/SYM64/")) {
+            archive_out->symbol_index_offset    = data_offset;
+            archive_out->symbol_index_size      = member.size;
+            archive_out->is_symbol_index_64     = elfparser_is_archive_name(&member, "/SYM64/");
+        }
+        offset = next_offset;
+    }
+    archive_out->first_member_offset = offset;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_archive_member(const ElfParser_Archive* archive, uint64_t offset,
+                                             ElfParser_ArchiveMember* member_out) {
+    uint64_t next_offset;
+    return elfparser_read_archive_member(archive, offset, member_out, &next_offset);
+}
+
+
+void elfparser_archive_cursor_init(const ElfParser_Archive* archive, ElfParser_ArchiveCursor* cursor_out) {
+    cursor_out->archive = archive;
+    cursor_out->next    = archive->first_member_offset;
+}
+
+
+ElfParser_Error elfparser_archive_cursor_next(ElfParser_ArchiveCursor* cursor, ElfParser_ArchiveMember* member_out) {
+    const ElfParser_Archive* archive = cursor->archive;
+    
+    while (cursor->next < archive->archive_size) {
+        uint64_t next_offset;
+        if (elfparser_read_archive_member(archive, cursor->next, member_out, &next_offset) != ELFPARSER_NOERROR) {
+            // Without a valid size there's no way to find the next member
+            cursor->next = archive->archive_size;
+            return ELFPARSER_INVALID;
+        }
+        cursor->next = next_offset;
+        
+        // Special members may appear later in archives written by some tools
+        if (!elfparser_is_special_archive_member(member_out)) return ELFPARSER_NOERROR;
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+ElfParser_Error elfparser_archive_symbol_cursor_init(const ElfParser_Archive* archive,
+                                                     ElfParser_ArchiveSymbolCursor* cursor_out) {
+    uint64_t word_size = archive->is_symbol_index_64 ? 8 : 4;
+    
+    cursor_out->archive     = archive;
+    cursor_out->index       = 0;
+    cursor_out->num         = 0;
+    cursor_out->next_name   = 0;
+    
+    if (archive->symbol_index_offset == 0) return ELFPARSER_NOT_FOUND;
+    if (archive->symbol_index_size < word_size) return ELFPARSER_INVALID;
+    
+    // Symbol count, then one member offset per symbol, then the null-terminated names
+    uint64_t num = elfparser_read_archive_offset(archive->archive_start + archive->symbol_index_offset, word_size);
+    uint64_t num_fit = (archive->symbol_index_size - word_size) / word_size;
+    
+    cursor_out->num         = num < num_fit ? num : num_fit;
+    cursor_out->next_name   = word_size + cursor_out->num * word_size;
+    
+    return num <= num_fit ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
+
+
+ElfParser_Error elfparser_archive_symbol_cursor_next(ElfParser_ArchiveSymbolCursor* cursor,
+                                                     ElfParser_ArchiveSymbol* symbol_out) {
+    const ElfParser_Archive* archive = cursor->archive;
+    if (cursor->index >= cursor->num || cursor->next_name >= archive->symbol_index_size) return ELFPARSER_NOT_FOUND;
+    
+    const uint8_t* index = archive->archive_start + archive->symbol_index_offset;
+    uint64_t word_size = archive->is_symbol_index_64 ? 8 : 4;
+    
+    const char* name = (const char*)index + cursor->next_name;
+    const char* name_end = memchr(name, '\0', archive->symbol_index_size - cursor->next_name);
+    if (name_end == NULL) return ELFPARSER_NOT_FOUND;
+    
+    symbol_out->name            = name;
+    symbol_out->member_offset   = elfparser_read_archive_offset(index + word_size * (cursor->index + 1), word_size);
+    symbol_out->index           = cursor->index;
+    
+    cursor->next_name += name_end - name + 1;
+    cursor->index++;
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_archive_lookup_symbol(const ElfParser_Archive* archive, const char* name,
+                                                ElfParser_ArchiveMember* member_out) {
+    if (name == NULL) return ELFPARSER_INVALID;
+    
+    ElfParser_ArchiveSymbolCursor cursor;
+    if (elfparser_archive_symbol_cursor_init(archive, &cursor) == ELFPARSER_NOT_FOUND) return ELFPARSER_NOT_FOUND;
+    
+    // Names aren't sorted, but comparing strings is much cheaper than parsing members. The first definition wins, like
+    // when linking
+    ElfParser_ArchiveSymbol symbol;
+    while (elfparser_archive_symbol_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        if (strcmp(symbol.name, name) == 0) return elfparser_get_archive_member(archive, symbol.member_offset, member_out);
+    }
+    return ELFPARSER_NOT_FOUND;
+}
\ No newline at end of file
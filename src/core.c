@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+static bool elfparser_is_core_note(const ElfParser_Note* note, ElfParser_N_Type type) {
+    return note->n_type == type && strcmp(note->name, "CORE") == 0;
+}
+
+
+ElfParser_Error elfparser_get_prstatus(const ElfParser_Header* header, const ElfParser_Note* note,
+                                       ElfParser_PrStatus* prstatus_out) {
+    if (!elfparser_is_core_note(note, ELFPARSER_NT_PRSTATUS)) return ELFPARSER_INVALID;
+    
+    // Layout of struct elf_prstatus only depends on the word size, except for the size of the register set at the end
+    bool is_64 = header->ei_class == ELFPARSER_ELFCLASS64;
+    uint64_t pid_off        = is_64 ? 32  : 24;
+    uint64_t registers_off  = is_64 ? 112 : 72;
+    uint64_t trailer_size   = is_64 ? 8   : 4;   // pr_fpvalid, plus padding in 64-bit files
+    
+    if (note->n_descsz < registers_off + trailer_size) return ELFPARSER_INVALID;
+    
+    const void* desc = note->desc;
+    prstatus_out->pr_signo      = elfparser_read_32(header, desc + 0);
+    prstatus_out->pr_code       = elfparser_read_32(header, desc + 4);
+    prstatus_out->pr_errno      = elfparser_read_32(header, desc + 8);
+    prstatus_out->pr_cursig     = elfparser_read_16(header, desc + 12);
+    prstatus_out->pr_pid        = elfparser_read_32(header, desc + pid_off);
+    prstatus_out->pr_ppid       = elfparser_read_32(header, desc + pid_off + 4);
+    prstatus_out->pr_pgrp       = elfparser_read_32(header, desc + pid_off + 8);
+    prstatus_out->pr_sid        = elfparser_read_32(header, desc + pid_off + 12);
+    
+    prstatus_out->register_size = elfparser_get_word_size(header);
+    prstatus_out->register_num  = (note->n_descsz - registers_off - trailer_size) / prstatus_out->register_size;
+    prstatus_out->registers     = desc + registers_off;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_prstatus_register(const ElfParser_Header* header, const ElfParser_PrStatus* prstatus,
+                                                uint64_t index, uint64_t* value_out) {
+    if (index >= prstatus->register_num) return ELFPARSER_INVALID;
+    
+    *value_out = elfparser_read_word(header, prstatus->registers + index * prstatus->register_size);
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_prstatus_pc_sp(const ElfParser_Header* header, const ElfParser_PrStatus* prstatus,
+                                             uint64_t* pc_out, uint64_t* sp_out) {
+    // Indexes into the register set (struct user_regs_struct on Linux)
+    uint64_t pc_index;
+    uint64_t sp_index;
+    
+    switch (header->e_machine) {
+        case ELFPARSER_EM_X86_64:   pc_index = 16;  sp_index = 19;  break;  // rip, rsp
+        case ELFPARSER_EM_386:      pc_index = 12;  sp_index = 15;  break;  // eip, esp
+        case ELFPARSER_EM_AARCH64:  pc_index = 32;  sp_index = 31;  break;  // pc, sp
+        case ELFPARSER_EM_ARM:      pc_index = 15;  sp_index = 13;  break;  // r15, r13
+        case ELFPARSER_EM_RISCV:    pc_index = 0;   sp_index = 2;   break;  // pc, x2
+        default:                    return ELFPARSER_NOT_FOUND;
+    }
+    
+    if (elfparser_get_prstatus_register(header, prstatus, pc_index, pc_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
+    if (elfparser_get_prstatus_register(header, prstatus, sp_index, sp_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_file_mapping_cursor_init(const ElfParser_Header* header, const ElfParser_Note* note,
+                                                   ElfParser_FileMappingCursor* cursor_out) {
+    if (!elfparser_is_core_note(note, ELFPARSER_NT_FILE)) return ELFPARSER_INVALID;
+    
+    // Note data is: count, page size, count * (start, end, file offset in pages), count * null-terminated file name
+    uint64_t word_size = elfparser_get_word_size(header);
+    if (note->n_descsz < 2 * word_size) return ELFPARSER_INVALID;
+    
+    uint64_t num = elfparser_read_word(header, note->desc);
+    if (num > (note->n_descsz - 2 * word_size) / (3 * word_size)) return ELFPARSER_INVALID;
+    
+    cursor_out->header      = header;
+    cursor_out->page_size   = elfparser_read_word(header, note->desc + word_size);
+    cursor_out->next_entry  = note->desc + 2 * word_size;
+    cursor_out->next_name   = cursor_out->next_entry + num * 3 * word_size;
+    cursor_out->end         = note->desc + note->n_descsz;
+    cursor_out->index       = 0;
+    cursor_out->num         = num;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_file_mapping_cursor_next(ElfParser_FileMappingCursor* cursor, ElfParser_FileMapping* mapping_out) {
+    if (cursor->index >= cursor->num) return ELFPARSER_NOT_FOUND;
+    
+    uint64_t word_size = elfparser_get_word_size(cursor->header);
+    
+    mapping_out->start          = elfparser_read_word(cursor->header, cursor->next_entry);
+    mapping_out->end            = elfparser_read_word(cursor->header, cursor->next_entry + word_size);
+    mapping_out->file_offset    = elfparser_read_word(cursor->header, cursor->next_entry + 2 * word_size) * cursor->page_size;
+    
+    // Names run up to the end of the note - return empty string once they're used up
+    const char* name_end = memchr(cursor->next_name, '\0', cursor->end - cursor->next_name);
+    if (name_end != NULL) {
+        mapping_out->name   = cursor->next_name;
+        cursor->next_name   = name_end + 1;
+    } else {
+        mapping_out->name   = "";
+        cursor->next_name   = cursor->end;
+    }
+    
+    cursor->next_entry += 3 * word_size;
+    cursor->index++;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_auxv_entry(const ElfParser_Header* header, const ElfParser_Note* note,
+                                         uint64_t index, ElfParser_AuxvEntry* entry_out) {
+    if (!elfparser_is_core_note(note, ELFPARSER_NT_AUXV)) return ELFPARSER_INVALID;
+    
+    uint64_t word_size = elfparser_get_word_size(header);
+    if (index >= note->n_descsz / (2 * word_size)) return ELFPARSER_INVALID;
+    
+    const void* entry = note->desc + index * 2 * word_size;
+    entry_out->a_type   = elfparser_read_word(header, entry);
+    entry_out->a_val    = elfparser_read_word(header, entry + word_size);
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_find_auxv_entry(const ElfParser_Header* header, const ElfParser_Note* note,
+                                          ElfParser_AT_Type type, uint64_t* value_out) {
+    ElfParser_AuxvEntry entry;
+    
+    for (uint64_t i = 0; elfparser_get_auxv_entry(header, note, i, &entry) == ELFPARSER_NOERROR; i++) {
+        if (entry.a_type == ELFPARSER_AT_NULL) break;
+        
+        if (entry.a_type == type) {
+            *value_out = entry.a_val;
+            return ELFPARSER_NOERROR;
+        }
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+uint64_t elfparser_read_core_memory(const ElfParser_SegmentMap* map, uint64_t vaddr, void* dest, uint64_t num_bytes) {
+    uint64_t total_bytes_copied = 0;
+    
+    while (num_bytes > 0) {
+        ElfParser_VaddrTranslation translation;
+        if (elfparser_translate_vaddr(map, vaddr, num_bytes, &translation) != ELFPARSER_NOERROR) break;
+        
+        // Memory missing from the file wasn't dumped - unlike .bss in an executable, it isn't known to be 0
+        memcpy(dest, map->elf_start + translation.file_offset, translation.file_size);
+        
+        dest                += translation.file_size;
+        vaddr               += translation.file_size;
+        num_bytes           -= translation.file_size;
+        total_bytes_copied  += translation.file_size;
+        
+        if (translation.zero_size != 0 || translation.file_size == 0) break;
+    }
+    
+    return total_bytes_copied;
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+ElfParser_Error elfparser_section_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                              ElfParser_SectionCursor* cursor_out) {
+    uint64_t struct_size = header->ei_class == ELFPARSER_ELFCLASS64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr);
+    
+    cursor_out->elf_start   = elf_start;
+    cursor_out->header      = header;
+    cursor_out->next        = elf_start + header->e_shoff;
+    cursor_out->entry_size  = header->e_shentsize;
+    cursor_out->index       = 0;
+    cursor_out->num         = elfparser_get_num_entries_in_bounds(header, header->e_shoff, header->e_shentsize,
+                                                                  struct_size, header->true_shnum);
+    
+    return cursor_out->num == header->true_shnum ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
+
+
+ElfParser_Error elfparser_section_cursor_next(ElfParser_SectionCursor* cursor, ElfParser_SectionHeader* section_header_out) {
+    if (cursor->index >= cursor->num) return ELFPARSER_NOT_FOUND;
+    
+    // Bounds were already checked when the cursor was initialized
+    if (cursor->header->ei_class == ELFPARSER_ELFCLASS64) {
+        elfparser_get_section_header64(cursor->header, cursor->next, section_header_out);
+    } else {
+        elfparser_get_section_header32(cursor->header, cursor->next, section_header_out);
+    }
+    
+    section_header_out->index   = cursor->index;
+    section_header_out->name    = NULL;
+    
+    cursor->next += cursor->entry_size;
+    cursor->index++;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+const char* elfparser_section_cursor_get_name(const ElfParser_SectionCursor* cursor, ElfParser_SectionHeader* section_header) {
+    section_header->name = elfparser_get_section_header_name(cursor->elf_start, cursor->header, section_header);
+    return section_header->name;
+}
+
+
+ElfParser_Error elfparser_symbol_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                             ElfParser_SymbolCursor* cursor_out) {
+    ElfParser_SymbolTable table = {
+        .offset                 = header->symbol_table_offset,
+        .entry_size             = header->symbol_entry_size,
+        .num                    = header->symbol_num,
+        .string_table_offset    = header->symbol_string_table_offset
+    };
+    return elfparser_symbol_table_cursor_init(elf_start, header, &table, cursor_out);
+}
+
+
+ElfParser_Error elfparser_symbol_table_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                                   const ElfParser_SymbolTable* table, ElfParser_SymbolCursor* cursor_out) {
+    uint64_t struct_size = header->ei_class == ELFPARSER_ELFCLASS64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+    
+    cursor_out->elf_start           = elf_start;
+    cursor_out->header              = header;
+    cursor_out->next                = elf_start + table->offset;
+    cursor_out->entry_size          = table->entry_size;
+    cursor_out->index               = 0;
+    cursor_out->num                 = elfparser_get_num_entries_in_bounds(header, table->offset, table->entry_size,
+                                                                          struct_size, table->num);
+    cursor_out->string_table_offset = table->string_table_offset;
+    
+    return cursor_out->num == table->num ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
+
+
+ElfParser_Error elfparser_symbol_cursor_next(ElfParser_SymbolCursor* cursor, ElfParser_Symbol* symbol_out) {
+    if (cursor->index >= cursor->num) return ELFPARSER_NOT_FOUND;
+    
+    // Bounds were already checked when the cursor was initialized
+    if (cursor->header->ei_class == ELFPARSER_ELFCLASS64) {
+        elfparser_get_symbol64(cursor->header, cursor->next, symbol_out);
+    } else {
+        elfparser_get_symbol32(cursor->header, cursor->next, symbol_out);
+    }
+    
+    elfparser_decode_symbol_info(symbol_out);
+    symbol_out->index   = cursor->index;
+    symbol_out->name    = NULL;
+    
+    cursor->next += cursor->entry_size;
+    cursor->index++;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+const char* elfparser_symbol_cursor_get_name(const ElfParser_SymbolCursor* cursor, ElfParser_Symbol* symbol) {
+    symbol->name = elfparser_get_symbol_name(cursor->elf_start, cursor->header, cursor->string_table_offset, symbol);
+    return symbol->name;
+}
+
+
+ElfParser_Error elfparser_program_header_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                                     ElfParser_ProgramHeaderCursor* cursor_out) {
+    uint64_t struct_size = header->ei_class == ELFPARSER_ELFCLASS64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr);
+    
+    cursor_out->elf_start   = elf_start;
+    cursor_out->header      = header;
+    cursor_out->next        = elf_start + header->e_phoff;
+    cursor_out->entry_size  = header->e_phentsize;
+    cursor_out->index       = 0;
+    cursor_out->num         = elfparser_get_num_entries_in_bounds(header, header->e_phoff, header->e_phentsize,
+                                                                  struct_size, header->e_phnum);
+    
+    return cursor_out->num == header->e_phnum ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
+
+
+ElfParser_Error elfparser_program_header_cursor_next(ElfParser_ProgramHeaderCursor* cursor,
+                                                     ElfParser_ProgramHeader* program_header_out) {
+    if (cursor->index >= cursor->num) return ELFPARSER_NOT_FOUND;
+    
+    // Bounds were already checked when the cursor was initialized
+    if (cursor->header->ei_class == ELFPARSER_ELFCLASS64) {
+        elfparser_get_program_header64(cursor->header, cursor->next, program_header_out);
+    } else {
+        elfparser_get_program_header32(cursor->header, cursor->next, program_header_out);
+    }
+    
+    program_header_out->index = cursor->index;
+    
+    cursor->next += cursor->entry_size;
+    cursor->index++;
+    
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
@@ -0,0 +1,1021 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "dwarf.h"
+#include "sort.h"
+
+
+#define DW_AT_STMT_LIST         0x10
+#define DW_AT_COMP_DIR          0x1b
+
+#define DW_LNCT_PATH            0x1
+#define DW_LNCT_DIRECTORY_INDEX 0x2
+
+#define LINE_FILE_UNKNOWN       (UINT16_MAX - 1)
+#define LINE_END_SEQUENCE       UINT16_MAX          // File of the row ending a sequence
+
+// Attribute forms of .debug_info and of DWARF 5 line table headers
+enum {
+    DW_FORM_ADDR            = 0x01,
+    DW_FORM_BLOCK2          = 0x03,
+    DW_FORM_BLOCK4          = 0x04,
+    DW_FORM_DATA2           = 0x05,
+    DW_FORM_DATA4           = 0x06,
+    DW_FORM_DATA8           = 0x07,
+    DW_FORM_STRING          = 0x08,
+    DW_FORM_BLOCK           = 0x09,
+    DW_FORM_BLOCK1          = 0x0a,
+    DW_FORM_DATA1           = 0x0b,
+    DW_FORM_FLAG            = 0x0c,
+    DW_FORM_SDATA           = 0x0d,
+    DW_FORM_STRP            = 0x0e,
+    DW_FORM_UDATA           = 0x0f,
+    DW_FORM_REF_ADDR        = 0x10,
+    DW_FORM_REF1            = 0x11,
+    DW_FORM_REF2            = 0x12,
+    DW_FORM_REF4            = 0x13,
+    DW_FORM_REF8            = 0x14,
+    DW_FORM_REF_UDATA       = 0x15,
+    DW_FORM_INDIRECT        = 0x16,
+    DW_FORM_SEC_OFFSET      = 0x17,
+    DW_FORM_EXPRLOC         = 0x18,
+    DW_FORM_FLAG_PRESENT    = 0x19,
+    DW_FORM_STRX            = 0x1a,
+    DW_FORM_ADDRX           = 0x1b,
+    DW_FORM_REF_SUP4        = 0x1c,
+    DW_FORM_STRP_SUP        = 0x1d,
+    DW_FORM_DATA16          = 0x1e,
+    DW_FORM_LINE_STRP       = 0x1f,
+    DW_FORM_REF_SIG8        = 0x20,
+    DW_FORM_IMPLICIT_CONST  = 0x21,
+    DW_FORM_LOCLISTX        = 0x22,
+    DW_FORM_RNGLISTX        = 0x23,
+    DW_FORM_REF_SUP8        = 0x24,
+    DW_FORM_STRX1           = 0x25,
+    DW_FORM_STRX2           = 0x26,
+    DW_FORM_STRX3           = 0x27,
+    DW_FORM_STRX4           = 0x28,
+    DW_FORM_ADDRX1          = 0x29,
+    DW_FORM_ADDRX2          = 0x2a,
+    DW_FORM_ADDRX3          = 0x2b,
+    DW_FORM_ADDRX4          = 0x2c,
+    DW_FORM_GNU_ADDR_INDEX  = 0x1f01,
+    DW_FORM_GNU_STR_INDEX   = 0x1f02,
+    DW_FORM_GNU_REF_ALT     = 0x1f20,
+    DW_FORM_GNU_STRP_ALT    = 0x1f21
+};
+
+// Line number program opcodes
+enum {
+    DW_LNS_COPY                 = 0x01,
+    DW_LNS_ADVANCE_PC           = 0x02,
+    DW_LNS_ADVANCE_LINE         = 0x03,
+    DW_LNS_SET_FILE             = 0x04,
+    DW_LNS_SET_COLUMN           = 0x05,
+    DW_LNS_NEGATE_STMT          = 0x06,
+    DW_LNS_SET_BASIC_BLOCK      = 0x07,
+    DW_LNS_CONST_ADD_PC         = 0x08,
+    DW_LNS_FIXED_ADVANCE_PC     = 0x09,
+    DW_LNE_END_SEQUENCE         = 0x01,
+    DW_LNE_SET_ADDRESS          = 0x02
+};
+
+// Compilation unit of ElfParser_LineIndex
+typedef struct {
+    uint64_t            info_offset;
+    uint64_t            line_offset;    // UINT64_MAX if the unit has no line table
+    const char*         comp_dir;
+    void*               rows;           // ElfParser_LineRow array in the cache, NULL until decoded
+    uint64_t            num_rows;
+    void*               files;          // ElfParser_LineFile array in the cache
+    uint64_t            num_files;
+    bool                is_parsed;      // line_offset and comp_dir are valid
+    bool                has_aranges;
+} ElfParser_LineUnit;
+
+typedef struct {
+    uint64_t            begin;
+    uint64_t            end;
+    uint64_t            max_end;        // Largest end of this and every earlier range, to find overlapping ranges
+    uint64_t            unit;
+} ElfParser_LineRange;
+
+typedef struct {
+    uint64_t            address;
+    uint32_t            line;
+    uint16_t            column;
+    uint16_t            file;           // Index into the file table, or LINE_END_SEQUENCE
+} ElfParser_LineRow;
+
+typedef struct {
+    const char*         name;
+    const char*         directory;
+} ElfParser_LineFile;
+
+// Sizes which forms depend on
+typedef struct {
+    uint16_t            version;
+    uint8_t             offset_size;    // 4 for 32-bit DWARF, 8 for 64-bit DWARF
+    uint8_t             address_size;
+} ElfParser_FormContext;
+
+// Decoded header of a line table
+typedef struct {
+    ElfParser_FormContext   context;
+    uint8_t             min_instruction_length;
+    uint8_t             max_ops_per_instruction;
+    bool                default_is_stmt;
+    int8_t              line_base;
+    uint8_t             line_range;
+    uint8_t             opcode_base;
+    const uint8_t*      standard_opcode_lengths;
+    const uint8_t*      entries;        // Directory and file tables
+    const uint8_t*      program;
+    const uint8_t*      end;
+} ElfParser_LineProgram;
+
+
+static bool elfparser_find_debug_section(const void* elf_start, const ElfParser_Header* header, const char* name,
+                                         const uint8_t** data_out, uint64_t* size_out) {
+    ElfParser_SectionHeader section;
+    if (elfparser_get_section_header_by_name(elf_start, header, name, &section) != ELFPARSER_NOERROR ||
+        section.sh_type == ELFPARSER_SHT_NOBITS || (section.sh_flags & ELFPARSER_SHF_COMPRESSED) ||
+        section.sh_offset > header->elf_size || section.sh_size > header->elf_size - section.sh_offset) {
+        *data_out = NULL;
+        *size_out = 0;
+        return false;
+    }
+    
+    *data_out = elf_start + section.sh_offset;
+    *size_out = section.sh_size;
+    return true;
+}
+
+
+// Reads the initial length of a unit, and sets offset_size_out to 4 or 8 for 32 and 64-bit DWARF. Returns false if
+// the unit doesn't fit before end
+static bool elfparser_read_unit_length(const ElfParser_Header* header, const uint8_t** ptr, const uint8_t* end,
+                                       uint64_t* length_out, uint8_t* offset_size_out) {
+    if (!elfparser_read_fixed(header, ptr, end, 4, length_out)) return false;
+    *offset_size_out = 4;
+    
+    if (*length_out == 0xffffffff) {
+        if (!elfparser_read_fixed(header, ptr, end, 8, length_out)) return false;
+        *offset_size_out = 8;
+    }
+    return *length_out <= (uint64_t)(end - *ptr);
+}
+
+
+static const char* elfparser_get_debug_string(const uint8_t* section, uint64_t section_size, uint64_t offset) {
+    if (section == NULL || offset >= section_size || memchr(section + offset, '\0', section_size - offset) == NULL) {
+        return NULL;
+    }
+    return (const char*)section + offset;
+}
+
+
+// Reads an attribute of form `form`. Constants and offsets are returned in value_out, and strings in string_out, which
+// is left alone for other forms. Strings which can't be read, e.g. those in .debug_str_offsets, are NULL
+static bool elfparser_read_form(const ElfParser_LineIndex* index, const ElfParser_FormContext* context, uint64_t form,
+                                const uint8_t** ptr, const uint8_t* end, uint64_t* value_out, const char** string_out) {
+    const ElfParser_Header* header = index->header;
+    uint64_t size = 0;
+    int64_t signed_value;
+    *value_out = 0;
+    
+    switch (form) {
+        case DW_FORM_FLAG_PRESENT:
+        case DW_FORM_IMPLICIT_CONST:
+            return true;
+        case DW_FORM_DATA1: case DW_FORM_REF1: case DW_FORM_FLAG: case DW_FORM_STRX1: case DW_FORM_ADDRX1:
+            return elfparser_read_fixed(header, ptr, end, 1, value_out);
+        case DW_FORM_DATA2: case DW_FORM_REF2: case DW_FORM_STRX2: case DW_FORM_ADDRX2:
+            return elfparser_read_fixed(header, ptr, end, 2, value_out);
+        case DW_FORM_STRX3: case DW_FORM_ADDRX3:
+            size = 3;
+            break;
+        case DW_FORM_DATA4: case DW_FORM_REF4: case DW_FORM_REF_SUP4: case DW_FORM_STRX4: case DW_FORM_ADDRX4:
+            return elfparser_read_fixed(header, ptr, end, 4, value_out);
+        case DW_FORM_DATA8: case DW_FORM_REF8: case DW_FORM_REF_SIG8: case DW_FORM_REF_SUP8:
+            return elfparser_read_fixed(header, ptr, end, 8, value_out);
+        case DW_FORM_DATA16:
+            size = 16;
+            break;
+        case DW_FORM_ADDR:
+            return elfparser_read_fixed(header, ptr, end, context->address_size, value_out);
+        case DW_FORM_REF_ADDR:
+            // DWARF 2 references have the size of an address
+            return elfparser_read_fixed(header, ptr, end, context->version <= 2 ? context->address_size :
+                                        context->offset_size, value_out);
+        case DW_FORM_SEC_OFFSET: case DW_FORM_STRP_SUP: case DW_FORM_GNU_REF_ALT: case DW_FORM_GNU_STRP_ALT:
+            return elfparser_read_fixed(header, ptr, end, context->offset_size, value_out);
+        case DW_FORM_UDATA: case DW_FORM_REF_UDATA: case DW_FORM_STRX: case DW_FORM_ADDRX: case DW_FORM_LOCLISTX:
+        case DW_FORM_RNGLISTX: case DW_FORM_GNU_ADDR_INDEX: case DW_FORM_GNU_STR_INDEX:
+            return elfparser_read_uleb128(ptr, end, value_out);
+        case DW_FORM_SDATA:
+            if (!elfparser_read_sleb128(ptr, end, &signed_value)) return false;
+            *value_out = signed_value;
+            return true;
+        case DW_FORM_STRING: {
+            const uint8_t* terminator = memchr(*ptr, '\0', end - *ptr);
+            if (terminator == NULL) return false;
+            *string_out = (const char*)*ptr;
+            *ptr = terminator + 1;
+            return true;
+        }
+        case DW_FORM_STRP:
+            if (!elfparser_read_fixed(header, ptr, end, context->offset_size, value_out)) return false;
+            *string_out = elfparser_get_debug_string(index->debug_str, index->debug_str_size, *value_out);
+            return true;
+        case DW_FORM_LINE_STRP:
+            if (!elfparser_read_fixed(header, ptr, end, context->offset_size, value_out)) return false;
+            *string_out = elfparser_get_debug_string(index->debug_line_str, index->debug_line_str_size, *value_out);
+            return true;
+        case DW_FORM_BLOCK1: case DW_FORM_BLOCK2: case DW_FORM_BLOCK4: case DW_FORM_BLOCK: case DW_FORM_EXPRLOC:
+            if (form == DW_FORM_BLOCK1)         size = 1;
+            else if (form == DW_FORM_BLOCK2)    size = 2;
+            else if (form == DW_FORM_BLOCK4)    size = 4;
+            
+            if (size != 0 && !elfparser_read_fixed(header, ptr, end, size, &size)) return false;
+            if (size == 0 && !elfparser_read_uleb128(ptr, end, &size)) return false;
+            break;
+        default:
+            return false;
+    }
+    
+    // Skip over the value
+    if ((uint64_t)(end - *ptr) < size) return false;
+    *ptr += size;
+    return true;
+}
+
+
+// Reads DW_AT_stmt_list and DW_AT_comp_dir from the first DIE of a unit
+static ElfParser_Error elfparser_parse_line_unit(const ElfParser_LineIndex* index, ElfParser_LineUnit* unit) {
+    const ElfParser_Header* header = index->header;
+    unit->is_parsed     = true;
+    unit->line_offset   = UINT64_MAX;
+    unit->comp_dir      = "";
+    
+    const uint8_t* ptr = index->debug_info + unit->info_offset;
+    const uint8_t* end = index->debug_info + index->debug_info_size;
+    
+    ElfParser_FormContext context;
+    uint64_t length, abbrev_offset, address_size, unit_type = 1;
+    if (!elfparser_read_unit_length(header, &ptr, end, &length, &context.offset_size)) return ELFPARSER_INVALID;
+    end = ptr + length;
+    
+    uint64_t version;
+    if (!elfparser_read_fixed(header, &ptr, end, 2, &version) || version < 2 || version > 5) return ELFPARSER_INVALID;
+    context.version = version;
+    
+    // DWARF 5 moved the address size before the abbreviation offset, and added the unit type
+    if (version >= 5) {
+        if (!elfparser_read_fixed(header, &ptr, end, 1, &unit_type) ||
+            !elfparser_read_fixed(header, &ptr, end, 1, &address_size) ||
+            !elfparser_read_fixed(header, &ptr, end, context.offset_size, &abbrev_offset)) {
+            return ELFPARSER_INVALID;
+        }
+    } else if (!elfparser_read_fixed(header, &ptr, end, context.offset_size, &abbrev_offset) ||
+               !elfparser_read_fixed(header, &ptr, end, 1, &address_size)) {
+        return ELFPARSER_INVALID;
+    }
+    context.address_size = address_size;
+    
+    // Skeleton and split compilation units have an 8 byte ID, type units a signature and type offset
+    uint64_t extra_size = 0;
+    if (unit_type == 4 || unit_type == 5)       extra_size = 8;
+    else if (unit_type == 2 || unit_type == 6)  extra_size = 8 + context.offset_size;
+    if ((uint64_t)(end - ptr) < extra_size) return ELFPARSER_INVALID;
+    ptr += extra_size;
+    
+    uint64_t code;
+    if (!elfparser_read_uleb128(&ptr, end, &code) || code == 0) return ELFPARSER_NOERROR;
+    
+    // Find the abbreviation of the DIE
+    if (abbrev_offset >= index->debug_abbrev_size) return ELFPARSER_INVALID;
+    const uint8_t* abbrev = index->debug_abbrev + abbrev_offset;
+    const uint8_t* abbrev_end = index->debug_abbrev + index->debug_abbrev_size;
+    
+    while (true) {
+        uint64_t abbrev_code, tag, attribute, form;
+        int64_t implicit_const;
+        if (!elfparser_read_uleb128(&abbrev, abbrev_end, &abbrev_code) || abbrev_code == 0 ||
+            !elfparser_read_uleb128(&abbrev, abbrev_end, &tag) || abbrev == abbrev_end) {
+            return ELFPARSER_INVALID;
+        }
+        abbrev++;   // DW_CHILDREN_*
+        if (abbrev_code == code) break;
+        
+        do {
+            if (!elfparser_read_uleb128(&abbrev, abbrev_end, &attribute) ||
+                !elfparser_read_uleb128(&abbrev, abbrev_end, &form)) {
+                return ELFPARSER_INVALID;
+            }
+            if (form == DW_FORM_IMPLICIT_CONST && !elfparser_read_sleb128(&abbrev, abbrev_end, &implicit_const)) {
+                return ELFPARSER_INVALID;
+            }
+        } while (attribute != 0 || form != 0);
+    }
+    
+    // Walk the attributes of the DIE
+    while (true) {
+        uint64_t attribute, form, value;
+        int64_t implicit_const;
+        const char* string = NULL;
+        if (!elfparser_read_uleb128(&abbrev, abbrev_end, &attribute) ||
+            !elfparser_read_uleb128(&abbrev, abbrev_end, &form)) {
+            return ELFPARSER_INVALID;
+        }
+        if (attribute == 0 && form == 0) break;
+        
+        if (form == DW_FORM_IMPLICIT_CONST && !elfparser_read_sleb128(&abbrev, abbrev_end, &implicit_const)) {
+            return ELFPARSER_INVALID;
+        }
+        if (form == DW_FORM_INDIRECT && !elfparser_read_uleb128(&ptr, end, &form)) return ELFPARSER_INVALID;
+        if (!elfparser_read_form(index, &context, form, &ptr, end, &value, &string)) return ELFPARSER_INVALID;
+        
+        if (attribute == DW_AT_STMT_LIST)                       unit->line_offset = value;
+        else if (attribute == DW_AT_COMP_DIR && string != NULL) unit->comp_dir = string;
+    }
+    
+    if (unit->line_offset >= index->debug_line_size) unit->line_offset = UINT64_MAX;
+    return ELFPARSER_NOERROR;
+}
+
+
+static ElfParser_Error elfparser_read_line_program(const ElfParser_LineIndex* index, uint64_t offset,
+                                                   ElfParser_LineProgram* program_out) {
+    const ElfParser_Header* header = index->header;
+    const uint8_t* ptr = index->debug_line + offset;
+    const uint8_t* end = index->debug_line + index->debug_line_size;
+    ElfParser_FormContext* context = &program_out->context;
+    
+    uint64_t length, version, header_length;
+    if (!elfparser_read_unit_length(header, &ptr, end, &length, &context->offset_size)) return ELFPARSER_INVALID;
+    end = ptr + length;
+    program_out->end = end;
+    
+    if (!elfparser_read_fixed(header, &ptr, end, 2, &version) || version < 2 || version > 5) return ELFPARSER_INVALID;
+    context->version = version;
+    context->address_size = elfparser_get_word_size(header);
+    
+    if (version >= 5) {
+        // Address and segment selector sizes
+        if (end - ptr < 2) return ELFPARSER_INVALID;
+        context->address_size = ptr[0];
+        ptr += 2;
+    }
+    
+    if (!elfparser_read_fixed(header, &ptr, end, context->offset_size, &header_length) ||
+        header_length > (uint64_t)(end - ptr)) {
+        return ELFPARSER_INVALID;
+    }
+    program_out->program = ptr + header_length;
+    
+    if (end - ptr < (version >= 4 ? 6 : 5)) return ELFPARSER_INVALID;
+    program_out->min_instruction_length = *ptr++;
+    program_out->max_ops_per_instruction = version >= 4 ? *ptr++ : 1;
+    program_out->default_is_stmt        = *ptr++;
+    program_out->line_base              = (int8_t)*ptr++;
+    program_out->line_range             = *ptr++;
+    program_out->opcode_base            = *ptr++;
+    
+    if (program_out->line_range == 0 || program_out->max_ops_per_instruction == 0 || program_out->opcode_base == 0 ||
+        (uint64_t)(program_out->program - ptr) < program_out->opcode_base - 1u) {
+        return ELFPARSER_INVALID;
+    }
+    program_out->standard_opcode_lengths = ptr;
+    program_out->entries = ptr + program_out->opcode_base - 1;
+    return ELFPARSER_NOERROR;
+}
+
+
+// Reads a DWARF 5 directory or file name table into entries_out, or only counts the entries if it is NULL.
+// `directories` resolves the directory indexes of files
+static bool elfparser_read_line_entry_table(const ElfParser_LineIndex* index, const ElfParser_LineProgram* program,
+                                            const uint8_t** ptr, const ElfParser_LineFile* directories,
+                                            uint64_t num_directories, ElfParser_LineFile* entries_out, uint64_t* num_out) {
+    const uint8_t* end = program->program;
+    if (*ptr >= end) return false;
+    
+    // Pairs of content type and form describe each entry
+    uint64_t format_count = *(*ptr)++;
+    const uint8_t* format = *ptr;
+    for (uint64_t i = 0; i < format_count * 2; i++) {
+        uint64_t value;
+        if (!elfparser_read_uleb128(ptr, end, &value)) return false;
+    }
+    
+    // Every entry takes at least a byte, which bounds count by what is left of the header
+    uint64_t count;
+    if (!elfparser_read_uleb128(ptr, end, &count) || count > (uint64_t)(end - *ptr)) return false;
+    if (count > 0 && format_count == 0) return false;
+    
+    for (uint64_t i = 0; i < count; i++) {
+        const char* name = "";
+        const char* directory = "";
+        const uint8_t* format_ptr = format;
+        const uint8_t* entry_start = *ptr;
+        
+        for (uint64_t j = 0; j < format_count; j++) {
+            uint64_t content_type, form, value;
+            const char* string = NULL;
+            if (!elfparser_read_uleb128(&format_ptr, end, &content_type) ||
+                !elfparser_read_uleb128(&format_ptr, end, &form) ||
+                !elfparser_read_form(index, &program->context, form, ptr, end, &value, &string)) {
+                return false;
+            }
+            
+            if (content_type == DW_LNCT_PATH && string != NULL) {
+                name = string;
+            } else if (content_type == DW_LNCT_DIRECTORY_INDEX && value < num_directories) {
+                directory = directories[value].name;
+            }
+        }
+        
+        // Entries of only implicit forms would never run out of bytes
+        if (*ptr == entry_start) return false;
+        
+        if (entries_out != NULL) {
+            entries_out[i].name         = name;
+            entries_out[i].directory    = directory;
+        }
+    }
+    
+    *num_out = count;
+    return true;
+}
+
+
+// Reads the directory table followed by the file table into entries_out, or only counts them if it is NULL. Files are
+// numbered like in DWARF 5 line programs - DWARF 4 numbers them from 1, and its directory 0 is the compilation
+// directory, which is added in front of the include directories
+static bool elfparser_read_line_files(const ElfParser_LineIndex* index, const ElfParser_LineProgram* program,
+                                      const ElfParser_LineUnit* unit, ElfParser_LineFile* entries_out,
+                                      uint64_t* num_directories_out, uint64_t* num_files_out) {
+    const uint8_t* ptr = program->entries;
+    const uint8_t* end = program->program;
+    
+    if (program->context.version >= 5) {
+        ElfParser_LineFile* directories = entries_out;
+        if (!elfparser_read_line_entry_table(index, program, &ptr, NULL, 0, directories, num_directories_out)) {
+            return false;
+        }
+        
+        // Directory 0 is the compilation directory
+        if (directories != NULL && *num_directories_out > 0 && directories[0].name[0] == '\0') {
+            directories[0].name = unit->comp_dir;
+        }
+        
+        return elfparser_read_line_entry_table(index, program, &ptr, directories, directories ? *num_directories_out : 0,
+                                               entries_out ? entries_out + *num_directories_out : NULL, num_files_out);
+    }
+    
+    // DWARF 4 and earlier: a list of directory strings, then a list of files, each ending with an empty string
+    uint64_t num_directories = 1;
+    if (entries_out != NULL) entries_out[0] = (ElfParser_LineFile){ .name = unit->comp_dir, .directory = "" };
+    
+    while (ptr < end && *ptr != '\0') {
+        const uint8_t* terminator = memchr(ptr, '\0', end - ptr);
+        if (terminator == NULL) return false;
+        if (entries_out != NULL) {
+            entries_out[num_directories] = (ElfParser_LineFile){ .name = (const char*)ptr, .directory = "" };
+        }
+        ptr = terminator + 1;
+        num_directories++;
+    }
+    if (ptr >= end) return false;
+    ptr++;
+    
+    uint64_t num_files = 0;
+    while (ptr < end && *ptr != '\0') {
+        const char* name = (const char*)ptr;
+        const uint8_t* terminator = memchr(ptr, '\0', end - ptr);
+        if (terminator == NULL) return false;
+        ptr = terminator + 1;
+        
+        uint64_t directory_index, mtime, size;
+        if (!elfparser_read_uleb128(&ptr, end, &directory_index) || !elfparser_read_uleb128(&ptr, end, &mtime) ||
+            !elfparser_read_uleb128(&ptr, end, &size)) {
+            return false;
+        }
+        
+        if (entries_out != NULL) {
+            ElfParser_LineFile* file = &entries_out[num_directories + num_files];
+            file->name      = name;
+            file->directory = directory_index < num_directories ? entries_out[directory_index].name : "";
+        }
+        num_files++;
+    }
+    
+    *num_directories_out = num_directories;
+    *num_files_out = num_files;
+    return true;
+}
+
+
+
+// Sequences of code discarded by the linker are left in the line table at address 0, or at a tombstone value
+static bool elfparser_is_discarded_address(const ElfParser_LineIndex* index, uint64_t address) {
+    if (address == 0) return index->header->e_type != ELFPARSER_ET_REL;
+    return address >= (elfparser_get_word_size(index->header) == 4 ? UINT32_MAX - 1 : UINT64_MAX - 1);
+}
+
+
+// Runs a line program. Rows are written to rows_out while they fit in max_rows, and the number of rows is returned in
+// num_rows_out either way. If ranges_out isn't NULL, the address range of each sequence is added to it, with the last
+// of max_ranges covering any sequences left over
+static bool elfparser_run_line_program(const ElfParser_LineIndex* index, const ElfParser_LineProgram* program,
+                                       ElfParser_LineRow* rows_out, uint64_t max_rows, uint64_t* num_rows_out,
+                                       ElfParser_LineRange* ranges_out, uint64_t max_ranges, uint64_t* num_ranges_out) {
+    const ElfParser_Header* header = index->header;
+    const uint8_t* ptr = program->program;
+    const uint8_t* end = program->end;
+    
+    uint64_t num_rows = 0, num_ranges = 0;
+    uint64_t sequence_start = 0, sequence_address = 0, previous_address = 0;
+    bool in_sequence = false;
+    
+    // State machine registers
+    uint64_t address = 0, op_index = 0, file = 1, column = 0;
+    int64_t line = 1;
+    
+    while (ptr < end) {
+        uint8_t opcode = *ptr++;
+        uint64_t advance = 0, value;
+        int64_t signed_value;
+        bool emit = false, end_sequence = false;
+        
+        if (opcode >= program->opcode_base) {
+            // Special opcodes advance the address and line at once, then add a row
+            uint8_t adjusted = opcode - program->opcode_base;
+            advance = adjusted / program->line_range;
+            line += program->line_base + adjusted % program->line_range;
+            emit = true;
+        } else if (opcode == 0) {
+            uint64_t length;
+            if (!elfparser_read_uleb128(&ptr, end, &length) || length == 0 || length > (uint64_t)(end - ptr)) return false;
+            const uint8_t* next = ptr + length;
+            
+            uint8_t extended_opcode = *ptr++;
+            if (extended_opcode == DW_LNE_END_SEQUENCE) {
+                emit = end_sequence = true;
+            } else if (extended_opcode == DW_LNE_SET_ADDRESS) {
+                if (length - 1 > 8 || !elfparser_read_fixed(header, &ptr, next, length - 1, &address)) return false;
+                op_index = 0;
+            }
+            ptr = next;
+        } else {
+            bool ok = true;
+            switch (opcode) {
+                case DW_LNS_COPY:           emit = true;                                                    break;
+                case DW_LNS_ADVANCE_PC:     ok = elfparser_read_uleb128(&ptr, end, &advance);               break;
+                case DW_LNS_SET_FILE:       ok = elfparser_read_uleb128(&ptr, end, &file);                  break;
+                case DW_LNS_SET_COLUMN:     ok = elfparser_read_uleb128(&ptr, end, &column);                break;
+                case DW_LNS_CONST_ADD_PC:   advance = (255 - program->opcode_base) / program->line_range;   break;
+                case DW_LNS_ADVANCE_LINE:
+                    ok = elfparser_read_sleb128(&ptr, end, &signed_value);
+                    line += signed_value;
+                    break;
+                case DW_LNS_FIXED_ADVANCE_PC:
+                    ok = elfparser_read_fixed(header, &ptr, end, 2, &value);
+                    address += value;
+                    op_index = 0;
+                    break;
+                default:
+                    // Opcodes which don't matter here, or are unknown, are skipped using their number of operands
+                    for (uint8_t i = 0; ok && i < program->standard_opcode_lengths[opcode - 1]; i++) {
+                        ok = elfparser_read_uleb128(&ptr, end, &value);
+                    }
+                    break;
+            }
+            if (!ok) return false;
+        }
+        
+        if (advance != 0) {
+            address += program->min_instruction_length * ((op_index + advance) / program->max_ops_per_instruction);
+            op_index = (op_index + advance) % program->max_ops_per_instruction;
+        }
+        if (!emit) continue;
+        
+        if (!in_sequence) {
+            in_sequence         = true;
+            sequence_start      = num_rows;
+            sequence_address    = address;
+        } else if (address == previous_address) {
+            // A later row at the same address replaces the earlier one
+            num_rows--;
+        }
+        
+        if (num_rows < max_rows) {
+            // DWARF 4 numbers files from 1
+            uint64_t file_index = program->context.version >= 5 ? file : file - 1;
+            
+            ElfParser_LineRow* row = &rows_out[num_rows];
+            row->address    = address;
+            row->line       = line < 0 ? 0 : line > UINT32_MAX ? UINT32_MAX : line;
+            row->column     = column > UINT16_MAX ? UINT16_MAX : column;
+            row->file       = end_sequence ? LINE_END_SEQUENCE : file_index < LINE_FILE_UNKNOWN ? file_index :
+                              LINE_FILE_UNKNOWN;
+        }
+        num_rows++;
+        previous_address = address;
+        
+        if (end_sequence) {
+            if (elfparser_is_discarded_address(index, sequence_address)) {
+                num_rows = sequence_start;
+            } else if (ranges_out != NULL && num_ranges < max_ranges) {
+                ranges_out[num_ranges].begin    = sequence_address;
+                ranges_out[num_ranges++].end    = address;
+            } else if (ranges_out != NULL) {
+                // Out of room - grow the last range to cover the sequence too
+                ElfParser_LineRange* range = &ranges_out[num_ranges - 1];
+                if (sequence_address < range->begin)    range->begin = sequence_address;
+                if (address > range->end)               range->end = address;
+            }
+            
+            in_sequence = false;
+            address = op_index = column = 0;
+            file = line = 1;
+        }
+    }
+    
+    // Rows of a sequence which never ended don't cover anything
+    if (in_sequence) num_rows = sequence_start;
+    
+    *num_rows_out = num_rows;
+    if (num_ranges_out != NULL) *num_ranges_out = num_ranges;
+    return true;
+}
+
+
+static bool elfparser_is_line_row_less(const void* a, const void* b, const void* context) {
+    const ElfParser_LineRow* row_a = a;
+    const ElfParser_LineRow* row_b = b;
+    if (row_a->address != row_b->address) return row_a->address < row_b->address;
+    
+    // A sequence may start where another ends - the end goes first so that the start covers the address
+    return row_a->file == LINE_END_SEQUENCE && row_b->file != LINE_END_SEQUENCE;
+}
+
+
+static void elfparser_clear_line_cache(ElfParser_LineIndex* index) {
+    ElfParser_LineUnit* units = index->units;
+    for (uint64_t i = 0; i < index->num_units; i++) {
+        units[i].rows   = NULL;
+        units[i].files  = NULL;
+    }
+    index->cache_next = index->cache_start;
+}
+
+
+// Decodes the line table of a unit into the cache, making room by clearing the cache if needed
+static ElfParser_Error elfparser_load_line_unit(ElfParser_LineIndex* index, ElfParser_LineUnit* unit) {
+    if (unit->rows != NULL) return ELFPARSER_NOERROR;
+    
+    ElfParser_Error err;
+    if (!unit->is_parsed && (err = elfparser_parse_line_unit(index, unit)) != ELFPARSER_NOERROR) return err;
+    if (unit->line_offset == UINT64_MAX) return ELFPARSER_NOT_FOUND;
+    
+    ElfParser_LineProgram program;
+    if ((err = elfparser_read_line_program(index, unit->line_offset, &program)) != ELFPARSER_NOERROR) return err;
+    
+    uint64_t num_directories, num_files;
+    if (!elfparser_read_line_files(index, &program, unit, NULL, &num_directories, &num_files) ||
+        num_files > UINT64_MAX / sizeof(ElfParser_LineFile) ||
+        num_directories > UINT64_MAX / sizeof(ElfParser_LineFile) - num_files) {
+        return ELFPARSER_INVALID;
+    }
+    uint64_t files_size = (num_directories + num_files) * sizeof(ElfParser_LineFile);
+    
+    while (true) {
+        uint64_t available = index->cache_end - index->cache_next;
+        
+        if (files_size <= available) {
+            ElfParser_LineFile* entries = (void*)index->cache_next;
+            ElfParser_LineRow* rows = (void*)(index->cache_next + files_size);
+            uint64_t max_rows = (available - files_size) / sizeof(ElfParser_LineRow);
+            
+            uint64_t num_rows;
+            if (!elfparser_run_line_program(index, &program, rows, max_rows, &num_rows, NULL, 0, NULL)) {
+                return ELFPARSER_INVALID;
+            }
+            
+            if (num_rows <= max_rows) {
+                elfparser_read_line_files(index, &program, unit, entries, &num_directories, &num_files);
+                
+                // Sequences are usually in order of address already
+                for (uint64_t i = 1; i < num_rows; i++) {
+                    if (elfparser_is_line_row_less(&rows[i], &rows[i - 1], NULL)) {
+                        elfparser_sort(rows, num_rows, sizeof(ElfParser_LineRow), elfparser_is_line_row_less, NULL);
+                        break;
+                    }
+                }
+                
+                unit->rows          = rows;
+                unit->num_rows      = num_rows;
+                unit->files         = entries + num_directories;
+                unit->num_files     = num_files;
+                index->cache_next   = (uint8_t*)(rows + num_rows);
+                return ELFPARSER_NOERROR;
+            }
+        }
+        
+        // Doesn't fit even in an empty cache
+        if (index->cache_next == index->cache_start) return ELFPARSER_INVALID;
+        elfparser_clear_line_cache(index);
+    }
+}
+
+
+static ElfParser_Error elfparser_find_line_in_unit(const ElfParser_LineIndex* index, const ElfParser_LineUnit* unit,
+                                                   uint64_t address, ElfParser_LineInfo* info_out) {
+    const ElfParser_LineRow* rows = unit->rows;
+    
+    // Find the last row at or before address
+    uint64_t low = 0, num = unit->num_rows;
+    while (num > 0) {
+        uint64_t half = num / 2;
+        if (rows[low + half].address <= address) {
+            low += half + 1;
+            num -= half + 1;
+        } else {
+            num = half;
+        }
+    }
+    if (low == 0 || rows[low - 1].file == LINE_END_SEQUENCE) return ELFPARSER_NOT_FOUND;
+    
+    const ElfParser_LineRow* row = &rows[low - 1];
+    const ElfParser_LineFile* files = unit->files;
+    
+    info_out->address       = row->address;
+    info_out->line          = row->line;
+    info_out->column        = row->column;
+    info_out->file_name     = row->file < unit->num_files ? files[row->file].name : "";
+    info_out->directory     = row->file < unit->num_files ? files[row->file].directory : "";
+    info_out->comp_dir      = unit->comp_dir;
+    info_out->unit_offset   = unit->info_offset;
+    return ELFPARSER_NOERROR;
+}
+
+
+static bool elfparser_find_line_sections(const void* elf_start, const ElfParser_Header* header,
+                                         ElfParser_LineIndex* index_out) {
+    memset(index_out, 0, sizeof(ElfParser_LineIndex));
+    index_out->elf_start    = elf_start;
+    index_out->header       = header;
+    
+    elfparser_find_debug_section(elf_start, header, ".debug_abbrev", &index_out->debug_abbrev, &index_out->debug_abbrev_size);
+    elfparser_find_debug_section(elf_start, header, ".debug_str", &index_out->debug_str, &index_out->debug_str_size);
+    elfparser_find_debug_section(elf_start, header, ".debug_line_str", &index_out->debug_line_str,
+                                 &index_out->debug_line_str_size);
+    
+    return elfparser_find_debug_section(elf_start, header, ".debug_info", &index_out->debug_info,
+                                        &index_out->debug_info_size) &&
+           elfparser_find_debug_section(elf_start, header, ".debug_line", &index_out->debug_line,
+                                        &index_out->debug_line_size);
+}
+
+
+// Steps through the units of .debug_info, adding them to units_out if it isn't NULL. Returns the number of units
+static uint64_t elfparser_read_line_units(const ElfParser_LineIndex* index, ElfParser_LineUnit* units_out) {
+    const uint8_t* ptr = index->debug_info;
+    const uint8_t* end = index->debug_info + index->debug_info_size;
+    uint64_t num = 0;
+    
+    while (ptr < end) {
+        uint64_t offset = ptr - index->debug_info;
+        uint64_t length;
+        uint8_t offset_size;
+        if (!elfparser_read_unit_length(index->header, &ptr, end, &length, &offset_size)) break;
+        ptr += length;
+        
+        if (units_out != NULL) {
+            memset(&units_out[num], 0, sizeof(ElfParser_LineUnit));
+            units_out[num].info_offset = offset;
+        }
+        num++;
+    }
+    return num;
+}
+
+
+static bool elfparser_is_line_unit_before_offset(const void* unit, const void* offset, const void* context) {
+    return ((const ElfParser_LineUnit*)unit)->info_offset < *(const uint64_t*)offset;
+}
+
+
+// Steps through the address ranges of .debug_aranges, adding them to ranges_out and marking their units if it isn't
+// NULL. Returns the number of ranges
+static uint64_t elfparser_read_line_aranges(const ElfParser_LineIndex* index, ElfParser_LineUnit* units,
+                                            uint64_t num_units, ElfParser_LineRange* ranges_out) {
+    const ElfParser_Header* header = index->header;
+    const uint8_t* section;
+    uint64_t section_size;
+    if (!elfparser_find_debug_section(index->elf_start, header, ".debug_aranges", &section, &section_size)) return 0;
+    
+    const uint8_t* ptr = section;
+    const uint8_t* section_end = section + section_size;
+    uint64_t num = 0;
+    
+    while (ptr < section_end) {
+        const uint8_t* set_start = ptr;
+        uint64_t length, version, info_offset, address_size, segment_size;
+        uint8_t offset_size;
+        if (!elfparser_read_unit_length(header, &ptr, section_end, &length, &offset_size)) break;
+        const uint8_t* end = ptr + length;
+        const uint8_t* next = end;
+        
+        if (!elfparser_read_fixed(header, &ptr, end, 2, &version) ||
+            !elfparser_read_fixed(header, &ptr, end, offset_size, &info_offset) ||
+            !elfparser_read_fixed(header, &ptr, end, 1, &address_size) ||
+            !elfparser_read_fixed(header, &ptr, end, 1, &segment_size) ||
+            (address_size != 4 && address_size != 8)) {
+            ptr = next;
+            continue;
+        }
+        
+        // Tuples are aligned to twice their address size from the start of the set
+        uint64_t tuple_size = address_size * 2 + segment_size;
+        uint64_t padding = (address_size * 2 - (ptr - set_start) % (address_size * 2)) % (address_size * 2);
+        ptr = (uint64_t)(end - ptr) < padding ? end : ptr + padding;
+        
+        uint64_t unit = UINT64_MAX;
+        if (units != NULL) {
+            unit = elfparser_lower_bound(units, num_units, sizeof(ElfParser_LineUnit), &info_offset,
+                                         elfparser_is_line_unit_before_offset, NULL);
+            if (unit == num_units || units[unit].info_offset != info_offset) unit = UINT64_MAX;
+        }
+        
+        for (; (uint64_t)(end - ptr) >= tuple_size; ptr += tuple_size) {
+            const uint8_t* tuple = ptr + segment_size;
+            uint64_t address, size;
+            elfparser_read_fixed(header, &tuple, end, address_size, &address);
+            elfparser_read_fixed(header, &tuple, end, address_size, &size);
+            
+            if (address == 0 && size == 0) break;
+            if (size == 0 || elfparser_is_discarded_address(index, address)) continue;
+            
+            if (units != NULL) {
+                if (unit == UINT64_MAX) continue;
+                units[unit].has_aranges     = true;
+                ranges_out[num].begin       = address;
+                ranges_out[num].end         = address + size;
+                ranges_out[num].unit        = unit;
+            }
+            num++;
+        }
+        ptr = next;
+    }
+    return num;
+}
+
+
+static bool elfparser_is_line_range_less(const void* a, const void* b, const void* context) {
+    return ((const ElfParser_LineRange*)a)->begin < ((const ElfParser_LineRange*)b)->begin;
+}
+
+
+static void elfparser_sort_line_ranges(ElfParser_LineIndex* index) {
+    ElfParser_LineRange* ranges = index->ranges;
+    elfparser_sort(ranges, index->num_ranges, sizeof(ElfParser_LineRange), elfparser_is_line_range_less, NULL);
+    
+    uint64_t max_end = 0;
+    for (uint64_t i = 0; i < index->num_ranges; i++) {
+        if (ranges[i].end > max_end) max_end = ranges[i].end;
+        ranges[i].max_end = max_end;
+    }
+}
+
+
+uint64_t elfparser_get_line_index_buffer_size(const void* elf_start, const ElfParser_Header* header) {
+    ElfParser_LineIndex index;
+    if (!elfparser_find_line_sections(elf_start, header, &index)) return 7;
+    
+    // Units missing from .debug_aranges may add ranges of their own later
+    uint64_t num_units = elfparser_read_line_units(&index, NULL);
+    uint64_t num_ranges = elfparser_read_line_aranges(&index, NULL, 0, NULL) + num_units;
+    
+    // Extra bytes to align the start of the buffer
+    return num_units * sizeof(ElfParser_LineUnit) + num_ranges * sizeof(ElfParser_LineRange) + 7;
+}
+
+
+ElfParser_Error elfparser_build_line_index(const void* elf_start, const ElfParser_Header* header,
+                                          void* buffer, uint64_t buffer_size, ElfParser_LineIndex* index_out) {
+    uint64_t min_size = elfparser_get_line_index_buffer_size(elf_start, header);
+    if (!elfparser_find_line_sections(elf_start, header, index_out)) return ELFPARSER_NOT_FOUND;
+    if (buffer_size < min_size) return ELFPARSER_INVALID;
+    
+    ElfParser_LineUnit* units = (void*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+    uint64_t num_units = elfparser_read_line_units(index_out, units);
+    
+    ElfParser_LineRange* ranges = (void*)(units + num_units);
+    uint64_t num_ranges = elfparser_read_line_aranges(index_out, units, num_units, ranges);
+    
+    index_out->units        = units;
+    index_out->num_units    = num_units;
+    index_out->ranges       = ranges;
+    index_out->num_ranges   = num_ranges;
+    elfparser_sort_line_ranges(index_out);
+    
+    // Keep room for the ranges of units missing from .debug_aranges
+    index_out->cache_start  = (uint8_t*)(ranges + num_ranges + num_units);
+    index_out->cache_next   = index_out->cache_start;
+    index_out->cache_end    = (uint8_t*)buffer + buffer_size;
+    return ELFPARSER_NOERROR;
+}
+
+
+// Adds the ranges covered by the line tables of units missing from .debug_aranges, which means decoding each of them
+// once. A unit gets one range per sequence while there's room, and at least one covering all of them
+static void elfparser_add_unit_line_ranges(ElfParser_LineIndex* index) {
+    ElfParser_LineUnit* units = index->units;
+    ElfParser_LineRange* ranges = index->ranges;
+    ElfParser_LineRange* max_range = (ElfParser_LineRange*)index->cache_start;
+    index->has_unit_ranges = true;
+    
+    for (uint64_t i = 0; i < index->num_units; i++) {
+        ElfParser_LineUnit* unit = &units[i];
+        if (unit->has_aranges) continue;
+        
+        ElfParser_LineProgram program;
+        if ((!unit->is_parsed && elfparser_parse_line_unit(index, unit) != ELFPARSER_NOERROR) ||
+            unit->line_offset == UINT64_MAX ||
+            elfparser_read_line_program(index, unit->line_offset, &program) != ELFPARSER_NOERROR) {
+            continue;
+        }
+        
+        // Each unit left gets at least one range
+        ElfParser_LineRange* unit_ranges = &ranges[index->num_ranges];
+        uint64_t num_units_left = 0;
+        for (uint64_t j = i; j < index->num_units; j++) num_units_left += !units[j].has_aranges;
+        uint64_t max_ranges = max_range - unit_ranges - (num_units_left - 1);
+        
+        uint64_t num_rows, num_ranges;
+        if (!elfparser_run_line_program(index, &program, NULL, 0, &num_rows, unit_ranges, max_ranges, &num_ranges) ||
+            num_ranges == 0) {
+            continue;
+        }
+        
+        for (uint64_t j = 0; j < num_ranges; j++) unit_ranges[j].unit = i;
+        index->num_ranges += num_ranges;
+    }
+    
+    elfparser_sort_line_ranges(index);
+}
+
+
+ElfParser_Error elfparser_line_index_find(ElfParser_LineIndex* index, uint64_t address, ElfParser_LineInfo* info_out) {
+    const ElfParser_LineRange* ranges = index->ranges;
+    
+    while (true) {
+        // Find the last range starting at or before address, then go back through every range which may overlap it
+        uint64_t low = 0, num = index->num_ranges;
+        while (num > 0) {
+            uint64_t half = num / 2;
+            if (ranges[low + half].begin <= address) {
+                low += half + 1;
+                num -= half + 1;
+            } else {
+                num = half;
+            }
+        }
+        
+        for (uint64_t i = low; i > 0 && ranges[i - 1].max_end > address; i--) {
+            const ElfParser_LineRange* range = &ranges[i - 1];
+            if (address >= range->end) continue;
+            
+            ElfParser_LineUnit* unit = &((ElfParser_LineUnit*)index->units)[range->unit];
+            ElfParser_Error err = elfparser_load_line_unit(index, unit);
+            if (err == ELFPARSER_NOERROR) err = elfparser_find_line_in_unit(index, unit, address, info_out);
+            if (err != ELFPARSER_NOT_FOUND) return err;
+        }
+        
+        if (index->has_unit_ranges) return ELFPARSER_NOT_FOUND;
+        elfparser_add_unit_line_ranges(index);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,522 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+// Back-references in deflate data reach at most this far into the output
+#define INFLATE_WINDOW_SIZE     32768
+#define INFLATE_MAX_MATCH       258
+
+// Codes up to this long are decoded with a single table lookup, longer ones bit by bit
+#define INFLATE_FAST_BITS       10
+#define INFLATE_FAST_MASK       ((1 << INFLATE_FAST_BITS) - 1)
+
+typedef struct {
+    const uint8_t*          ptr;
+    const uint8_t*          end;
+    uint64_t                bits;
+    uint32_t                num_bits;
+    uint32_t                padding_bits;   // Zero bits added past the end of the data
+} ElfParser_BitReader;
+
+typedef struct {
+    uint16_t                fast[1 << INFLATE_FAST_BITS];   // Symbol << 4 | code length, 0 if the code is longer
+    uint16_t                counts[16];     // Number of codes of each length
+    uint16_t                symbols[288];   // Symbols ordered by code
+} ElfParser_Huffman;
+
+typedef struct {
+    uint8_t*                buffer;
+    uint64_t                buffer_size;
+    uint64_t                pos;            // End of the output in buffer
+    uint64_t                flushed;        // End of the output already passed to the callback
+    uint64_t                offset;         // Position of buffer[0] in the decompressed data
+    uint64_t                size;           // Expected size of the decompressed data
+    uint64_t                limit;          // Output can go up to here in buffer without calling elfparser_reserve_output
+    uint32_t                adler_a;
+    uint32_t                adler_b;
+    ElfParser_DecompressCallback callback;  // NULL if buffer holds all of the output
+    void*                   user_data;
+} ElfParser_InflateOutput;
+
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t distance_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+static const uint8_t distance_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order in which code length code lengths are stored in a dynamic block
+static const uint8_t code_length_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+ElfParser_Error elfparser_get_section_contents(const void* elf_start, const ElfParser_Header* header,
+                                               const ElfParser_SectionHeader* section,
+                                               ElfParser_SectionContents* contents_out) {
+    memset(contents_out, 0, sizeof(ElfParser_SectionContents));
+    contents_out->size      = section->sh_size;
+    contents_out->alignment = section->sh_addralign;
+    
+    // Section takes up no space in the file, but its contents are all 0s
+    if (section->sh_type == ELFPARSER_SHT_NOBITS) return ELFPARSER_NOERROR;
+    
+    if (section->sh_offset > header->elf_size || section->sh_size > header->elf_size - section->sh_offset) {
+        return ELFPARSER_INVALID;
+    }
+    contents_out->data      = elf_start + section->sh_offset;
+    contents_out->data_size = section->sh_size;
+    if (!(section->sh_flags & ELFPARSER_SHF_COMPRESSED)) return ELFPARSER_NOERROR;
+    
+    // The data starts with an Elf32_Chdr or Elf64_Chdr
+    const uint8_t* chdr = contents_out->data;
+    uint64_t chdr_size = elfparser_get_word_size(header) == 4 ? 12 : 24;
+    if (section->sh_size < chdr_size) return ELFPARSER_INVALID;
+    
+    contents_out->is_compressed     = true;
+    contents_out->compression_type  = elfparser_read_32(header, chdr);
+    if (chdr_size == 12) {
+        contents_out->size          = elfparser_read_32(header, chdr + 4);
+        contents_out->alignment     = elfparser_read_32(header, chdr + 8);
+    } else {
+        contents_out->size          = elfparser_read_64(header, chdr + 8);
+        contents_out->alignment     = elfparser_read_64(header, chdr + 16);
+    }
+    contents_out->data      += chdr_size;
+    contents_out->data_size -= chdr_size;
+    return ELFPARSER_NOERROR;
+}
+
+
+// Tops up the bit buffer to at least 57 bits. Past the end of the data, 0s are added and counted so reading them can be
+// detected
+static inline void elfparser_refill_bits(ElfParser_BitReader* reader) {
+    if (reader->end - reader->ptr >= 8) {
+        // Read a whole word and keep as many of its bytes as fit. Deflate data is little-endian
+        uint64_t word;
+        memcpy(&word, reader->ptr, 8);
+        reader->bits        |= convert_endian_64(word, true) << reader->num_bits;
+        reader->ptr         += (63 - reader->num_bits) >> 3;
+        reader->num_bits    |= 56;
+        return;
+    }
+    
+    while (reader->num_bits <= 56) {
+        if (reader->ptr < reader->end) {
+            reader->bits |= (uint64_t)*reader->ptr++ << reader->num_bits;
+        } else {
+            reader->padding_bits += 8;
+        }
+        reader->num_bits += 8;
+    }
+}
+
+
+static inline uint32_t elfparser_read_bits(ElfParser_BitReader* reader, uint32_t num) {
+    elfparser_refill_bits(reader);
+    uint32_t value = reader->bits & ((1ULL << num) - 1);
+    reader->bits >>= num;
+    reader->num_bits -= num;
+    return value;
+}
+
+
+// Returns true if more bits were read than there is data
+static inline bool elfparser_is_past_end(const ElfParser_BitReader* reader) {
+    return reader->padding_bits > reader->num_bits;
+}
+
+
+// Builds the decoding tables of a canonical Huffman code from the code length of each symbol. Incomplete codes are
+// allowed, since a block may use a single distance code
+static bool elfparser_build_huffman(ElfParser_Huffman* huffman, const uint8_t* lengths, uint32_t num_symbols) {
+    memset(huffman->counts, 0, sizeof(huffman->counts));
+    memset(huffman->fast, 0, sizeof(huffman->fast));
+    for (uint32_t i = 0; i < num_symbols; i++) huffman->counts[lengths[i]]++;
+    huffman->counts[0] = 0;
+    
+    int32_t left = 1;
+    uint16_t offsets[16];
+    uint32_t next_code[16];
+    offsets[1] = 0;
+    next_code[1] = 0;
+    for (uint32_t length = 1; length < 16; length++) {
+        left = (left << 1) - huffman->counts[length];
+        if (left < 0) return false;
+        
+        if (length < 15) {
+            offsets[length + 1] = offsets[length] + huffman->counts[length];
+            next_code[length + 1] = (next_code[length] + huffman->counts[length]) << 1;
+        }
+    }
+    
+    for (uint32_t symbol = 0; symbol < num_symbols; symbol++) {
+        uint32_t length = lengths[symbol];
+        if (length == 0) continue;
+        huffman->symbols[offsets[length]++] = symbol;
+        
+        uint32_t code = next_code[length]++;
+        if (length > INFLATE_FAST_BITS) continue;
+        
+        // Codes are stored starting from their most significant bit, so the table is indexed by the reversed code
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+        for (uint32_t i = reversed; i < (1 << INFLATE_FAST_BITS); i += 1 << length) {
+            huffman->fast[i] = symbol << 4 | length;
+        }
+    }
+    return true;
+}
+
+
+// Returns the next symbol, or -1 if the bits don't match any code
+static inline int32_t elfparser_decode_symbol(ElfParser_BitReader* reader, const ElfParser_Huffman* huffman) {
+    elfparser_refill_bits(reader);
+    uint16_t entry = huffman->fast[reader->bits & INFLATE_FAST_MASK];
+    if (entry != 0) {
+        reader->bits >>= entry & 15;
+        reader->num_bits -= entry & 15;
+        return entry >> 4;
+    }
+    
+    // Walk through the codes one length at a time - codes of each length are consecutive
+    int32_t code = 0, first = 0, index = 0;
+    for (uint32_t length = 1; length < 16; length++) {
+        code |= (reader->bits >> (length - 1)) & 1;
+        int32_t count = huffman->counts[length];
+        if (code - first < count) {
+            reader->bits >>= length;
+            reader->num_bits -= length;
+            return huffman->symbols[index + code - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+
+// Adds the output from start up to pos to the Adler-32 checksum
+static void elfparser_update_adler32(ElfParser_InflateOutput* output, uint64_t start) {
+    uint32_t a = output->adler_a, b = output->adler_b;
+    const uint8_t* ptr = output->buffer + start;
+    uint64_t size = output->pos - start;
+    
+    while (size > 0) {
+        // Largest number of bytes before b could overflow
+        uint64_t block = size < 5552 ? size : 5552;
+        size -= block;
+        while (block--) {
+            a += *ptr++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    output->adler_a = a;
+    output->adler_b = b;
+}
+
+
+// Sets the limit of the output in buffer, which is the end of buffer or of the decompressed data, whichever comes first
+static void elfparser_update_output_limit(ElfParser_InflateOutput* output) {
+    uint64_t left = output->size - output->offset;
+    output->limit = left < output->buffer_size ? left : output->buffer_size;
+}
+
+
+// Makes room for `size` more bytes of output. In a stream, the output so far is passed to the callback, and the end of
+// it is kept as the window for back-references
+static bool elfparser_reserve_output(ElfParser_InflateOutput* output, uint64_t size) {
+    if (output->offset + output->pos + size > output->size) return false;
+    if (output->pos + size <= output->buffer_size) return true;
+    if (output->callback == NULL) return false;
+    
+    elfparser_update_adler32(output, output->flushed);
+    if (!output->callback(output->buffer + output->flushed, output->pos - output->flushed,
+                          output->offset + output->flushed, output->user_data)) {
+        return false;
+    }
+    
+    uint64_t keep = output->pos < INFLATE_WINDOW_SIZE ? output->pos : INFLATE_WINDOW_SIZE;
+    memmove(output->buffer, output->buffer + output->pos - keep, keep);
+    output->offset  += output->pos - keep;
+    output->pos     = keep;
+    output->flushed = keep;
+    elfparser_update_output_limit(output);
+    return true;
+}
+
+
+static bool elfparser_inflate_stored_block(ElfParser_BitReader* reader, ElfParser_InflateOutput* output) {
+    // Skip to a byte boundary, then give back the whole bytes left in the bit buffer
+    elfparser_read_bits(reader, reader->num_bits % 8);
+    if (elfparser_is_past_end(reader)) return false;
+    uint32_t num_bytes = (reader->num_bits - reader->padding_bits) / 8;
+    reader->ptr         -= num_bytes;
+    reader->bits        = 0;
+    reader->num_bits    = 0;
+    reader->padding_bits = 0;
+    
+    if (reader->end - reader->ptr < 4) return false;
+    uint32_t length = reader->ptr[0] | reader->ptr[1] << 8;
+    uint32_t inverse = reader->ptr[2] | reader->ptr[3] << 8;
+    reader->ptr += 4;
+    if (length != (~inverse & 0xffff) || (uint64_t)(reader->end - reader->ptr) < length) return false;
+    
+    while (length > 0) {
+        uint32_t chunk = length < INFLATE_WINDOW_SIZE ? length : INFLATE_WINDOW_SIZE;
+        if (!elfparser_reserve_output(output, chunk)) return false;
+        memcpy(output->buffer + output->pos, reader->ptr, chunk);
+        output->pos += chunk;
+        reader->ptr += chunk;
+        length      -= chunk;
+    }
+    return true;
+}
+
+
+static bool elfparser_read_dynamic_codes(ElfParser_BitReader* reader, ElfParser_Huffman* literals,
+                                         ElfParser_Huffman* distances) {
+    uint32_t num_literals   = elfparser_read_bits(reader, 5) + 257;
+    uint32_t num_distances  = elfparser_read_bits(reader, 5) + 1;
+    uint32_t num_lengths    = elfparser_read_bits(reader, 4) + 4;
+    if (num_literals > 286 || num_distances > 30) return false;
+    
+    uint8_t lengths[288 + 32] = { 0 };
+    for (uint32_t i = 0; i < num_lengths; i++) lengths[code_length_order[i]] = elfparser_read_bits(reader, 3);
+    
+    // The code lengths of both codes are themselves Huffman coded, with run-length codes
+    ElfParser_Huffman length_code;
+    if (!elfparser_build_huffman(&length_code, lengths, 19)) return false;
+    
+    memset(lengths, 0, 19);
+    uint32_t num = num_literals + num_distances;
+    for (uint32_t i = 0; i < num;) {
+        int32_t symbol = elfparser_decode_symbol(reader, &length_code);
+        if (symbol < 0) return false;
+        
+        if (symbol < 16) {
+            lengths[i++] = symbol;
+            continue;
+        }
+        
+        uint8_t value = 0;
+        uint32_t repeat;
+        if (symbol == 16) {
+            if (i == 0) return false;
+            value = lengths[i - 1];
+            repeat = 3 + elfparser_read_bits(reader, 2);
+        } else if (symbol == 17) {
+            repeat = 3 + elfparser_read_bits(reader, 3);
+        } else {
+            repeat = 11 + elfparser_read_bits(reader, 7);
+        }
+        if (repeat > num - i) return false;
+        while (repeat--) lengths[i++] = value;
+    }
+    
+    // The end of block code must exist
+    if (lengths[256] == 0) return false;
+    return elfparser_build_huffman(literals, lengths, num_literals) &&
+           elfparser_build_huffman(distances, lengths + num_literals, num_distances);
+}
+
+
+static void elfparser_get_fixed_codes(ElfParser_Huffman* literals, ElfParser_Huffman* distances) {
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    elfparser_build_huffman(literals, lengths, 288);
+    
+    memset(lengths, 5, 30);
+    elfparser_build_huffman(distances, lengths, 30);
+}
+
+
+static bool elfparser_inflate_huffman_block(ElfParser_BitReader* reader, ElfParser_InflateOutput* output,
+                                            const ElfParser_Huffman* literals, const ElfParser_Huffman* distances) {
+    while (true) {
+        int32_t symbol = elfparser_decode_symbol(reader, literals);
+        if (symbol < 0 || elfparser_is_past_end(reader)) return false;
+        
+        if (symbol < 256) {
+            if (output->pos + 1 > output->limit && !elfparser_reserve_output(output, 1)) return false;
+            output->buffer[output->pos++] = symbol;
+            continue;
+        }
+        if (symbol == 256) return true;
+        
+        symbol -= 257;
+        if (symbol >= 29) return false;
+        uint32_t length = length_base[symbol] + elfparser_read_bits(reader, length_extra[symbol]);
+        
+        symbol = elfparser_decode_symbol(reader, distances);
+        if (symbol < 0 || symbol >= 30) return false;
+        uint32_t distance = distance_base[symbol] + elfparser_read_bits(reader, distance_extra[symbol]);
+        
+        if (output->pos + length > output->limit && !elfparser_reserve_output(output, length)) return false;
+        if (distance > output->pos) return false;
+        uint8_t* dest = output->buffer + output->pos;
+        const uint8_t* src = dest - distance;
+        output->pos += length;
+        
+        if (distance >= 8 && output->pos + 8 <= output->buffer_size) {
+            // Copy 8 bytes at a time, possibly past the end of the match - those bytes are overwritten later
+            for (uint32_t i = 0; i < length; i += 8) memcpy(dest + i, src + i, 8);
+        } else {
+            // Overlapping copies repeat the last `distance` bytes
+            while (length--) *dest++ = *src++;
+        }
+    }
+}
+
+
+// Decompresses zlib data (RFC 1950 and 1951) into output, checking the Adler-32 checksum at the end
+static ElfParser_Error elfparser_inflate(const uint8_t* data, uint64_t data_size, ElfParser_InflateOutput* output) {
+    // Compression method 8 (deflate), no preset dictionary, and a header checksum
+    if (data_size < 6 || (data[0] & 0x0f) != 8 || (data[0] >> 4) > 7 || (data[1] & 0x20) ||
+        (data[0] << 8 | data[1]) % 31 != 0) {
+        return ELFPARSER_INVALID;
+    }
+    
+    ElfParser_BitReader reader = { .ptr = data + 2, .end = data + data_size - 4 };
+    ElfParser_Huffman literals, distances;
+    output->adler_a = 1;
+    output->adler_b = 0;
+    elfparser_update_output_limit(output);
+    
+    bool is_final = false;
+    while (!is_final) {
+        is_final = elfparser_read_bits(&reader, 1);
+        uint32_t type = elfparser_read_bits(&reader, 2);
+        
+        bool ok;
+        if (type == 0) {
+            ok = elfparser_inflate_stored_block(&reader, output);
+        } else if (type == 1) {
+            elfparser_get_fixed_codes(&literals, &distances);
+            ok = elfparser_inflate_huffman_block(&reader, output, &literals, &distances);
+        } else if (type == 2) {
+            ok = elfparser_read_dynamic_codes(&reader, &literals, &distances) &&
+                 elfparser_inflate_huffman_block(&reader, output, &literals, &distances);
+        } else {
+            ok = false;
+        }
+        if (!ok || elfparser_is_past_end(&reader)) return ELFPARSER_INVALID;
+    }
+    if (output->offset + output->pos != output->size) return ELFPARSER_INVALID;
+    
+    elfparser_update_adler32(output, output->flushed);
+    uint32_t adler = (uint32_t)data[data_size - 4] << 24 | data[data_size - 3] << 16 | data[data_size - 2] << 8 |
+                     data[data_size - 1];
+    if (adler != (output->adler_b << 16 | output->adler_a)) return ELFPARSER_INVALID;
+    
+    if (output->callback != NULL && output->pos > output->flushed &&
+        !output->callback(output->buffer + output->flushed, output->pos - output->flushed,
+                          output->offset + output->flushed, output->user_data)) {
+        return ELFPARSER_INVALID;
+    }
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_decompress_section(const void* elf_start, const ElfParser_Header* header,
+                                             const ElfParser_SectionHeader* section, void* dest, uint64_t dest_size) {
+    ElfParser_SectionContents contents;
+    ElfParser_Error err = elfparser_get_section_contents(elf_start, header, section, &contents);
+    if (err != ELFPARSER_NOERROR) return err;
+    if (dest_size < contents.size) return ELFPARSER_INVALID;
+    
+    if (!contents.is_compressed) {
+        if (contents.data == NULL) {
+            memset(dest, 0, contents.size);
+        } else {
+            memcpy(dest, contents.data, contents.size);
+        }
+        return ELFPARSER_NOERROR;
+    }
+    if (contents.compression_type != ELFPARSER_ELFCOMPRESS_ZLIB) return ELFPARSER_NOT_FOUND;
+    
+    ElfParser_InflateOutput output = { .buffer = dest, .buffer_size = contents.size, .size = contents.size };
+    return elfparser_inflate(contents.data, contents.data_size, &output);
+}
+
+
+ElfParser_Error elfparser_decompress_section_stream(const void* elf_start, const ElfParser_Header* header,
+                                                    const ElfParser_SectionHeader* section, void* buffer,
+                                                    uint64_t buffer_size, ElfParser_DecompressCallback callback,
+                                                    void* user_data) {
+    ElfParser_SectionContents contents;
+    ElfParser_Error err = elfparser_get_section_contents(elf_start, header, section, &contents);
+    if (err != ELFPARSER_NOERROR) return err;
+    if (buffer_size < ELFPARSER_DECOMPRESS_MIN_BUFFER_SIZE) return ELFPARSER_INVALID;
+    
+    if (!contents.is_compressed) {
+        // Uncompressed sections are passed straight from the file, except .bss-like sections which are passed as 0s
+        if (contents.data != NULL) {
+            if (contents.size > 0 && !callback(contents.data, contents.size, 0, user_data)) return ELFPARSER_INVALID;
+            return ELFPARSER_NOERROR;
+        }
+        
+        memset(buffer, 0, buffer_size);
+        for (uint64_t offset = 0; offset < contents.size; offset += buffer_size) {
+            uint64_t size = contents.size - offset < buffer_size ? contents.size - offset : buffer_size;
+            if (!callback(buffer, size, offset, user_data)) return ELFPARSER_INVALID;
+        }
+        return ELFPARSER_NOERROR;
+    }
+    if (contents.compression_type != ELFPARSER_ELFCOMPRESS_ZLIB) return ELFPARSER_NOT_FOUND;
+    
+    ElfParser_InflateOutput output = {
+        .buffer = buffer, .buffer_size = buffer_size, .size = contents.size, .callback = callback, .user_data = user_data
+    };
+    return elfparser_inflate(contents.data, contents.data_size, &output);
+}
+
+
+ElfParser_Error elfparser_decompress_sections(const void* elf_start, const ElfParser_Header* header,
+                                              ElfParser_DecompressJob* jobs, uint64_t num) {
+    ElfParser_Error result = ELFPARSER_NOERROR;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        ElfParser_SectionHeader section;
+        jobs[i].error = elfparser_get_section_header(elf_start, header, jobs[i].index, &section);
+        
+        if (jobs[i].error == ELFPARSER_NOERROR) {
+            jobs[i].error = elfparser_decompress_section(elf_start, header, &section, jobs[i].dest, jobs[i].dest_size);
+        }
+        if (jobs[i].error != ELFPARSER_NOERROR) result = ELFPARSER_INVALID;
+    }
+    return result;
+}
\ No newline at end of file
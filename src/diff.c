@@ -0,0 +1,238 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+// Sections and symbols are matched by name - entries are sorted by name, then by index so that duplicate names are
+// paired up in the order they appear in each file
+typedef struct {
+    const char*     name;
+    uint64_t        index;
+} ElfParser_DiffName;
+
+typedef struct {
+    const void*                 old_start;
+    const ElfParser_Header*     old_header;
+    const void*                 new_start;
+    const ElfParser_Header*     new_header;
+    ElfParser_DiffCallback      callback;
+    void*                       user_data;
+} ElfParser_DiffContext;
+
+
+static bool elfparser_is_diff_name_less(const void* a, const void* b, const void* context) {
+    const ElfParser_DiffName* name_a = a;
+    const ElfParser_DiffName* name_b = b;
+    
+    int cmp = strcmp(name_a->name, name_b->name);
+    return cmp < 0 || (cmp == 0 && name_a->index < name_b->index);
+}
+
+
+static uint64_t elfparser_get_diff_section_names(const void* elf_start, const ElfParser_Header* header,
+                                                 ElfParser_DiffName* names) {
+    uint64_t num = 0;
+    
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.index == 0) continue;
+        
+        names[num].name     = elfparser_section_cursor_get_name(&cursor, &section);
+        names[num].index    = section.index;
+        num++;
+    }
+    
+    elfparser_sort(names, num, sizeof(ElfParser_DiffName), elfparser_is_diff_name_less, NULL);
+    return num;
+}
+
+
+static uint64_t elfparser_get_diff_symbol_names(const void* elf_start, const ElfParser_Header* header,
+                                                ElfParser_DiffName* names) {
+    uint64_t num = 0;
+    
+    ElfParser_SymbolCursor cursor;
+    elfparser_symbol_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        // Section and file symbols describe the layout of the file rather than anything in it
+        if (symbol.st_type == ELFPARSER_STT_SECTION || symbol.st_type == ELFPARSER_STT_FILE) continue;
+        
+        const char* name = elfparser_symbol_cursor_get_name(&cursor, &symbol);
+        if (name[0] == '\0') continue;
+        
+        names[num].name     = name;
+        names[num].index    = symbol.index;
+        num++;
+    }
+    
+    elfparser_sort(names, num, sizeof(ElfParser_DiffName), elfparser_is_diff_name_less, NULL);
+    return num;
+}
+
+
+static void elfparser_report_diff(const ElfParser_DiffContext* context, ElfParser_DiffKind kind, const char* name,
+                                  uint64_t old_index, uint64_t new_index, uint64_t old_value, uint64_t new_value) {
+    ElfParser_DiffEntry entry = {
+        .kind       = kind,
+        .name       = name,
+        .old_index  = old_index,
+        .new_index  = new_index,
+        .old_value  = old_value,
+        .new_value  = new_value
+    };
+    context->callback(&entry, context->user_data);
+}
+
+
+static void elfparser_diff_sections(const ElfParser_DiffContext* context, uint64_t old_index, uint64_t new_index) {
+    ElfParser_SectionHeader old_section;
+    ElfParser_SectionHeader new_section;
+    
+    // Indexes came from the cursors, so these can't fail
+    elfparser_get_section_header(context->old_start, context->old_header, old_index, &old_section);
+    elfparser_get_section_header(context->new_start, context->new_header, new_index, &new_section);
+    
+    if (old_section.sh_size != new_section.sh_size) {
+        elfparser_report_diff(context, ELFPARSER_DIFF_SECTION_RESIZED, new_section.name, old_index, new_index,
+                              old_section.sh_size, new_section.sh_size);
+        return;
+    }
+    
+    ElfParser_Digest old_digest;
+    ElfParser_Digest new_digest;
+    bool old_ok = elfparser_hash_section(context->old_start, context->old_header, &old_section,
+                                         ELFPARSER_HASH_XXH64, &old_digest) == ELFPARSER_NOERROR;
+    bool new_ok = elfparser_hash_section(context->new_start, context->new_header, &new_section,
+                                         ELFPARSER_HASH_XXH64, &new_digest) == ELFPARSER_NOERROR;
+    
+    // Contents which can't be read count as changed, unless neither can be read
+    if (old_ok != new_ok || (old_ok && memcmp(old_digest.digest, new_digest.digest, 8) != 0)) {
+        elfparser_report_diff(context, ELFPARSER_DIFF_SECTION_CHANGED, new_section.name, old_index, new_index,
+                              old_section.sh_size, new_section.sh_size);
+    }
+}
+
+
+static void elfparser_diff_symbols(const ElfParser_DiffContext* context, uint64_t old_index, uint64_t new_index) {
+    ElfParser_Symbol old_symbol;
+    ElfParser_Symbol new_symbol;
+    
+    elfparser_get_symbol(context->old_start, context->old_header, old_index, &old_symbol);
+    elfparser_get_symbol(context->new_start, context->new_header, new_index, &new_symbol);
+    
+    if (old_symbol.st_value != new_symbol.st_value) {
+        elfparser_report_diff(context, ELFPARSER_DIFF_SYMBOL_MOVED, new_symbol.name, old_index, new_index,
+                              old_symbol.st_value, new_symbol.st_value);
+    }
+    if (old_symbol.st_size != new_symbol.st_size) {
+        elfparser_report_diff(context, ELFPARSER_DIFF_SYMBOL_RESIZED, new_symbol.name, old_index, new_index,
+                              old_symbol.st_size, new_symbol.st_size);
+    }
+}
+
+
+// Walk both sorted name lists at once, reporting names only in one list and comparing entries present in both
+static void elfparser_merge_join(const ElfParser_DiffContext* context,
+                                 const ElfParser_DiffName* old_names, uint64_t old_num,
+                                 const ElfParser_DiffName* new_names, uint64_t new_num,
+                                 ElfParser_DiffKind added, ElfParser_DiffKind removed,
+                                 void (*compare)(const ElfParser_DiffContext*, uint64_t, uint64_t)) {
+    uint64_t i = 0;
+    uint64_t j = 0;
+    
+    while (i < old_num || j < new_num) {
+        int cmp;
+        if (i >= old_num)       cmp = 1;
+        else if (j >= new_num)  cmp = -1;
+        else                    cmp = strcmp(old_names[i].name, new_names[j].name);
+        
+        if (cmp < 0) {
+            elfparser_report_diff(context, removed, old_names[i].name, old_names[i].index, UINT64_MAX, 0, 0);
+            i++;
+        } else if (cmp > 0) {
+            elfparser_report_diff(context, added, new_names[j].name, UINT64_MAX, new_names[j].index, 0, 0);
+            j++;
+        } else {
+            compare(context, old_names[i].index, new_names[j].index);
+            i++;
+            j++;
+        }
+    }
+}
+
+
+uint64_t elfparser_get_diff_buffer_size(const ElfParser_Header* old_header, const ElfParser_Header* new_header) {
+    // Sections and symbols are compared one after the other, so the space is shared
+    uint64_t section_num = old_header->true_shnum + new_header->true_shnum;
+    uint64_t symbol_num = old_header->symbol_num + new_header->symbol_num;
+    
+    return sizeof(ElfParser_DiffName) * (section_num > symbol_num ? section_num : symbol_num) + 7;
+}
+
+
+ElfParser_Error elfparser_diff(const void* old_start, const ElfParser_Header* old_header,
+                               const void* new_start, const ElfParser_Header* new_header,
+                               void* buffer, uint64_t buffer_size,
+                               ElfParser_DiffCallback callback, void* user_data) {
+    if (callback == NULL) return ELFPARSER_INVALID;
+    if (buffer == NULL || buffer_size < elfparser_get_diff_buffer_size(old_header, new_header)) return ELFPARSER_INVALID;
+    
+    ElfParser_DiffContext context = {
+        .old_start  = old_start,
+        .old_header = old_header,
+        .new_start  = new_start,
+        .new_header = new_header,
+        .callback   = callback,
+        .user_data  = user_data
+    };
+    
+    ElfParser_DiffName* old_names = (ElfParser_DiffName*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+    ElfParser_DiffName* new_names;
+    uint64_t old_num;
+    uint64_t new_num;
+    
+    // Sections first
+    old_num = elfparser_get_diff_section_names(old_start, old_header, old_names);
+    new_names = old_names + old_num;
+    new_num = elfparser_get_diff_section_names(new_start, new_header, new_names);
+    
+    elfparser_merge_join(&context, old_names, old_num, new_names, new_num,
+                         ELFPARSER_DIFF_SECTION_ADDED, ELFPARSER_DIFF_SECTION_REMOVED, elfparser_diff_sections);
+    
+    // Then symbols, reusing the same space
+    old_num = elfparser_get_diff_symbol_names(old_start, old_header, old_names);
+    new_names = old_names + old_num;
+    new_num = elfparser_get_diff_symbol_names(new_start, new_header, new_names);
+    
+    elfparser_merge_join(&context, old_names, old_num, new_names, new_num,
+                         ELFPARSER_DIFF_SYMBOL_ADDED, ELFPARSER_DIFF_SYMBOL_REMOVED, elfparser_diff_symbols);
+    
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include "parse.h"
+
+// This file should *not* be included! It is used as an interface for the implementation
+// Any functions here should be considered private
+
+// Readers for the variable length encodings of DWARF data. Each one reads from *ptr, which must be before end, and
+// advances it past the value - returns false without reading anything if the value would run past end
+
+static inline bool elfparser_read_uleb128(const uint8_t** ptr, const uint8_t* end, uint64_t* value_out) {
+    uint64_t value = 0;
+    const uint8_t* position = *ptr;
+    
+    for (uint64_t shift = 0; position < end; shift += 7) {
+        uint8_t byte = *position++;
+        if (shift < 64) value |= (uint64_t)(byte & 0x7f) << shift;
+        
+        if (!(byte & 0x80)) {
+            *value_out = value;
+            *ptr = position;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline bool elfparser_read_sleb128(const uint8_t** ptr, const uint8_t* end, int64_t* value_out) {
+    uint64_t value = 0;
+    const uint8_t* position = *ptr;
+    
+    for (uint64_t shift = 0; position < end; shift += 7) {
+        uint8_t byte = *position++;
+        if (shift < 64) value |= (uint64_t)(byte & 0x7f) << shift;
+        
+        if (!(byte & 0x80)) {
+            // Sign extend from the last bit read
+            if (shift + 7 < 64 && (byte & 0x40)) value |= UINT64_MAX << (shift + 7);
+            *value_out = (int64_t)value;
+            *ptr = position;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline bool elfparser_read_fixed(const ElfParser_Header* header, const uint8_t** ptr, const uint8_t* end,
+                                        uint64_t size, uint64_t* value_out) {
+    if ((uint64_t)(end - *ptr) < size) return false;
+    
+    switch (size) {
+        case 1:     *value_out = **ptr;                             break;
+        case 2:     *value_out = elfparser_read_16(header, *ptr);   break;
+        case 4:     *value_out = elfparser_read_32(header, *ptr);   break;
+        default:    *value_out = elfparser_read_64(header, *ptr);   break;
+    }
+    *ptr += size;
+    return true;
+}
+
+
+// Addresses which ElfParser_DW_EH_PE encoded pointers can be relative to
+typedef struct {
+    const uint8_t*  data_start;     // Start of the data being read, at address data_vaddr
+    uint64_t        data_vaddr;
+    uint64_t        datarel;        // Base for ELFPARSER_DW_EH_PE_DATAREL
+    uint64_t        funcrel;        // Base for ELFPARSER_DW_EH_PE_FUNCREL
+} ElfParser_PointerBases;
+
+// Reads an ElfParser_DW_EH_PE encoded pointer. Indirect pointers are read from the file through the PT_LOAD segments
+// Returns false if the value runs past end, or the encoding is unknown or ELFPARSER_DW_EH_PE_OMIT
+bool elfparser_read_encoded_pointer(const void* elf_start, const ElfParser_Header* header, const uint8_t** ptr,
+                                    const uint8_t* end, uint8_t encoding, const ElfParser_PointerBases* bases,
+                                    uint64_t* value_out);
\ No newline at end of file
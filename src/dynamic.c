@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+// Find the dynamic string table from DT_STRTAB and DT_STRSZ. Section headers aren't needed, so this works on stripped
+// files, but the section linked from .dynamic is used if DT_STRTAB doesn't lie within the file
+static void elfparser_find_dynamic_string_table(ElfParser_DynamicCursor* cursor, uint64_t dynamic_section_link) {
+    const ElfParser_Header* header = cursor->header;
+    uint64_t word_size = elfparser_get_word_size(header);
+    
+    uint64_t strtab = 0;
+    uint64_t strsz = UINT64_MAX;
+    bool found_strtab = false;
+    
+    for (uint64_t i = 0; i < cursor->num; i++) {
+        const void* entry = cursor->next + i * cursor->entry_size;
+        uint64_t tag = elfparser_read_word(header, entry);
+        uint64_t value = elfparser_read_word(header, entry + word_size);
+        
+        if (tag == ELFPARSER_DT_NULL) break;
+        if (tag == ELFPARSER_DT_STRTAB) {
+            strtab = value;
+            found_strtab = true;
+        }
+        if (tag == ELFPARSER_DT_STRSZ) strsz = value;
+    }
+    
+    uint64_t offset;
+    uint64_t size;
+    if (found_strtab && elfparser_get_vaddr_file_offset(cursor->elf_start, header, strtab, &offset, &size)) {
+        // `size` stops at the end of the file, so DT_STRSZ can't take the table past it
+        cursor->string_table_offset = offset;
+        cursor->string_table_size = strsz < size ? strsz : size;
+        return;
+    }
+    
+    ElfParser_SectionHeader section;
+    if (dynamic_section_link != 0 &&
+        elfparser_get_section_header(cursor->elf_start, header, dynamic_section_link, &section) == ELFPARSER_NOERROR &&
+        section.sh_offset <= header->elf_size) {
+        cursor->string_table_offset = section.sh_offset;
+        cursor->string_table_size = header->elf_size - section.sh_offset < section.sh_size ? header->elf_size - section.sh_offset
+                                                                                             : section.sh_size;
+    }
+}
+
+
+ElfParser_Error elfparser_dynamic_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                              ElfParser_DynamicCursor* cursor_out) {
+    // The dynamic linker finds the dynamic section through PT_DYNAMIC, so prefer that over the section header
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t section_link = 0;
+    bool found = false;
+    
+    ElfParser_ProgramHeaderCursor program_header_cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &program_header_cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&program_header_cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type == ELFPARSER_PT_DYNAMIC) {
+            offset  = program_header.p_offset;
+            size    = program_header.p_filesz;
+            found   = true;
+            break;
+        }
+    }
+    
+    ElfParser_SectionCursor section_cursor;
+    elfparser_section_cursor_init(elf_start, header, &section_cursor);
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&section_cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.sh_type == ELFPARSER_SHT_DYNAMIC) {
+            if (!found) {
+                offset  = section.sh_offset;
+                size    = section.sh_size;
+                found   = true;
+            }
+            section_link = section.sh_link;
+            break;
+        }
+    }
+    
+    uint64_t entry_size = elfparser_get_word_size(header) * 2;
+    
+    cursor_out->elf_start           = elf_start;
+    cursor_out->header              = header;
+    cursor_out->next                = elf_start + offset;
+    cursor_out->entry_size          = entry_size;
+    cursor_out->index               = 0;
+    cursor_out->num                 = elfparser_get_num_entries_in_bounds(header, offset, entry_size, entry_size,
+                                                                          size / entry_size);
+    cursor_out->string_table_offset = 0;
+    cursor_out->string_table_size   = 0;
+    
+    if (!found) return ELFPARSER_NOT_FOUND;
+    
+    elfparser_find_dynamic_string_table(cursor_out, section_link);
+    
+    return cursor_out->num == size / entry_size ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
+
+
+ElfParser_Error elfparser_dynamic_cursor_next(ElfParser_DynamicCursor* cursor, ElfParser_DynamicEntry* entry_out) {
+    if (cursor->index >= cursor->num) return ELFPARSER_NOT_FOUND;
+    
+    // Bounds were already checked when the cursor was initialized
+    entry_out->d_tag    = elfparser_read_word(cursor->header, cursor->next);
+    entry_out->d_val    = elfparser_read_word(cursor->header, cursor->next + elfparser_get_word_size(cursor->header));
+    entry_out->index    = cursor->index;
+    
+    // Table ends at DT_NULL - anything after it is padding
+    if (entry_out->d_tag == ELFPARSER_DT_NULL) {
+        cursor->index = cursor->num;
+        return ELFPARSER_NOT_FOUND;
+    }
+    
+    cursor->next += cursor->entry_size;
+    cursor->index++;
+    return ELFPARSER_NOERROR;
+}
+
+
+const char* elfparser_get_dynamic_string(const ElfParser_DynamicCursor* cursor, uint64_t offset) {
+    if (offset >= cursor->string_table_size) return "";
+    
+    // Check that the string is terminated within the string table
+    const char* string = cursor->elf_start + cursor->string_table_offset + offset;
+    if (memchr(string, '\0', cursor->string_table_size - offset) == NULL) return "";
+    return string;
+}
+
+
+ElfParser_Error elfparser_get_dynamic_info(const void* elf_start, const ElfParser_Header* header,
+                                           ElfParser_DynamicInfo* info_out) {
+    info_out->soname        = "";
+    info_out->rpath         = "";
+    info_out->runpath       = "";
+    info_out->num_needed    = 0;
+    info_out->flags         = 0;
+    info_out->flags_1       = 0;
+    
+    ElfParser_DynamicCursor cursor;
+    if (elfparser_dynamic_cursor_init(elf_start, header, &cursor) == ELFPARSER_NOT_FOUND) return ELFPARSER_NOT_FOUND;
+    
+    ElfParser_DynamicEntry entry;
+    while (elfparser_dynamic_cursor_next(&cursor, &entry) == ELFPARSER_NOERROR) {
+        switch (entry.d_tag) {
+            case ELFPARSER_DT_NEEDED:   info_out->num_needed++;                                                 break;
+            case ELFPARSER_DT_SONAME:   info_out->soname = elfparser_get_dynamic_string(&cursor, entry.d_val);  break;
+            case ELFPARSER_DT_RPATH:    info_out->rpath = elfparser_get_dynamic_string(&cursor, entry.d_val);   break;
+            case ELFPARSER_DT_RUNPATH:  info_out->runpath = elfparser_get_dynamic_string(&cursor, entry.d_val); break;
+            case ELFPARSER_DT_FLAGS:    info_out->flags = entry.d_val;                                          break;
+            case ELFPARSER_DT_FLAGS_1:  info_out->flags_1 = entry.d_val;                                        break;
+            default:                                                                                            break;
+        }
+    }
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
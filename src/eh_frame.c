@@ -0,0 +1,683 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "dwarf.h"
+#include "sort.h"
+
+
+#define EH_FRAME_HDR_VERSION    1
+
+// Entry of a table built by elfparser_build_fde_table
+typedef struct {
+    uint64_t    pc_begin;
+    uint64_t    pc_end;
+    uint64_t    offset;     // File offset of the FDE
+} ElfParser_FdeIndexEntry;
+
+
+bool elfparser_read_encoded_pointer(const void* elf_start, const ElfParser_Header* header, const uint8_t** ptr,
+                                    const uint8_t* end, uint8_t encoding, const ElfParser_PointerBases* bases,
+                                    uint64_t* value_out) {
+    if (encoding == ELFPARSER_DW_EH_PE_OMIT) return false;
+    
+    const uint8_t* start = *ptr;
+    uint64_t word_size = elfparser_get_word_size(header);
+    uint64_t value;
+    
+    // Aligned pointers are word sized and start at the next word boundary of the address
+    if ((encoding & 0x70) == ELFPARSER_DW_EH_PE_ALIGNED) {
+        uint64_t vaddr = bases->data_vaddr + (start - bases->data_start);
+        uint64_t padding = (word_size - vaddr % word_size) % word_size;
+        if ((uint64_t)(end - start) < padding) return false;
+        
+        *ptr += padding;
+        if (!elfparser_read_fixed(header, ptr, end, word_size, &value)) return false;
+    } else {
+        bool ok;
+        int64_t signed_value;
+        
+        switch (encoding & 0x0f) {
+            case ELFPARSER_DW_EH_PE_ABSPTR:     ok = elfparser_read_fixed(header, ptr, end, word_size, &value); break;
+            case ELFPARSER_DW_EH_PE_ULEB128:    ok = elfparser_read_uleb128(ptr, end, &value);                  break;
+            case ELFPARSER_DW_EH_PE_UDATA2:     ok = elfparser_read_fixed(header, ptr, end, 2, &value);         break;
+            case ELFPARSER_DW_EH_PE_UDATA4:     ok = elfparser_read_fixed(header, ptr, end, 4, &value);         break;
+            case ELFPARSER_DW_EH_PE_UDATA8:     ok = elfparser_read_fixed(header, ptr, end, 8, &value);         break;
+            case ELFPARSER_DW_EH_PE_SLEB128:
+                ok = elfparser_read_sleb128(ptr, end, &signed_value);
+                value = signed_value;
+                break;
+            case ELFPARSER_DW_EH_PE_SDATA2:
+                ok = elfparser_read_fixed(header, ptr, end, 2, &value);
+                value = (int16_t)value;
+                break;
+            case ELFPARSER_DW_EH_PE_SDATA4:
+                ok = elfparser_read_fixed(header, ptr, end, 4, &value);
+                value = (int32_t)value;
+                break;
+            case ELFPARSER_DW_EH_PE_SDATA8:     ok = elfparser_read_fixed(header, ptr, end, 8, &value);         break;
+            default:                            ok = false;                                                     break;
+        }
+        if (!ok) return false;
+        
+        switch (encoding & 0x70) {
+            case 0:                             break;
+            case ELFPARSER_DW_EH_PE_PCREL:      value += bases->data_vaddr + (start - bases->data_start);   break;
+            case ELFPARSER_DW_EH_PE_DATAREL:    value += bases->datarel;                                    break;
+            case ELFPARSER_DW_EH_PE_FUNCREL:    value += bases->funcrel;                                    break;
+            default:                            return false;
+        }
+    }
+    
+    // Word sized values of 32-bit files wrap around
+    if (word_size == 4) value &= UINT32_MAX;
+    
+    if (encoding & ELFPARSER_DW_EH_PE_INDIRECT) {
+        uint64_t offset, size;
+        if (!elfparser_get_vaddr_file_offset(elf_start, header, value, &offset, &size) || size < word_size ||
+            offset > header->elf_size || header->elf_size - offset < word_size) {
+            return false;
+        }
+        value = elfparser_read_word(header, elf_start + offset);
+    }
+    
+    *value_out = value;
+    return true;
+}
+
+
+// Reads the header of the .eh_frame or .debug_frame record at `offset`. The record data runs from data_out to
+// record_end_out. cie_offset_out is the file offset of the CIE of an FDE, or UINT64_MAX if the record is a CIE itself
+// Returns false if the record doesn't fit in the section, e.g. at the zero length terminator of .eh_frame
+static bool elfparser_read_frame_record(const ElfParser_FdeTable* table, uint64_t offset, const uint8_t** data_out,
+                                        const uint8_t** record_end_out, uint64_t* cie_offset_out) {
+    const uint8_t* start = table->elf_start + table->eh_frame_offset;
+    const uint8_t* end = start + table->eh_frame_size;
+    if (offset < table->eh_frame_offset || offset - table->eh_frame_offset >= table->eh_frame_size) return false;
+    
+    const uint8_t* ptr = table->elf_start + offset;
+    uint64_t length;
+    bool is_64 = false;
+    if (!elfparser_read_fixed(table->header, &ptr, end, 4, &length)) return false;
+    if (length == 0xffffffff) {
+        if (!elfparser_read_fixed(table->header, &ptr, end, 8, &length)) return false;
+        is_64 = true;
+    }
+    if (length > (uint64_t)(end - ptr)) return false;
+    *record_end_out = ptr + length;
+    
+    // The ID is always 4 bytes in .eh_frame, but is 8 bytes in 64-bit .debug_frame
+    const uint8_t* id = ptr;
+    uint64_t id_size = table->is_debug_frame && is_64 ? 8 : 4;
+    uint64_t id_value;
+    if (!elfparser_read_fixed(table->header, &ptr, *record_end_out, id_size, &id_value)) return false;
+    *data_out = ptr;
+    
+    if (table->is_debug_frame) {
+        // The CIE pointer of .debug_frame is an offset from the start of the section
+        if (id_value == (id_size == 8 ? UINT64_MAX : UINT32_MAX)) {
+            *cie_offset_out = UINT64_MAX;
+        } else if (id_value >= table->eh_frame_size) {
+            return false;
+        } else {
+            *cie_offset_out = table->eh_frame_offset + id_value;
+        }
+    } else {
+        // The CIE pointer of .eh_frame is the distance back to the CIE from the pointer itself
+        uint64_t id_offset = (const void*)id - table->elf_start;
+        if (id_value == 0) {
+            *cie_offset_out = UINT64_MAX;
+        } else if (id_value > id_offset) {
+            return false;
+        } else {
+            *cie_offset_out = id_offset - id_value;
+        }
+    }
+    return true;
+}
+
+
+// Decodes the CIE at `offset`. Without `is_full`, the personality routine is skipped rather than read (it may be behind
+// an indirect pointer) and left as 0, which is enough to decode the address range of its FDEs
+static ElfParser_Error elfparser_parse_cie(const ElfParser_FdeTable* table, uint64_t offset, bool is_full,
+                                           ElfParser_Cie* cie_out) {
+    const ElfParser_Header* header = table->header;
+    const uint8_t* ptr;
+    const uint8_t* end;
+    uint64_t cie_offset;
+    if (!elfparser_read_frame_record(table, offset, &ptr, &end, &cie_offset) || cie_offset != UINT64_MAX) {
+        return ELFPARSER_INVALID;
+    }
+    
+    ElfParser_PointerBases bases = {
+        .data_start = table->elf_start + table->eh_frame_offset,
+        .data_vaddr = table->eh_frame_vaddr,
+    };
+    
+    cie_out->offset         = offset;
+    cie_out->fde_encoding   = ELFPARSER_DW_EH_PE_ABSPTR;
+    cie_out->lsda_encoding  = ELFPARSER_DW_EH_PE_OMIT;
+    cie_out->personality    = 0;
+    cie_out->is_signal_frame = false;
+    
+    if (ptr >= end) return ELFPARSER_INVALID;
+    cie_out->version = *ptr++;
+    
+    const char* augmentation = (const char*)ptr;
+    const uint8_t* augmentation_end = memchr(ptr, '\0', end - ptr);
+    if (augmentation_end == NULL) return ELFPARSER_INVALID;
+    cie_out->augmentation = augmentation;
+    ptr = augmentation_end + 1;
+    
+    // Version 4 adds address and segment selector sizes. Addresses of .debug_frame are never encoded, but have the
+    // size of an address
+    uint8_t address_size = elfparser_get_word_size(header);
+    if (cie_out->version >= 4) {
+        if (end - ptr < 2) return ELFPARSER_INVALID;
+        address_size = *ptr;
+        ptr += 2;
+    }
+    if (table->is_debug_frame) {
+        if (address_size == 4)      cie_out->fde_encoding = ELFPARSER_DW_EH_PE_UDATA4;
+        else if (address_size == 8) cie_out->fde_encoding = ELFPARSER_DW_EH_PE_UDATA8;
+        else                        return ELFPARSER_INVALID;
+    }
+    
+    // Old GCC "eh" augmentation is followed by a pointer to exception data
+    if (augmentation[0] == 'e' && augmentation[1] == 'h') {
+        uint64_t word_size = elfparser_get_word_size(header);
+        if ((uint64_t)(end - ptr) < word_size) return ELFPARSER_INVALID;
+        ptr += word_size;
+    }
+    
+    uint64_t return_address_register;
+    if (!elfparser_read_uleb128(&ptr, end, &cie_out->code_alignment) ||
+        !elfparser_read_sleb128(&ptr, end, &cie_out->data_alignment)) {
+        return ELFPARSER_INVALID;
+    }
+    if (cie_out->version == 1) {
+        if (ptr >= end) return ELFPARSER_INVALID;
+        return_address_register = *ptr++;
+    } else if (!elfparser_read_uleb128(&ptr, end, &return_address_register)) {
+        return ELFPARSER_INVALID;
+    }
+    cie_out->return_address_register = return_address_register;
+    
+    if (augmentation[0] == 'z') {
+        uint64_t augmentation_size;
+        if (!elfparser_read_uleb128(&ptr, end, &augmentation_size) || augmentation_size > (uint64_t)(end - ptr)) {
+            return ELFPARSER_INVALID;
+        }
+        const uint8_t* data_end = ptr + augmentation_size;
+        
+        for (const char* c = augmentation + 1; *c != '\0'; c++) {
+            if (*c == 'L') {
+                if (ptr >= data_end) return ELFPARSER_INVALID;
+                cie_out->lsda_encoding = *ptr++;
+            } else if (*c == 'R') {
+                if (ptr >= data_end) return ELFPARSER_INVALID;
+                cie_out->fde_encoding = *ptr++;
+            } else if (*c == 'P') {
+                if (ptr >= data_end) return ELFPARSER_INVALID;
+                uint8_t encoding = *ptr++;
+                if (!is_full) encoding &= ~ELFPARSER_DW_EH_PE_INDIRECT;
+                if (!elfparser_read_encoded_pointer(table->elf_start, header, &ptr, data_end, encoding, &bases,
+                                                    &cie_out->personality)) {
+                    return ELFPARSER_INVALID;
+                }
+                if (!is_full) cie_out->personality = 0;
+            } else if (*c == 'S') {
+                cie_out->is_signal_frame = true;
+            } else if (*c != 'B' && *c != 'G') {
+                // Unknown augmentation - the size says where the data ends, but the rest of it can't be decoded
+                break;
+            }
+        }
+        ptr = data_end;
+    }
+    
+    cie_out->instructions_offset    = (const void*)ptr - table->elf_start;
+    cie_out->instructions_size      = end - ptr;
+    return ELFPARSER_NOERROR;
+}
+
+
+// Decodes an FDE. If `cie` already holds the FDE's CIE it is not parsed again
+static ElfParser_Error elfparser_parse_fde(const ElfParser_FdeTable* table, uint64_t offset, const ElfParser_Cie* cie,
+                                           ElfParser_Fde* fde_out) {
+    const uint8_t* ptr;
+    const uint8_t* end;
+    uint64_t cie_offset;
+    if (!elfparser_read_frame_record(table, offset, &ptr, &end, &cie_offset) || cie_offset == UINT64_MAX) {
+        return ELFPARSER_INVALID;
+    }
+    
+    if (cie != NULL && cie->offset == cie_offset) {
+        fde_out->cie = *cie;
+    } else if (elfparser_parse_cie(table, cie_offset, true, &fde_out->cie) != ELFPARSER_NOERROR) {
+        return ELFPARSER_INVALID;
+    }
+    
+    ElfParser_PointerBases bases = {
+        .data_start = table->elf_start + table->eh_frame_offset,
+        .data_vaddr = table->eh_frame_vaddr,
+    };
+    
+    // pc_range has the format of pc_begin, but isn't relative to anything
+    uint8_t encoding = fde_out->cie.fde_encoding;
+    if (!elfparser_read_encoded_pointer(table->elf_start, table->header, &ptr, end, encoding, &bases, &fde_out->pc_begin) ||
+        !elfparser_read_encoded_pointer(table->elf_start, table->header, &ptr, end, encoding & 0x0f, &bases,
+                                        &fde_out->pc_range)) {
+        return ELFPARSER_INVALID;
+    }
+    
+    fde_out->offset = offset;
+    fde_out->lsda = 0;
+    
+    if (fde_out->cie.augmentation[0] == 'z') {
+        uint64_t augmentation_size;
+        if (!elfparser_read_uleb128(&ptr, end, &augmentation_size) || augmentation_size > (uint64_t)(end - ptr)) {
+            return ELFPARSER_INVALID;
+        }
+        const uint8_t* data_end = ptr + augmentation_size;
+        
+        bases.funcrel = fde_out->pc_begin;
+        if (fde_out->cie.lsda_encoding != ELFPARSER_DW_EH_PE_OMIT && augmentation_size > 0) {
+            elfparser_read_encoded_pointer(table->elf_start, table->header, &ptr, data_end, fde_out->cie.lsda_encoding,
+                                           &bases, &fde_out->lsda);
+        }
+        ptr = data_end;
+    }
+    
+    fde_out->instructions_offset    = (const void*)ptr - table->elf_start;
+    fde_out->instructions_size      = end - ptr;
+    return ELFPARSER_NOERROR;
+}
+
+
+static bool elfparser_find_frame_section_by_name(const void* elf_start, const ElfParser_Header* header, const char* name,
+                                                 ElfParser_FdeTable* table_out) {
+    ElfParser_SectionHeader section;
+    if (elfparser_get_section_header_by_name(elf_start, header, name, &section) != ELFPARSER_NOERROR ||
+        section.sh_type == ELFPARSER_SHT_NOBITS || (section.sh_flags & ELFPARSER_SHF_COMPRESSED) ||
+        section.sh_offset > header->elf_size) {
+        return false;
+    }
+    uint64_t max_size = header->elf_size - section.sh_offset;
+    
+    table_out->eh_frame_offset  = section.sh_offset;
+    table_out->eh_frame_vaddr   = section.sh_addr;
+    table_out->eh_frame_size    = section.sh_size < max_size ? section.sh_size : max_size;
+    return true;
+}
+
+
+// Finds .eh_frame through its section or the pointer in .eh_frame_hdr, or else .debug_frame, which is where the unwind
+// information of code built without unwind tables and of separate debug files ends up
+static bool elfparser_find_frame_section(const void* elf_start, const ElfParser_Header* header, ElfParser_FdeTable* table_out) {
+    if (elfparser_find_frame_section_by_name(elf_start, header, ".eh_frame", table_out)) return true;
+    
+    ElfParser_FdeTable header_table;
+    ElfParser_Error err = elfparser_get_fde_table(elf_start, header, &header_table);
+    if (err != ELFPARSER_INVALID && header_table.eh_frame_size != 0) {
+        table_out->eh_frame_offset  = header_table.eh_frame_offset;
+        table_out->eh_frame_vaddr   = header_table.eh_frame_vaddr;
+        table_out->eh_frame_size    = header_table.eh_frame_size;
+        return true;
+    }
+    
+    table_out->is_debug_frame = elfparser_find_frame_section_by_name(elf_start, header, ".debug_frame", table_out);
+    return table_out->is_debug_frame;
+}
+
+
+// Gets the file offset of the FDE an .eh_frame_hdr table entry points to
+static bool elfparser_get_table_fde_offset(const ElfParser_FdeTable* table, uint64_t index, uint64_t* offset_out) {
+    const ElfParser_Header* header = table->header;
+    const uint8_t* entries = table->entries;
+    uint64_t fde_vaddr = table->table_vaddr;
+    switch (table->table_encoding & 0x0f) {
+        case ELFPARSER_DW_EH_PE_SDATA4: fde_vaddr += (int64_t)(int32_t)elfparser_read_32(header, entries + index * 8 + 4);  break;
+        case ELFPARSER_DW_EH_PE_UDATA4: fde_vaddr += elfparser_read_32(header, entries + index * 8 + 4);                    break;
+        default:                        fde_vaddr += elfparser_read_64(header, entries + index * 16 + 8);                   break;
+    }
+    
+    if (header->ei_class != ELFPARSER_ELFCLASS64) fde_vaddr &= UINT32_MAX;
+    if (fde_vaddr < table->eh_frame_vaddr || fde_vaddr - table->eh_frame_vaddr >= table->eh_frame_size) return false;
+    *offset_out = table->eh_frame_offset + (fde_vaddr - table->eh_frame_vaddr);
+    return true;
+}
+
+
+ElfParser_Error elfparser_get_fde_table(const void* elf_start, const ElfParser_Header* header, ElfParser_FdeTable* table_out) {
+    memset(table_out, 0, sizeof(ElfParser_FdeTable));
+    table_out->elf_start    = elf_start;
+    table_out->header       = header;
+    table_out->cie.offset   = UINT64_MAX;
+    
+    // Prefer PT_GNU_EH_FRAME, which is what unwinders use
+    uint64_t hdr_offset = 0, hdr_vaddr = 0, hdr_size = 0;
+    bool found = false;
+    
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_GNU_EH_FRAME) continue;
+        
+        hdr_offset  = program_header.p_offset;
+        hdr_vaddr   = program_header.p_vaddr;
+        hdr_size    = program_header.p_filesz;
+        found       = true;
+        break;
+    }
+    
+    ElfParser_SectionHeader section;
+    if (!found && elfparser_get_section_header_by_name(elf_start, header, ".eh_frame_hdr", &section) == ELFPARSER_NOERROR) {
+        hdr_offset  = section.sh_offset;
+        hdr_vaddr   = section.sh_addr;
+        hdr_size    = section.sh_size;
+        found       = true;
+    }
+    
+    if (!found) return ELFPARSER_NOT_FOUND;
+    if (hdr_offset > header->elf_size || hdr_size > header->elf_size - hdr_offset || hdr_size < 4) return ELFPARSER_INVALID;
+    
+    const uint8_t* start = elf_start + hdr_offset;
+    const uint8_t* end = start + hdr_size;
+    if (start[0] != EH_FRAME_HDR_VERSION) return ELFPARSER_INVALID;
+    
+    uint8_t eh_frame_ptr_encoding   = start[1];
+    uint8_t fde_count_encoding      = start[2];
+    uint8_t table_encoding          = start[3];
+    const uint8_t* ptr = start + 4;
+    
+    ElfParser_PointerBases bases = { .data_start = start, .data_vaddr = hdr_vaddr, .datarel = hdr_vaddr };
+    
+    uint64_t eh_frame_vaddr, eh_frame_offset, eh_frame_size;
+    if (!elfparser_read_encoded_pointer(elf_start, header, &ptr, end, eh_frame_ptr_encoding, &bases, &eh_frame_vaddr) ||
+        !elfparser_get_vaddr_file_offset(elf_start, header, eh_frame_vaddr, &eh_frame_offset, &eh_frame_size) ||
+        eh_frame_offset > header->elf_size) {
+        return ELFPARSER_INVALID;
+    }
+    
+    // .eh_frame runs to the end of its segment at most, or the end of its section if there are section headers
+    if (eh_frame_size > header->elf_size - eh_frame_offset) eh_frame_size = header->elf_size - eh_frame_offset;
+    if (elfparser_get_section_header_by_name(elf_start, header, ".eh_frame", &section) == ELFPARSER_NOERROR &&
+        section.sh_offset == eh_frame_offset && section.sh_size < eh_frame_size) {
+        eh_frame_size = section.sh_size;
+    }
+    
+    table_out->eh_frame_offset  = eh_frame_offset;
+    table_out->eh_frame_vaddr   = eh_frame_vaddr;
+    table_out->eh_frame_size    = eh_frame_size;
+    
+    // Only tables with fixed size entries relative to .eh_frame_hdr can be searched
+    uint64_t entry_size;
+    switch (table_encoding) {
+        case ELFPARSER_DW_EH_PE_DATAREL | ELFPARSER_DW_EH_PE_UDATA4:
+        case ELFPARSER_DW_EH_PE_DATAREL | ELFPARSER_DW_EH_PE_SDATA4:    entry_size = 8;     break;
+        case ELFPARSER_DW_EH_PE_DATAREL | ELFPARSER_DW_EH_PE_UDATA8:
+        case ELFPARSER_DW_EH_PE_DATAREL | ELFPARSER_DW_EH_PE_SDATA8:    entry_size = 16;    break;
+        default:                                                        return ELFPARSER_NOT_FOUND;
+    }
+    
+    uint64_t fde_count;
+    if (!elfparser_read_encoded_pointer(elf_start, header, &ptr, end, fde_count_encoding, &bases, &fde_count)) {
+        return ELFPARSER_NOT_FOUND;
+    }
+    
+    uint64_t num_fit = (end - ptr) / entry_size;
+    
+    table_out->entries          = ptr;
+    table_out->num              = fde_count < num_fit ? fde_count : num_fit;
+    table_out->table_vaddr      = hdr_vaddr;
+    table_out->table_encoding   = table_encoding;
+    
+    // Most FDEs share one CIE, so decode the one of the middle FDE once rather than on every lookup
+    uint64_t fde_offset, cie_offset;
+    const uint8_t* data;
+    const uint8_t* record_end;
+    if (table_out->num != 0 && elfparser_get_table_fde_offset(table_out, table_out->num / 2, &fde_offset) &&
+        elfparser_read_frame_record(table_out, fde_offset, &data, &record_end, &cie_offset) && cie_offset != UINT64_MAX &&
+        elfparser_parse_cie(table_out, cie_offset, true, &table_out->cie) != ELFPARSER_NOERROR) {
+        table_out->cie.offset = UINT64_MAX;
+    }
+    
+    return fde_count <= num_fit ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
+
+
+// Steps through the records of the frame section - returns false at the end, or at the first record which doesn't fit
+static bool elfparser_next_frame_record(const ElfParser_FdeTable* table, uint64_t* offset_in_out, bool* is_fde_out) {
+    const uint8_t* data;
+    const uint8_t* record_end;
+    uint64_t cie_offset;
+    if (!elfparser_read_frame_record(table, *offset_in_out, &data, &record_end, &cie_offset)) return false;
+    
+    *is_fde_out = cie_offset != UINT64_MAX;
+    *offset_in_out = (const void*)record_end - table->elf_start;
+    return true;
+}
+
+
+uint64_t elfparser_get_fde_table_buffer_size(const void* elf_start, const ElfParser_Header* header) {
+    ElfParser_FdeTable table = { .elf_start = elf_start, .header = header };
+    if (!elfparser_find_frame_section(elf_start, header, &table)) return 7;
+    
+    uint64_t num = 0;
+    uint64_t offset = table.eh_frame_offset;
+    bool is_fde;
+    while (elfparser_next_frame_record(&table, &offset, &is_fde)) {
+        if (is_fde) num++;
+    }
+    
+    // Extra bytes to align the start of the buffer
+    return num * sizeof(ElfParser_FdeIndexEntry) + 7;
+}
+
+
+static bool elfparser_is_fde_index_entry_less(const void* a, const void* b, const void* context) {
+    return ((const ElfParser_FdeIndexEntry*)a)->pc_begin < ((const ElfParser_FdeIndexEntry*)b)->pc_begin;
+}
+
+
+ElfParser_Error elfparser_build_fde_table(const void* elf_start, const ElfParser_Header* header,
+                                          void* buffer, uint64_t buffer_size, ElfParser_FdeTable* table_out) {
+    memset(table_out, 0, sizeof(ElfParser_FdeTable));
+    table_out->elf_start    = elf_start;
+    table_out->header       = header;
+    table_out->is_built     = true;
+    table_out->cie.offset   = UINT64_MAX;
+    
+    if (buffer_size < elfparser_get_fde_table_buffer_size(elf_start, header)) return ELFPARSER_INVALID;
+    if (!elfparser_find_frame_section(elf_start, header, table_out)) return ELFPARSER_NOT_FOUND;
+    
+    ElfParser_FdeIndexEntry* entries = (void*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+    uint64_t num = 0;
+    
+    // FDEs usually follow their CIE, so keep the last CIE around instead of parsing it for every FDE
+    ElfParser_Cie cie = { .offset = UINT64_MAX };
+    
+    uint64_t offset = table_out->eh_frame_offset;
+    uint64_t next_offset = offset;
+    bool is_fde;
+    for (; elfparser_next_frame_record(table_out, &next_offset, &is_fde); offset = next_offset) {
+        ElfParser_Fde fde;
+        if (!is_fde || elfparser_parse_fde(table_out, offset, &cie, &fde) != ELFPARSER_NOERROR) continue;
+        cie = fde.cie;
+        
+        // FDEs of discarded functions are left in .eh_frame with a range of 0
+        if (fde.pc_range == 0) continue;
+        
+        entries[num].pc_begin   = fde.pc_begin;
+        entries[num].pc_end     = fde.pc_begin + fde.pc_range;
+        entries[num].offset     = offset;
+        num++;
+    }
+    
+    elfparser_sort(entries, num, sizeof(ElfParser_FdeIndexEntry), elfparser_is_fde_index_entry_less, NULL);
+    
+    table_out->entries  = entries;
+    table_out->num      = num;
+    table_out->cie      = cie;
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_fde(const ElfParser_FdeTable* table, uint64_t offset, ElfParser_Fde* fde_out) {
+    return elfparser_parse_fde(table, offset, &table->cie, fde_out);
+}
+
+
+// Decodes just the address range of the FDE at `offset`, reading no more of its CIE than the encoding of addresses
+static ElfParser_Error elfparser_read_fde_range(const ElfParser_FdeTable* table, uint64_t offset,
+                                                ElfParser_FdeRange* range_out) {
+    const uint8_t* ptr;
+    const uint8_t* end;
+    uint64_t cie_offset;
+    if (!elfparser_read_frame_record(table, offset, &ptr, &end, &cie_offset) || cie_offset == UINT64_MAX) {
+        return ELFPARSER_INVALID;
+    }
+    
+    // The CIE most FDEs share was decoded with the table
+    uint8_t encoding = table->cie.fde_encoding;
+    if (cie_offset != table->cie.offset) {
+        ElfParser_Cie cie;
+        if (elfparser_parse_cie(table, cie_offset, false, &cie) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
+        encoding = cie.fde_encoding;
+    }
+    
+    ElfParser_PointerBases bases = {
+        .data_start = table->elf_start + table->eh_frame_offset,
+        .data_vaddr = table->eh_frame_vaddr,
+    };
+    
+    if (!elfparser_read_encoded_pointer(table->elf_start, table->header, &ptr, end, encoding, &bases,
+                                        &range_out->pc_begin) ||
+        !elfparser_read_encoded_pointer(table->elf_start, table->header, &ptr, end, encoding & 0x0f, &bases,
+                                        &range_out->pc_range)) {
+        return ELFPARSER_INVALID;
+    }
+    range_out->offset = offset;
+    return ELFPARSER_NOERROR;
+}
+
+
+// Finds the index of the last table entry starting at or before pc. Each loop only runs the comparison, the table type
+// and entry format are decided once up front. The loops halve the range without branching on the comparison, which
+// becomes a conditional move - addresses are looked up in no particular order, so a branch would be mispredicted half
+// the time
+static bool elfparser_search_fde_table(const ElfParser_FdeTable* table, uint64_t pc, uint64_t* index_out) {
+    if (table->num == 0) return false;
+    uint64_t low = 0, num = table->num;
+    
+    if (table->is_built) {
+        const ElfParser_FdeIndexEntry* entries = table->entries;
+        while (num > 1) {
+            uint64_t half = num / 2;
+            low = entries[low + half].pc_begin <= pc ? low + half : low;
+            num -= half;
+        }
+        if (entries[low].pc_begin > pc) return false;
+    } else {
+        const ElfParser_Header* header = table->header;
+        const uint8_t* entries = table->entries;
+        bool is_signed = (table->table_encoding & 0x0f) == ELFPARSER_DW_EH_PE_SDATA4 ||
+                         (table->table_encoding & 0x0f) == ELFPARSER_DW_EH_PE_SDATA8;
+        
+        if ((table->table_encoding & 0x0f) == ELFPARSER_DW_EH_PE_SDATA4 ||
+            (table->table_encoding & 0x0f) == ELFPARSER_DW_EH_PE_UDATA4) {
+            // Compare relative to .eh_frame_hdr to avoid adding the base to every entry
+            int64_t target = pc - table->table_vaddr;
+            while (num > 1) {
+                uint64_t half = num / 2;
+                uint32_t raw = elfparser_read_32(header, entries + (low + half) * 8);
+                int64_t location = is_signed ? (int64_t)(int32_t)raw : (int64_t)raw;
+                low = location <= target ? low + half : low;
+                num -= half;
+            }
+            uint32_t first = elfparser_read_32(header, entries + low * 8);
+            if ((is_signed ? (int64_t)(int32_t)first : (int64_t)first) > target) return false;
+        } else {
+            while (num > 1) {
+                uint64_t half = num / 2;
+                uint64_t location = table->table_vaddr + elfparser_read_64(header, entries + (low + half) * 16);
+                low = location <= pc ? low + half : low;
+                num -= half;
+            }
+            if (table->table_vaddr + elfparser_read_64(header, entries + low * 16) > pc) return false;
+        }
+    }
+    
+    *index_out = low;
+    return true;
+}
+
+
+ElfParser_Error elfparser_find_fde_range(const ElfParser_FdeTable* table, uint64_t pc, ElfParser_FdeRange* range_out) {
+    uint64_t index;
+    if (!elfparser_search_fde_table(table, pc, &index)) return ELFPARSER_NOT_FOUND;
+    
+    if (table->is_built) {
+        // Built tables hold the whole range, so nothing has to be decoded
+        const ElfParser_FdeIndexEntry* entry = (const ElfParser_FdeIndexEntry*)table->entries + index;
+        if (pc >= entry->pc_end) return ELFPARSER_NOT_FOUND;
+        range_out->offset   = entry->offset;
+        range_out->pc_begin = entry->pc_begin;
+        range_out->pc_range = entry->pc_end - entry->pc_begin;
+        return ELFPARSER_NOERROR;
+    }
+    
+    uint64_t offset;
+    if (!elfparser_get_table_fde_offset(table, index, &offset)) return ELFPARSER_INVALID;
+    
+    ElfParser_Error err = elfparser_read_fde_range(table, offset, range_out);
+    if (err != ELFPARSER_NOERROR) return err;
+    
+    // The closest FDE may end before pc, e.g. for code without unwind information
+    if (pc - range_out->pc_begin >= range_out->pc_range) return ELFPARSER_NOT_FOUND;
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_find_fde(const ElfParser_FdeTable* table, uint64_t pc, ElfParser_Fde* fde_out) {
+    uint64_t index, offset;
+    if (!elfparser_search_fde_table(table, pc, &index)) return ELFPARSER_NOT_FOUND;
+    
+    // Check the range before decoding where the table has it, otherwise decode the FDE just once and check after
+    if (table->is_built) {
+        const ElfParser_FdeIndexEntry* entry = (const ElfParser_FdeIndexEntry*)table->entries + index;
+        if (pc >= entry->pc_end) return ELFPARSER_NOT_FOUND;
+        offset = entry->offset;
+    } else if (!elfparser_get_table_fde_offset(table, index, &offset)) {
+        return ELFPARSER_INVALID;
+    }
+    
+    ElfParser_Error err = elfparser_parse_fde(table, offset, &table->cie, fde_out);
+    if (err != ELFPARSER_NOERROR) return err;
+    
+    if (pc - fde_out->pc_begin >= fde_out->pc_range) return ELFPARSER_NOT_FOUND;
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
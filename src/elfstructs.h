@@ -142,3 +142,58 @@ typedef struct __attribute__((packed)) {
 	uint64_t	p_memsz;
 	uint64_t	p_align;
 } Elf64_Phdr;
+
+// Note header is the same for 32- and 64-bit files
+typedef struct __attribute__((packed)) {
+	uint32_t	n_namesz;
+	uint32_t	n_descsz;
+	uint32_t	n_type;
+} Elf_Nhdr;
+
+// Symbol version structures are the same for 32- and 64-bit files
+typedef struct __attribute__((packed)) {
+	uint16_t	vd_version;
+	uint16_t	vd_flags;
+	uint16_t	vd_ndx;
+	uint16_t	vd_cnt;
+	uint32_t	vd_hash;
+	uint32_t	vd_aux;
+	uint32_t	vd_next;
+} Elf_Verdef;
+
+typedef struct __attribute__((packed)) {
+	uint32_t	vda_name;
+	uint32_t	vda_next;
+} Elf_Verdaux;
+
+typedef struct __attribute__((packed)) {
+	uint16_t	vn_version;
+	uint16_t	vn_cnt;
+	uint32_t	vn_file;
+	uint32_t	vn_aux;
+	uint32_t	vn_next;
+} Elf_Verneed;
+
+typedef struct __attribute__((packed)) {
+	uint32_t	vna_hash;
+	uint16_t	vna_flags;
+	uint16_t	vna_other;
+	uint32_t	vna_name;
+	uint32_t	vna_next;
+} Elf_Vernaux;
+
+#define AR_MAGIC        "!<arch>\n"
+#define AR_THIN_MAGIC   "!<thin>\n"
+#define AR_MAGIC_SIZE   8
+#define AR_FMAG         "`\n"
+
+// Header of each archive member. All fields are ASCII, padded with spaces
+typedef struct __attribute__((packed)) {
+	char		ar_name[16];
+	char		ar_date[12];
+	char		ar_uid[6];
+	char		ar_gid[6];
+	char		ar_mode[8];
+	char		ar_size[10];
+	char		ar_fmag[2];
+} Ar_Hdr;
\ No newline at end of file
@@ -0,0 +1,365 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+#define XXH_PRIME_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME_3 0x165667B19E3779F9ULL
+#define XXH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME_5 0x27D4EB2F165667C5ULL
+
+// Zero-filled data (e.g. .bss) is hashed from here, so it never has to be copied into a buffer
+static const uint8_t zero_block[4096];
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+static inline uint64_t rotl_64(uint64_t n, int bits) {
+    return (n << bits) | (n >> (64 - bits));
+}
+
+static inline uint32_t rotr_32(uint32_t n, int bits) {
+    return (n >> bits) | (n << (32 - bits));
+}
+
+static inline uint64_t load_le_64(const uint8_t* ptr) {
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return convert_endian_64(value, true);
+}
+
+static inline uint32_t load_le_32(const uint8_t* ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return convert_endian_32(value, true);
+}
+
+static inline uint32_t load_be_32(const uint8_t* ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return convert_endian_32(value, false);
+}
+
+static inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME_2;
+    acc  = rotl_64(acc, 31);
+    return acc * XXH_PRIME_1;
+}
+
+static inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t value) {
+    acc ^= xxh64_round(0, value);
+    return acc * XXH_PRIME_1 + XXH_PRIME_4;
+}
+
+
+// Processes 32 byte stripes - the 4 accumulators are independent, so the rounds can run in parallel
+static const uint8_t* elfparser_xxh64_stripes(uint64_t* acc, const uint8_t* data, uint64_t num_stripes) {
+    uint64_t v1 = acc[0], v2 = acc[1], v3 = acc[2], v4 = acc[3];
+    
+    for (; num_stripes > 0; num_stripes--, data += 32) {
+        v1 = xxh64_round(v1, load_le_64(data));
+        v2 = xxh64_round(v2, load_le_64(data + 8));
+        v3 = xxh64_round(v3, load_le_64(data + 16));
+        v4 = xxh64_round(v4, load_le_64(data + 24));
+    }
+    
+    acc[0] = v1; acc[1] = v2; acc[2] = v3; acc[3] = v4;
+    return data;
+}
+
+
+static void elfparser_sha256_blocks(uint64_t* state, const uint8_t* data, uint64_t num_blocks) {
+    for (; num_blocks > 0; num_blocks--, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) w[i] = load_be_32(data + i * 4);
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr_32(w[i - 15], 7) ^ rotr_32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr_32(w[i - 2], 17) ^ rotr_32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1     = rotr_32(e, 6) ^ rotr_32(e, 11) ^ rotr_32(e, 25);
+            uint32_t ch     = (e & f) ^ (~e & g);
+            uint32_t temp1  = h + s1 + ch + sha256_k[i] + w[i];
+            uint32_t s0     = rotr_32(a, 2) ^ rotr_32(a, 13) ^ rotr_32(a, 22);
+            uint32_t maj    = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t temp2  = s0 + maj;
+            
+            h = g; g = f; f = e; e = d + temp1;
+            d = c; c = b; b = a; a = temp1 + temp2;
+        }
+        
+        state[0] = (uint32_t)(state[0] + a); state[1] = (uint32_t)(state[1] + b);
+        state[2] = (uint32_t)(state[2] + c); state[3] = (uint32_t)(state[3] + d);
+        state[4] = (uint32_t)(state[4] + e); state[5] = (uint32_t)(state[5] + f);
+        state[6] = (uint32_t)(state[6] + g); state[7] = (uint32_t)(state[7] + h);
+    }
+}
+
+
+void elfparser_hash_init(ElfParser_HashState* state, ElfParser_HashType type) {
+    state->type         = type;
+    state->total_size   = 0;
+    state->buffer_size  = 0;
+    
+    if (type == ELFPARSER_HASH_SHA256) {
+        static const uint32_t sha256_init[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        for (int i = 0; i < 8; i++) state->state[i] = sha256_init[i];
+    } else {
+        // Seed of 0
+        state->state[0] = XXH_PRIME_1 + XXH_PRIME_2;
+        state->state[1] = XXH_PRIME_2;
+        state->state[2] = 0;
+        state->state[3] = -XXH_PRIME_1;
+    }
+}
+
+
+void elfparser_hash_update(ElfParser_HashState* state, const void* data, uint64_t size) {
+    // Both hashes consume whole blocks - XXH64 uses 32 byte stripes, SHA-256 uses 64 byte blocks
+    uint64_t block_size = state->type == ELFPARSER_HASH_SHA256 ? 64 : 32;
+    const uint8_t* ptr = data;
+    
+    state->total_size += size;
+    
+    // Top up a partially filled block first
+    if (state->buffer_size > 0) {
+        uint64_t fill = block_size - state->buffer_size;
+        if (fill > size) fill = size;
+        
+        memcpy(state->buffer + state->buffer_size, ptr, fill);
+        state->buffer_size  += fill;
+        ptr                 += fill;
+        size                -= fill;
+        
+        if (state->buffer_size < block_size) return;
+        
+        if (state->type == ELFPARSER_HASH_SHA256) {
+            elfparser_sha256_blocks(state->state, state->buffer, 1);
+        } else {
+            elfparser_xxh64_stripes(state->state, state->buffer, 1);
+        }
+        state->buffer_size = 0;
+    }
+    
+    // Hash whole blocks straight from the input
+    uint64_t num_blocks = size / block_size;
+    if (state->type == ELFPARSER_HASH_SHA256) {
+        elfparser_sha256_blocks(state->state, ptr, num_blocks);
+    } else {
+        elfparser_xxh64_stripes(state->state, ptr, num_blocks);
+    }
+    ptr     += num_blocks * block_size;
+    size    -= num_blocks * block_size;
+    
+    memcpy(state->buffer, ptr, size);
+    state->buffer_size = size;
+}
+
+
+void elfparser_hash_update_zeros(ElfParser_HashState* state, uint64_t size) {
+    while (size > 0) {
+        uint64_t chunk = size < sizeof(zero_block) ? size : sizeof(zero_block);
+        elfparser_hash_update(state, zero_block, chunk);
+        size -= chunk;
+    }
+}
+
+
+uint64_t elfparser_hash_final(ElfParser_HashState* state, uint8_t* digest_out) {
+    if (state->type == ELFPARSER_HASH_SHA256) {
+        uint64_t bit_size = state->total_size * 8;
+        uint8_t padding[72] = { 0x80 };
+        
+        // Pad to 56 bytes mod 64, then append the size in bits as a big-endian 64-bit number
+        uint64_t padding_size = (state->buffer_size < 56 ? 56 : 120) - state->buffer_size;
+        for (int i = 0; i < 8; i++) padding[padding_size + i] = bit_size >> (56 - i * 8);
+        elfparser_hash_update(state, padding, padding_size + 8);
+        
+        for (int i = 0; i < 8; i++) {
+            digest_out[i * 4 + 0] = state->state[i] >> 24;
+            digest_out[i * 4 + 1] = state->state[i] >> 16;
+            digest_out[i * 4 + 2] = state->state[i] >> 8;
+            digest_out[i * 4 + 3] = state->state[i];
+        }
+        return 32;
+    }
+    
+    uint64_t hash;
+    const uint64_t* acc = state->state;
+    if (state->total_size >= 32) {
+        hash = rotl_64(acc[0], 1) + rotl_64(acc[1], 7) + rotl_64(acc[2], 12) + rotl_64(acc[3], 18);
+        hash = xxh64_merge_round(hash, acc[0]);
+        hash = xxh64_merge_round(hash, acc[1]);
+        hash = xxh64_merge_round(hash, acc[2]);
+        hash = xxh64_merge_round(hash, acc[3]);
+    } else {
+        hash = XXH_PRIME_5;
+    }
+    hash += state->total_size;
+    
+    // Consume the rest of the input left in buffer
+    const uint8_t* ptr = state->buffer;
+    uint64_t size = state->buffer_size;
+    for (; size >= 8; size -= 8, ptr += 8) {
+        hash ^= xxh64_round(0, load_le_64(ptr));
+        hash  = rotl_64(hash, 27) * XXH_PRIME_1 + XXH_PRIME_4;
+    }
+    if (size >= 4) {
+        hash ^= (uint64_t)load_le_32(ptr) * XXH_PRIME_1;
+        hash  = rotl_64(hash, 23) * XXH_PRIME_2 + XXH_PRIME_3;
+        size -= 4;
+        ptr  += 4;
+    }
+    for (; size > 0; size--, ptr++) {
+        hash ^= *ptr * XXH_PRIME_5;
+        hash  = rotl_64(hash, 11) * XXH_PRIME_1;
+    }
+    
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME_3;
+    hash ^= hash >> 32;
+    
+    for (int i = 0; i < 8; i++) digest_out[i] = hash >> (56 - i * 8);
+    return 8;
+}
+
+
+ElfParser_Error elfparser_hash_section(const void* elf_start, const ElfParser_Header* header,
+                                       const ElfParser_SectionHeader* section, ElfParser_HashType type,
+                                       ElfParser_Digest* digest_out) {
+    ElfParser_HashState state;
+    elfparser_hash_init(&state, type);
+    
+    if (section->sh_type == ELFPARSER_SHT_NOBITS) {
+        // Section takes up no space in the file, but its contents are all 0s
+        elfparser_hash_update_zeros(&state, section->sh_size);
+    } else {
+        if (section->sh_offset > header->elf_size || section->sh_size > header->elf_size - section->sh_offset) {
+            return ELFPARSER_INVALID;
+        }
+        elfparser_hash_update(&state, elf_start + section->sh_offset, section->sh_size);
+    }
+    
+    digest_out->index   = section->index;
+    digest_out->size    = section->sh_size;
+    memset(digest_out->digest, 0, sizeof(digest_out->digest));
+    elfparser_hash_final(&state, digest_out->digest);
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_hash_segment(const void* elf_start, const ElfParser_Header* header,
+                                       const ElfParser_ProgramHeader* program_header, ElfParser_HashType type,
+                                       ElfParser_Digest* digest_out) {
+    if (program_header->p_offset > header->elf_size ||
+        program_header->p_filesz > header->elf_size - program_header->p_offset) return ELFPARSER_INVALID;
+    
+    ElfParser_HashState state;
+    elfparser_hash_init(&state, type);
+    
+    // Hash the same bytes elfparser_copy_segment would copy - file data followed by 0s up to the memory size
+    uint64_t file_size = program_header->p_filesz < program_header->p_memsz ? program_header->p_filesz : program_header->p_memsz;
+    elfparser_hash_update(&state, elf_start + program_header->p_offset, file_size);
+    elfparser_hash_update_zeros(&state, program_header->p_memsz - file_size);
+    
+    digest_out->index   = program_header->index;
+    digest_out->size    = program_header->p_memsz;
+    memset(digest_out->digest, 0, sizeof(digest_out->digest));
+    elfparser_hash_final(&state, digest_out->digest);
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_hash_sections(const void* elf_start, const ElfParser_Header* header, ElfParser_HashType type,
+                                        ElfParser_Digest* digests, uint64_t num) {
+    ElfParser_Error result = ELFPARSER_NOERROR;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        ElfParser_SectionHeader section;
+        digests[i].error = elfparser_get_section_header(elf_start, header, digests[i].index, &section);
+        
+        if (digests[i].error == ELFPARSER_NOERROR) {
+            digests[i].error = elfparser_hash_section(elf_start, header, &section, type, &digests[i]);
+        }
+        if (digests[i].error != ELFPARSER_NOERROR) result = ELFPARSER_INVALID;
+    }
+    return result;
+}
+
+
+ElfParser_Error elfparser_hash_segments(const void* elf_start, const ElfParser_Header* header, ElfParser_HashType type,
+                                        ElfParser_Digest* digests, uint64_t num) {
+    ElfParser_Error result = ELFPARSER_NOERROR;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        ElfParser_ProgramHeader program_header;
+        digests[i].error = elfparser_get_program_header(elf_start, header, digests[i].index, &program_header);
+        
+        if (digests[i].error == ELFPARSER_NOERROR) {
+            digests[i].error = elfparser_hash_segment(elf_start, header, &program_header, type, &digests[i]);
+        }
+        if (digests[i].error != ELFPARSER_NOERROR) result = ELFPARSER_INVALID;
+    }
+    return result;
+}
+
+
+uint64_t elfparser_get_load_segment_indexes(const void* elf_start, const ElfParser_Header* header,
+                                            ElfParser_Digest* digests, uint64_t max_digests) {
+    uint64_t num = 0;
+    
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_LOAD) continue;
+        
+        if (num < max_digests) digests[num].index = program_header.index;
+        num++;
+    }
+    return num;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "image.h"
+
+#define FINGERPRINT_HEAD_SIZE   4096    // Bytes hashed from the start of the file - headers, notes and the build ID
+
+
+// Hash of the start of the file and of the section header table, which change whenever a file is rebuilt
+static uint64_t elfparser_get_file_fingerprint(const void* elf_start, const ElfParser_Header* header) {
+    ElfParser_HashState state;
+    uint8_t digest[8];
+    elfparser_hash_init(&state, ELFPARSER_HASH_XXH64);
+    
+    elfparser_hash_update(&state, elf_start, header->elf_size < FINGERPRINT_HEAD_SIZE ? header->elf_size
+                                                                                      : FINGERPRINT_HEAD_SIZE);
+    if (header->e_shoff < header->elf_size) {
+        uint64_t size = header->true_shnum * header->e_shentsize;
+        if (size > header->elf_size - header->e_shoff) size = header->elf_size - header->e_shoff;
+        elfparser_hash_update(&state, elf_start + header->e_shoff, size);
+    }
+    elfparser_hash_final(&state, digest);
+    
+    uint64_t fingerprint = 0;
+    for (int i = 0; i < 8; i++) fingerprint = fingerprint << 8 | digest[i];
+    return fingerprint;
+}
+
+
+void elfparser_init_index_image(const void* elf_start, const ElfParser_Header* header, uint32_t kind,
+                                uint32_t entry_size, ElfParser_IndexImage* image_out) {
+    memset(image_out, 0, sizeof(ElfParser_IndexImage));
+    image_out->kind         = kind;
+    image_out->entry_size   = entry_size;
+    image_out->elf_size     = header->elf_size;
+    image_out->fingerprint  = elfparser_get_file_fingerprint(elf_start, header);
+}
+
+
+const ElfParser_IndexImage* elfparser_check_index_image(const void* elf_start, const ElfParser_Header* header,
+                                                        uint32_t kind, uint32_t entry_size, const void* buffer,
+                                                        uint64_t buffer_size) {
+    const ElfParser_IndexImage* image = elfparser_get_index_image(buffer);
+    uint64_t padding = (const void*)image - buffer;
+    if (buffer_size < padding + sizeof(ElfParser_IndexImage)) return NULL;
+    
+    uint64_t max_num = (buffer_size - padding - sizeof(ElfParser_IndexImage)) / entry_size;
+    if (image->kind != kind || image->entry_size != entry_size || image->num > max_num) return NULL;
+    if (image->elf_size != header->elf_size || image->fingerprint != elfparser_get_file_fingerprint(elf_start, header)) {
+        return NULL;
+    }
+    return image;
+}
\ No newline at end of file
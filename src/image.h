@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include "parse.h"
+
+// This file should *not* be included! It is used as an interface for the implementation
+// Any functions here should be considered private
+
+#define ELFPARSER_IMAGE_FUNCTION_TABLE  0x4e554645  // "EFUN"
+#define ELFPARSER_IMAGE_NAME_INDEX      0x4d414e45  // "ENAM"
+
+// Start of the buffer of an index which can be attached to. Everything after it refers to the file by offset, so the
+// buffer works wherever it's mapped
+typedef struct {
+    uint32_t                kind;           // ELFPARSER_IMAGE_x
+    uint32_t                entry_size;     // Size of each entry, which also catches builds with another entry layout
+    uint64_t                num;            // Number of entries following the image header
+    uint64_t                elf_size;       // Size and fingerprint of the file the index was built from
+    uint64_t                fingerprint;
+    ElfParser_SymbolTable   table;          // Symbol table a name index was built from
+} ElfParser_IndexImage;
+
+// Returns the start of the image in a buffer - buffers are aligned the same way by the build and attach functions
+static inline ElfParser_IndexImage* elfparser_get_index_image(const void* buffer) {
+    return (ElfParser_IndexImage*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+}
+
+void elfparser_init_index_image(const void* elf_start, const ElfParser_Header* header, uint32_t kind,
+                                uint32_t entry_size, ElfParser_IndexImage* image_out);
+
+// Returns the image in buffer if it is an index of the given kind built from this file, NULL if not
+const ElfParser_IndexImage* elfparser_check_index_image(const void* elf_start, const ElfParser_Header* header,
+                                                        uint32_t kind, uint32_t entry_size, const void* buffer,
+                                                        uint64_t buffer_size);
\ No newline at end of file
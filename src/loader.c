@@ -0,0 +1,224 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+// Each stage issues one batch of reads, which can all be in flight at once. Each batch depends on data from the last
+enum {
+    LOADER_STAGE_EHDR,              // ELF header
+    LOADER_STAGE_HEADER_TABLES,     // Program header table, and section header table (or just section 0 if e_shnum is 0)
+    LOADER_STAGE_EXTENDED_SECTIONS, // Rest of the section header table when the real number of sections is in section 0
+    LOADER_STAGE_SECTION_NAMES,     // Section name string table
+    LOADER_STAGE_TABLES,            // Tables selected by the load flags
+    LOADER_STAGE_DYNAMIC_STRINGS,   // String table referenced by DT_STRTAB, if there was no SHT_DYNAMIC section
+    LOADER_STAGE_DONE
+};
+
+
+// Adds a range to the current batch of reads, clipped to the file. Ranges which overlap or touch an earlier range are
+// merged into it, and once the batch is full the last range is grown to cover the new one - reading extra bytes into
+// the image is harmless
+static void elfparser_loader_request(ElfParser_Loader* loader, uint64_t offset, uint64_t size) {
+    if (offset >= loader->file_size) return;
+    if (size > loader->file_size - offset) size = loader->file_size - offset;
+    if (size == 0) return;
+    
+    uint64_t end = offset + size;
+    
+    for (uint64_t i = 0; i < loader->num_requests; i++) {
+        ElfParser_ReadRequest* request = &loader->requests[i];
+        uint64_t request_end = request->offset + request->size;
+        
+        if (offset > request_end || end < request->offset) continue;
+        
+        if (offset < request->offset) request->offset = offset;
+        if (end > request_end) request_end = end;
+        request->size = request_end - request->offset;
+        return;
+    }
+    
+    if (loader->num_requests < ELFPARSER_LOADER_MAX_REQUESTS) {
+        loader->requests[loader->num_requests].offset = offset;
+        loader->requests[loader->num_requests].size = size;
+        loader->num_requests++;
+        return;
+    }
+    
+    ElfParser_ReadRequest* last = &loader->requests[ELFPARSER_LOADER_MAX_REQUESTS - 1];
+    uint64_t last_end = last->offset + last->size;
+    if (offset < last->offset) last->offset = offset;
+    if (end > last_end) last_end = end;
+    last->size = last_end - last->offset;
+}
+
+
+// Requests `num` entries of a table. The entry count may come from a corrupted file, so avoid overflowing
+static void elfparser_loader_request_table(ElfParser_Loader* loader, uint64_t offset, uint64_t entry_size, uint64_t num) {
+    if (offset >= loader->file_size) return;
+    
+    uint64_t max_size = loader->file_size - offset;
+    uint64_t size = (entry_size != 0 && num > max_size / entry_size) ? max_size : entry_size * num;
+    elfparser_loader_request(loader, offset, size);
+}
+
+
+static void elfparser_loader_request_section(ElfParser_Loader* loader, uint64_t index) {
+    ElfParser_SectionHeader section;
+    if (elfparser_get_section_header(loader->image, &loader->header, index, &section) != ELFPARSER_NOERROR) return;
+    if (section.sh_type == ELFPARSER_SHT_NOBITS) return;
+    
+    elfparser_loader_request(loader, section.sh_offset, section.sh_size);
+}
+
+
+// Requests a symbol table section and the string table linked to it
+static void elfparser_loader_request_symbol_table(ElfParser_Loader* loader, ElfParser_SH_Type type) {
+    ElfParser_SymbolTable table;
+    if (elfparser_get_symbol_table(loader->image, &loader->header, type, &table) != ELFPARSER_NOERROR) return;
+    
+    ElfParser_SectionHeader section;
+    if (elfparser_get_section_header(loader->image, &loader->header, table.section_index, &section) != ELFPARSER_NOERROR) {
+        return;
+    }
+    elfparser_loader_request(loader, section.sh_offset, section.sh_size);
+    elfparser_loader_request_section(loader, section.sh_link);
+}
+
+
+// Requests the tables selected by the load flags. Returns true if the dynamic string table must be found through
+// DT_STRTAB once the dynamic section has been read
+static bool elfparser_loader_request_tables(ElfParser_Loader* loader) {
+    const ElfParser_Header* header = &loader->header;
+    bool needs_dynamic_strings = false;
+    
+    if (loader->flags & ELFPARSER_LOAD_SYMTAB) elfparser_loader_request_symbol_table(loader, ELFPARSER_SHT_SYMTAB);
+    if (loader->flags & ELFPARSER_LOAD_DYNSYM) elfparser_loader_request_symbol_table(loader, ELFPARSER_SHT_DYNSYM);
+    
+    if (loader->flags & ELFPARSER_LOAD_DYNAMIC) {
+        // .dynamic links to the same string table as DT_STRTAB - only files without section headers need another batch
+        needs_dynamic_strings = true;
+        
+        ElfParser_SectionCursor section_cursor;
+        elfparser_section_cursor_init(loader->image, header, &section_cursor);
+        
+        ElfParser_SectionHeader section;
+        while (elfparser_section_cursor_next(&section_cursor, &section) == ELFPARSER_NOERROR) {
+            if (section.sh_type != ELFPARSER_SHT_DYNAMIC) continue;
+            
+            elfparser_loader_request(loader, section.sh_offset, section.sh_size);
+            elfparser_loader_request_section(loader, section.sh_link);
+            needs_dynamic_strings = false;
+            break;
+        }
+    }
+    
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(loader->image, header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        bool is_wanted = (program_header.p_type == ELFPARSER_PT_DYNAMIC && (loader->flags & ELFPARSER_LOAD_DYNAMIC)) ||
+                         (program_header.p_type == ELFPARSER_PT_INTERP  && (loader->flags & ELFPARSER_LOAD_INTERP)) ||
+                         (program_header.p_type == ELFPARSER_PT_NOTE    && (loader->flags & ELFPARSER_LOAD_NOTES));
+        
+        if (is_wanted) elfparser_loader_request(loader, program_header.p_offset, program_header.p_filesz);
+    }
+    
+    return needs_dynamic_strings;
+}
+
+
+void elfparser_loader_init(ElfParser_Loader* loader_out, void* image, uint64_t file_size, uint32_t flags) {
+    memset(loader_out, 0, sizeof(ElfParser_Loader));
+    loader_out->image       = image;
+    loader_out->file_size   = file_size;
+    loader_out->flags       = flags;
+    loader_out->stage       = LOADER_STAGE_EHDR;
+    
+    elfparser_loader_request(loader_out, 0, sizeof(Elf64_Ehdr));
+}
+
+
+ElfParser_Error elfparser_loader_advance(ElfParser_Loader* loader) {
+    ElfParser_Header* header = &loader->header;
+    loader->num_requests = 0;
+    
+    // Stages with nothing to read fall through to the next one
+    while (loader->num_requests == 0 && loader->stage != LOADER_STAGE_DONE) {
+        switch (loader->stage) {
+            case LOADER_STAGE_EHDR:
+                if (elfparser_sniff_header(loader->image, loader->file_size, header) != ELFPARSER_NOERROR) {
+                    return ELFPARSER_INVALID;
+                }
+                elfparser_loader_request_table(loader, header->e_phoff, header->e_phentsize, header->e_phnum);
+                if (header->e_shoff != 0) {
+                    elfparser_loader_request_table(loader, header->e_shoff, header->e_shentsize,
+                                                   header->e_shnum != 0 ? header->e_shnum : 1);
+                }
+                loader->stage = LOADER_STAGE_HEADER_TABLES;
+                break;
+                
+            case LOADER_STAGE_HEADER_TABLES:
+                // Section 0 holds the real number of sections and string table index if they don't fit in the ELF header
+                header->true_shnum = elfparser_get_true_shnum(loader->image, header);
+                header->true_shstrndx = elfparser_get_true_shstrndx(loader->image, header);
+                
+                if (header->e_shnum == 0 && header->true_shnum > 1) {
+                    elfparser_loader_request_table(loader, header->e_shoff + header->e_shentsize, header->e_shentsize,
+                                                   header->true_shnum - 1);
+                }
+                loader->stage = LOADER_STAGE_EXTENDED_SECTIONS;
+                break;
+                
+            case LOADER_STAGE_EXTENDED_SECTIONS:
+                if (header->true_shstrndx != 0) elfparser_loader_request_section(loader, header->true_shstrndx);
+                loader->stage = LOADER_STAGE_SECTION_NAMES;
+                break;
+                
+            case LOADER_STAGE_SECTION_NAMES:
+                // Everything elfparser_get_header reads is in the image now
+                if (elfparser_get_header(loader->image, loader->file_size, header) != ELFPARSER_NOERROR) {
+                    return ELFPARSER_INVALID;
+                }
+                loader->stage = elfparser_loader_request_tables(loader) ? LOADER_STAGE_TABLES : LOADER_STAGE_DYNAMIC_STRINGS;
+                break;
+                
+            case LOADER_STAGE_TABLES: {
+                ElfParser_DynamicCursor cursor;
+                if (elfparser_dynamic_cursor_init(loader->image, header, &cursor) != ELFPARSER_NOT_FOUND) {
+                    elfparser_loader_request(loader, cursor.string_table_offset, cursor.string_table_size);
+                }
+                loader->stage = LOADER_STAGE_DYNAMIC_STRINGS;
+                break;
+            }
+            
+            default:
+                loader->stage = LOADER_STAGE_DONE;
+                break;
+        }
+    }
+    
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
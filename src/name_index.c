@@ -0,0 +1,344 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "image.h"
+#include "sort.h"
+
+typedef struct {
+    uint32_t                key;            // First 4 bytes of the name, big-endian and padded with 0s, to compare
+                                            // names without reading them most of the time
+    uint32_t                st_name;
+    uint32_t                symbol_index;
+    uint32_t                lcp;            // Length of the prefix shared with the name of the previous entry
+} ElfParser_NameEntry;
+
+
+// Orders keys the same way as strcmp orders the names they come from
+static uint32_t elfparser_get_name_key(const char* name, uint64_t max_length) {
+    uint32_t key = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        uint8_t c = i < max_length ? name[i] : 0;
+        key |= (uint32_t)c << (24 - i * 8);
+        if (c == 0) max_length = 0;
+    }
+    return key;
+}
+
+
+static const char* elfparser_get_entry_name(const ElfParser_NameIndex* index, const ElfParser_NameEntry* entry) {
+    return index->elf_start + index->table.string_table_offset + entry->st_name;
+}
+
+
+static void elfparser_get_default_symbol_table(const ElfParser_Header* header, const ElfParser_SymbolTable* table,
+                                               ElfParser_SymbolTable* table_out) {
+    if (table != NULL) {
+        *table_out = *table;
+        return;
+    }
+    
+    memset(table_out, 0, sizeof(ElfParser_SymbolTable));
+    table_out->offset               = header->symbol_table_offset;
+    table_out->entry_size           = header->symbol_entry_size;
+    table_out->num                  = header->symbol_num;
+    table_out->string_table_offset  = header->symbol_string_table_offset;
+}
+
+
+uint64_t elfparser_get_name_index_buffer_size(const void* elf_start, const ElfParser_Header* header,
+                                              const ElfParser_SymbolTable* table) {
+    ElfParser_SymbolTable symbol_table;
+    elfparser_get_default_symbol_table(header, table, &symbol_table);
+    
+    // Extra bytes to align the start of the buffer
+    return sizeof(ElfParser_IndexImage) + symbol_table.num * sizeof(ElfParser_NameEntry) + 7;
+}
+
+
+static bool elfparser_is_name_entry_less(const void* a, const void* b, const void* context) {
+    const ElfParser_NameEntry* entry_a = a;
+    const ElfParser_NameEntry* entry_b = b;
+    if (entry_a->key != entry_b->key) return entry_a->key < entry_b->key;
+    
+    // Keys holding a terminator mean both names are equal
+    if ((entry_a->key & 0xff) != 0) {
+        const char* strings = context;
+        int cmp = strcmp(strings + entry_a->st_name + 4, strings + entry_b->st_name + 4);
+        if (cmp != 0) return cmp < 0;
+    }
+    
+    // Symbols with the same name stay in order of index
+    return entry_a->symbol_index < entry_b->symbol_index;
+}
+
+
+ElfParser_Error elfparser_build_name_index(const void* elf_start, const ElfParser_Header* header,
+                                          const ElfParser_SymbolTable* table, void* buffer, uint64_t buffer_size,
+                                          ElfParser_NameIndex* index_out) {
+    memset(index_out, 0, sizeof(ElfParser_NameIndex));
+    index_out->elf_start    = elf_start;
+    index_out->header       = header;
+    elfparser_get_default_symbol_table(header, table, &index_out->table);
+    
+    if (buffer_size < elfparser_get_name_index_buffer_size(elf_start, header, table)) return ELFPARSER_INVALID;
+    ElfParser_IndexImage* image = elfparser_get_index_image(buffer);
+    ElfParser_NameEntry* entries = (ElfParser_NameEntry*)(image + 1);
+    index_out->entries = entries;
+    
+    // Symbols outside the file are skipped by the cursor, so the return value can be ignored
+    ElfParser_SymbolCursor cursor;
+    ElfParser_Symbol symbol;
+    elfparser_symbol_table_cursor_init(elf_start, header, &index_out->table, &cursor);
+    
+    // Symbols without a name, or whose name isn't within the file, are left out
+    uint64_t num = 0;
+    uint64_t strings_offset = index_out->table.string_table_offset;
+    while (elfparser_symbol_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        uint64_t name_off;
+        if (!elfparser_get_symbol_name_offset(strings_offset, &symbol, &name_off) ||
+            !elfparser_is_string_in_bounds(elf_start, header, name_off)) {
+            continue;
+        }
+        
+        const char* name = elf_start + name_off;
+        if (name[0] == '\0' || symbol.index > UINT32_MAX) continue;
+        
+        entries[num].key            = elfparser_get_name_key(name, UINT64_MAX);
+        entries[num].st_name        = symbol.st_name;
+        entries[num].symbol_index   = symbol.index;
+        num++;
+    }
+    
+    elfparser_sort(entries, num, sizeof(ElfParser_NameEntry), elfparser_is_name_entry_less, elf_start + strings_offset);
+    index_out->num = num;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        uint64_t lcp = 0;
+        if (i > 0) {
+            const char* name = elfparser_get_entry_name(index_out, &entries[i]);
+            const char* previous = elfparser_get_entry_name(index_out, &entries[i - 1]);
+            while (name[lcp] != '\0' && name[lcp] == previous[lcp]) lcp++;
+        }
+        entries[i].lcp = lcp < UINT32_MAX ? lcp : UINT32_MAX;
+    }
+    
+    elfparser_init_index_image(elf_start, header, ELFPARSER_IMAGE_NAME_INDEX, sizeof(ElfParser_NameEntry), image);
+    image->num      = num;
+    image->table    = index_out->table;
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_attach_name_index(const void* elf_start, const ElfParser_Header* header,
+                                           const void* buffer, uint64_t buffer_size, ElfParser_NameIndex* index_out) {
+    const ElfParser_IndexImage* image = elfparser_check_index_image(elf_start, header, ELFPARSER_IMAGE_NAME_INDEX,
+                                                                    sizeof(ElfParser_NameEntry), buffer, buffer_size);
+    if (image == NULL || image->table.string_table_offset >= header->elf_size) return ELFPARSER_INVALID;
+    
+    // The index is only ever read, so the entries may be in read-only memory
+    memset(index_out, 0, sizeof(ElfParser_NameIndex));
+    index_out->elf_start    = elf_start;
+    index_out->header       = header;
+    index_out->table        = image->table;
+    index_out->entries      = (void*)(image + 1);
+    index_out->num          = image->num;
+    return ELFPARSER_NOERROR;
+}
+
+
+typedef struct {
+    const ElfParser_NameIndex*  index;
+    const char*                 prefix;
+    uint64_t                    length;
+    uint32_t                    key;
+} ElfParser_PrefixSearch;
+
+
+// Name is before every name starting with the prefix
+static bool elfparser_is_name_before_prefix(const void* element, const void* key, const void* context) {
+    const ElfParser_NameEntry* entry = element;
+    const ElfParser_PrefixSearch* search = key;
+    if (entry->key != search->key) return entry->key < search->key;
+    if (search->length <= 4) return false;
+    return strncmp(elfparser_get_entry_name(search->index, entry), search->prefix, search->length) < 0;
+}
+
+
+// Name starts with the prefix or is before it
+static bool elfparser_is_name_not_after_prefix(const void* element, const void* key, const void* context) {
+    const ElfParser_NameEntry* entry = element;
+    const ElfParser_PrefixSearch* search = key;
+    
+    // The key of a prefix shorter than 4 bytes is padded with 0s, so only the bytes of the prefix are compared
+    uint32_t key_mask = search->length >= 4 ? UINT32_MAX : ~(UINT32_MAX >> (search->length * 8));
+    if ((entry->key & key_mask) != search->key) return (entry->key & key_mask) < search->key;
+    if (search->length <= 4) return true;
+    return strncmp(elfparser_get_entry_name(search->index, entry), search->prefix, search->length) <= 0;
+}
+
+
+static void elfparser_find_name_prefix(const ElfParser_NameIndex* index, const char* prefix, uint64_t length,
+                                       uint64_t* first_out, uint64_t* end_out) {
+    ElfParser_PrefixSearch search = {
+        .index = index, .prefix = prefix, .length = length, .key = elfparser_get_name_key(prefix, length)
+    };
+    
+    *first_out = elfparser_lower_bound(index->entries, index->num, sizeof(ElfParser_NameEntry), &search,
+                                       elfparser_is_name_before_prefix, NULL);
+    *end_out = *first_out + elfparser_lower_bound((ElfParser_NameEntry*)index->entries + *first_out,
+                                                  index->num - *first_out, sizeof(ElfParser_NameEntry), &search,
+                                                  elfparser_is_name_not_after_prefix, NULL);
+}
+
+
+ElfParser_Error elfparser_name_index_find_prefix(const ElfParser_NameIndex* index, const char* prefix,
+                                                 uint64_t* first_out, uint64_t* end_out) {
+    if (prefix == NULL) return ELFPARSER_INVALID;
+    
+    elfparser_find_name_prefix(index, prefix, strlen(prefix), first_out, end_out);
+    return *first_out < *end_out ? ELFPARSER_NOERROR : ELFPARSER_NOT_FOUND;
+}
+
+
+ElfParser_Error elfparser_name_index_get(const ElfParser_NameIndex* index, uint64_t position, ElfParser_Symbol* symbol_out) {
+    if (position >= index->num) return ELFPARSER_NOT_FOUND;
+    
+    const ElfParser_NameEntry* entry = (const ElfParser_NameEntry*)index->entries + position;
+    return elfparser_get_symbol_from_table(index->elf_start, index->header, &index->table, entry->symbol_index,
+                                           symbol_out);
+}
+
+
+uint64_t elfparser_name_index_get_common_prefix_length(const ElfParser_NameIndex* index, uint64_t first, uint64_t end) {
+    if (end > index->num) end = index->num;
+    if (first >= end) return 0;
+    
+    // The prefix shared by a range of sorted names is the shortest prefix shared by two neighbours
+    const ElfParser_NameEntry* entries = index->entries;
+    uint64_t length = strlen(elfparser_get_entry_name(index, &entries[first]));
+    for (uint64_t i = first + 1; i < end && length > 0; i++) {
+        if (entries[i].lcp < length) length = entries[i].lcp;
+    }
+    return length;
+}
+
+
+// Matches one character against the pattern item (a character, ? or a [] class) at `pattern`, and sets next_out to
+// the item after it
+static bool elfparser_match_glob_item(const char* pattern, char c, const char** next_out) {
+    *next_out = pattern + 1;
+    if (*pattern == '?') return true;
+    if (*pattern != '[') return *pattern == c;
+    
+    const char* ptr = pattern + 1;
+    bool is_negated = *ptr == '!' || *ptr == '^';
+    if (is_negated) ptr++;
+    
+    // A ] straight after the [ is part of the class
+    bool is_matched = false;
+    const char* start = ptr;
+    while (*ptr != '\0' && (*ptr != ']' || ptr == start)) {
+        if (ptr[1] == '-' && ptr[2] != ']' && ptr[2] != '\0') {
+            is_matched |= (uint8_t)ptr[0] <= (uint8_t)c && (uint8_t)c <= (uint8_t)ptr[2];
+            ptr += 3;
+        } else {
+            is_matched |= *ptr == c;
+            ptr++;
+        }
+    }
+    
+    // No closing ] - the [ is just a character
+    if (*ptr == '\0') return c == '[';
+    
+    *next_out = ptr + 1;
+    return is_matched != is_negated;
+}
+
+
+// Matches a name against a glob pattern, backtracking to the last * on a mismatch. When the name doesn't match before
+// any * of the pattern was reached, fail_out is set to the position in the name where it failed - any name sharing
+// more than that many characters with this one fails as well. Otherwise fail_out is set to UINT64_MAX
+static bool elfparser_match_glob(const char* pattern, const char* name, uint64_t* fail_out) {
+    const char* ptr = pattern;
+    const char* name_ptr = name;
+    const char* star = NULL;
+    const char* star_name = NULL;
+    
+    while (*name_ptr != '\0') {
+        const char* next;
+        if (*ptr == '*') {
+            while (*ptr == '*') ptr++;
+            if (*ptr == '\0') return true;  // A trailing * takes the rest of the name
+            star        = ptr;
+            star_name   = name_ptr;
+        } else if (*ptr != '\0' && elfparser_match_glob_item(ptr, *name_ptr, &next)) {
+            ptr = next;
+            name_ptr++;
+        } else if (star != NULL) {
+            // Let the last * take one more character
+            ptr         = star;
+            name_ptr    = ++star_name;
+        } else {
+            *fail_out = name_ptr - name;
+            return false;
+        }
+    }
+    
+    while (*ptr == '*') ptr++;
+    if (*ptr == '\0') return true;
+    
+    *fail_out = star == NULL ? (uint64_t)(name_ptr - name) : UINT64_MAX;
+    return false;
+}
+
+
+void elfparser_name_glob_cursor_init(const ElfParser_NameIndex* index, const char* pattern,
+                                     ElfParser_NameGlobCursor* cursor_out) {
+    cursor_out->index           = index;
+    cursor_out->pattern         = pattern;
+    cursor_out->fail_position   = UINT64_MAX;
+    
+    // Only names starting with the characters before the first wildcard can match
+    uint64_t length = strcspn(pattern, "*?[");
+    elfparser_find_name_prefix(index, pattern, length, &cursor_out->next, &cursor_out->end);
+}
+
+
+ElfParser_Error elfparser_name_glob_cursor_next(ElfParser_NameGlobCursor* cursor, ElfParser_Symbol* symbol_out) {
+    const ElfParser_NameIndex* index = cursor->index;
+    const ElfParser_NameEntry* entries = index->entries;
+    
+    while (cursor->next < cursor->end) {
+        const ElfParser_NameEntry* entry = &entries[cursor->next++];
+        
+        // Names sharing the part of the last name which already failed fail in the same way
+        if (cursor->fail_position != UINT64_MAX && entry->lcp > cursor->fail_position) continue;
+        
+        cursor->fail_position = UINT64_MAX;
+        if (elfparser_match_glob(cursor->pattern, elfparser_get_entry_name(index, entry), &cursor->fail_position)) {
+            return elfparser_name_index_get(index, cursor->next - 1, symbol_out);
+        }
+    }
+    return ELFPARSER_NOT_FOUND;
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+ElfParser_Error elfparser_note_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                           ElfParser_NoteCursor* cursor_out) {
+    cursor_out->elf_start       = elf_start;
+    cursor_out->header          = header;
+    cursor_out->segment_index   = 0;
+    cursor_out->next            = 0;
+    cursor_out->end             = 0;
+    cursor_out->alignment       = 4;
+    
+    return elfparser_program_header_cursor_init(elf_start, header, &cursor_out->segments);
+}
+
+
+// Move cursor to the start of the next PT_NOTE segment - returns false if there are none left
+static bool elfparser_note_cursor_next_segment(ElfParser_NoteCursor* cursor) {
+    ElfParser_ProgramHeader program_header;
+    
+    while (elfparser_program_header_cursor_next(&cursor->segments, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_NOTE) continue;
+        
+        // Skip segments with bad data
+        if (program_header.p_offset > cursor->header->elf_size ||
+            program_header.p_filesz > cursor->header->elf_size - program_header.p_offset) continue;
+        
+        cursor->segment_index   = program_header.index;
+        cursor->next            = program_header.p_offset;
+        cursor->end             = program_header.p_offset + program_header.p_filesz;
+        
+        // Notes are 4 byte aligned, except in segments which ask for 8 byte alignment (e.g. GNU property notes)
+        cursor->alignment       = program_header.p_align == 8 ? 8 : 4;
+        return true;
+    }
+    return false;
+}
+
+
+ElfParser_Error elfparser_note_cursor_next(ElfParser_NoteCursor* cursor, ElfParser_Note* note_out) {
+    const ElfParser_Header* header = cursor->header;
+    
+    while (true) {
+        if (cursor->end - cursor->next < sizeof(Elf_Nhdr)) {
+            // Current segment is used up
+            if (!elfparser_note_cursor_next_segment(cursor)) return ELFPARSER_NOT_FOUND;
+            continue;
+        }
+        
+        const Elf_Nhdr* nhdr = cursor->elf_start + cursor->next;
+        uint64_t align_mask = cursor->alignment - 1;
+        
+        note_out->n_namesz  = elfparser_read_32(header, &nhdr->n_namesz);
+        note_out->n_descsz  = elfparser_read_32(header, &nhdr->n_descsz);
+        note_out->n_type    = elfparser_read_32(header, &nhdr->n_type);
+        
+        uint64_t name_off = cursor->next + sizeof(Elf_Nhdr);
+        uint64_t desc_off = (name_off + note_out->n_namesz + align_mask) & ~align_mask;
+        uint64_t note_end = (desc_off + note_out->n_descsz + align_mask) & ~align_mask;
+        
+        if (desc_off + note_out->n_descsz > cursor->end) {
+            // Note runs past the end of the segment, so the rest of the segment can't be trusted
+            cursor->next = cursor->end;
+            continue;
+        }
+        
+        const char* name = cursor->elf_start + name_off;
+        note_out->name          = memchr(name, '\0', note_out->n_namesz) != NULL ? name : "";
+        note_out->desc          = cursor->elf_start + desc_off;
+        note_out->offset        = cursor->next;
+        note_out->segment_index = cursor->segment_index;
+        
+        cursor->next = note_end < cursor->end ? note_end : cursor->end;
+        return ELFPARSER_NOERROR;
+    }
+}
+
+
+ElfParser_Error elfparser_get_note(const void* elf_start, const ElfParser_Header* header, const char* name,
+                                   ElfParser_N_Type type, ElfParser_Note* note_out) {
+    if (name == NULL) {
+        // Null string not allowed
+        return ELFPARSER_INVALID;
+    }
+    
+    ElfParser_NoteCursor cursor;
+    elfparser_note_cursor_init(elf_start, header, &cursor);
+    
+    while (elfparser_note_cursor_next(&cursor, note_out) == ELFPARSER_NOERROR) {
+        if (note_out->n_type == type && strcmp(note_out->name, name) == 0) return ELFPARSER_NOERROR;
+    }
+    return ELFPARSER_NOT_FOUND;
+}
\ No newline at end of file
@@ -26,21 +26,8 @@
 
 
 ElfParser_Error elfparser_get_header(const void* elf_start, uint64_t elf_size, ElfParser_Header* header_out) {
-    // Start with basic checks to make sure file is long enough
-    if (elf_size < sizeof(Elf32_Ehdr)) return ELFPARSER_INVALID;
-    
-    header_out->elf_size = elf_size;
-    
-    const Elf32_Ehdr* header = elf_start;
-    Elf_Ident* ident = (Elf_Ident*)(&header->e_ident);
-
     // Parse header
-    if (ident->ei_class == ELFPARSER_ELFCLASS64) {
-        if (elfparser_get_header64(elf_start, header_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
-    }
-    else {
-        if (elfparser_get_header32(elf_start, header_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
-    }
+    if (elfparser_sniff_header(elf_start, elf_size, header_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
     
     // Get true # of sections and string table index
     header_out->true_shnum = elfparser_get_true_shnum(elf_start, header_out);
@@ -79,6 +66,33 @@ ElfParser_Error elfparser_get_header(const void* elf_start, uint64_t elf_size, E
 }
 
 
+ElfParser_Error elfparser_sniff_header(const void* data, uint64_t data_size, ElfParser_Header* header_out) {
+    // Start with basic checks to make sure file is long enough
+    if (data_size < sizeof(Elf32_Ehdr)) return ELFPARSER_INVALID;
+    
+    memset(header_out, 0, sizeof(ElfParser_Header));
+    header_out->elf_size = data_size;
+    
+    const Elf32_Ehdr* header = data;
+    Elf_Ident* ident = (Elf_Ident*)(&header->e_ident);
+    
+    // Parse header
+    if (ident->ei_class == ELFPARSER_ELFCLASS64) {
+        if (data_size < sizeof(Elf64_Ehdr)) return ELFPARSER_INVALID;
+        if (elfparser_get_header64(data, header_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
+    }
+    else {
+        if (elfparser_get_header32(data, header_out) != ELFPARSER_NOERROR) return ELFPARSER_INVALID;
+    }
+    
+    // Section 0 holds the real values if they don't fit, but it isn't read here
+    header_out->true_shnum      = header_out->e_shnum;
+    header_out->true_shstrndx   = header_out->e_shstrndx;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
 ElfParser_Error elfparser_get_section_header(const void* elf_start, const ElfParser_Header* header,
                                              uint64_t index, ElfParser_SectionHeader* section_header_out) {
     // Check that index is reasonable
@@ -110,12 +124,15 @@ ElfParser_Error elfparser_get_section_header_by_name(const void* elf_start, cons
         return ELFPARSER_INVALID;
     }
     
-    for (uint64_t i = 0; i < header->true_shnum; i++) {
-        ElfParser_Error err = elfparser_get_section_header(elf_start, header, i, section_header_out);
-        
-        if (err != ELFPARSER_NOERROR) continue;
-        
-        if (strcmp(name, section_header_out->name) == 0) {
+    uint64_t name_len = strlen(name);
+    
+    // Sections that lie outside the file are skipped by the cursor, so the return value can be ignored
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    
+    while (elfparser_section_cursor_next(&cursor, section_header_out) == ELFPARSER_NOERROR) {
+        if (elfparser_is_section_header_name_equal(elf_start, header, section_header_out, name, name_len)) {
+            elfparser_section_cursor_get_name(&cursor, section_header_out);
             return ELFPARSER_NOERROR;
         }
     }
@@ -125,26 +142,40 @@ ElfParser_Error elfparser_get_section_header_by_name(const void* elf_start, cons
 
 ElfParser_Error elfparser_get_symbol(const void* elf_start, const ElfParser_Header* header,
                                      uint64_t index, ElfParser_Symbol* symbol_out) {
+    ElfParser_SymbolTable table = {
+        .offset                 = header->symbol_table_offset,
+        .entry_size             = header->symbol_entry_size,
+        .num                    = header->symbol_num,
+        .string_table_offset    = header->symbol_string_table_offset
+    };
+    return elfparser_get_symbol_from_table(elf_start, header, &table, index, symbol_out);
+}
+
+
+ElfParser_Error elfparser_get_symbol_from_table(const void* elf_start, const ElfParser_Header* header,
+                                                const ElfParser_SymbolTable* table, uint64_t index,
+                                                ElfParser_Symbol* symbol_out) {
     // Check that index is reasonable
-    if (index >= header->symbol_num) return ELFPARSER_INVALID;
+    if (index >= table->num) return ELFPARSER_INVALID;
     
-    uint64_t symbol_off = header->symbol_table_offset + (uint64_t)header->symbol_entry_size * index;
+    // Tables may come from anywhere, so check the offset without letting it wrap around
+    uint64_t symbol_size = header->ei_class == ELFPARSER_ELFCLASS64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+    if (table->entry_size != 0 && index > UINT64_MAX / table->entry_size) return ELFPARSER_INVALID;
+    uint64_t symbol_rel = table->entry_size * index;
+    if (table->offset > header->elf_size || symbol_rel > header->elf_size - table->offset) return ELFPARSER_INVALID;
+    uint64_t symbol_off = table->offset + symbol_rel;
+    if (symbol_size > header->elf_size - symbol_off) return ELFPARSER_INVALID;
 
     // Get symbol
     if (header->ei_class == ELFPARSER_ELFCLASS64) {
-        if (symbol_off + sizeof(Elf64_Sym) > header->elf_size) return ELFPARSER_INVALID; // Check that offset is within bounds
         elfparser_get_symbol64(header, elf_start + symbol_off, symbol_out);
-        
     } else {
-        if (symbol_off + sizeof(Elf32_Sym) > header->elf_size) return ELFPARSER_INVALID; // Check that offset is within bounds
         elfparser_get_symbol32(header, elf_start + symbol_off, symbol_out);
     }
     
-    symbol_out->st_bind         = symbol_out->st_info  >> 4;
-    symbol_out->st_type         = symbol_out->st_info  & 0xf;
-    symbol_out->st_visibility   = symbol_out->st_other & 0x3;
+    elfparser_decode_symbol_info(symbol_out);
     symbol_out->index           = index;
-    symbol_out->name            = elfparser_get_symbol_name(elf_start, header, symbol_out);
+    symbol_out->name            = elfparser_get_symbol_name(elf_start, header, table->string_table_offset, symbol_out);
     
     return ELFPARSER_NOERROR;
 }
@@ -157,12 +188,15 @@ ElfParser_Error elfparser_get_symbol_by_name(const void* elf_start, const ElfPar
         return ELFPARSER_INVALID;
     }
     
-    for (uint64_t i = 0; i < header->symbol_num; i++) {
-        ElfParser_Error err = elfparser_get_symbol(elf_start, header, i, symbol_out);
-        
-        if (err != ELFPARSER_NOERROR) continue;
-        
-        if (strcmp(name, symbol_out->name) == 0) {
+    uint64_t name_len = strlen(name);
+    
+    // Symbols that lie outside the file are skipped by the cursor, so the return value can be ignored
+    ElfParser_SymbolCursor cursor;
+    elfparser_symbol_cursor_init(elf_start, header, &cursor);
+    
+    while (elfparser_symbol_cursor_next(&cursor, symbol_out) == ELFPARSER_NOERROR) {
+        if (elfparser_is_symbol_name_equal(elf_start, header, cursor.string_table_offset, symbol_out, name, name_len)) {
+            elfparser_symbol_cursor_get_name(&cursor, symbol_out);
             return ELFPARSER_NOERROR;
         }
     }
@@ -170,6 +204,19 @@ ElfParser_Error elfparser_get_symbol_by_name(const void* elf_start, const ElfPar
 }
 
 
+ElfParser_Error elfparser_get_symbol_table(const void* elf_start, const ElfParser_Header* header,
+                                           ElfParser_SH_Type type, ElfParser_SymbolTable* table_out) {
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.sh_type == type) return elfparser_get_section_symbol_table(elf_start, header, &section, table_out);
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
 ElfParser_Error elfparser_get_program_header(const void* elf_start, const ElfParser_Header* header,
                                              uint64_t index, ElfParser_ProgramHeader* program_header_out) {
     // Check that index is reasonable
@@ -301,22 +348,42 @@ uint64_t elfparser_get_true_shstrndx(const void* elf_start, const ElfParser_Head
 }
 
 
-const char* elfparser_get_section_header_name(const void* elf_start, const ElfParser_Header* header,
-                                              const ElfParser_SectionHeader* section) {
+bool elfparser_get_section_header_name_offset(const ElfParser_Header* header, const ElfParser_SectionHeader* section,
+                                              uint64_t* name_off_out) {
     // If there is no string table section, then we don't have a name to return
-    if (header->true_shstrndx == 0) return "";
+    if (header->true_shstrndx == 0) return false;
     
     // If we're looking at the null/undefined section header, we already know there's no name
-    if (section->index == 0) return "";
+    if (section->index == 0) return false;
     
-    uint64_t name_off; // Offset of name in file
     if (section->index == header->true_shstrndx) {
         // If this current section *is* the string table, get the name offset using own section offset
-        name_off = section->sh_offset + section->sh_name;
+        *name_off_out = section->sh_offset + section->sh_name;
     } else { 
         // Else, get offset using header field previously set by elfparser_get_header
-        name_off = header->string_table_offset + section->sh_name;
+        *name_off_out = header->string_table_offset + section->sh_name;
     }
+    return true;
+}
+
+
+bool elfparser_get_symbol_name_offset(uint64_t string_table_offset, const ElfParser_Symbol* symbol,
+                                      uint64_t* name_off_out) {
+    // If there is no symbol string table section, then we don't have a name to return
+    if (string_table_offset == 0) return false;
+    
+    // If we're looking at the null/undefined symbol, we already know there's no name
+    if (symbol->index == 0) return false;
+    
+    *name_off_out = string_table_offset + symbol->st_name;
+    return true;
+}
+
+
+const char* elfparser_get_section_header_name(const void* elf_start, const ElfParser_Header* header,
+                                              const ElfParser_SectionHeader* section) {
+    uint64_t name_off; // Offset of name in file
+    if (!elfparser_get_section_header_name_offset(header, section, &name_off)) return "";
     
     // Return empty string if name out of bounds
     if (!elfparser_is_string_in_bounds(elf_start, header, name_off)) return "";
@@ -327,18 +394,76 @@ const char* elfparser_get_section_header_name(const void* elf_start, const ElfPa
 
 
 const char* elfparser_get_symbol_name(const void* elf_start, const ElfParser_Header* header,
-                                      const ElfParser_Symbol* symbol) {
-    // If there is no symbol string table section, then we don't have a name to return
-    if (header->symbol_string_table_offset == 0) return "";
-    
-    // If we're looking at the null/undefined symbol, we already know there's no name
-    if (symbol->index == 0) return "";
-    
-    uint64_t name_off = header->symbol_string_table_offset + symbol->st_name; // Offset of name in file
+                                      uint64_t string_table_offset, const ElfParser_Symbol* symbol) {
+    uint64_t name_off; // Offset of name in file
+    if (!elfparser_get_symbol_name_offset(string_table_offset, symbol, &name_off)) return "";
 
     // Return empty string if name out of bounds
     if (!elfparser_is_string_in_bounds(elf_start, header, name_off)) return "";
     
     // Else return name
     return elf_start + name_off;
+}
+
+
+bool elfparser_is_section_header_name_equal(const void* elf_start, const ElfParser_Header* header,
+                                            const ElfParser_SectionHeader* section, const char* name, uint64_t name_len) {
+    uint64_t name_off;
+    if (!elfparser_get_section_header_name_offset(header, section, &name_off)) return name_len == 0;
+    
+    return elfparser_is_string_equal(elf_start, header, name_off, name, name_len);
+}
+
+
+bool elfparser_is_symbol_name_equal(const void* elf_start, const ElfParser_Header* header, uint64_t string_table_offset,
+                                    const ElfParser_Symbol* symbol, const char* name, uint64_t name_len) {
+    uint64_t name_off;
+    if (!elfparser_get_symbol_name_offset(string_table_offset, symbol, &name_off)) return name_len == 0;
+    
+    return elfparser_is_string_equal(elf_start, header, name_off, name, name_len);
+}
+
+
+ElfParser_Error elfparser_get_section_symbol_table(const void* elf_start, const ElfParser_Header* header,
+                                                   const ElfParser_SectionHeader* section, ElfParser_SymbolTable* table_out) {
+    // Entry size of 0 would make the number of symbols meaningless
+    if (section->sh_entsize == 0) return ELFPARSER_INVALID;
+    if (section->sh_offset > header->elf_size || section->sh_size > header->elf_size - section->sh_offset) {
+        return ELFPARSER_INVALID;
+    }
+    
+    table_out->offset               = section->sh_offset;
+    table_out->entry_size           = section->sh_entsize;
+    table_out->num                  = section->sh_size / section->sh_entsize;
+    table_out->section_index        = section->index;
+    table_out->string_table_offset  = 0; // Default
+    
+    // Get section of symbol string table referenced by sh_link
+    ElfParser_SectionHeader string_section;
+    if (elfparser_get_section_header(elf_start, header, section->sh_link, &string_section) == ELFPARSER_NOERROR) {
+        table_out->string_table_offset = string_section.sh_offset;
+    }
+    return ELFPARSER_NOERROR;
+}
+
+
+bool elfparser_get_vaddr_file_offset(const void* elf_start, const ElfParser_Header* header, uint64_t vaddr,
+                                     uint64_t* offset_out, uint64_t* size_out) {
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_LOAD || program_header.p_offset > header->elf_size) continue;
+        
+        // Only the part of the segment's file data which is actually within the file can be used
+        uint64_t filesz = program_header.p_filesz;
+        if (filesz > header->elf_size - program_header.p_offset) filesz = header->elf_size - program_header.p_offset;
+        if (vaddr < program_header.p_vaddr || vaddr - program_header.p_vaddr >= filesz) continue;
+        
+        *offset_out = program_header.p_offset + (vaddr - program_header.p_vaddr);
+        *size_out = filesz - (vaddr - program_header.p_vaddr);
+        return true;
+    }
+    return false;
 }
\ No newline at end of file
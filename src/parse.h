@@ -43,8 +43,33 @@ uint64_t elfparser_get_true_shstrndx(const void* elf_start, const ElfParser_Head
 const char* elfparser_get_section_header_name(const void* elf_start, const ElfParser_Header* header,
                                               const ElfParser_SectionHeader* section);
 
+// Fill in table_out from a symbol table section header - returns ELFPARSER_INVALID if the entry size is 0, or the
+// table lies outside the file
+ElfParser_Error elfparser_get_section_symbol_table(const void* elf_start, const ElfParser_Header* header,
+                                                   const ElfParser_SectionHeader* section, ElfParser_SymbolTable* table_out);
+
+// Symbol names are read from the string table at string_table_offset, e.g. header->symbol_string_table_offset for .symtab
 const char* elfparser_get_symbol_name(const void* elf_start, const ElfParser_Header* header,
-                                      const ElfParser_Symbol* symbol);
+                                      uint64_t string_table_offset, const ElfParser_Symbol* symbol);
+
+// Get file offset of name - returns false if the section/symbol has no name
+bool elfparser_get_section_header_name_offset(const ElfParser_Header* header, const ElfParser_SectionHeader* section,
+                                              uint64_t* name_off_out);
+
+bool elfparser_get_symbol_name_offset(uint64_t string_table_offset, const ElfParser_Symbol* symbol,
+                                      uint64_t* name_off_out);
+
+// Same result as strcmp(name, elfparser_get_x_name(...)) == 0, but without scanning for the end of the string in the file
+bool elfparser_is_section_header_name_equal(const void* elf_start, const ElfParser_Header* header,
+                                            const ElfParser_SectionHeader* section, const char* name, uint64_t name_len);
+
+bool elfparser_is_symbol_name_equal(const void* elf_start, const ElfParser_Header* header, uint64_t string_table_offset,
+                                    const ElfParser_Symbol* symbol, const char* name, uint64_t name_len);
+
+// Translate an address to a file offset through the PT_LOAD segments, and get the number of bytes of the segment's file
+// data from there on, up to the end of the file - returns false if no segment has file data at the address
+bool elfparser_get_vaddr_file_offset(const void* elf_start, const ElfParser_Header* header, uint64_t vaddr,
+                                     uint64_t* offset_out, uint64_t* size_out);
 
 
 // 32-bit specific functions
@@ -74,6 +99,28 @@ void elfparser_get_program_header64(const ElfParser_Header* header, const Elf64_
 
 // Inline functions below here
 
+// Get the number of table entries, starting from the first, which lie entirely within the file
+static inline uint64_t elfparser_get_num_entries_in_bounds(const ElfParser_Header* header, uint64_t table_off,
+                                                           uint64_t entry_size, uint64_t struct_size, uint64_t num) {
+    if (num == 0) return 0;
+    
+    // Check that the first entry fits
+    if (table_off > header->elf_size || struct_size > header->elf_size - table_off) return 0;
+    
+    // With an entry size of 0, every entry is the first entry
+    if (entry_size == 0) return num;
+    
+    uint64_t num_fit = (header->elf_size - table_off - struct_size) / entry_size + 1;
+    return num_fit < num ? num_fit : num;
+}
+
+// Fill in the members of a symbol which are calculated from st_info and st_other
+static inline void elfparser_decode_symbol_info(ElfParser_Symbol* symbol) {
+    symbol->st_bind         = symbol->st_info  >> 4;
+    symbol->st_type         = symbol->st_info  & 0xf;
+    symbol->st_visibility   = symbol->st_other & 0x3;
+}
+
 // Check if null/magic section @ index 0 is valid
 static inline bool elfparser_is_null_section(const ElfParser_SectionHeader* section) {
     return  section->sh_name        == 0 &&
@@ -97,4 +144,71 @@ static inline bool elfparser_is_string_in_bounds(const void* elf_start, const El
     // Check that string is null-terminated
     const char* str_ptr = elf_start + string_off;
     return memchr(str_ptr, '\0', header->elf_size - string_off) != NULL;
+}
+
+// Read a value from anywhere in the file (no alignment needed) and convert it to host byte order
+static inline uint16_t elfparser_read_16(const ElfParser_Header* header, const void* ptr) {
+    uint16_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return convert_endian_16(value, header->ei_data == ELFPARSER_ELFDATA2LSB);
+}
+
+static inline uint32_t elfparser_read_32(const ElfParser_Header* header, const void* ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return convert_endian_32(value, header->ei_data == ELFPARSER_ELFDATA2LSB);
+}
+
+static inline uint64_t elfparser_read_64(const ElfParser_Header* header, const void* ptr) {
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return convert_endian_64(value, header->ei_data == ELFPARSER_ELFDATA2LSB);
+}
+
+// Size of a word (e.g. unsigned long or a pointer) of the machine the file was made for
+static inline uint64_t elfparser_get_word_size(const ElfParser_Header* header) {
+    return header->ei_class == ELFPARSER_ELFCLASS64 ? 8 : 4;
+}
+
+static inline uint64_t elfparser_read_word(const ElfParser_Header* header, const void* ptr) {
+    return header->ei_class == ELFPARSER_ELFCLASS64 ? elfparser_read_64(header, ptr) : elfparser_read_32(header, ptr);
+}
+
+// Hash function used by DT_GNU_HASH tables. Also returns length of name
+static inline uint32_t elfparser_gnu_hash(const char* name, uint64_t* name_len_out) {
+    uint32_t hash = 5381;
+    const unsigned char* c = (const unsigned char*)name;
+    
+    for (; *c != '\0'; c++) {
+        hash = hash * 33 + *c;
+    }
+    
+    if (name_len_out != NULL) *name_len_out = c - (const unsigned char*)name;
+    return hash;
+}
+
+// Hash function used by DT_HASH tables
+static inline uint32_t elfparser_elf_hash(const char* name) {
+    uint32_t hash = 0;
+    
+    for (const unsigned char* c = (const unsigned char*)name; *c != '\0'; c++) {
+        hash = (hash << 4) + *c;
+        uint32_t high = hash & 0xf0000000;
+        if (high != 0) hash ^= high >> 24;
+        hash &= ~high;
+    }
+    return hash;
+}
+
+// Check that string at string_off is in bounds and equal to name, which is name_len bytes long (excluding terminator)
+static inline bool elfparser_is_string_equal(const void* elf_start, const ElfParser_Header* header,
+                                             uint64_t string_off, const char* name, uint64_t name_len) {
+    if (name_len == 0) {
+        // Out of bounds strings are treated as empty strings, so they are equal to an empty name
+        return !elfparser_is_string_in_bounds(elf_start, header, string_off) || *(const char*)(elf_start + string_off) == '\0';
+    }
+    
+    // Compare terminator as well - this also checks that the string is terminated within the file
+    if (string_off >= header->elf_size || header->elf_size - string_off <= name_len) return false;
+    return memcmp(elf_start + string_off, name, name_len + 1) == 0;
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+// Epoch based reclamation. A reader announces the epoch it started in before loading any published pointer, and a
+// writer retires the old value of a slot in the epoch it replaced it in. All of these are sequentially consistent, so
+// a reader either announced an epoch which holds back the reclamation of what it may load, or started late enough to
+// only load the new values
+
+
+void elfparser_rcu_init(ElfParser_RcuDomain* domain) {
+    // Epoch 0 marks an idle reader
+    domain->epoch = 1;
+    for (uint64_t i = 0; i < ELFPARSER_RCU_MAX_READERS; i++) domain->readers[i].epoch = 0;
+}
+
+
+void elfparser_rcu_read_lock(ElfParser_RcuDomain* domain, uint64_t reader) {
+    uint64_t epoch = __atomic_load_n(&domain->epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&domain->readers[reader].epoch, epoch, __ATOMIC_SEQ_CST);
+}
+
+
+void elfparser_rcu_read_unlock(ElfParser_RcuDomain* domain, uint64_t reader) {
+    // Every read of the published data must be done before the reader looks idle
+    __atomic_store_n(&domain->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+
+void* elfparser_rcu_dereference(void* const* slot) {
+    return __atomic_load_n(slot, __ATOMIC_SEQ_CST);
+}
+
+
+uint64_t elfparser_rcu_publish(ElfParser_RcuDomain* domain, void** slot, void* value, void** old_out) {
+    // The value is fully built before this, and the exchange makes it visible to every later load
+    void* old = __atomic_exchange_n(slot, value, __ATOMIC_SEQ_CST);
+    if (old_out != NULL) *old_out = old;
+    return __atomic_fetch_add(&domain->epoch, 1, __ATOMIC_SEQ_CST);
+}
+
+
+uint64_t elfparser_rcu_get_safe_epoch(const ElfParser_RcuDomain* domain) {
+    // Every value retired before the current epoch is safe unless a reader started before it was retired
+    uint64_t safe_epoch = __atomic_load_n(&domain->epoch, __ATOMIC_SEQ_CST);
+    for (uint64_t i = 0; i < ELFPARSER_RCU_MAX_READERS; i++) {
+        uint64_t epoch = __atomic_load_n(&domain->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < safe_epoch) safe_epoch = epoch;
+    }
+    return safe_epoch;
+}
\ No newline at end of file
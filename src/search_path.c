@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+
+// If `position` starts with the token `name`, either as $NAME or ${NAME}, returns the length of the token, otherwise 0
+static uint64_t elfparser_match_search_path_token(const char* position, const char* end, const char* name) {
+    uint64_t name_len = strlen(name);
+    uint64_t left = end - position;
+    
+    if (left >= name_len + 1 && memcmp(position + 1, name, name_len) == 0) {
+        // $NAME must not run on into more identifier characters, e.g. $ORIGINAL is not $ORIGIN
+        char next = name_len + 1 < left ? position[name_len + 1] : '\0';
+        bool is_identifier = (next >= 'A' && next <= 'Z') || (next >= 'a' && next <= 'z') ||
+                             (next >= '0' && next <= '9') || next == '_';
+        if (!is_identifier) return name_len + 1;
+    }
+    if (left >= name_len + 3 && position[1] == '{' && memcmp(position + 2, name, name_len) == 0 &&
+        position[name_len + 2] == '}') {
+        return name_len + 3;
+    }
+    return 0;
+}
+
+
+void elfparser_search_path_cursor_init(const char* path_list, const char* origin, const char* lib, const char* platform,
+                                       ElfParser_SearchPathCursor* cursor_out) {
+    cursor_out->next        = path_list;
+    cursor_out->origin      = origin;
+    cursor_out->lib         = lib;
+    cursor_out->platform    = platform;
+}
+
+
+ElfParser_Error elfparser_search_path_cursor_next(ElfParser_SearchPathCursor* cursor, char* dest, uint64_t dest_size) {
+    if (cursor->next == NULL) return ELFPARSER_NOT_FOUND;
+    
+    const char* start = cursor->next;
+    const char* end = strchr(start, ':');
+    if (end == NULL) {
+        end = start + strlen(start);
+        cursor->next = NULL;
+    } else {
+        cursor->next = end + 1;
+    }
+    
+    // An empty entry means the current directory
+    if (start == end) {
+        start = ".";
+        end = start + 1;
+    }
+    
+    uint64_t len = 0;
+    bool fits = true;
+    bool skip = false;
+    
+    for (const char* position = start; position < end; ) {
+        const char* replacement = NULL;
+        uint64_t token_len = 0;
+        
+        if (*position == '$') {
+            if      ((token_len = elfparser_match_search_path_token(position, end, "ORIGIN")) != 0)   replacement = cursor->origin;
+            else if ((token_len = elfparser_match_search_path_token(position, end, "LIB")) != 0)      replacement = cursor->lib;
+            else if ((token_len = elfparser_match_search_path_token(position, end, "PLATFORM")) != 0) replacement = cursor->platform;
+        }
+        
+        if (token_len == 0) {
+            // Plain character, including a $ which doesn't start a known token
+            if (len + 1 < dest_size) dest[len] = *position;
+            else                     fits = false;
+            len++;
+            position++;
+            continue;
+        }
+        
+        if (replacement == NULL) skip = true;
+        else {
+            uint64_t replacement_len = strlen(replacement);
+            if (len + replacement_len < dest_size) memcpy(dest + len, replacement, replacement_len);
+            else                                   fits = false;
+            len += replacement_len;
+        }
+        position += token_len;
+    }
+    
+    if (dest_size > 0) dest[fits ? len : 0] = '\0';
+    
+    // Entries with a token that can't be expanded are left out entirely
+    if (skip) return elfparser_search_path_cursor_next(cursor, dest, dest_size);
+    return fits ? ELFPARSER_NOERROR : ELFPARSER_INVALID;
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+// Section types below this value get a bitmap, the rest are found by scanning sh_type
+#define NUM_TYPE_BITMAPS 32
+
+
+// Get the number of slots in the name hash table - a power of 2 at least twice the number of sections
+static uint64_t elfparser_get_name_bucket_num(uint64_t num) {
+    uint64_t bucket_num = 1;
+    while (bucket_num < num * 2) bucket_num <<= 1;
+    return bucket_num;
+}
+
+
+uint64_t elfparser_get_section_cache_size(const ElfParser_Header* header) {
+    // Indexes are stored in 32 bits, so larger tables can't be cached. UINT64_MAX is never a valid buffer size
+    uint64_t num = header->true_shnum;
+    if (num > UINT32_MAX) return UINT64_MAX;
+    uint64_t bitmap_words = (num + 63) / 64;
+    
+    return  7 +                                         // Slack for aligning start of buffer
+            num * sizeof(uint64_t) * 6 +                // sh_flags, sh_addr, sh_offset, sh_size, name_offset, addr_max_end
+            bitmap_words * sizeof(uint64_t) * NUM_TYPE_BITMAPS +
+            num * sizeof(uint32_t) * 3 +                // sh_type, name_hash, addr_order
+            elfparser_get_name_bucket_num(num) * sizeof(uint32_t);
+}
+
+
+static bool elfparser_is_section_addr_less(const void* a, const void* b, const void* context) {
+    const ElfParser_SectionCache* cache = context;
+    return cache->sh_addr[*(const uint32_t*)a] < cache->sh_addr[*(const uint32_t*)b];
+}
+
+
+static bool elfparser_is_cached_name_equal(const ElfParser_SectionCache* cache, uint64_t index,
+                                           const char* name, uint64_t name_len) {
+    uint64_t name_off = cache->name_offset[index];
+    if (name_off == UINT64_MAX) return name_len == 0;
+    
+    return elfparser_is_string_equal(cache->elf_start, cache->header, name_off, name, name_len);
+}
+
+
+ElfParser_Error elfparser_build_section_cache(const void* elf_start, const ElfParser_Header* header,
+                                              void* buffer, uint64_t buffer_size, ElfParser_SectionCache* cache_out) {
+    if (header->true_shnum > UINT32_MAX) return ELFPARSER_INVALID; // Indexes are stored in 32 bits
+    if (buffer == NULL || buffer_size < elfparser_get_section_cache_size(header)) return ELFPARSER_INVALID;
+    
+    uint64_t num = header->true_shnum;
+    uint64_t bucket_num = elfparser_get_name_bucket_num(num);
+    
+    cache_out->elf_start        = elf_start;
+    cache_out->header           = header;
+    cache_out->bitmap_words     = (num + 63) / 64;
+    cache_out->name_bucket_mask = bucket_num - 1;
+    
+    // Carve arrays out of buffer, 64-bit arrays first so that everything stays aligned
+    uint8_t* ptr = (uint8_t*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+    cache_out->sh_flags         = (uint64_t*)ptr;   ptr += num * sizeof(uint64_t);
+    cache_out->sh_addr          = (uint64_t*)ptr;   ptr += num * sizeof(uint64_t);
+    cache_out->sh_offset        = (uint64_t*)ptr;   ptr += num * sizeof(uint64_t);
+    cache_out->sh_size          = (uint64_t*)ptr;   ptr += num * sizeof(uint64_t);
+    cache_out->name_offset      = (uint64_t*)ptr;   ptr += num * sizeof(uint64_t);
+    cache_out->addr_max_end     = (uint64_t*)ptr;   ptr += num * sizeof(uint64_t);
+    cache_out->type_bitmaps     = (uint64_t*)ptr;   ptr += cache_out->bitmap_words * sizeof(uint64_t) * NUM_TYPE_BITMAPS;
+    cache_out->sh_type          = (uint32_t*)ptr;   ptr += num * sizeof(uint32_t);
+    cache_out->name_hash        = (uint32_t*)ptr;   ptr += num * sizeof(uint32_t);
+    cache_out->addr_order       = (uint32_t*)ptr;   ptr += num * sizeof(uint32_t);
+    cache_out->name_buckets     = (uint32_t*)ptr;
+    
+    memset(cache_out->type_bitmaps, 0, cache_out->bitmap_words * sizeof(uint64_t) * NUM_TYPE_BITMAPS);
+    memset(cache_out->name_buckets, 0, bucket_num * sizeof(uint32_t));
+    
+    // Sections that lie outside the file are skipped by the cursor, so the return value can be ignored
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    cache_out->num = cursor.num;
+    cache_out->addr_num = 0;
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&cursor, &section) == ELFPARSER_NOERROR) {
+        uint64_t i = section.index;
+        
+        cache_out->sh_type[i]   = section.sh_type;
+        cache_out->sh_flags[i]  = section.sh_flags;
+        cache_out->sh_addr[i]   = section.sh_addr;
+        cache_out->sh_offset[i] = section.sh_offset;
+        cache_out->sh_size[i]   = section.sh_size;
+        
+        // Sections without a valid name are treated as having an empty name, same as elfparser_get_section_header
+        const char* name = elfparser_section_cursor_get_name(&cursor, &section);
+        cache_out->name_hash[i]     = elfparser_gnu_hash(name, NULL);
+        cache_out->name_offset[i]   = name[0] == '\0' ? UINT64_MAX : (uint64_t)(name - (const char*)elf_start);
+        
+        // Insert into name table - earlier sections are always found first when probing
+        uint64_t slot = cache_out->name_hash[i] & cache_out->name_bucket_mask;
+        while (cache_out->name_buckets[slot] != 0) slot = (slot + 1) & cache_out->name_bucket_mask;
+        cache_out->name_buckets[slot] = i + 1;
+        
+        if (section.sh_type < NUM_TYPE_BITMAPS) {
+            cache_out->type_bitmaps[section.sh_type * cache_out->bitmap_words + i / 64] |= (uint64_t)1 << (i % 64);
+        }
+        
+        // .tbss doesn't occupy any addresses outside of the TLS template, so leave it out of the address lookup
+        bool is_tbss = (section.sh_flags & ELFPARSER_SHF_TLS) && section.sh_type == ELFPARSER_SHT_NOBITS;
+        if ((section.sh_flags & ELFPARSER_SHF_ALLOC) && section.sh_size != 0 && !is_tbss) {
+            cache_out->addr_order[cache_out->addr_num++] = i;
+        }
+    }
+    
+    elfparser_sort(cache_out->addr_order, cache_out->addr_num, sizeof(uint32_t), elfparser_is_section_addr_less, cache_out);
+    
+    // Sections may overlap, so keep track of the furthest any section reaches to know when to stop searching backwards
+    uint64_t max_end = 0;
+    for (uint64_t i = 0; i < cache_out->addr_num; i++) {
+        uint64_t index = cache_out->addr_order[i];
+        uint64_t end = cache_out->sh_addr[index] + cache_out->sh_size[index];
+        if (end > max_end) max_end = end;
+        cache_out->addr_max_end[i] = max_end;
+    }
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_section_cache_find_by_name(const ElfParser_SectionCache* cache, const char* name,
+                                                     uint64_t* index_out) {
+    if (name == NULL) {
+        // Null string not allowed
+        return ELFPARSER_INVALID;
+    }
+    
+    uint64_t name_len;
+    uint32_t hash = elfparser_gnu_hash(name, &name_len);
+    
+    for (uint64_t slot = hash & cache->name_bucket_mask; cache->name_buckets[slot] != 0;
+         slot = (slot + 1) & cache->name_bucket_mask) {
+        uint64_t index = cache->name_buckets[slot] - 1;
+        
+        if (cache->name_hash[index] == hash && elfparser_is_cached_name_equal(cache, index, name, name_len)) {
+            *index_out = index;
+            return ELFPARSER_NOERROR;
+        }
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+ElfParser_Error elfparser_section_cache_find_by_address(const ElfParser_SectionCache* cache, uint64_t addr,
+                                                        uint64_t* index_out) {
+    // Find first section starting after addr
+    uint64_t low = 0;
+    uint64_t high = cache->addr_num;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (cache->sh_addr[cache->addr_order[mid]] <= addr) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    // Search backwards through the sections starting at or before addr, until none of them can reach addr
+    for (uint64_t i = low; i > 0 && cache->addr_max_end[i - 1] > addr; i--) {
+        uint64_t index = cache->addr_order[i - 1];
+        
+        if (addr - cache->sh_addr[index] < cache->sh_size[index]) {
+            *index_out = index;
+            return ELFPARSER_NOERROR;
+        }
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+ElfParser_Error elfparser_section_cache_find_by_type(const ElfParser_SectionCache* cache, ElfParser_SH_Type type,
+                                                     uint64_t start_index, uint64_t* index_out) {
+    if (start_index >= cache->num) return ELFPARSER_NOT_FOUND;
+    
+    if (type >= NUM_TYPE_BITMAPS) {
+        // No bitmap for this type, scan instead
+        for (uint64_t i = start_index; i < cache->num; i++) {
+            if (cache->sh_type[i] == type) {
+                *index_out = i;
+                return ELFPARSER_NOERROR;
+            }
+        }
+        return ELFPARSER_NOT_FOUND;
+    }
+    
+    const uint64_t* bitmap = cache->type_bitmaps + type * cache->bitmap_words;
+    
+    // Mask out sections before start_index in the first word
+    uint64_t word_index = start_index / 64;
+    uint64_t word = bitmap[word_index] & (UINT64_MAX << (start_index % 64));
+    
+    while (true) {
+        if (word != 0) {
+            *index_out = word_index * 64 + __builtin_ctzll(word);
+            return ELFPARSER_NOERROR;
+        }
+        if (++word_index >= cache->bitmap_words) return ELFPARSER_NOT_FOUND;
+        word = bitmap[word_index];
+    }
+}
+
+
+const char* elfparser_section_cache_get_name(const ElfParser_SectionCache* cache, uint64_t index) {
+    if (index >= cache->num || cache->name_offset[index] == UINT64_MAX) return "";
+    return cache->elf_start + cache->name_offset[index];
+}
\ No newline at end of file
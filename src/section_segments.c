@@ -0,0 +1,183 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+// Allocated sections are matched to segments by address, and other sections by file offset. Both kinds are kept in one
+// array - allocated sections first, each kind sorted by its own start - so each segment only looks at a run of entries
+typedef struct {
+    bool                is_alloc;
+    uint64_t            start;      // sh_addr if allocated, otherwise sh_offset
+    uint64_t            sh_addr;
+    uint64_t            sh_offset;
+    uint64_t            sh_size;
+    ElfParser_SH_Type   sh_type;
+    ElfParser_SH_Flags  sh_flags;
+    uint64_t            index;
+} ElfParser_MappingSection;
+
+
+static bool elfparser_is_mapping_section_less(const void* a, const void* b, const void* context) {
+    const ElfParser_MappingSection* section_a = a;
+    const ElfParser_MappingSection* section_b = b;
+    
+    if (section_a->is_alloc != section_b->is_alloc) return section_a->is_alloc;
+    if (section_a->start != section_b->start) return section_a->start < section_b->start;
+    return section_a->index < section_b->index;
+}
+
+
+// Same rules as readelf's section to segment mapping
+static bool elfparser_is_section_in_segment(const ElfParser_MappingSection* section,
+                                            const ElfParser_ProgramHeader* program_header) {
+    ElfParser_P_Type p_type = program_header->p_type;
+    bool is_tls = (section->sh_flags & ELFPARSER_SHF_TLS) != 0;
+    bool is_nobits = section->sh_type == ELFPARSER_SHT_NOBITS;
+    
+    // TLS sections only belong in TLS, RELRO and loadable segments, other sections never belong in TLS or PHDR segments
+    if (is_tls) {
+        if (p_type != ELFPARSER_PT_TLS && p_type != ELFPARSER_PT_GNU_RELRO && p_type != ELFPARSER_PT_LOAD) return false;
+    } else {
+        if (p_type == ELFPARSER_PT_TLS || p_type == ELFPARSER_PT_PHDR) return false;
+    }
+    
+    // These segments are only made of allocated sections
+    if (!section->is_alloc && (p_type == ELFPARSER_PT_LOAD || p_type == ELFPARSER_PT_DYNAMIC ||
+                               p_type == ELFPARSER_PT_GNU_EH_FRAME || p_type == ELFPARSER_PT_GNU_STACK ||
+                               p_type == ELFPARSER_PT_GNU_RELRO || p_type == ELFPARSER_PT_GNU_SFRAME ||
+                               (ELFPARSER_PT_GNU_MBIND_LO <= p_type && p_type <= ELFPARSER_PT_GNU_MBIND_HI))) {
+        return false;
+    }
+    
+    // .tbss only takes up space in the TLS segment - elsewhere it overlaps whatever follows it
+    if (is_tls && is_nobits && p_type != ELFPARSER_PT_TLS) return false;
+    
+    // Any section with file data must lie within the segment's file data
+    if (!is_nobits) {
+        if (section->sh_offset < program_header->p_offset) return false;
+        uint64_t rel_offset = section->sh_offset - program_header->p_offset;
+        if (rel_offset > program_header->p_filesz || section->sh_size > program_header->p_filesz - rel_offset) {
+            return false;
+        }
+        // Empty sections right at the end belong to whatever follows the segment
+        if (program_header->p_filesz != 0 && rel_offset == program_header->p_filesz) return false;
+    }
+    
+    if (section->is_alloc) {
+        if (section->sh_addr < program_header->p_vaddr) return false;
+        uint64_t rel_addr = section->sh_addr - program_header->p_vaddr;
+        if (rel_addr > program_header->p_memsz || section->sh_size > program_header->p_memsz - rel_addr) return false;
+        if (program_header->p_memsz != 0 && rel_addr == program_header->p_memsz) return false;
+    }
+    
+    // Empty sections at either end of these segments don't belong to them either
+    if ((p_type != ELFPARSER_PT_DYNAMIC && p_type != ELFPARSER_PT_NOTE) || section->sh_size != 0 ||
+        program_header->p_memsz == 0) {
+        return true;
+    }
+    if (!is_nobits && (section->sh_offset == program_header->p_offset ||
+                       section->sh_offset - program_header->p_offset >= program_header->p_filesz)) {
+        return false;
+    }
+    return !section->is_alloc || (section->sh_addr != program_header->p_vaddr &&
+                                  section->sh_addr - program_header->p_vaddr < program_header->p_memsz);
+}
+
+
+uint64_t elfparser_get_section_segment_buffer_size(const ElfParser_Header* header) {
+    return sizeof(ElfParser_MappingSection) * header->true_shnum + 7;
+}
+
+
+ElfParser_Error elfparser_map_sections_to_segments(const void* elf_start, const ElfParser_Header* header,
+                                                   void* buffer, uint64_t buffer_size,
+                                                   ElfParser_SectionSegmentPair* pairs, uint64_t max_pairs,
+                                                   uint64_t* num_out) {
+    *num_out = 0;
+    if (buffer == NULL || buffer_size < elfparser_get_section_segment_buffer_size(header)) return ELFPARSER_INVALID;
+    
+    ElfParser_MappingSection* sections = (ElfParser_MappingSection*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+    uint64_t num_sections = 0;
+    uint64_t num_alloc = 0;
+    
+    ElfParser_SectionCursor section_cursor;
+    elfparser_section_cursor_init(elf_start, header, &section_cursor);
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&section_cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.sh_type == ELFPARSER_SHT_NULL) continue;
+        
+        ElfParser_MappingSection* entry = &sections[num_sections++];
+        entry->is_alloc     = (section.sh_flags & ELFPARSER_SHF_ALLOC) != 0;
+        entry->start        = entry->is_alloc ? section.sh_addr : section.sh_offset;
+        entry->sh_addr      = section.sh_addr;
+        entry->sh_offset    = section.sh_offset;
+        entry->sh_size      = section.sh_size;
+        entry->sh_type      = section.sh_type;
+        entry->sh_flags     = section.sh_flags;
+        entry->index        = section.index;
+        
+        if (entry->is_alloc) num_alloc++;
+    }
+    
+    elfparser_sort(sections, num_sections, sizeof(ElfParser_MappingSection), elfparser_is_mapping_section_less, NULL);
+    
+    ElfParser_ProgramHeaderCursor program_header_cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &program_header_cursor);
+    
+    uint64_t num = 0;
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&program_header_cursor, &program_header) == ELFPARSER_NOERROR) {
+        // Sections which start inside the segment form a run in the sorted array - find where it begins, then walk it
+        for (int kind = 0; kind < 2; kind++) {
+            bool is_alloc = kind == 0;
+            ElfParser_MappingSection key = {
+                .is_alloc   = is_alloc,
+                .start      = is_alloc ? program_header.p_vaddr : program_header.p_offset,
+                .index      = 0
+            };
+            uint64_t run_size = is_alloc ? program_header.p_memsz : program_header.p_filesz;
+            
+            const ElfParser_MappingSection* run = is_alloc ? sections : sections + num_alloc;
+            uint64_t run_num = is_alloc ? num_alloc : num_sections - num_alloc;
+            uint64_t i = elfparser_lower_bound(run, run_num, sizeof(ElfParser_MappingSection), &key,
+                                               elfparser_is_mapping_section_less, NULL);
+            
+            for (; i < run_num && run[i].start - key.start <= run_size; i++) {
+                if (!elfparser_is_section_in_segment(&run[i], &program_header)) continue;
+                
+                // Keep counting once the table is full so the caller knows how much space is needed
+                if (num < max_pairs) {
+                    pairs[num].segment_index = program_header.index;
+                    pairs[num].section_index = run[i].index;
+                }
+                num++;
+            }
+        }
+    }
+    
+    *num_out = num;
+    return num > max_pairs ? ELFPARSER_INVALID : ELFPARSER_NOERROR;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+
+static bool elfparser_is_mapping_less(const void* a, const void* b, const void* context) {
+    return ((const ElfParser_SegmentMapping*)a)->p_vaddr < ((const ElfParser_SegmentMapping*)b)->p_vaddr;
+}
+
+
+ElfParser_Error elfparser_build_segment_map(const void* elf_start, const ElfParser_Header* header,
+                                            ElfParser_SegmentMapping* mappings, uint64_t max_mappings,
+                                            ElfParser_SegmentMap* map_out) {
+    map_out->elf_start  = elf_start;
+    map_out->header     = header;
+    map_out->mappings   = mappings;
+    map_out->num        = 0;
+    
+    // Program headers that lie outside the file are skipped by the cursor, so the return value can be ignored
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_LOAD || program_header.p_memsz == 0) continue;
+        
+        // Leave out segments with bad data, same as elfparser_copy_segment refuses to copy them
+        if (program_header.p_offset > header->elf_size ||
+            program_header.p_filesz > header->elf_size - program_header.p_offset) continue;
+        
+        if (map_out->num >= max_mappings) return ELFPARSER_INVALID;
+        
+        ElfParser_SegmentMapping* mapping = &mappings[map_out->num++];
+        mapping->p_vaddr    = program_header.p_vaddr;
+        mapping->p_memsz    = program_header.p_memsz;
+        mapping->p_offset   = program_header.p_offset;
+        
+        // Memory size is the size of the segment, so any file data past it isn't mapped
+        mapping->p_filesz   = program_header.p_filesz < program_header.p_memsz ? program_header.p_filesz : program_header.p_memsz;
+        mapping->index      = program_header.index;
+    }
+    
+    elfparser_sort(mappings, map_out->num, sizeof(ElfParser_SegmentMapping), elfparser_is_mapping_less, NULL);
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_translate_vaddr(const ElfParser_SegmentMap* map, uint64_t vaddr, uint64_t size,
+                                         ElfParser_VaddrTranslation* translation_out) {
+    // Find last segment starting at or before vaddr
+    uint64_t low = 0;
+    uint64_t high = map->num;
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (map->mappings[mid].p_vaddr <= vaddr) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) return ELFPARSER_NOT_FOUND;
+    
+    const ElfParser_SegmentMapping* mapping = &map->mappings[low - 1];
+    uint64_t skip = vaddr - mapping->p_vaddr;
+    if (skip >= mapping->p_memsz) return ELFPARSER_NOT_FOUND;
+    
+    // Limit range to end of segment
+    uint64_t segment_left = mapping->p_memsz - skip;
+    if (size > segment_left) size = segment_left;
+    
+    translation_out->segment_index  = mapping->index;
+    translation_out->file_offset    = mapping->p_offset + skip;
+    translation_out->file_size      = 0;
+    
+    if (skip < mapping->p_filesz) {
+        uint64_t file_left = mapping->p_filesz - skip;
+        translation_out->file_size = size < file_left ? size : file_left;
+    }
+    translation_out->zero_size = size - translation_out->file_size;
+    
+    return ELFPARSER_NOERROR;
+}
+
+
+uint64_t elfparser_read_at_vaddr(const ElfParser_SegmentMap* map, uint64_t vaddr, void* dest, uint64_t num_bytes) {
+    uint64_t total_bytes_copied = 0;
+    
+    while (num_bytes > 0) {
+        ElfParser_VaddrTranslation translation;
+        if (elfparser_translate_vaddr(map, vaddr, num_bytes, &translation) != ELFPARSER_NOERROR) break;
+        
+        memcpy(dest, map->elf_start + translation.file_offset, translation.file_size);
+        memset(dest + translation.file_size, 0, translation.zero_size);
+        
+        uint64_t bytes_copied = translation.file_size + translation.zero_size;
+        dest                += bytes_copied;
+        vaddr               += bytes_copied;
+        num_bytes           -= bytes_copied;
+        total_bytes_copied  += bytes_copied;
+    }
+    
+    return total_bytes_copied;
+}
\ No newline at end of file
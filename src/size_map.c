@@ -0,0 +1,302 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+// Every owner becomes one range. Ranges of the same kind are trimmed so they don't overlap each other (the earliest
+// starting range keeps shared bytes), and then one sweep over all kinds at once picks the most specific owner
+typedef struct {
+    uint64_t                start;
+    uint64_t                end;
+    ElfParser_SizeOwnerKind kind;
+    uint64_t                index;
+} ElfParser_OwnerRange;
+
+#define ELFPARSER_SIZE_NUM_KINDS (ELFPARSER_SIZE_SYMBOL + 1)
+
+typedef struct {
+    ElfParser_OwnerRange*   ranges;
+    uint64_t                num;
+} ElfParser_OwnerRanges;
+
+
+static void elfparser_add_owner_range(ElfParser_OwnerRanges* ranges, ElfParser_SizeOwnerKind kind,
+                                      uint64_t start, uint64_t size, uint64_t index) {
+    if (size == 0 || start + size < start) return;
+    
+    ElfParser_OwnerRange* range = &ranges->ranges[ranges->num++];
+    range->start    = start;
+    range->end      = start + size;
+    range->kind     = kind;
+    range->index    = index;
+}
+
+
+// Sorted by kind, then start. Longer ranges come first so that aliases (e.g. two symbols at one address) are owned by
+// the range covering the most bytes
+static bool elfparser_is_owner_range_less(const void* a, const void* b, const void* context) {
+    const ElfParser_OwnerRange* range_a = a;
+    const ElfParser_OwnerRange* range_b = b;
+    
+    if (range_a->kind != range_b->kind) return range_a->kind < range_b->kind;
+    if (range_a->start != range_b->start) return range_a->start < range_b->start;
+    if (range_a->end != range_b->end) return range_a->end > range_b->end;
+    return range_a->index < range_b->index;
+}
+
+
+static bool elfparser_is_sized_symbol(const ElfParser_Symbol* symbol) {
+    if (symbol->st_size == 0) return false;
+    if (symbol->st_shndx == ELFPARSER_SHN_UNDEF || symbol->st_shndx >= ELFPARSER_SHN_LORESERVE) return false;
+    
+    // Section and file symbols describe the layout rather than any contents, and TLS symbol values aren't addresses
+    return symbol->st_type != ELFPARSER_STT_SECTION && symbol->st_type != ELFPARSER_STT_FILE &&
+           symbol->st_type != ELFPARSER_STT_TLS;
+}
+
+
+// Find .symtab, or .dynsym if the file was stripped
+static bool elfparser_get_size_symbol_table(const void* elf_start, const ElfParser_Header* header,
+                                            ElfParser_SymbolTable* table_out) {
+    return elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_SYMTAB, table_out) == ELFPARSER_NOERROR ||
+           elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_DYNSYM, table_out) == ELFPARSER_NOERROR;
+}
+
+
+static void elfparser_add_file_ranges(const void* elf_start, const ElfParser_Header* header,
+                                      ElfParser_OwnerRanges* ranges) {
+    elfparser_add_owner_range(ranges, ELFPARSER_SIZE_HEADER, 0, header->e_ehsize, 0);
+    elfparser_add_owner_range(ranges, ELFPARSER_SIZE_HEADER, header->e_phoff,
+                              (uint64_t)header->e_phnum * header->e_phentsize, 1);
+    elfparser_add_owner_range(ranges, ELFPARSER_SIZE_HEADER, header->e_shoff,
+                              header->true_shnum * header->e_shentsize, 2);
+    
+    ElfParser_ProgramHeaderCursor program_header_cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &program_header_cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&program_header_cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_LOAD) continue;
+        elfparser_add_owner_range(ranges, ELFPARSER_SIZE_SEGMENT, program_header.p_offset, program_header.p_filesz,
+                                  program_header.index);
+    }
+    
+    ElfParser_SectionCursor section_cursor;
+    elfparser_section_cursor_init(elf_start, header, &section_cursor);
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&section_cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.sh_type == ELFPARSER_SHT_NULL || section.sh_type == ELFPARSER_SHT_NOBITS) continue;
+        elfparser_add_owner_range(ranges, ELFPARSER_SIZE_SECTION, section.sh_offset, section.sh_size, section.index);
+    }
+    
+    ElfParser_SymbolTable table;
+    if (!elfparser_get_size_symbol_table(elf_start, header, &table)) return;
+    
+    ElfParser_SymbolCursor symbol_cursor;
+    elfparser_symbol_table_cursor_init(elf_start, header, &table, &symbol_cursor);
+    
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_cursor_next(&symbol_cursor, &symbol) == ELFPARSER_NOERROR) {
+        if (!elfparser_is_sized_symbol(&symbol)) continue;
+        if (elfparser_get_section_header(elf_start, header, symbol.st_shndx, &section) != ELFPARSER_NOERROR) continue;
+        if (section.sh_type == ELFPARSER_SHT_NOBITS) continue;
+        
+        // Symbol values are offsets into the section in relocatable files, and addresses everywhere else
+        uint64_t section_offset = symbol.st_value;
+        if (header->e_type != ELFPARSER_ET_REL) {
+            if (symbol.st_value < section.sh_addr) continue;
+            section_offset = symbol.st_value - section.sh_addr;
+        }
+        if (section_offset >= section.sh_size) continue;
+        
+        uint64_t size = section.sh_size - section_offset < symbol.st_size ? section.sh_size - section_offset
+                                                                           : symbol.st_size;
+        elfparser_add_owner_range(ranges, ELFPARSER_SIZE_SYMBOL, section.sh_offset + section_offset, size, symbol.index);
+    }
+}
+
+
+static void elfparser_add_vm_ranges(const void* elf_start, const ElfParser_Header* header,
+                                    ElfParser_OwnerRanges* ranges) {
+    ElfParser_ProgramHeaderCursor program_header_cursor;
+    elfparser_program_header_cursor_init(elf_start, header, &program_header_cursor);
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&program_header_cursor, &program_header) == ELFPARSER_NOERROR) {
+        if (program_header.p_type != ELFPARSER_PT_LOAD) continue;
+        elfparser_add_owner_range(ranges, ELFPARSER_SIZE_SEGMENT, program_header.p_vaddr, program_header.p_memsz,
+                                  program_header.index);
+    }
+    
+    ElfParser_SectionCursor section_cursor;
+    elfparser_section_cursor_init(elf_start, header, &section_cursor);
+    
+    ElfParser_SectionHeader section;
+    while (elfparser_section_cursor_next(&section_cursor, &section) == ELFPARSER_NOERROR) {
+        if ((section.sh_flags & ELFPARSER_SHF_ALLOC) == 0) continue;
+        
+        // .tbss takes no space in the address space of the file itself - only in each thread's TLS block
+        if ((section.sh_flags & ELFPARSER_SHF_TLS) && section.sh_type == ELFPARSER_SHT_NOBITS) continue;
+        
+        elfparser_add_owner_range(ranges, ELFPARSER_SIZE_SECTION, section.sh_addr, section.sh_size, section.index);
+    }
+    
+    // Relocatable files aren't laid out in memory yet
+    if (header->e_type == ELFPARSER_ET_REL) return;
+    
+    ElfParser_SymbolTable table;
+    if (!elfparser_get_size_symbol_table(elf_start, header, &table)) return;
+    
+    ElfParser_SymbolCursor symbol_cursor;
+    elfparser_symbol_table_cursor_init(elf_start, header, &table, &symbol_cursor);
+    
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_cursor_next(&symbol_cursor, &symbol) == ELFPARSER_NOERROR) {
+        if (!elfparser_is_sized_symbol(&symbol)) continue;
+        elfparser_add_owner_range(ranges, ELFPARSER_SIZE_SYMBOL, symbol.st_value, symbol.st_size, symbol.index);
+    }
+}
+
+
+// Trim the sorted ranges of each kind so they no longer overlap, dropping ranges left empty. Returns the new count
+static uint64_t elfparser_trim_owner_ranges(ElfParser_OwnerRange* ranges, uint64_t num) {
+    uint64_t num_kept = 0;
+    uint64_t claimed_end = 0;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        ElfParser_OwnerRange range = ranges[i];
+        if (i == 0 || range.kind != ranges[i - 1].kind) claimed_end = 0;
+        
+        if (range.start < claimed_end) range.start = claimed_end;
+        if (range.start >= range.end) continue;
+        
+        claimed_end = range.end;
+        ranges[num_kept++] = range;
+    }
+    return num_kept;
+}
+
+
+static void elfparser_sweep_owner_ranges(const ElfParser_OwnerRange* ranges, uint64_t num, ElfParser_SizeSpace space,
+                                         uint64_t space_end, ElfParser_SizeCallback callback, void* user_data) {
+    // Each kind is now a sorted run of disjoint ranges - keep one position per run
+    uint64_t next[ELFPARSER_SIZE_NUM_KINDS];
+    uint64_t run_end[ELFPARSER_SIZE_NUM_KINDS];
+    
+    for (int kind = 0; kind < ELFPARSER_SIZE_NUM_KINDS; kind++) {
+        next[kind] = 0;
+        run_end[kind] = 0;
+    }
+    for (uint64_t i = 0; i < num; i++) {
+        ElfParser_SizeOwnerKind kind = ranges[i].kind;
+        if (i == 0 || ranges[i - 1].kind != kind) next[kind] = i;
+        run_end[kind] = i + 1;
+    }
+    
+    // The file is covered from start to end, but only the parts of the address space which something occupies
+    uint64_t pos = 0;
+    if (space == ELFPARSER_SIZE_VM) {
+        pos = UINT64_MAX;
+        for (int kind = 0; kind < ELFPARSER_SIZE_NUM_KINDS; kind++) {
+            if (next[kind] < run_end[kind] && ranges[next[kind]].start < pos) pos = ranges[next[kind]].start;
+        }
+    }
+    
+    while (true) {
+        const ElfParser_OwnerRange* active[ELFPARSER_SIZE_NUM_KINDS] = {NULL};
+        uint64_t boundary = UINT64_MAX;
+        
+        for (int kind = 0; kind < ELFPARSER_SIZE_NUM_KINDS; kind++) {
+            while (next[kind] < run_end[kind] && ranges[next[kind]].end <= pos) next[kind]++;
+            if (next[kind] >= run_end[kind]) continue;
+            
+            const ElfParser_OwnerRange* range = &ranges[next[kind]];
+            if (range->start <= pos) {
+                active[kind] = range;
+                if (range->end < boundary) boundary = range->end;
+            } else if (range->start < boundary) {
+                boundary = range->start;
+            }
+        }
+        
+        if (space == ELFPARSER_SIZE_FILE && space_end < boundary) boundary = space_end;
+        if (boundary == UINT64_MAX || boundary <= pos) break;
+        
+        ElfParser_SizeRange size_range = {
+            .start          = pos,
+            .end            = boundary,
+            .kind           = ELFPARSER_SIZE_UNMAPPED,
+            .index          = UINT64_MAX,
+            .section_index  = active[ELFPARSER_SIZE_SECTION] ? active[ELFPARSER_SIZE_SECTION]->index : UINT64_MAX,
+            .segment_index  = active[ELFPARSER_SIZE_SEGMENT] ? active[ELFPARSER_SIZE_SEGMENT]->index : UINT64_MAX
+        };
+        for (int kind = ELFPARSER_SIZE_NUM_KINDS - 1; kind > ELFPARSER_SIZE_UNMAPPED; kind--) {
+            if (active[kind] != NULL) {
+                size_range.kind     = kind;
+                size_range.index    = active[kind]->index;
+                break;
+            }
+        }
+        
+        // Gaps between segments aren't part of the address space used by the file
+        if (space == ELFPARSER_SIZE_FILE || size_range.kind != ELFPARSER_SIZE_UNMAPPED) callback(&size_range, user_data);
+        pos = boundary;
+    }
+}
+
+
+uint64_t elfparser_get_size_map_buffer_size(const void* elf_start, const ElfParser_Header* header) {
+    ElfParser_SymbolTable table;
+    uint64_t symbol_num = elfparser_get_size_symbol_table(elf_start, header, &table) ? table.num : 0;
+    
+    // One range per symbol, section and program header, plus the ELF header and the two header tables
+    return sizeof(ElfParser_OwnerRange) * (symbol_num + header->true_shnum + header->e_phnum + 3) + 7;
+}
+
+
+ElfParser_Error elfparser_attribute_size(const void* elf_start, const ElfParser_Header* header, ElfParser_SizeSpace space,
+                                         void* buffer, uint64_t buffer_size,
+                                         ElfParser_SizeCallback callback, void* user_data) {
+    if (callback == NULL) return ELFPARSER_INVALID;
+    if (buffer == NULL || buffer_size < elfparser_get_size_map_buffer_size(elf_start, header)) return ELFPARSER_INVALID;
+    
+    ElfParser_OwnerRanges ranges = {
+        .ranges = (ElfParser_OwnerRange*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7),
+        .num    = 0
+    };
+    
+    if (space == ELFPARSER_SIZE_FILE) {
+        elfparser_add_file_ranges(elf_start, header, &ranges);
+    } else {
+        elfparser_add_vm_ranges(elf_start, header, &ranges);
+    }
+    
+    elfparser_sort(ranges.ranges, ranges.num, sizeof(ElfParser_OwnerRange), elfparser_is_owner_range_less, NULL);
+    ranges.num = elfparser_trim_owner_ranges(ranges.ranges, ranges.num);
+    
+    elfparser_sweep_owner_ranges(ranges.ranges, ranges.num, space, header->elf_size, callback, user_data);
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
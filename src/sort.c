@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "sort.h"
+
+#include <string.h>
+
+
+static void elfparser_swap(uint8_t* a, uint8_t* b, uint64_t size) {
+    uint8_t temp[64];
+    
+    while (size > 0) {
+        uint64_t chunk = size < sizeof(temp) ? size : sizeof(temp);
+        memcpy(temp, a, chunk);
+        memcpy(a, b, chunk);
+        memcpy(b, temp, chunk);
+        a       += chunk;
+        b       += chunk;
+        size    -= chunk;
+    }
+}
+
+
+static void elfparser_sift_down(uint8_t* base, uint64_t root, uint64_t num, uint64_t element_size,
+                                ElfParser_LessFunc less, const void* context) {
+    while (true) {
+        uint64_t child = 2 * root + 1;
+        if (child >= num) return;
+        
+        // Pick the larger child
+        if (child + 1 < num && less(base + child * element_size, base + (child + 1) * element_size, context)) child++;
+        
+        if (!less(base + root * element_size, base + child * element_size, context)) return;
+        
+        elfparser_swap(base + root * element_size, base + child * element_size, element_size);
+        root = child;
+    }
+}
+
+
+void elfparser_sort(void* base, uint64_t num, uint64_t element_size, ElfParser_LessFunc less, const void* context) {
+    if (num < 2) return;
+    
+    // Build max heap
+    for (uint64_t i = num / 2; i > 0; i--) {
+        elfparser_sift_down(base, i - 1, num, element_size, less, context);
+    }
+    
+    // Repeatedly move largest element to end
+    for (uint64_t end = num - 1; end > 0; end--) {
+        elfparser_swap(base, (uint8_t*)base + end * element_size, element_size);
+        elfparser_sift_down(base, 0, end, element_size, less, context);
+    }
+}
+
+
+uint64_t elfparser_lower_bound(const void* base, uint64_t num, uint64_t element_size, const void* key,
+                               ElfParser_LessFunc less, const void* context) {
+    uint64_t low = 0;
+    uint64_t high = num;
+    
+    while (low < high) {
+        uint64_t mid = low + (high - low) / 2;
+        if (less((const uint8_t*)base + mid * element_size, key, context)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// This file should *not* be included! It is used as an interface for the implementation
+// Any functions here should be considered private
+
+// Returns true if element a should be ordered before element b
+typedef bool (*ElfParser_LessFunc)(const void* a, const void* b, const void* context);
+
+// In-place heapsort - doesn't allocate or recurse, so it's safe to use on caller provided buffers of any size
+void elfparser_sort(void* base, uint64_t num, uint64_t element_size, ElfParser_LessFunc less, const void* context);
+
+// Returns the number of elements which should be ordered before key (i.e. index of first element not less than key)
+uint64_t elfparser_lower_bound(const void* base, uint64_t num, uint64_t element_size, const void* key,
+                               ElfParser_LessFunc less, const void* context);
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+// Split block Bloom filter: a name sets one bit in each of the 8 words of a single 64 byte block, so checking a name
+// against a filter touches one cache line and needs no branches. The high half of the hash picks the block and the low
+// half picks the bits, so the same key works for filters of any size
+#define FILTER_WORDS        (ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE / 8)
+#define FILTER_BITS_PER_KEY 16      // About 0.05% false positives when every table entry is a defined name
+#define PREFETCH_DISTANCE   8
+
+typedef uint64_t ElfParser_FilterBlock __attribute__((vector_size(ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE), aligned(8)));
+
+static const uint32_t filter_salts[FILTER_WORDS] = {
+    0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31
+};
+
+
+static uint64_t elfparser_get_filter_hash(const char* name) {
+    ElfParser_HashState state;
+    uint8_t digest[8];
+    
+    elfparser_hash_init(&state, ELFPARSER_HASH_XXH64);
+    elfparser_hash_update(&state, name, strlen(name));
+    elfparser_hash_final(&state, digest);
+    
+    uint64_t hash = 0;
+    for (int i = 0; i < 8; i++) hash = hash << 8 | digest[i];
+    return hash;
+}
+
+static inline const ElfParser_FilterBlock* elfparser_get_filter_block(const void* filter, uint64_t filter_size,
+                                                                      uint64_t hash) {
+    // Maps the high half of the hash onto the blocks without a division
+    uint64_t num_blocks = filter_size / ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE;
+    return filter + ((hash >> 32) * num_blocks >> 32) * ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE;
+}
+
+static inline bool elfparser_is_key_in_block(const ElfParser_FilterBlock* block, const ElfParser_SymbolFilterKey* key) {
+    ElfParser_FilterBlock mask;
+    memcpy(&mask, key->mask, sizeof(mask));
+    
+    // Bits of the key missing from the block, OR-ed across the words
+    ElfParser_FilterBlock missing = mask & ~*block;
+    uint64_t any = 0;
+    for (int i = 0; i < FILTER_WORDS; i++) any |= missing[i];
+    return any == 0;
+}
+
+
+void elfparser_symbol_filter_key_init(const char* name, ElfParser_SymbolFilterKey* key_out) {
+    uint64_t hash = elfparser_get_filter_hash(name);
+    key_out->hash = hash;
+    
+    for (int i = 0; i < FILTER_WORDS; i++) {
+        key_out->mask[i] = (uint64_t)1 << ((uint32_t)((uint32_t)hash * filter_salts[i]) >> 26);
+    }
+}
+
+
+uint64_t elfparser_get_symbol_filter_size(const void* elf_start, const ElfParser_Header* header) {
+    // Every entry of the symbol tables is counted, which is an upper bound on the number of defined names
+    uint64_t num = 0;
+    ElfParser_SymbolTable table;
+    if (elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_SYMTAB, &table) == ELFPARSER_NOERROR) num += table.num;
+    if (elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_DYNSYM, &table) == ELFPARSER_NOERROR) num += table.num;
+    
+    uint64_t bits_per_block = ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE * 8;
+    uint64_t num_blocks = (num * FILTER_BITS_PER_KEY + bits_per_block - 1) / bits_per_block;
+    if (num_blocks == 0) num_blocks = 1;
+    return num_blocks * ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE;
+}
+
+
+static void elfparser_add_symbol_table_to_filter(const void* elf_start, const ElfParser_Header* header,
+                                                 ElfParser_SH_Type type, void* filter, uint64_t filter_size) {
+    ElfParser_SymbolTable table;
+    if (elfparser_get_symbol_table(elf_start, header, type, &table) != ELFPARSER_NOERROR) return;
+    
+    ElfParser_SymbolQuery query;
+    elfparser_symbol_query_init(&query);
+    query.bind_mask = 1 << ELFPARSER_STB_GLOBAL | 1 << ELFPARSER_STB_WEAK | 1 << ELFPARSER_STB_GNU_UNIQUE;
+    query.shndx_min = ELFPARSER_SHN_UNDEF + 1;
+    
+    ElfParser_SymbolQueryCursor cursor;
+    elfparser_symbol_query_cursor_init(elf_start, header, &table, &query, &cursor);
+    
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_query_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        if (*symbol.name == '\0') continue;
+        
+        ElfParser_SymbolFilterKey key;
+        elfparser_symbol_filter_key_init(symbol.name, &key);
+        
+        uint64_t* block = (uint64_t*)elfparser_get_filter_block(filter, filter_size, key.hash);
+        for (int i = 0; i < FILTER_WORDS; i++) block[i] |= key.mask[i];
+    }
+}
+
+ElfParser_Error elfparser_build_symbol_filter(const void* elf_start, const ElfParser_Header* header,
+                                             void* filter, uint64_t filter_size) {
+    if (filter_size == 0 || filter_size % ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE != 0) return ELFPARSER_INVALID;
+    
+    memset(filter, 0, filter_size);
+    elfparser_add_symbol_table_to_filter(elf_start, header, ELFPARSER_SHT_SYMTAB, filter, filter_size);
+    elfparser_add_symbol_table_to_filter(elf_start, header, ELFPARSER_SHT_DYNSYM, filter, filter_size);
+    return ELFPARSER_NOERROR;
+}
+
+
+bool elfparser_symbol_filter_may_contain(const void* filter, uint64_t filter_size, const ElfParser_SymbolFilterKey* key) {
+    if (filter_size < ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE) return false;
+    return elfparser_is_key_in_block(elfparser_get_filter_block(filter, filter_size, key->hash), key);
+}
+
+
+uint64_t elfparser_scan_symbol_filters(const void* base, const ElfParser_SymbolFilterRef* filters, uint64_t num,
+                                       const ElfParser_SymbolFilterKey* key, uint64_t* matches_out) {
+    uint64_t num_matches = 0;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        // Each filter costs one cache miss at most, so start loading the block of a later filter before checking
+        if (i + PREFETCH_DISTANCE < num) {
+            const ElfParser_SymbolFilterRef* ahead = &filters[i + PREFETCH_DISTANCE];
+            __builtin_prefetch(elfparser_get_filter_block(base + ahead->offset, ahead->size, key->hash));
+        }
+        
+        const ElfParser_SymbolFilterRef* ref = &filters[i];
+        bool is_match = ref->size >= ELFPARSER_SYMBOL_FILTER_BLOCK_SIZE &&
+                        elfparser_is_key_in_block(elfparser_get_filter_block(base + ref->offset, ref->size, key->hash), key);
+        
+        // Written unconditionally and kept only on a match
+        matches_out[num_matches] = i;
+        num_matches += is_match;
+    }
+    return num_matches;
+}
\ No newline at end of file
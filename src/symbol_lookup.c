@@ -0,0 +1,223 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+// Size in bytes of the header at the start of each kind of hash table
+#define ELFPARSER_GNU_HASH_HEADER_SIZE  16
+#define ELFPARSER_SYSV_HASH_HEADER_SIZE 8
+
+typedef struct {
+    const void*                     elf_start;
+    const ElfParser_Header*         header;
+    const ElfParser_SymbolHashTable* table;
+    const ElfParser_VersionTable*   versions;
+    const char*                     name;
+    uint64_t                        name_len;
+    const char*                     version;
+} ElfParser_SymbolLookup;
+
+
+// Read a 32-bit word at pos bytes into the hash table - returns false if it lies outside the table
+static bool elfparser_read_hash_32(const ElfParser_SymbolLookup* lookup, uint64_t pos, uint32_t* value_out) {
+    if (pos > lookup->table->size || lookup->table->size - pos < 4) return false;
+    *value_out = elfparser_read_32(lookup->header, lookup->elf_start + lookup->table->offset + pos);
+    return true;
+}
+
+
+// Check whether the symbol at index is the one being looked up, reading it into symbol_out
+static bool elfparser_is_lookup_match(const ElfParser_SymbolLookup* lookup, uint64_t index, ElfParser_Symbol* symbol_out) {
+    if (elfparser_get_symbol_from_table(lookup->elf_start, lookup->header, &lookup->table->symbols, index,
+                                        symbol_out) != ELFPARSER_NOERROR) return false;
+    
+    // Undefined symbols are references to other files, not definitions
+    if (symbol_out->st_shndx == ELFPARSER_SHN_UNDEF) return false;
+    
+    if (!elfparser_is_symbol_name_equal(lookup->elf_start, lookup->header, lookup->table->symbols.string_table_offset,
+                                        symbol_out, lookup->name, lookup->name_len)) return false;
+    
+    if (lookup->versions == NULL) return true;
+    
+    ElfParser_SymbolVersion version;
+    if (elfparser_get_symbol_version(lookup->elf_start, lookup->header, lookup->versions, index,
+                                     &version) != ELFPARSER_NOERROR) {
+        // Symbols without version info can only match an unversioned lookup
+        return lookup->version == NULL;
+    }
+    
+    // Without a version, only the default version of a symbol matches, like the dynamic linker does for unversioned references
+    if (lookup->version == NULL) return !version.is_hidden;
+    return strcmp(version.name, lookup->version) == 0;
+}
+
+
+static ElfParser_Error elfparser_lookup_gnu_hash(const ElfParser_SymbolLookup* lookup, uint32_t hash,
+                                                 ElfParser_Symbol* symbol_out) {
+    const ElfParser_SymbolHashTable* table = lookup->table;
+    uint64_t word_size = elfparser_get_word_size(lookup->header);
+    uint64_t word_bits = word_size * 8;
+    
+    // Bloom filter rejects most names which aren't present without touching the buckets
+    uint64_t bloom_pos = ELFPARSER_GNU_HASH_HEADER_SIZE + (hash / word_bits) % table->bloom_size * word_size;
+    uint64_t bloom_word = elfparser_read_word(lookup->header, lookup->elf_start + table->offset + bloom_pos);
+    uint64_t bloom_mask = (1ull << (hash % word_bits)) | (1ull << ((hash >> table->bloom_shift) % word_bits));
+    if ((bloom_word & bloom_mask) != bloom_mask) return ELFPARSER_NOT_FOUND;
+    
+    uint64_t buckets_pos = ELFPARSER_GNU_HASH_HEADER_SIZE + (uint64_t)table->bloom_size * word_size;
+    uint64_t chains_pos = buckets_pos + (uint64_t)table->num_buckets * 4;
+    
+    uint32_t index;
+    if (!elfparser_read_hash_32(lookup, buckets_pos + (uint64_t)(hash % table->num_buckets) * 4, &index)) {
+        return ELFPARSER_INVALID;
+    }
+    if (index < table->symbol_offset) return ELFPARSER_NOT_FOUND;
+    
+    // Chain holds the hashes of consecutive symbols, with the lowest bit set on the last one
+    for (uint64_t i = index; i < table->symbols.num; i++) {
+        uint32_t chain_hash;
+        if (!elfparser_read_hash_32(lookup, chains_pos + (i - table->symbol_offset) * 4, &chain_hash)) {
+            return ELFPARSER_INVALID;
+        }
+        
+        if ((chain_hash | 1) == (hash | 1) && elfparser_is_lookup_match(lookup, i, symbol_out)) return ELFPARSER_NOERROR;
+        if (chain_hash & 1) break;
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+static ElfParser_Error elfparser_lookup_sysv_hash(const ElfParser_SymbolLookup* lookup, uint32_t hash,
+                                                  ElfParser_Symbol* symbol_out) {
+    const ElfParser_SymbolHashTable* table = lookup->table;
+    
+    uint64_t buckets_pos = ELFPARSER_SYSV_HASH_HEADER_SIZE;
+    uint64_t chains_pos = buckets_pos + (uint64_t)table->num_buckets * 4;
+    
+    uint32_t index;
+    if (!elfparser_read_hash_32(lookup, buckets_pos + (uint64_t)(hash % table->num_buckets) * 4, &index)) {
+        return ELFPARSER_INVALID;
+    }
+    
+    // Chain ends at index 0 (the null symbol). It can't be longer than the number of symbols unless it loops
+    for (uint64_t i = 0; index != 0 && i < table->symbols.num; i++) {
+        if (elfparser_is_lookup_match(lookup, index, symbol_out)) return ELFPARSER_NOERROR;
+        
+        if (!elfparser_read_hash_32(lookup, chains_pos + (uint64_t)index * 4, &index)) return ELFPARSER_INVALID;
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+ElfParser_Error elfparser_get_symbol_hash_table(const void* elf_start, const ElfParser_Header* header,
+                                                ElfParser_SymbolHashTable* table_out) {
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    
+    // GNU hash tables are faster, so use one if present - otherwise fall back to a SysV hash table
+    ElfParser_SectionHeader section;
+    ElfParser_SectionHeader hash_section;
+    bool found = false;
+    while (elfparser_section_cursor_next(&cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.sh_type == ELFPARSER_SHT_GNU_HASH) {
+            hash_section = section;
+            found = true;
+            break;
+        }
+        if (section.sh_type == ELFPARSER_SHT_HASH && !found) {
+            hash_section = section;
+            found = true;
+        }
+    }
+    if (!found) return ELFPARSER_NOT_FOUND;
+    
+    // Hash table indexes into the symbol table referenced by sh_link
+    ElfParser_SectionHeader symbol_section;
+    if (elfparser_get_section_header(elf_start, header, hash_section.sh_link, &symbol_section) != ELFPARSER_NOERROR) {
+        return ELFPARSER_INVALID;
+    }
+    if (elfparser_get_section_symbol_table(elf_start, header, &symbol_section, &table_out->symbols) != ELFPARSER_NOERROR) {
+        return ELFPARSER_INVALID;
+    }
+    
+    if (hash_section.sh_offset > header->elf_size) return ELFPARSER_INVALID;
+    uint64_t size_in_file = header->elf_size - hash_section.sh_offset;
+    
+    table_out->type             = hash_section.sh_type;
+    table_out->offset           = hash_section.sh_offset;
+    table_out->size             = hash_section.sh_size < size_in_file ? hash_section.sh_size : size_in_file;
+    table_out->symbol_offset    = 0;
+    table_out->bloom_size       = 0;
+    table_out->bloom_shift      = 0;
+    
+    const void* hash_start = elf_start + hash_section.sh_offset;
+    if (table_out->type == ELFPARSER_SHT_GNU_HASH) {
+        if (table_out->size < ELFPARSER_GNU_HASH_HEADER_SIZE) return ELFPARSER_INVALID;
+        
+        table_out->num_buckets      = elfparser_read_32(header, hash_start);
+        table_out->symbol_offset    = elfparser_read_32(header, hash_start + 4);
+        table_out->bloom_size       = elfparser_read_32(header, hash_start + 8);
+        table_out->bloom_shift      = elfparser_read_32(header, hash_start + 12);
+        
+        // Whole bloom filter is checked here, so lookups don't have to. Hashes are 32 bits, so larger shifts are invalid
+        if (table_out->bloom_shift >= 32) return ELFPARSER_INVALID;
+        uint64_t bloom_bytes = (uint64_t)table_out->bloom_size * elfparser_get_word_size(header);
+        if (table_out->bloom_size == 0 || bloom_bytes > table_out->size - ELFPARSER_GNU_HASH_HEADER_SIZE) {
+            return ELFPARSER_INVALID;
+        }
+    } else {
+        if (table_out->size < ELFPARSER_SYSV_HASH_HEADER_SIZE) return ELFPARSER_INVALID;
+        
+        table_out->num_buckets      = elfparser_read_32(header, hash_start);
+    }
+    
+    return table_out->num_buckets == 0 ? ELFPARSER_INVALID : ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_lookup_symbol(const void* elf_start, const ElfParser_Header* header,
+                                        const ElfParser_SymbolHashTable* table, const ElfParser_VersionTable* versions,
+                                        const char* name, const char* version, ElfParser_Symbol* symbol_out) {
+    if (name == NULL) {
+        // Null string not allowed
+        return ELFPARSER_INVALID;
+    }
+    
+    ElfParser_SymbolLookup lookup = {
+        .elf_start  = elf_start,
+        .header     = header,
+        .table      = table,
+        .versions   = versions,
+        .name       = name,
+        .version    = version
+    };
+    
+    if (table->type == ELFPARSER_SHT_GNU_HASH) {
+        uint32_t hash = elfparser_gnu_hash(name, &lookup.name_len);
+        return elfparser_lookup_gnu_hash(&lookup, hash, symbol_out);
+    }
+    
+    lookup.name_len = strlen(name);
+    return elfparser_lookup_sysv_hash(&lookup, elfparser_elf_hash(name), symbol_out);
+}
\ No newline at end of file
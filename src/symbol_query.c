@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+// Symbols are filtered this many at a time, giving a bit mask of candidates for the name check
+#define QUERY_BATCH_SIZE 64
+
+
+void elfparser_symbol_query_init(ElfParser_SymbolQuery* query_out) {
+    query_out->bind_mask        = UINT16_MAX;
+    query_out->type_mask        = UINT16_MAX;
+    query_out->visibility_mask  = UINT8_MAX;
+    query_out->shndx_min        = 0;
+    query_out->shndx_max        = UINT16_MAX;
+    query_out->value_min        = 0;
+    query_out->value_max        = UINT64_MAX;
+    query_out->size_min         = 0;
+    query_out->size_max         = UINT64_MAX;
+    query_out->name_prefix      = NULL;
+}
+
+
+// Checks the fixed-size fields of `num` symbol entries against the query, giving a bit mask with bit i set if entry i
+// matches. The first pass checks st_info, st_other and st_shndx of every entry without branching, and the value and
+// size ranges are then only checked for the entries left, if they narrow anything down at all. Called with constant
+// is_64 and is_lsb (and entry_size when it's the size of the struct) so each combination gets its own loops
+static inline __attribute__((always_inline)) uint64_t elfparser_filter_symbols(const ElfParser_SymbolQueryCursor* cursor,
+                                                                               const uint8_t* entries, uint64_t entry_size,
+                                                                               uint64_t num, bool is_64, bool is_lsb) {
+    const ElfParser_SymbolQuery* query = &cursor->query;
+    
+    // Unsigned subtraction turns each range check into a single comparison
+    uint16_t shndx_min  = query->shndx_min;
+    uint16_t shndx_span = query->shndx_max - query->shndx_min;
+    uint64_t mask = 0;
+    
+    // Fields up to st_shndx are laid out the same way in Elf32_Sym and Elf64_Sym, apart from where they start
+    uint64_t info_offset = is_64 ? __builtin_offsetof(Elf64_Sym, st_info) : __builtin_offsetof(Elf32_Sym, st_info);
+    for (uint64_t i = 0; i < num; i++) {
+        const uint8_t* entry = entries + i * entry_size + info_offset;
+        uint16_t shndx;
+        memcpy(&shndx, entry + 2, sizeof(shndx));
+        
+        uint64_t match = cursor->is_info_matched[(entry[1] & 0x3) << 8 | entry[0]] &
+                         ((uint16_t)(convert_endian_16(shndx, is_lsb) - shndx_min) <= shndx_span);
+        mask |= match << i;
+    }
+    
+    uint64_t value_span = query->value_max - query->value_min;
+    uint64_t size_span  = query->size_max - query->size_min;
+    if (value_span == UINT64_MAX && size_span == UINT64_MAX) return mask;
+    
+    for (uint64_t left = mask; left != 0; left &= left - 1) {
+        uint64_t i = __builtin_ctzll(left);
+        const uint8_t* entry = entries + i * entry_size;
+        uint64_t value, size;
+        
+        if (is_64) {
+            const Elf64_Sym* symbol = (const Elf64_Sym*)entry;
+            value   = convert_endian_64(symbol->st_value, is_lsb);
+            size    = convert_endian_64(symbol->st_size, is_lsb);
+        } else {
+            const Elf32_Sym* symbol = (const Elf32_Sym*)entry;
+            value   = convert_endian_32(symbol->st_value, is_lsb);
+            size    = convert_endian_32(symbol->st_size, is_lsb);
+        }
+        
+        if (value - query->value_min > value_span || size - query->size_min > size_span) mask &= ~(1ULL << i);
+    }
+    return mask;
+}
+
+
+static uint64_t elfparser_filter_symbol_batch(const ElfParser_SymbolQueryCursor* cursor, uint64_t num) {
+    const ElfParser_SymbolCursor* symbols = &cursor->symbols;
+    bool is_64 = symbols->header->ei_class == ELFPARSER_ELFCLASS64;
+    bool is_lsb = symbols->header->ei_data == ELFPARSER_ELFDATA2LSB;
+    const uint8_t* entries = symbols->next;
+    uint64_t size = symbols->entry_size;
+    
+    // Entries are almost always packed, and a constant stride makes for a much faster loop
+    if (is_64 && is_lsb && size == sizeof(Elf64_Sym)) {
+        return elfparser_filter_symbols(cursor, entries, sizeof(Elf64_Sym), num, true, true);
+    }
+    if (is_64)  return elfparser_filter_symbols(cursor, entries, size, num, true, is_lsb);
+    if (is_lsb) return elfparser_filter_symbols(cursor, entries, size, num, false, true);
+    return             elfparser_filter_symbols(cursor, entries, size, num, false, false);
+}
+
+
+ElfParser_Error elfparser_symbol_query_cursor_init(const void* elf_start, const ElfParser_Header* header,
+                                                   const ElfParser_SymbolTable* table, const ElfParser_SymbolQuery* query,
+                                                   ElfParser_SymbolQueryCursor* cursor_out) {
+    ElfParser_Error err;
+    if (table == NULL) {
+        err = elfparser_symbol_cursor_init(elf_start, header, &cursor_out->symbols);
+    } else {
+        err = elfparser_symbol_table_cursor_init(elf_start, header, table, &cursor_out->symbols);
+    }
+    
+    // Binding, type and visibility are checked with one lookup of st_info and the visibility bits of st_other
+    for (uint32_t i = 0; i < 1024; i++) {
+        uint32_t info = i & 0xff;
+        cursor_out->is_info_matched[i] = (query->bind_mask >> (info >> 4)) & (query->type_mask >> (info & 0xf)) &
+                                         (query->visibility_mask >> (i >> 8)) & 1;
+    }
+    
+    cursor_out->query               = *query;
+    cursor_out->name_prefix_length  = query->name_prefix == NULL ? 0 : strlen(query->name_prefix);
+    cursor_out->batch_mask          = 0;
+    cursor_out->batch_start         = 0;
+    return err;
+}
+
+
+// Checks the name of a candidate against the prefix straight from the string table, before resolving it
+static bool elfparser_is_symbol_name_prefixed(const ElfParser_SymbolQueryCursor* cursor, const ElfParser_Symbol* symbol) {
+    if (cursor->name_prefix_length == 0) return true;
+    
+    const ElfParser_SymbolCursor* symbols = &cursor->symbols;
+    uint64_t name_off;
+    if (!elfparser_get_symbol_name_offset(symbols->string_table_offset, symbol, &name_off)) return false;
+    if (name_off > symbols->header->elf_size ||
+        cursor->name_prefix_length > symbols->header->elf_size - name_off) {
+        return false;
+    }
+    return memcmp(symbols->elf_start + name_off, cursor->query.name_prefix, cursor->name_prefix_length) == 0;
+}
+
+
+ElfParser_Error elfparser_symbol_query_cursor_next(ElfParser_SymbolQueryCursor* cursor, ElfParser_Symbol* symbol_out) {
+    ElfParser_SymbolCursor* symbols = &cursor->symbols;
+    
+    while (true) {
+        while (cursor->batch_mask == 0) {
+            if (symbols->index >= symbols->num) return ELFPARSER_NOT_FOUND;
+            
+            uint64_t num = symbols->num - symbols->index;
+            if (num > QUERY_BATCH_SIZE) num = QUERY_BATCH_SIZE;
+            
+            cursor->batch_mask  = elfparser_filter_symbol_batch(cursor, num);
+            cursor->batch_start = symbols->index;
+            symbols->next       += num * symbols->entry_size;
+            symbols->index      += num;
+        }
+        
+        // Candidates are taken in order of index, lowest bit first
+        uint64_t i = __builtin_ctzll(cursor->batch_mask);
+        cursor->batch_mask &= cursor->batch_mask - 1;
+        
+        const void* entry = symbols->next - (symbols->index - cursor->batch_start - i) * symbols->entry_size;
+        if (symbols->header->ei_class == ELFPARSER_ELFCLASS64) {
+            elfparser_get_symbol64(symbols->header, entry, symbol_out);
+        } else {
+            elfparser_get_symbol32(symbols->header, entry, symbol_out);
+        }
+        
+        elfparser_decode_symbol_info(symbol_out);
+        symbol_out->index = cursor->batch_start + i;
+        if (!elfparser_is_symbol_name_prefixed(cursor, symbol_out)) continue;
+        
+        symbol_out->name = elfparser_get_symbol_name(symbols->elf_start, symbols->header, symbols->string_table_offset,
+                                                     symbol_out);
+        return ELFPARSER_NOERROR;
+    }
+}
\ No newline at end of file
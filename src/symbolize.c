@@ -0,0 +1,339 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "image.h"
+#include "sort.h"
+
+#define LOOKUP_INSERTION_SORT_SIZE  32  // Smaller buckets are sorted by insertion sort
+
+typedef struct {
+    uint64_t                address;
+    uint64_t                end;            // End of the function (exclusive)
+    uint64_t                name_offset;    // File offset of the name
+    uint64_t                rank;           // Used while building - lower ranks win between functions at one address
+} ElfParser_FunctionEntry;
+
+
+static bool elfparser_parse_hex(const char** ptr, const char* end, uint64_t* value_out) {
+    const char* c = *ptr;
+    uint64_t value = 0;
+    
+    for (; c < end; c++) {
+        uint64_t digit;
+        if (*c >= '0' && *c <= '9')         digit = *c - '0';
+        else if (*c >= 'a' && *c <= 'f')    digit = *c - 'a' + 10;
+        else if (*c >= 'A' && *c <= 'F')    digit = *c - 'A' + 10;
+        else                                break;
+        value = value << 4 | digit;
+    }
+    if (c == *ptr) return false;
+    
+    *ptr = c;
+    *value_out = value;
+    return true;
+}
+
+static bool elfparser_parse_decimal(const char** ptr, const char* end, uint64_t* value_out) {
+    const char* c = *ptr;
+    uint64_t value = 0;
+    
+    for (; c < end && *c >= '0' && *c <= '9'; c++) value = value * 10 + (*c - '0');
+    if (c == *ptr) return false;
+    
+    *ptr = c;
+    *value_out = value;
+    return true;
+}
+
+static bool elfparser_skip_char(const char** ptr, const char* end, char c) {
+    if (*ptr == end || **ptr != c) return false;
+    (*ptr)++;
+    return true;
+}
+
+static void elfparser_skip_spaces(const char** ptr, const char* end) {
+    while (*ptr < end && (**ptr == ' ' || **ptr == '\t')) (*ptr)++;
+}
+
+// Parses one line of /proc/<pid>/maps, e.g. "7f2a1c000000-7f2a1c021000 r-xp 00002000 08:01 1311003    /usr/lib/libc.so.6"
+static bool elfparser_parse_process_mapping(const char* line, const char* end, ElfParser_ProcessMapping* mapping_out) {
+    const char* c = line;
+    uint64_t dev_major, dev_minor;
+    
+    if (!elfparser_parse_hex(&c, end, &mapping_out->start) || !elfparser_skip_char(&c, end, '-') ||
+        !elfparser_parse_hex(&c, end, &mapping_out->end) || !elfparser_skip_char(&c, end, ' ')) return false;
+    
+    if (end - c < 5 || c[4] != ' ') return false;
+    mapping_out->flags      = (c[0] == 'r' ? ELFPARSER_PF_R : 0) | (c[1] == 'w' ? ELFPARSER_PF_W : 0) |
+                              (c[2] == 'x' ? ELFPARSER_PF_X : 0);
+    mapping_out->is_shared  = c[3] == 's';
+    c += 5;
+    
+    if (!elfparser_parse_hex(&c, end, &mapping_out->file_offset) || !elfparser_skip_char(&c, end, ' ') ||
+        !elfparser_parse_hex(&c, end, &dev_major) || !elfparser_skip_char(&c, end, ':') ||
+        !elfparser_parse_hex(&c, end, &dev_minor) || !elfparser_skip_char(&c, end, ' ') ||
+        !elfparser_parse_decimal(&c, end, &mapping_out->inode)) return false;
+    
+    mapping_out->dev_major  = dev_major;
+    mapping_out->dev_minor  = dev_minor;
+    
+    // The name is the rest of the line after the padding, and may contain spaces
+    elfparser_skip_spaces(&c, end);
+    mapping_out->name           = c;
+    mapping_out->name_length    = end - c;
+    return true;
+}
+
+
+void elfparser_process_mapping_cursor_init(const char* maps, uint64_t maps_size, ElfParser_ProcessMappingCursor* cursor_out) {
+    cursor_out->next    = maps;
+    cursor_out->end     = maps + maps_size;
+}
+
+
+ElfParser_Error elfparser_process_mapping_cursor_next(ElfParser_ProcessMappingCursor* cursor,
+                                                      ElfParser_ProcessMapping* mapping_out) {
+    // Lines which can't be parsed are skipped
+    while (cursor->next < cursor->end) {
+        const char* line = cursor->next;
+        const char* line_end = memchr(line, '\n', cursor->end - line);
+        if (line_end == NULL) line_end = cursor->end;
+        cursor->next = line_end + (line_end < cursor->end);
+        
+        if (elfparser_parse_process_mapping(line, line_end, mapping_out)) return ELFPARSER_NOERROR;
+    }
+    return ELFPARSER_NOT_FOUND;
+}
+
+
+// Defined functions (and GNU indirect functions) in a section, leaving out absolute symbols
+static void elfparser_init_function_query(ElfParser_SymbolQuery* query_out) {
+    elfparser_symbol_query_init(query_out);
+    query_out->type_mask = 1 << ELFPARSER_STT_FUNC | 1 << ELFPARSER_STT_GNU_IFUNC;
+    query_out->shndx_min = ELFPARSER_SHN_UNDEF + 1;
+    query_out->shndx_max = ELFPARSER_SHN_LORESERVE - 1;
+}
+
+uint64_t elfparser_get_function_table_buffer_size(const void* elf_start, const ElfParser_Header* header) {
+    uint64_t num = 0;
+    ElfParser_SymbolTable table;
+    if (elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_SYMTAB, &table) == ELFPARSER_NOERROR) num += table.num;
+    if (elfparser_get_symbol_table(elf_start, header, ELFPARSER_SHT_DYNSYM, &table) == ELFPARSER_NOERROR) num += table.num;
+    return sizeof(ElfParser_IndexImage) + num * sizeof(ElfParser_FunctionEntry) + 7;
+}
+
+
+static uint64_t elfparser_add_functions(const void* elf_start, const ElfParser_Header* header, ElfParser_SH_Type type,
+                                        ElfParser_FunctionEntry* entries, uint64_t num, uint64_t max_num) {
+    ElfParser_SymbolTable table;
+    if (elfparser_get_symbol_table(elf_start, header, type, &table) != ELFPARSER_NOERROR) return num;
+    
+    ElfParser_SymbolQuery query;
+    elfparser_init_function_query(&query);
+    
+    ElfParser_SymbolQueryCursor cursor;
+    elfparser_symbol_query_cursor_init(elf_start, header, &table, &query, &cursor);
+    
+    ElfParser_Symbol symbol;
+    while (num < max_num && elfparser_symbol_query_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        // Names which aren't in the file come back as an empty string which isn't in the file either
+        if (*symbol.name == '\0') continue;
+        
+        // Between aliases, prefer global over weak over local names and names with a size, then the first one found
+        uint64_t bind_rank = symbol.st_bind == ELFPARSER_STB_GLOBAL ? 0 : symbol.st_bind == ELFPARSER_STB_WEAK ? 1 : 2;
+        ElfParser_FunctionEntry* entry = &entries[num];
+        entry->address      = symbol.st_value;
+        entry->end          = symbol.st_value + symbol.st_size;
+        entry->name_offset  = (const void*)symbol.name - elf_start;
+        entry->rank         = (bind_rank * 2 + (symbol.st_size == 0)) << 48 | num;
+        num++;
+    }
+    return num;
+}
+
+static bool elfparser_is_function_entry_less(const void* a, const void* b, const void* context) {
+    const ElfParser_FunctionEntry* entry_a = a;
+    const ElfParser_FunctionEntry* entry_b = b;
+    
+    if (entry_a->address != entry_b->address) return entry_a->address < entry_b->address;
+    return entry_a->rank < entry_b->rank;
+}
+
+ElfParser_Error elfparser_build_function_table(const void* elf_start, const ElfParser_Header* header,
+                                              void* buffer, uint64_t buffer_size, ElfParser_FunctionTable* table_out) {
+    uint64_t needed_size = elfparser_get_function_table_buffer_size(elf_start, header);
+    if (buffer_size < needed_size) return ELFPARSER_INVALID;
+    
+    ElfParser_IndexImage* image = elfparser_get_index_image(buffer);
+    uint64_t max_num = (needed_size - sizeof(ElfParser_IndexImage) - 7) / sizeof(ElfParser_FunctionEntry);
+    
+    // .symtab usually holds everything in .dynsym as well, but stripped files only have .dynsym
+    ElfParser_FunctionEntry* entries = (ElfParser_FunctionEntry*)(image + 1);
+    uint64_t num = elfparser_add_functions(elf_start, header, ELFPARSER_SHT_SYMTAB, entries, 0, max_num);
+    num = elfparser_add_functions(elf_start, header, ELFPARSER_SHT_DYNSYM, entries, num, max_num);
+    elfparser_sort(entries, num, sizeof(ElfParser_FunctionEntry), elfparser_is_function_entry_less, NULL);
+    
+    // Keep the best name at each address. Functions without a size extend up to the next function
+    uint64_t num_unique = 0;
+    for (uint64_t i = 0; i < num; i++) {
+        if (num_unique > 0 && entries[num_unique - 1].address == entries[i].address) continue;
+        entries[num_unique++] = entries[i];
+    }
+    for (uint64_t i = 0; i < num_unique; i++) {
+        ElfParser_FunctionEntry* entry = &entries[i];
+        if (entry->end != entry->address) continue;
+        entry->end = i + 1 < num_unique ? entries[i + 1].address : entry->address + 1;
+    }
+    
+    elfparser_init_index_image(elf_start, header, ELFPARSER_IMAGE_FUNCTION_TABLE, sizeof(ElfParser_FunctionEntry), image);
+    image->num = num_unique;
+    
+    table_out->elf_start    = elf_start;
+    table_out->header       = header;
+    table_out->entries      = entries;
+    table_out->num          = num_unique;
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_attach_function_table(const void* elf_start, const ElfParser_Header* header,
+                                               const void* buffer, uint64_t buffer_size, ElfParser_FunctionTable* table_out) {
+    const ElfParser_IndexImage* image = elfparser_check_index_image(elf_start, header, ELFPARSER_IMAGE_FUNCTION_TABLE,
+                                                                    sizeof(ElfParser_FunctionEntry), buffer, buffer_size);
+    if (image == NULL) return ELFPARSER_INVALID;
+    
+    // The table is only ever read, so the entries may be in read-only memory
+    table_out->elf_start    = elf_start;
+    table_out->header       = header;
+    table_out->entries      = (void*)(image + 1);
+    table_out->num          = image->num;
+    return ELFPARSER_NOERROR;
+}
+
+
+static void elfparser_insertion_sort_lookups(ElfParser_AddressLookup* lookups, uint64_t num) {
+    for (uint64_t i = 1; i < num; i++) {
+        ElfParser_AddressLookup lookup = lookups[i];
+        uint64_t j = i;
+        for (; j > 0 && lookups[j - 1].address > lookup.address; j--) lookups[j] = lookups[j - 1];
+        lookups[j] = lookup;
+    }
+}
+
+// In-place MSD radix sort on one byte of the address at a time, with no allocation and a recursion depth of at most 8
+static void elfparser_radix_sort_lookups(ElfParser_AddressLookup* lookups, uint64_t num, uint32_t shift) {
+    if (num <= LOOKUP_INSERTION_SORT_SIZE) {
+        elfparser_insertion_sort_lookups(lookups, num);
+        return;
+    }
+    
+    uint64_t next[256] = { 0 };
+    uint64_t ends[256];
+    for (uint64_t i = 0; i < num; i++) next[lookups[i].address >> shift & 0xff]++;
+    
+    uint64_t start = 0;
+    for (uint32_t bucket = 0; bucket < 256; bucket++) {
+        ends[bucket] = start + next[bucket];
+        next[bucket] = start;
+        start = ends[bucket];
+    }
+    
+    // Swap each lookup straight into the next free slot of its bucket until every bucket is full
+    for (uint32_t bucket = 0; bucket < 256; bucket++) {
+        while (next[bucket] < ends[bucket]) {
+            ElfParser_AddressLookup lookup = lookups[next[bucket]];
+            uint32_t target = lookup.address >> shift & 0xff;
+            while (target != bucket) {
+                ElfParser_AddressLookup displaced = lookups[next[target]];
+                lookups[next[target]++] = lookup;
+                lookup = displaced;
+                target = lookup.address >> shift & 0xff;
+            }
+            lookups[next[bucket]++] = lookup;
+        }
+    }
+    
+    if (shift == 0) return;
+    for (uint32_t bucket = 0, first = 0; bucket < 256; first = ends[bucket++]) {
+        if (ends[bucket] - first > 1) elfparser_radix_sort_lookups(lookups + first, ends[bucket] - first, shift - 8);
+    }
+}
+
+void elfparser_sort_address_lookups(ElfParser_AddressLookup* lookups, uint64_t num) {
+    if (num < 2) return;
+    
+    // Bytes above the highest one that differs between any two addresses are already in order
+    uint64_t differing = 0;
+    for (uint64_t i = 1; i < num; i++) differing |= lookups[i].address ^ lookups[0].address;
+    if (differing == 0) return;
+    
+    uint32_t shift = (63 - __builtin_clzll(differing)) / 8 * 8;
+    elfparser_radix_sort_lookups(lookups, num, shift);
+}
+
+
+static bool elfparser_is_function_at_or_before(const void* element, const void* key, const void* context) {
+    return ((const ElfParser_FunctionEntry*)element)->address <= *(const uint64_t*)key;
+}
+
+ElfParser_Error elfparser_resolve_addresses(const ElfParser_FunctionTable* table, ElfParser_AddressLookup* lookups,
+                                            uint64_t num) {
+    const ElfParser_FunctionEntry* entries = table->entries;
+    ElfParser_Error ret = ELFPARSER_NOERROR;
+    
+    // Number of functions starting at or before the previous address
+    uint64_t position = 0;
+    uint64_t previous_address = 0;
+    
+    for (uint64_t i = 0; i < num; i++) {
+        ElfParser_AddressLookup* lookup = &lookups[i];
+        uint64_t address = lookup->address;
+        if (address < previous_address) position = 0;
+        previous_address = address;
+        
+        // Gallop forward from the previous position, so sorted addresses walk the table once however they're spread
+        uint64_t step = 1;
+        while (position + step <= table->num && entries[position + step - 1].address <= address) {
+            position += step;
+            step *= 2;
+        }
+        uint64_t span = table->num - position < step ? table->num - position : step;
+        position += elfparser_lower_bound(&entries[position], span, sizeof(ElfParser_FunctionEntry), &address,
+                                          elfparser_is_function_at_or_before, NULL);
+        
+        if (position == 0 || address >= entries[position - 1].end) {
+            lookup->name    = NULL;
+            lookup->error   = ELFPARSER_NOT_FOUND;
+            ret             = ELFPARSER_NOT_FOUND;
+            continue;
+        }
+        
+        const ElfParser_FunctionEntry* entry = &entries[position - 1];
+        lookup->name                = table->elf_start + entry->name_offset;
+        lookup->function_address    = entry->address;
+        lookup->offset              = address - entry->address;
+        lookup->error               = ELFPARSER_NOERROR;
+    }
+    return ret;
+}
\ No newline at end of file
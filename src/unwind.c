@@ -0,0 +1,631 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "dwarf.h"
+
+
+#define UNWIND_MAX_REMEMBERED_STATES    8
+#define UNWIND_EXPRESSION_STACK_SIZE    64
+#define UNWIND_EXPRESSION_MAX_STEPS     1024    // Bounds loops made with DW_OP_bra and DW_OP_skip
+
+// Call frame instructions. The first three have the opcode in the top 2 bits and an operand in the low 6 bits
+enum {
+    DW_CFA_ADVANCE_LOC                  = 0x40,
+    DW_CFA_OFFSET                       = 0x80,
+    DW_CFA_RESTORE                      = 0xc0,
+    DW_CFA_NOP                          = 0x00,
+    DW_CFA_SET_LOC                      = 0x01,
+    DW_CFA_ADVANCE_LOC1                 = 0x02,
+    DW_CFA_ADVANCE_LOC2                 = 0x03,
+    DW_CFA_ADVANCE_LOC4                 = 0x04,
+    DW_CFA_OFFSET_EXTENDED              = 0x05,
+    DW_CFA_RESTORE_EXTENDED             = 0x06,
+    DW_CFA_UNDEFINED                    = 0x07,
+    DW_CFA_SAME_VALUE                   = 0x08,
+    DW_CFA_REGISTER                     = 0x09,
+    DW_CFA_REMEMBER_STATE               = 0x0a,
+    DW_CFA_RESTORE_STATE                = 0x0b,
+    DW_CFA_DEF_CFA                      = 0x0c,
+    DW_CFA_DEF_CFA_REGISTER             = 0x0d,
+    DW_CFA_DEF_CFA_OFFSET               = 0x0e,
+    DW_CFA_DEF_CFA_EXPRESSION           = 0x0f,
+    DW_CFA_EXPRESSION                   = 0x10,
+    DW_CFA_OFFSET_EXTENDED_SF           = 0x11,
+    DW_CFA_DEF_CFA_SF                   = 0x12,
+    DW_CFA_DEF_CFA_OFFSET_SF            = 0x13,
+    DW_CFA_VAL_OFFSET                   = 0x14,
+    DW_CFA_VAL_OFFSET_SF                = 0x15,
+    DW_CFA_VAL_EXPRESSION               = 0x16,
+    DW_CFA_AARCH64_NEGATE_RA_STATE      = 0x2d,     // DW_CFA_GNU_window_save on SPARC
+    DW_CFA_GNU_ARGS_SIZE                = 0x2e,
+    DW_CFA_GNU_NEGATIVE_OFFSET_EXTENDED = 0x2f
+};
+
+// DWARF expression operations which can appear in call frame information
+enum {
+    DW_OP_ADDR          = 0x03,
+    DW_OP_DEREF         = 0x06,
+    DW_OP_CONST1U       = 0x08,
+    DW_OP_CONST1S       = 0x09,
+    DW_OP_CONST2U       = 0x0a,
+    DW_OP_CONST2S       = 0x0b,
+    DW_OP_CONST4U       = 0x0c,
+    DW_OP_CONST4S       = 0x0d,
+    DW_OP_CONST8U       = 0x0e,
+    DW_OP_CONST8S       = 0x0f,
+    DW_OP_CONSTU        = 0x10,
+    DW_OP_CONSTS        = 0x11,
+    DW_OP_DUP           = 0x12,
+    DW_OP_DROP          = 0x13,
+    DW_OP_OVER          = 0x14,
+    DW_OP_PICK          = 0x15,
+    DW_OP_SWAP          = 0x16,
+    DW_OP_ROT           = 0x17,
+    DW_OP_ABS           = 0x19,
+    DW_OP_AND           = 0x1a,
+    DW_OP_DIV           = 0x1b,
+    DW_OP_MINUS         = 0x1c,
+    DW_OP_MOD           = 0x1d,
+    DW_OP_MUL           = 0x1e,
+    DW_OP_NEG           = 0x1f,
+    DW_OP_NOT           = 0x20,
+    DW_OP_OR            = 0x21,
+    DW_OP_PLUS          = 0x22,
+    DW_OP_PLUS_UCONST   = 0x23,
+    DW_OP_SHL           = 0x24,
+    DW_OP_SHR           = 0x25,
+    DW_OP_SHRA          = 0x26,
+    DW_OP_XOR           = 0x27,
+    DW_OP_BRA           = 0x28,
+    DW_OP_EQ            = 0x29,
+    DW_OP_GE            = 0x2a,
+    DW_OP_GT            = 0x2b,
+    DW_OP_LE            = 0x2c,
+    DW_OP_LT            = 0x2d,
+    DW_OP_NE            = 0x2e,
+    DW_OP_SKIP          = 0x2f,
+    DW_OP_LIT0          = 0x30,
+    DW_OP_LIT31         = 0x4f,
+    DW_OP_BREG0         = 0x70,
+    DW_OP_BREG31        = 0x8f,
+    DW_OP_BREGX         = 0x92,
+    DW_OP_DEREF_SIZE    = 0x94,
+    DW_OP_NOP           = 0x96
+};
+
+
+static uint64_t elfparser_get_stack_pointer_register(const ElfParser_Header* header) {
+    switch (header->e_machine) {
+        case ELFPARSER_EM_X86_64:   return ELFPARSER_X86_64_RSP;
+        case ELFPARSER_EM_386:      return ELFPARSER_I386_ESP;
+        case ELFPARSER_EM_AARCH64:  return ELFPARSER_AARCH64_SP;
+        default:                    return UINT64_MAX;
+    }
+}
+
+
+// Sets the rule of register `reg` - rules of registers which aren't tracked are dropped. `other` is the register of
+// ELFPARSER_UNWIND_RULE_REGISTER and the size of expressions. Returns false if a value doesn't fit in the rule
+static bool elfparser_set_unwind_rule(ElfParser_UnwindRule* rules, uint64_t reg, uint8_t type, int64_t offset,
+                                      uint64_t other) {
+    if (offset < INT32_MIN || offset > INT32_MAX) return false;
+    if (reg >= ELFPARSER_UNWIND_MAX_REGISTERS) return true;
+    
+    ElfParser_UnwindRule* rule = &rules[reg];
+    rule->type      = type;
+    rule->offset    = offset;
+    rule->reg       = 0;
+    rule->size      = 0;
+    
+    if (type == ELFPARSER_UNWIND_RULE_REGISTER) {
+        // A register saved in a register which isn't tracked can't be recovered
+        if (other >= ELFPARSER_UNWIND_MAX_REGISTERS) rule->type = ELFPARSER_UNWIND_RULE_UNDEFINED;
+        else rule->reg = other;
+    } else if (type == ELFPARSER_UNWIND_RULE_EXPRESSION || type == ELFPARSER_UNWIND_RULE_VAL_EXPRESSION) {
+        if (other > UINT16_MAX) return false;
+        rule->size = other;
+    }
+    return true;
+}
+
+
+// Runs call frame instructions until the row covering `pc` is complete. `initial` is the row left by the CIE
+// instructions, or NULL when running the CIE instructions themselves
+static ElfParser_Error elfparser_run_call_frame_instructions(const ElfParser_FdeTable* table, const ElfParser_Fde* fde,
+                                                             uint64_t instructions_offset, uint64_t instructions_size,
+                                                             const ElfParser_UnwindRow* initial, uint64_t pc,
+                                                             ElfParser_UnwindRow* row) {
+    const ElfParser_Header* header = table->header;
+    const ElfParser_Cie* cie = &fde->cie;
+    const uint8_t* frame_start = table->elf_start + table->eh_frame_offset;
+    const uint8_t* ptr = table->elf_start + instructions_offset;
+    const uint8_t* end = ptr + instructions_size;
+    
+    ElfParser_PointerBases bases = {
+        .data_start = frame_start,
+        .data_vaddr = table->eh_frame_vaddr,
+        .funcrel    = fde->pc_begin,
+    };
+    
+    ElfParser_UnwindRow remembered[UNWIND_MAX_REMEMBERED_STATES];
+    uint64_t num_remembered = 0;
+    uint64_t location = fde->pc_begin;
+    
+    while (ptr < end) {
+        uint8_t opcode = *ptr++;
+        uint64_t reg, value, size;
+        int64_t signed_value;
+        uint64_t next_location = location;
+        bool ok = true;
+        
+        switch (opcode & 0xc0) {
+            case DW_CFA_ADVANCE_LOC:
+                next_location = location + (opcode & 0x3f) * cie->code_alignment;
+                break;
+            case DW_CFA_OFFSET:
+                ok = elfparser_read_uleb128(&ptr, end, &value) &&
+                     elfparser_set_unwind_rule(row->registers, opcode & 0x3f, ELFPARSER_UNWIND_RULE_OFFSET,
+                                               (int64_t)value * cie->data_alignment, 0);
+                break;
+            case DW_CFA_RESTORE:
+                reg = opcode & 0x3f;
+                if (reg < ELFPARSER_UNWIND_MAX_REGISTERS && initial != NULL) row->registers[reg] = initial->registers[reg];
+                break;
+            default:
+                switch (opcode) {
+                    case DW_CFA_NOP:
+                    case DW_CFA_GNU_ARGS_SIZE:
+                        if (opcode == DW_CFA_GNU_ARGS_SIZE) ok = elfparser_read_uleb128(&ptr, end, &value);
+                        break;
+                    case DW_CFA_SET_LOC:
+                        ok = elfparser_read_encoded_pointer(table->elf_start, header, &ptr, end, cie->fde_encoding, &bases,
+                                                            &next_location);
+                        break;
+                    case DW_CFA_ADVANCE_LOC1:
+                    case DW_CFA_ADVANCE_LOC2:
+                    case DW_CFA_ADVANCE_LOC4:
+                        size = opcode == DW_CFA_ADVANCE_LOC1 ? 1 : opcode == DW_CFA_ADVANCE_LOC2 ? 2 : 4;
+                        ok = elfparser_read_fixed(header, &ptr, end, size, &value);
+                        next_location = location + value * cie->code_alignment;
+                        break;
+                    case DW_CFA_OFFSET_EXTENDED:
+                    case DW_CFA_VAL_OFFSET:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg) && elfparser_read_uleb128(&ptr, end, &value) &&
+                             elfparser_set_unwind_rule(row->registers, reg, opcode == DW_CFA_OFFSET_EXTENDED ?
+                                                       ELFPARSER_UNWIND_RULE_OFFSET : ELFPARSER_UNWIND_RULE_VAL_OFFSET,
+                                                       (int64_t)value * cie->data_alignment, 0);
+                        break;
+                    case DW_CFA_OFFSET_EXTENDED_SF:
+                    case DW_CFA_VAL_OFFSET_SF:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg) && elfparser_read_sleb128(&ptr, end, &signed_value) &&
+                             elfparser_set_unwind_rule(row->registers, reg, opcode == DW_CFA_OFFSET_EXTENDED_SF ?
+                                                       ELFPARSER_UNWIND_RULE_OFFSET : ELFPARSER_UNWIND_RULE_VAL_OFFSET,
+                                                       signed_value * cie->data_alignment, 0);
+                        break;
+                    case DW_CFA_GNU_NEGATIVE_OFFSET_EXTENDED:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg) && elfparser_read_uleb128(&ptr, end, &value) &&
+                             elfparser_set_unwind_rule(row->registers, reg, ELFPARSER_UNWIND_RULE_OFFSET,
+                                                       -(int64_t)value * cie->data_alignment, 0);
+                        break;
+                    case DW_CFA_RESTORE_EXTENDED:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg);
+                        if (ok && reg < ELFPARSER_UNWIND_MAX_REGISTERS && initial != NULL) {
+                            row->registers[reg] = initial->registers[reg];
+                        }
+                        break;
+                    case DW_CFA_UNDEFINED:
+                    case DW_CFA_SAME_VALUE:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg) &&
+                             elfparser_set_unwind_rule(row->registers, reg, opcode == DW_CFA_UNDEFINED ?
+                                                       ELFPARSER_UNWIND_RULE_UNDEFINED : ELFPARSER_UNWIND_RULE_SAME_VALUE, 0, 0);
+                        break;
+                    case DW_CFA_REGISTER:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg) && elfparser_read_uleb128(&ptr, end, &value) &&
+                             elfparser_set_unwind_rule(row->registers, reg, ELFPARSER_UNWIND_RULE_REGISTER, 0, value);
+                        break;
+                    case DW_CFA_REMEMBER_STATE:
+                        if (num_remembered == UNWIND_MAX_REMEMBERED_STATES) return ELFPARSER_INVALID;
+                        remembered[num_remembered++] = *row;
+                        break;
+                    case DW_CFA_RESTORE_STATE:
+                        if (num_remembered == 0) return ELFPARSER_INVALID;
+                        num_remembered--;
+                        row->cfa = remembered[num_remembered].cfa;
+                        row->is_return_address_signed = remembered[num_remembered].is_return_address_signed;
+                        memcpy(row->registers, remembered[num_remembered].registers, sizeof(row->registers));
+                        break;
+                    case DW_CFA_DEF_CFA:
+                    case DW_CFA_DEF_CFA_SF:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg);
+                        if (opcode == DW_CFA_DEF_CFA) {
+                            ok = ok && elfparser_read_uleb128(&ptr, end, &value);
+                            signed_value = value;
+                        } else {
+                            ok = ok && elfparser_read_sleb128(&ptr, end, &signed_value);
+                            signed_value *= cie->data_alignment;
+                        }
+                        ok = ok && reg < ELFPARSER_UNWIND_MAX_REGISTERS &&
+                             elfparser_set_unwind_rule(&row->cfa, 0, ELFPARSER_UNWIND_RULE_REGISTER, signed_value, reg);
+                        break;
+                    case DW_CFA_DEF_CFA_REGISTER:
+                        ok = elfparser_read_uleb128(&ptr, end, &reg) && reg < ELFPARSER_UNWIND_MAX_REGISTERS &&
+                             row->cfa.type == ELFPARSER_UNWIND_RULE_REGISTER;
+                        if (ok) row->cfa.reg = reg;
+                        break;
+                    case DW_CFA_DEF_CFA_OFFSET:
+                    case DW_CFA_DEF_CFA_OFFSET_SF:
+                        if (opcode == DW_CFA_DEF_CFA_OFFSET) {
+                            ok = elfparser_read_uleb128(&ptr, end, &value);
+                            signed_value = value;
+                        } else {
+                            ok = elfparser_read_sleb128(&ptr, end, &signed_value);
+                            signed_value *= cie->data_alignment;
+                        }
+                        ok = ok && row->cfa.type == ELFPARSER_UNWIND_RULE_REGISTER &&
+                             elfparser_set_unwind_rule(&row->cfa, 0, ELFPARSER_UNWIND_RULE_REGISTER, signed_value,
+                                                       row->cfa.reg);
+                        break;
+                    case DW_CFA_DEF_CFA_EXPRESSION:
+                    case DW_CFA_EXPRESSION:
+                    case DW_CFA_VAL_EXPRESSION:
+                        reg = 0;
+                        if (opcode != DW_CFA_DEF_CFA_EXPRESSION) ok = elfparser_read_uleb128(&ptr, end, &reg);
+                        ok = ok && elfparser_read_uleb128(&ptr, end, &size) && size <= (uint64_t)(end - ptr);
+                        if (!ok) break;
+                        
+                        // Expressions are kept as their offset in the frame section and evaluated when applying the row
+                        ok = elfparser_set_unwind_rule(opcode == DW_CFA_DEF_CFA_EXPRESSION ? &row->cfa : row->registers, reg,
+                                                       opcode == DW_CFA_VAL_EXPRESSION ? ELFPARSER_UNWIND_RULE_VAL_EXPRESSION :
+                                                       ELFPARSER_UNWIND_RULE_EXPRESSION, ptr - frame_start, size);
+                        ptr += size;
+                        break;
+                    case DW_CFA_AARCH64_NEGATE_RA_STATE:
+                        if (header->e_machine == ELFPARSER_EM_AARCH64) {
+                            row->is_return_address_signed = !row->is_return_address_signed;
+                        }
+                        break;
+                    default:
+                        ok = false;
+                        break;
+                }
+                break;
+        }
+        if (!ok) return ELFPARSER_INVALID;
+        
+        // The CIE instructions apply to the whole FDE, so only the FDE instructions move the location
+        if (next_location != location && initial != NULL) {
+            if (next_location > pc) {
+                row->pc_end = next_location;
+                return ELFPARSER_NOERROR;
+            }
+            location = next_location;
+            row->pc_begin = location;
+        }
+    }
+    return ELFPARSER_NOERROR;
+}
+
+
+ElfParser_Error elfparser_get_unwind_row(const ElfParser_FdeTable* table, uint64_t pc, ElfParser_UnwindRow* row_out) {
+    ElfParser_Fde fde;
+    ElfParser_Error err = elfparser_find_fde(table, pc, &fde);
+    if (err != ELFPARSER_NOERROR) return err;
+    
+    if (fde.cie.return_address_register >= ELFPARSER_UNWIND_MAX_REGISTERS) return ELFPARSER_INVALID;
+    
+    // Zero is ELFPARSER_UNWIND_RULE_SAME_VALUE for every register
+    memset(row_out, 0, sizeof(ElfParser_UnwindRow));
+    row_out->pc_begin                   = fde.pc_begin;
+    row_out->pc_end                     = fde.pc_begin + fde.pc_range;
+    row_out->return_address_register    = fde.cie.return_address_register;
+    row_out->is_signal_frame            = fde.cie.is_signal_frame;
+    
+    err = elfparser_run_call_frame_instructions(table, &fde, fde.cie.instructions_offset, fde.cie.instructions_size,
+                                                NULL, pc, row_out);
+    if (err != ELFPARSER_NOERROR) return err;
+    
+    ElfParser_UnwindRow initial = *row_out;
+    err = elfparser_run_call_frame_instructions(table, &fde, fde.instructions_offset, fde.instructions_size,
+                                                &initial, pc, row_out);
+    if (err != ELFPARSER_NOERROR) return err;
+    
+    if (row_out->cfa.type != ELFPARSER_UNWIND_RULE_REGISTER && row_out->cfa.type != ELFPARSER_UNWIND_RULE_EXPRESSION) {
+        return ELFPARSER_INVALID;
+    }
+    
+    for (uint64_t i = 0; i < ELFPARSER_UNWIND_MAX_REGISTERS; i++) {
+        if (row_out->registers[i].type != ELFPARSER_UNWIND_RULE_SAME_VALUE) row_out->changed_registers |= 1ull << i;
+    }
+    return ELFPARSER_NOERROR;
+}
+
+
+// Evaluates the DWARF expression of `rule`, starting with `initial_value` on the stack if has_initial_value
+static bool elfparser_evaluate_unwind_expression(const ElfParser_FdeTable* table, const ElfParser_UnwindRule* rule,
+                                                 const uint64_t* registers, ElfParser_ReadMemoryCallback read_memory,
+                                                 void* user_data, bool has_initial_value, uint64_t initial_value,
+                                                 uint64_t* value_out) {
+    const ElfParser_Header* header = table->header;
+    uint64_t word_size = elfparser_get_word_size(header);
+    
+    if (rule->offset < 0 || (uint64_t)rule->offset + rule->size > table->eh_frame_size) return false;
+    const uint8_t* start = table->elf_start + table->eh_frame_offset + rule->offset;
+    const uint8_t* end = start + rule->size;
+    const uint8_t* ptr = start;
+    
+    uint64_t stack[UNWIND_EXPRESSION_STACK_SIZE];
+    uint64_t num = 0;
+    if (has_initial_value) stack[num++] = initial_value;
+    
+    for (uint64_t steps = 0; ptr < end; steps++) {
+        if (steps == UNWIND_EXPRESSION_MAX_STEPS) return false;
+        
+        uint8_t opcode = *ptr++;
+        uint64_t value, reg;
+        int64_t signed_value;
+        
+        // Make sure there is room for a push, and enough values for the operation
+        if (num == UNWIND_EXPRESSION_STACK_SIZE) return false;
+        uint64_t num_operands = 0;
+        switch (opcode) {
+            case DW_OP_DUP: case DW_OP_DROP: case DW_OP_PICK: case DW_OP_ABS: case DW_OP_NEG: case DW_OP_NOT:
+            case DW_OP_PLUS_UCONST: case DW_OP_DEREF: case DW_OP_DEREF_SIZE: case DW_OP_BRA:
+                num_operands = 1;
+                break;
+            case DW_OP_OVER: case DW_OP_SWAP: case DW_OP_AND: case DW_OP_DIV: case DW_OP_MINUS: case DW_OP_MOD:
+            case DW_OP_MUL: case DW_OP_OR: case DW_OP_PLUS: case DW_OP_SHL: case DW_OP_SHR: case DW_OP_SHRA:
+            case DW_OP_XOR: case DW_OP_EQ: case DW_OP_GE: case DW_OP_GT: case DW_OP_LE: case DW_OP_LT: case DW_OP_NE:
+                num_operands = 2;
+                break;
+            case DW_OP_ROT:
+                num_operands = 3;
+                break;
+        }
+        if (num < num_operands) return false;
+        
+        uint64_t* top = num > 0 ? &stack[num - 1] : stack;
+        bool ok = true;
+        
+        if (opcode >= DW_OP_LIT0 && opcode <= DW_OP_LIT31) {
+            stack[num++] = opcode - DW_OP_LIT0;
+            continue;
+        }
+        if ((opcode >= DW_OP_BREG0 && opcode <= DW_OP_BREG31) || opcode == DW_OP_BREGX) {
+            reg = opcode - DW_OP_BREG0;
+            if (opcode == DW_OP_BREGX && !elfparser_read_uleb128(&ptr, end, &reg)) return false;
+            if (reg >= ELFPARSER_UNWIND_MAX_REGISTERS || !elfparser_read_sleb128(&ptr, end, &signed_value)) return false;
+            stack[num++] = registers[reg] + signed_value;
+            continue;
+        }
+        
+        switch (opcode) {
+            case DW_OP_ADDR:        ok = elfparser_read_fixed(header, &ptr, end, word_size, &value);    break;
+            case DW_OP_CONST1U:     ok = elfparser_read_fixed(header, &ptr, end, 1, &value);            break;
+            case DW_OP_CONST2U:     ok = elfparser_read_fixed(header, &ptr, end, 2, &value);            break;
+            case DW_OP_CONST4U:     ok = elfparser_read_fixed(header, &ptr, end, 4, &value);            break;
+            case DW_OP_CONST8U:
+            case DW_OP_CONST8S:     ok = elfparser_read_fixed(header, &ptr, end, 8, &value);            break;
+            case DW_OP_CONSTU:      ok = elfparser_read_uleb128(&ptr, end, &value);                     break;
+            case DW_OP_CONST1S:
+                ok = elfparser_read_fixed(header, &ptr, end, 1, &value);
+                value = (int8_t)value;
+                break;
+            case DW_OP_CONST2S:
+                ok = elfparser_read_fixed(header, &ptr, end, 2, &value);
+                value = (int16_t)value;
+                break;
+            case DW_OP_CONST4S:
+                ok = elfparser_read_fixed(header, &ptr, end, 4, &value);
+                value = (int32_t)value;
+                break;
+            case DW_OP_CONSTS:
+                ok = elfparser_read_sleb128(&ptr, end, &signed_value);
+                value = signed_value;
+                break;
+            case DW_OP_DUP:         value = *top;       break;
+            case DW_OP_OVER:        value = top[-1];    break;
+            case DW_OP_PICK:
+                ok = elfparser_read_fixed(header, &ptr, end, 1, &value) && value < num;
+                if (ok) value = top[-(int64_t)value];
+                break;
+            default:
+                // Everything else works on the stack in place
+                switch (opcode) {
+                    case DW_OP_DROP:        num--;                                                  break;
+                    case DW_OP_SWAP:        value = *top; *top = top[-1]; top[-1] = value;          break;
+                    case DW_OP_ROT:         value = *top; *top = top[-1]; top[-1] = top[-2]; top[-2] = value; break;
+                    case DW_OP_ABS:         if ((int64_t)*top < 0) *top = -*top;                    break;
+                    case DW_OP_NEG:         *top = -*top;                                           break;
+                    case DW_OP_NOT:         *top = ~*top;                                           break;
+                    case DW_OP_PLUS_UCONST:
+                        ok = elfparser_read_uleb128(&ptr, end, &value);
+                        *top += value;
+                        break;
+                    case DW_OP_DEREF:
+                    case DW_OP_DEREF_SIZE:
+                        value = word_size;
+                        if (opcode == DW_OP_DEREF_SIZE) {
+                            ok = elfparser_read_fixed(header, &ptr, end, 1, &value) && value >= 1 && value <= 8;
+                        }
+                        ok = ok && read_memory(*top, value, top, user_data);
+                        break;
+                    case DW_OP_BRA:
+                    case DW_OP_SKIP:
+                        // DW_OP_BRA pops the condition, and only branches if it isn't zero
+                        ok = elfparser_read_fixed(header, &ptr, end, 2, &value);
+                        if (opcode == DW_OP_BRA && stack[--num] == 0) value = 0;
+                        if ((int16_t)value < 0 ? -(int16_t)value > ptr - start : (int16_t)value > end - ptr) ok = false;
+                        else ptr += (int16_t)value;
+                        break;
+                    case DW_OP_NOP:         break;
+                    default:
+                        if (num_operands != 2) return false;
+                        
+                        // Binary operations pop the top value and replace the next one
+                        value = *top;
+                        top--;
+                        num--;
+                        switch (opcode) {
+                            case DW_OP_AND:     *top &= value;                                              break;
+                            case DW_OP_MINUS:   *top -= value;                                              break;
+                            case DW_OP_MUL:     *top *= value;                                              break;
+                            case DW_OP_OR:      *top |= value;                                              break;
+                            case DW_OP_PLUS:    *top += value;                                              break;
+                            case DW_OP_SHL:     *top = value < 64 ? *top << value : 0;                      break;
+                            case DW_OP_SHR:     *top = value < 64 ? *top >> value : 0;                      break;
+                            case DW_OP_SHRA:    *top = (int64_t)*top >> (value < 64 ? value : 63);          break;
+                            case DW_OP_XOR:     *top ^= value;                                              break;
+                            case DW_OP_EQ:      *top = (int64_t)*top == (int64_t)value;                     break;
+                            case DW_OP_GE:      *top = (int64_t)*top >= (int64_t)value;                     break;
+                            case DW_OP_GT:      *top = (int64_t)*top > (int64_t)value;                      break;
+                            case DW_OP_LE:      *top = (int64_t)*top <= (int64_t)value;                     break;
+                            case DW_OP_LT:      *top = (int64_t)*top < (int64_t)value;                      break;
+                            case DW_OP_NE:      *top = (int64_t)*top != (int64_t)value;                     break;
+                            case DW_OP_DIV:
+                                if (value == 0 || ((int64_t)*top == INT64_MIN && (int64_t)value == -1)) return false;
+                                *top = (int64_t)*top / (int64_t)value;
+                                break;
+                            case DW_OP_MOD:
+                                if (value == 0) return false;
+                                *top %= value;
+                                break;
+                        }
+                        break;
+                }
+                if (!ok) return false;
+                continue;
+        }
+        if (!ok) return false;
+        stack[num++] = value;
+    }
+    
+    if (num == 0) return false;
+    *value_out = stack[num - 1];
+    return true;
+}
+
+
+ElfParser_Error elfparser_apply_unwind_row(const ElfParser_FdeTable* table, const ElfParser_UnwindRow* row,
+                                           const uint64_t* registers, ElfParser_ReadMemoryCallback read_memory,
+                                           void* user_data, uint64_t* registers_out) {
+    uint64_t word_size = elfparser_get_word_size(table->header);
+    uint64_t address_mask = word_size == 4 ? UINT32_MAX : UINT64_MAX;
+    
+    uint64_t cfa;
+    if (row->cfa.type == ELFPARSER_UNWIND_RULE_REGISTER) {
+        cfa = registers[row->cfa.reg] + row->cfa.offset;
+    } else if (row->cfa.type != ELFPARSER_UNWIND_RULE_EXPRESSION ||
+               !elfparser_evaluate_unwind_expression(table, &row->cfa, registers, read_memory, user_data, false, 0, &cfa)) {
+        return ELFPARSER_INVALID;
+    }
+    cfa &= address_mask;
+    
+    // Registers are computed into a copy so that registers_out may be registers. Most rules are
+    // ELFPARSER_UNWIND_RULE_SAME_VALUE, so copy everything and only visit the registers which changed
+    uint64_t caller[ELFPARSER_UNWIND_MAX_REGISTERS];
+    memcpy(caller, registers, sizeof(caller));
+    
+    for (uint64_t changed = row->changed_registers; changed != 0; changed &= changed - 1) {
+        uint64_t i = __builtin_ctzll(changed);
+        const ElfParser_UnwindRule* rule = &row->registers[i];
+        uint64_t address;
+        bool ok = true;
+        
+        switch (rule->type) {
+            case ELFPARSER_UNWIND_RULE_UNDEFINED:   caller[i] = 0;                                          break;
+            case ELFPARSER_UNWIND_RULE_VAL_OFFSET:  caller[i] = (cfa + rule->offset) & address_mask;        break;
+            case ELFPARSER_UNWIND_RULE_REGISTER:    caller[i] = registers[rule->reg];                       break;
+            case ELFPARSER_UNWIND_RULE_OFFSET:
+                ok = read_memory((cfa + rule->offset) & address_mask, word_size, &caller[i], user_data);
+                break;
+            case ELFPARSER_UNWIND_RULE_EXPRESSION:
+                ok = elfparser_evaluate_unwind_expression(table, rule, registers, read_memory, user_data, true, cfa,
+                                                          &address) &&
+                     read_memory(address & address_mask, word_size, &caller[i], user_data);
+                break;
+            case ELFPARSER_UNWIND_RULE_VAL_EXPRESSION:
+                ok = elfparser_evaluate_unwind_expression(table, rule, registers, read_memory, user_data, true, cfa,
+                                                          &caller[i]);
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok) return ELFPARSER_INVALID;
+    }
+    
+    // By convention the CFA is the value of the stack pointer in the calling frame
+    uint64_t stack_pointer = elfparser_get_stack_pointer_register(table->header);
+    if (stack_pointer < ELFPARSER_UNWIND_MAX_REGISTERS &&
+        row->registers[stack_pointer].type == ELFPARSER_UNWIND_RULE_SAME_VALUE) {
+        caller[stack_pointer] = cfa;
+    }
+    
+    memcpy(registers_out, caller, sizeof(caller));
+    
+    if (row->registers[row->return_address_register].type == ELFPARSER_UNWIND_RULE_UNDEFINED) return ELFPARSER_NOT_FOUND;
+    return ELFPARSER_NOERROR;
+}
+
+
+void elfparser_unwind_cache_init(ElfParser_UnwindCache* cache_out, void* buffer, uint64_t buffer_size) {
+    ElfParser_UnwindRow* rows = (void*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7);
+    uint64_t padding = (uintptr_t)rows - (uintptr_t)buffer;
+    uint64_t num_rows = buffer_size > padding ? (buffer_size - padding) / sizeof(ElfParser_UnwindRow) : 0;
+    
+    // Round down to a power of two so that a slot can be picked with a mask
+    while (num_rows & (num_rows - 1)) num_rows &= num_rows - 1;
+    
+    // An empty range never covers any address
+    for (uint64_t i = 0; i < num_rows; i++) {
+        rows[i].pc_begin    = 0;
+        rows[i].pc_end      = 0;
+    }
+    
+    cache_out->rows     = rows;
+    cache_out->num_rows = num_rows;
+}
+
+
+ElfParser_Error elfparser_get_unwind_row_cached(const ElfParser_FdeTable* table, ElfParser_UnwindCache* cache,
+                                                uint64_t pc, const ElfParser_UnwindRow** row_out) {
+    if (cache->num_rows == 0) return ELFPARSER_INVALID;
+    
+    // Fibonacci hashing - the top bits of the product spread nearby addresses over the whole cache
+    uint64_t bits = __builtin_ctzll(cache->num_rows);
+    uint64_t slot = bits == 0 ? 0 : (pc * 0x9e3779b97f4a7c15) >> (64 - bits);
+    ElfParser_UnwindRow* row = &cache->rows[slot];
+    
+    if (pc - row->pc_begin >= row->pc_end - row->pc_begin) {
+        ElfParser_Error err = elfparser_get_unwind_row(table, pc, row);
+        if (err != ELFPARSER_NOERROR) {
+            row->pc_begin   = 0;
+            row->pc_end     = 0;
+            return err;
+        }
+    }
+    
+    *row_out = row;
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
@@ -0,0 +1,481 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+#include "sort.h"
+
+// Offset of a header field, for reporting anomalies in the ELF header. <stddef.h> isn't needed for the builtin
+#define ELFPARSER_HEADER_FIELD_OFFSET(is_64, field) \
+    ((is_64) ? __builtin_offsetof(Elf64_Ehdr, field) : __builtin_offsetof(Elf32_Ehdr, field))
+
+// Kinds of file ranges checked for overlaps. Segments sort before everything else starting at the same offset, so a
+// section starting exactly at the start of a segment is seen as inside it
+typedef enum {
+    ELFPARSER_RANGE_SEGMENT,
+    ELFPARSER_RANGE_TABLE,      // ELF header, program header table or section header table
+    ELFPARSER_RANGE_SECTION,
+    ELFPARSER_RANGE_ALLOC_SECTION
+} ElfParser_VerifyRangeKind;
+
+typedef struct {
+    uint64_t                    start;
+    uint64_t                    end;
+    uint64_t                    index;      // Section or program header index, UINT64_MAX for tables
+    ElfParser_VerifyRangeKind   kind;
+} ElfParser_VerifyRange;
+
+typedef struct {
+    const void*             elf_start;
+    const ElfParser_Header* header;
+    ElfParser_Anomaly*      anomalies;
+    uint64_t                max_anomalies;
+    uint64_t                num_anomalies;  // Keeps counting past max_anomalies
+    ElfParser_VerifyRange*  ranges;
+    uint64_t                num_ranges;
+} ElfParser_VerifyContext;
+
+
+static void elfparser_report_anomaly(ElfParser_VerifyContext* context, ElfParser_AnomalyKind kind,
+                                     uint64_t offset, uint64_t index, uint64_t value) {
+    if (context->num_anomalies < context->max_anomalies) {
+        ElfParser_Anomaly* anomaly = &context->anomalies[context->num_anomalies];
+        anomaly->kind   = kind;
+        anomaly->offset = offset;
+        anomaly->index  = index;
+        anomaly->value  = value;
+    }
+    context->num_anomalies++;
+}
+
+
+static void elfparser_add_range(ElfParser_VerifyContext* context, ElfParser_VerifyRangeKind kind,
+                                uint64_t start, uint64_t size, uint64_t index) {
+    // Ranges which don't lie within the file have already been reported, and empty ranges can't overlap anything
+    if (size == 0 || start > context->header->elf_size || size > context->header->elf_size - start) return;
+    
+    ElfParser_VerifyRange* range = &context->ranges[context->num_ranges++];
+    range->start    = start;
+    range->end      = start + size;
+    range->index    = index;
+    range->kind     = kind;
+}
+
+
+static inline bool elfparser_is_power_of_2(uint64_t value) {
+    return (value & (value - 1)) == 0;
+}
+
+
+static bool elfparser_is_verify_range_less(const void* a, const void* b, const void* context) {
+    const ElfParser_VerifyRange* range_a = a;
+    const ElfParser_VerifyRange* range_b = b;
+    
+    if (range_a->start != range_b->start) return range_a->start < range_b->start;
+    if (range_a->kind != range_b->kind) return range_a->kind < range_b->kind;
+    return range_a->index < range_b->index;
+}
+
+
+static void elfparser_verify_header(ElfParser_VerifyContext* context) {
+    const ElfParser_Header* header = context->header;
+    bool is_64 = header->ei_class == ELFPARSER_ELFCLASS64;
+    
+    // Ident fields are at the same offsets (4 to 7) in both classes
+    if (!elfparser_is_valid_ei_class(header->ei_class)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_INVALID_HEADER_FIELD, 4, UINT64_MAX, header->ei_class);
+    }
+    if (!elfparser_is_valid_ei_data(header->ei_data)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_INVALID_HEADER_FIELD, 5, UINT64_MAX, header->ei_data);
+    }
+    if (!elfparser_is_valid_ei_version(header->ei_version)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_INVALID_HEADER_FIELD, 6, UINT64_MAX, header->ei_version);
+    }
+    if (!elfparser_is_valid_ei_osabi(header->ei_osabi)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_INVALID_HEADER_FIELD, 7, UINT64_MAX, header->ei_osabi);
+    }
+    if (!elfparser_is_valid_e_type(header->e_type)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_INVALID_HEADER_FIELD, ELFPARSER_HEADER_FIELD_OFFSET(is_64, e_type),
+                                 UINT64_MAX, header->e_type);
+    }
+    if (!elfparser_is_valid_e_version(header->e_version)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_INVALID_HEADER_FIELD, ELFPARSER_HEADER_FIELD_OFFSET(is_64, e_version),
+                                 UINT64_MAX, header->e_version);
+    }
+    
+    // Entry sizes smaller than the structures they describe would make entries overlap
+    uint64_t ehdr_size = is_64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr);
+    uint64_t phdr_size = is_64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr);
+    uint64_t shdr_size = is_64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr);
+    
+    if (header->e_ehsize < ehdr_size) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_BAD_ENTRY_SIZE,
+                                 ELFPARSER_HEADER_FIELD_OFFSET(is_64, e_ehsize),
+                                 UINT64_MAX, header->e_ehsize);
+    }
+    if (header->e_phnum != 0 && header->e_phentsize < phdr_size) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_BAD_ENTRY_SIZE,
+                                 ELFPARSER_HEADER_FIELD_OFFSET(is_64, e_phentsize),
+                                 UINT64_MAX, header->e_phentsize);
+    }
+    if (header->true_shnum != 0 && header->e_shentsize < shdr_size) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_BAD_ENTRY_SIZE,
+                                 ELFPARSER_HEADER_FIELD_OFFSET(is_64, e_shentsize),
+                                 UINT64_MAX, header->e_shentsize);
+    }
+    
+    // Tables are checked as a whole here, and as ranges for overlaps later
+    uint64_t ph_table_size = (uint64_t)header->e_phnum * header->e_phentsize;
+    uint64_t sh_table_size = header->true_shnum * header->e_shentsize;
+    
+    if (elfparser_get_num_entries_in_bounds(header, header->e_phoff, header->e_phentsize, phdr_size,
+                                            header->e_phnum) != header->e_phnum) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_PH_TABLE_OUT_OF_BOUNDS, header->e_phoff, UINT64_MAX,
+                                 ph_table_size);
+    }
+    if (elfparser_get_num_entries_in_bounds(header, header->e_shoff, header->e_shentsize, shdr_size,
+                                            header->true_shnum) != header->true_shnum) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SH_TABLE_OUT_OF_BOUNDS, header->e_shoff, UINT64_MAX,
+                                 sh_table_size);
+    }
+    
+    elfparser_add_range(context, ELFPARSER_RANGE_TABLE, 0, ehdr_size, UINT64_MAX);
+    elfparser_add_range(context, ELFPARSER_RANGE_TABLE, header->e_phoff, ph_table_size, UINT64_MAX);
+    elfparser_add_range(context, ELFPARSER_RANGE_TABLE, header->e_shoff, sh_table_size, UINT64_MAX);
+}
+
+
+static void elfparser_verify_section(ElfParser_VerifyContext* context, const ElfParser_SectionHeader* section,
+                                     uint64_t section_name_table_size) {
+    const ElfParser_Header* header = context->header;
+    uint64_t offset = header->e_shoff + section->index * header->e_shentsize;
+    
+    if (section->index == 0) {
+        if (!elfparser_is_null_section(section)) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_BAD_NULL_SECTION, offset, 0, section->sh_type);
+        }
+        return;
+    }
+    
+    if (!elfparser_is_valid_sh_type(section->sh_type)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_INVALID_TYPE, offset, section->index,
+                                 section->sh_type);
+    }
+    if (header->true_shstrndx != 0 && section->sh_name >= section_name_table_size) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_NAME_OUT_OF_BOUNDS, offset, section->index,
+                                 section->sh_name);
+    }
+    
+    bool has_data = section->sh_type != ELFPARSER_SHT_NOBITS && section->sh_type != ELFPARSER_SHT_NULL;
+    if (has_data && (section->sh_offset > header->elf_size || section->sh_size > header->elf_size - section->sh_offset)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_OUT_OF_BOUNDS, offset, section->index,
+                                 section->sh_offset);
+    }
+    
+    if (section->sh_addralign > 1 && !elfparser_is_power_of_2(section->sh_addralign)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_BAD_ALIGN, offset, section->index,
+                                 section->sh_addralign);
+    } else if (section->sh_addralign > 1 && section->sh_addr % section->sh_addralign != 0) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_MISALIGNED, offset, section->index,
+                                 section->sh_addr);
+    }
+    
+    // Sections which must link to another section, and sections made of fixed size entries
+    bool needs_link = false;
+    bool needs_entsize = false;
+    switch (section->sh_type) {
+        case ELFPARSER_SHT_SYMTAB:
+        case ELFPARSER_SHT_DYNSYM:
+        case ELFPARSER_SHT_DYNAMIC:
+            needs_link = true;
+            needs_entsize = true;
+            break;
+        case ELFPARSER_SHT_REL:
+        case ELFPARSER_SHT_RELA:
+            // Static executables have relocations which don't link to a symbol table
+            needs_entsize = true;
+            break;
+        case ELFPARSER_SHT_HASH:
+        case ELFPARSER_SHT_GNU_HASH:
+        case ELFPARSER_SHT_GNU_VERSYM:
+        case ELFPARSER_SHT_GNU_VERDEF:
+        case ELFPARSER_SHT_GNU_VERNEED:
+        case ELFPARSER_SHT_GROUP:
+        case ELFPARSER_SHT_SYMTAB_SHNDX:
+            needs_link = true;
+            break;
+        default:
+            break;
+    }
+    
+    if (section->sh_link >= header->true_shnum || (needs_link && section->sh_link == 0)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_BAD_LINK, offset, section->index, section->sh_link);
+    }
+    if (needs_entsize && (section->sh_entsize == 0 || section->sh_size % section->sh_entsize != 0)) {
+        elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_BAD_ENTSIZE, offset, section->index,
+                                 section->sh_entsize);
+    }
+    
+    // String tables must start with an empty string and end with a terminator
+    if (section->sh_type == ELFPARSER_SHT_STRTAB && has_data && section->sh_size != 0 &&
+        section->sh_offset <= header->elf_size && section->sh_size <= header->elf_size - section->sh_offset) {
+        const char* strings = context->elf_start + section->sh_offset;
+        if (strings[0] != '\0' || strings[section->sh_size - 1] != '\0') {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_STRING_TABLE_UNTERMINATED, offset, section->index,
+                                     section->sh_offset);
+        }
+    }
+    
+    if (has_data) {
+        bool is_alloc = (section->sh_flags & ELFPARSER_SHF_ALLOC) != 0;
+        elfparser_add_range(context, is_alloc ? ELFPARSER_RANGE_ALLOC_SECTION : ELFPARSER_RANGE_SECTION,
+                            section->sh_offset, section->sh_size, section->index);
+    }
+}
+
+
+static void elfparser_verify_symbols(ElfParser_VerifyContext* context, const ElfParser_SectionHeader* symbol_section) {
+    const void* elf_start = context->elf_start;
+    const ElfParser_Header* header = context->header;
+    
+    ElfParser_SymbolTable table;
+    if (elfparser_get_section_symbol_table(elf_start, header, symbol_section, &table) != ELFPARSER_NOERROR) return;
+    
+    // Without a string table, every name is out of bounds - that's reported as a bad link instead
+    ElfParser_SectionHeader string_section;
+    uint64_t string_table_size = 0;
+    if (elfparser_get_section_header(elf_start, header, symbol_section->sh_link, &string_section) == ELFPARSER_NOERROR) {
+        string_table_size = string_section.sh_size;
+    }
+    
+    ElfParser_SymbolCursor cursor;
+    elfparser_symbol_table_cursor_init(elf_start, header, &table, &cursor);
+    
+    ElfParser_Symbol symbol;
+    while (elfparser_symbol_cursor_next(&cursor, &symbol) == ELFPARSER_NOERROR) {
+        uint64_t offset = table.offset + symbol.index * table.entry_size;
+        
+        if (symbol.st_name != 0 && symbol.st_name >= string_table_size) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SYMBOL_NAME_OUT_OF_BOUNDS, offset, symbol.index,
+                                     symbol.st_name);
+        }
+        if (!elfparser_is_valid_st_bind(symbol.st_bind) || !elfparser_is_valid_st_type(symbol.st_type)) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SYMBOL_INVALID_INFO, offset, symbol.index,
+                                     symbol.st_info);
+        }
+        
+        // sh_info is the index of the first non-local symbol - all local symbols must come before it
+        if ((symbol.st_bind == ELFPARSER_STB_LOCAL) != (symbol.index < symbol_section->sh_info)) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SYMBOL_BAD_ORDER, offset, symbol.index,
+                                     symbol_section->sh_info);
+        }
+        
+        if (symbol.st_shndx == ELFPARSER_SHN_UNDEF || symbol.st_shndx >= ELFPARSER_SHN_LORESERVE) continue;
+        
+        ElfParser_SectionHeader section;
+        if (elfparser_get_section_header(elf_start, header, symbol.st_shndx, &section) != ELFPARSER_NOERROR) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SYMBOL_BAD_SECTION, offset, symbol.index,
+                                     symbol.st_shndx);
+            continue;
+        }
+        
+        // TLS symbol values are offsets into the TLS block rather than addresses
+        if (symbol.st_type == ELFPARSER_STT_TLS) continue;
+        
+        // Section boundary symbols defined by the linker (e.g. __bss_start) only loosely belong to their section - ld
+        // puts __bss_start in the alignment padding before .bss, and lld gives _end the first section of its segment
+        if (symbol.st_type == ELFPARSER_STT_NOTYPE && symbol.st_bind != ELFPARSER_STB_LOCAL && symbol.st_size == 0) {
+            continue;
+        }
+        
+        // Symbol values are offsets into sections in relocatable files, and addresses everywhere else.
+        // A symbol may sit right at the end of its section (e.g. _end)
+        bool is_outside;
+        if (header->e_type == ELFPARSER_ET_REL) {
+            is_outside = symbol.st_value > section.sh_size;
+        } else {
+            is_outside = (section.sh_flags & ELFPARSER_SHF_ALLOC) != 0 &&
+                         (symbol.st_value < section.sh_addr || symbol.st_value - section.sh_addr > section.sh_size);
+        }
+        if (is_outside) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SYMBOL_OUTSIDE_SECTION, offset, symbol.index,
+                                     symbol.st_value);
+        }
+    }
+}
+
+
+static void elfparser_verify_sections(ElfParser_VerifyContext* context) {
+    const void* elf_start = context->elf_start;
+    const ElfParser_Header* header = context->header;
+    
+    uint64_t section_name_table_size = 0;
+    ElfParser_SectionHeader section;
+    if (header->true_shstrndx != 0) {
+        // Section names can't be read without a string table
+        if (elfparser_get_section_header(elf_start, header, header->true_shstrndx, &section) != ELFPARSER_NOERROR ||
+            section.sh_type != ELFPARSER_SHT_STRTAB) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_BAD_SHSTRNDX,
+                                     ELFPARSER_HEADER_FIELD_OFFSET(header->ei_class == ELFPARSER_ELFCLASS64, e_shstrndx),
+                                     UINT64_MAX, header->true_shstrndx);
+        } else {
+            section_name_table_size = section.sh_size;
+        }
+    }
+    
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    
+    while (elfparser_section_cursor_next(&cursor, &section) == ELFPARSER_NOERROR) {
+        elfparser_verify_section(context, &section, section_name_table_size);
+        
+        if (section.sh_type == ELFPARSER_SHT_SYMTAB || section.sh_type == ELFPARSER_SHT_DYNSYM) {
+            elfparser_verify_symbols(context, &section);
+        }
+    }
+}
+
+
+static void elfparser_verify_segments(ElfParser_VerifyContext* context) {
+    const ElfParser_Header* header = context->header;
+    
+    ElfParser_ProgramHeaderCursor cursor;
+    elfparser_program_header_cursor_init(context->elf_start, header, &cursor);
+    
+    bool seen_load = false;
+    uint64_t last_load_vaddr = 0;
+    uint64_t last_load_end = 0;
+    
+    ElfParser_ProgramHeader program_header;
+    while (elfparser_program_header_cursor_next(&cursor, &program_header) == ELFPARSER_NOERROR) {
+        uint64_t offset = header->e_phoff + program_header.index * header->e_phentsize;
+        uint64_t index = program_header.index;
+        
+        if (!elfparser_is_valid_p_type(program_header.p_type)) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SEGMENT_INVALID_TYPE, offset, index,
+                                     program_header.p_type);
+        }
+        if (program_header.p_offset > header->elf_size ||
+            program_header.p_filesz > header->elf_size - program_header.p_offset) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SEGMENT_OUT_OF_BOUNDS, offset, index,
+                                     program_header.p_offset);
+        }
+        if (program_header.p_align > 1 && !elfparser_is_power_of_2(program_header.p_align)) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SEGMENT_BAD_ALIGN, offset, index,
+                                     program_header.p_align);
+        }
+        
+        if (program_header.p_type != ELFPARSER_PT_LOAD) continue;
+        
+        if (program_header.p_filesz > program_header.p_memsz) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SEGMENT_FILESZ_TOO_BIG, offset, index,
+                                     program_header.p_filesz);
+        }
+        
+        // Loadable segments must be mappable - file offset and address have to agree modulo the alignment
+        if (program_header.p_align > 1 && elfparser_is_power_of_2(program_header.p_align) &&
+            (program_header.p_offset ^ program_header.p_vaddr) & (program_header.p_align - 1)) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SEGMENT_MISALIGNED, offset, index,
+                                     program_header.p_vaddr);
+        }
+        
+        // Loadable segments must be sorted by address, so one pass finds any overlapping segments
+        if (seen_load && program_header.p_vaddr < last_load_vaddr) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_LOAD_SEGMENTS_UNORDERED, offset, index,
+                                     program_header.p_vaddr);
+        } else if (seen_load && program_header.p_vaddr < last_load_end) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_LOAD_SEGMENTS_OVERLAP, offset, index,
+                                     program_header.p_vaddr);
+        }
+        
+        uint64_t end = program_header.p_vaddr + program_header.p_memsz;
+        if (!seen_load || end > last_load_end) last_load_end = end;
+        last_load_vaddr = program_header.p_vaddr;
+        seen_load = true;
+        
+        elfparser_add_range(context, ELFPARSER_RANGE_SEGMENT, program_header.p_offset, program_header.p_filesz, index);
+    }
+}
+
+
+// One sweep over all ranges sorted by start offset finds both overlapping sections/tables and sections which begin in
+// a loadable segment but run past its end. Only the furthest reaching range of each group needs to be remembered
+static void elfparser_verify_ranges(ElfParser_VerifyContext* context) {
+    elfparser_sort(context->ranges, context->num_ranges, sizeof(ElfParser_VerifyRange),
+                   elfparser_is_verify_range_less, NULL);
+    
+    const ElfParser_VerifyRange* furthest_data = NULL;
+    const ElfParser_VerifyRange* furthest_segment = NULL;
+    
+    for (uint64_t i = 0; i < context->num_ranges; i++) {
+        const ElfParser_VerifyRange* range = &context->ranges[i];
+        
+        if (range->kind == ELFPARSER_RANGE_SEGMENT) {
+            if (furthest_segment == NULL || range->end > furthest_segment->end) furthest_segment = range;
+            continue;
+        }
+        
+        if (furthest_data != NULL && range->start < furthest_data->end) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_OVERLAP, range->start, range->index,
+                                     furthest_data->index);
+        }
+        if (furthest_data == NULL || range->end > furthest_data->end) furthest_data = range;
+        
+        if (range->kind == ELFPARSER_RANGE_ALLOC_SECTION && furthest_segment != NULL &&
+            range->start < furthest_segment->end && range->end > furthest_segment->end) {
+            elfparser_report_anomaly(context, ELFPARSER_ANOMALY_SECTION_STRADDLES_SEGMENT, range->start, range->index,
+                                     furthest_segment->index);
+        }
+    }
+}
+
+
+uint64_t elfparser_get_verify_buffer_size(const ElfParser_Header* header) {
+    // One range per section and program header, plus the ELF header and the two header tables
+    return sizeof(ElfParser_VerifyRange) * (header->true_shnum + header->e_phnum + 3) + 7;
+}
+
+
+ElfParser_Error elfparser_verify(const void* elf_start, const ElfParser_Header* header, void* buffer, uint64_t buffer_size,
+                                 ElfParser_Anomaly* anomalies, uint64_t max_anomalies, uint64_t* num_out) {
+    *num_out = 0;
+    if (buffer == NULL || buffer_size < elfparser_get_verify_buffer_size(header)) return ELFPARSER_INVALID;
+    
+    ElfParser_VerifyContext context = {
+        .elf_start      = elf_start,
+        .header         = header,
+        .anomalies      = anomalies,
+        .max_anomalies  = max_anomalies,
+        .num_anomalies  = 0,
+        .ranges         = (ElfParser_VerifyRange*)(((uintptr_t)buffer + 7) & ~(uintptr_t)7),
+        .num_ranges     = 0
+    };
+    
+    elfparser_verify_header(&context);
+    elfparser_verify_sections(&context);
+    elfparser_verify_segments(&context);
+    elfparser_verify_ranges(&context);
+    
+    *num_out = context.num_anomalies;
+    return ELFPARSER_NOERROR;
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2024 FennelFoxxo
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "parse.h"
+
+// Bit of a .gnu.version entry which marks a version as hidden (i.e. not the default version of the symbol)
+#define ELFPARSER_VERSYM_HIDDEN 0x8000
+
+
+// Check that a structure of struct_size bytes at off lies within the file
+static inline bool elfparser_is_version_struct_in_bounds(const ElfParser_Header* header, uint64_t off,
+                                                         uint64_t struct_size) {
+    return off <= header->elf_size && struct_size <= header->elf_size - off;
+}
+
+
+// Returns the string at string_table_offset + name, or an empty string if it is out of bounds
+static const char* elfparser_get_version_string(const void* elf_start, const ElfParser_Header* header,
+                                                uint64_t string_table_offset, uint32_t name) {
+    uint64_t name_off = string_table_offset + name;
+    if (!elfparser_is_string_in_bounds(elf_start, header, name_off)) return "";
+    return elf_start + name_off;
+}
+
+
+// Version definitions and needs both form a chain of structures linked by relative offsets, which can point anywhere
+// - every link is bounds checked, and the chains are never followed further than the count from sh_info
+static bool elfparser_find_verdef(const void* elf_start, const ElfParser_Header* header,
+                                  const ElfParser_VersionTable* versions, uint16_t index,
+                                  ElfParser_SymbolVersion* version_out) {
+    uint64_t verdef_off = versions->verdef_offset;
+    
+    for (uint64_t i = 0; i < versions->verdef_num && verdef_off != 0; i++) {
+        if (!elfparser_is_version_struct_in_bounds(header, verdef_off, sizeof(Elf_Verdef))) return false;
+        const Elf_Verdef* verdef = elf_start + verdef_off;
+        
+        if (elfparser_read_16(header, &verdef->vd_ndx) == index) {
+            // The first auxiliary entry holds the name of the version itself, the rest name its parents
+            uint64_t verdaux_off = verdef_off + elfparser_read_32(header, &verdef->vd_aux);
+            if (!elfparser_is_version_struct_in_bounds(header, verdaux_off, sizeof(Elf_Verdaux))) return false;
+            const Elf_Verdaux* verdaux = elf_start + verdaux_off;
+            
+            version_out->name = elfparser_get_version_string(elf_start, header, versions->verdef_string_table_offset,
+                                                             elfparser_read_32(header, &verdaux->vda_name));
+            version_out->file = NULL;
+            return true;
+        }
+        
+        uint32_t next = elfparser_read_32(header, &verdef->vd_next);
+        verdef_off = next == 0 ? 0 : verdef_off + next;
+    }
+    return false;
+}
+
+
+static bool elfparser_find_verneed(const void* elf_start, const ElfParser_Header* header,
+                                   const ElfParser_VersionTable* versions, uint16_t index,
+                                   ElfParser_SymbolVersion* version_out) {
+    uint64_t verneed_off = versions->verneed_offset;
+    
+    for (uint64_t i = 0; i < versions->verneed_num && verneed_off != 0; i++) {
+        if (!elfparser_is_version_struct_in_bounds(header, verneed_off, sizeof(Elf_Verneed))) return false;
+        const Elf_Verneed* verneed = elf_start + verneed_off;
+        
+        // Each needed file has one auxiliary entry per version needed from it
+        uint64_t vernaux_off = verneed_off + elfparser_read_32(header, &verneed->vn_aux);
+        uint16_t vernaux_num = elfparser_read_16(header, &verneed->vn_cnt);
+        
+        for (uint16_t j = 0; j < vernaux_num; j++) {
+            if (!elfparser_is_version_struct_in_bounds(header, vernaux_off, sizeof(Elf_Vernaux))) return false;
+            const Elf_Vernaux* vernaux = elf_start + vernaux_off;
+            
+            if (elfparser_read_16(header, &vernaux->vna_other) == index) {
+                version_out->name = elfparser_get_version_string(elf_start, header,
+                                                                 versions->verneed_string_table_offset,
+                                                                 elfparser_read_32(header, &vernaux->vna_name));
+                version_out->file = elfparser_get_version_string(elf_start, header,
+                                                                 versions->verneed_string_table_offset,
+                                                                 elfparser_read_32(header, &verneed->vn_file));
+                return true;
+            }
+            
+            uint32_t next = elfparser_read_32(header, &vernaux->vna_next);
+            if (next == 0) break;
+            vernaux_off += next;
+        }
+        
+        uint32_t next = elfparser_read_32(header, &verneed->vn_next);
+        verneed_off = next == 0 ? 0 : verneed_off + next;
+    }
+    return false;
+}
+
+
+ElfParser_Error elfparser_get_version_table(const void* elf_start, const ElfParser_Header* header,
+                                            const ElfParser_SymbolTable* symbols, ElfParser_VersionTable* versions_out) {
+    memset(versions_out, 0, sizeof(ElfParser_VersionTable));
+    bool found_versym = false;
+    
+    ElfParser_SectionCursor cursor;
+    elfparser_section_cursor_init(elf_start, header, &cursor);
+    
+    ElfParser_SectionHeader section;
+    ElfParser_SectionHeader string_section;
+    while (elfparser_section_cursor_next(&cursor, &section) == ELFPARSER_NOERROR) {
+        if (section.sh_type == ELFPARSER_SHT_GNU_VERSYM && section.sh_link == symbols->section_index) {
+            versions_out->versym_offset = section.sh_offset;
+            versions_out->versym_num    = elfparser_get_num_entries_in_bounds(header, section.sh_offset, 2, 2,
+                                                                              section.sh_size / 2);
+            found_versym = true;
+            
+        } else if (section.sh_type == ELFPARSER_SHT_GNU_VERDEF &&
+                   elfparser_get_section_header(elf_start, header, section.sh_link, &string_section) == ELFPARSER_NOERROR) {
+            versions_out->verdef_offset                 = section.sh_offset;
+            versions_out->verdef_num                    = section.sh_info;
+            versions_out->verdef_string_table_offset    = string_section.sh_offset;
+            
+        } else if (section.sh_type == ELFPARSER_SHT_GNU_VERNEED &&
+                   elfparser_get_section_header(elf_start, header, section.sh_link, &string_section) == ELFPARSER_NOERROR) {
+            versions_out->verneed_offset                = section.sh_offset;
+            versions_out->verneed_num                   = section.sh_info;
+            versions_out->verneed_string_table_offset   = string_section.sh_offset;
+        }
+    }
+    
+    return found_versym ? ELFPARSER_NOERROR : ELFPARSER_NOT_FOUND;
+}
+
+
+ElfParser_Error elfparser_get_symbol_version(const void* elf_start, const ElfParser_Header* header,
+                                             const ElfParser_VersionTable* versions, uint64_t symbol_index,
+                                             ElfParser_SymbolVersion* version_out) {
+    if (symbol_index >= versions->versym_num) return ELFPARSER_INVALID;
+    
+    uint16_t versym = elfparser_read_16(header, elf_start + versions->versym_offset + symbol_index * 2);
+    
+    version_out->name       = "";
+    version_out->file       = NULL;
+    version_out->index      = versym & ~ELFPARSER_VERSYM_HIDDEN;
+    version_out->is_hidden  = (versym & ELFPARSER_VERSYM_HIDDEN) != 0;
+    
+    // Index 0 is local and index 1 is the base version (the file itself) - neither names a version
+    if (version_out->index <= 1) return ELFPARSER_NOERROR;
+    
+    // Defined symbols use indexes from .gnu.version_d, undefined symbols use indexes from .gnu.version_r
+    if (elfparser_find_verdef(elf_start, header, versions, version_out->index, version_out)) return ELFPARSER_NOERROR;
+    if (elfparser_find_verneed(elf_start, header, versions, version_out->index, version_out)) return ELFPARSER_NOERROR;
+    
+    return ELFPARSER_NOT_FOUND;
+}
\ No newline at end of file